@@ -7,12 +7,23 @@
 REX_NS_BEGIN
 
 /// <summary>
-/// Defines a rudimentary, resizable device list.
+/// Defines a rudimentary, resizable device list. Storage grows geometrically, so adding items one at a time
+/// is amortized constant time.
 /// </summary>
 template<typename T> class DeviceList
 {
     T*     _items;
     uint32 _size;
+    uint32 _capacity;
+
+    DeviceList( const DeviceList& )            = delete;
+    DeviceList& operator=( const DeviceList& ) = delete;
+
+    /// <summary>
+    /// Moves this list's items into new storage with the given capacity.
+    /// </summary>
+    /// <param name="capacity">The new capacity. Must be at least the current size.</param>
+    __both__ void Reallocate( uint32 capacity );
 
 public:
     /// <summary>
@@ -20,57 +31,110 @@ public:
     /// </summary>
     __both__ DeviceList();
 
+    /// <summary>
+    /// Creates a new device list by taking another list's items.
+    /// </summary>
+    /// <param name="other">The list to take the items from. It is left empty.</param>
+    __both__ DeviceList( DeviceList&& other );
+
     /// <summary>
     /// Destroys this device list.
     /// </summary>
     __both__ ~DeviceList();
 
+    /// <summary>
+    /// Gets the number of items this list can hold before it needs to grow.
+    /// </summary>
+    __both__ uint32 GetCapacity() const;
+
     /// <summary>
     /// Gets the item at the given index.
     /// </summary>
     /// <param name="index">The index.</param>
-    __device__ const T& Get( uint32 index ) const;
+    __both__ const T& Get( uint32 index ) const;
 
     /// <summary>
     /// Gets the number of items in this list.
     /// </summary>
-    __device__ uint32 GetSize() const;
+    __both__ uint32 GetSize() const;
+
+    /// <summary>
+    /// Copies this list's items into a new block of device memory, which the caller must release with cudaFree.
+    /// Empty lists produce a null pointer.
+    /// </summary>
+    /// <param name="items">The device copy of the items.</param>
+    __host__ bool CopyToDevice( T*& items ) const;
 
     /// <summary>
     /// Adds the given item to this list.
     /// </summary>
     /// <param name="item">The item to add.</param>
-    __device__ void Add( const T& item );
+    __both__ void Add( const T& item );
+
+    /// <summary>
+    /// Adds a range of items to this list, growing it at most once.
+    /// </summary>
+    /// <param name="items">The items to add.</param>
+    /// <param name="count">The number of items.</param>
+    __both__ void AddRange( const T* items, uint32 count );
+
+    /// <summary>
+    /// Removes every item from this list without releasing its storage.
+    /// </summary>
+    __both__ void Clear();
 
     /// <summary>
     /// Gets the item at the given index.
     /// </summary>
     /// <param name="index">The index.</param>
-    __device__ T& Get( uint32 index );
+    __both__ T& Get( uint32 index );
+
+    /// <summary>
+    /// Removes the item at the given index, shifting every item after it down by one.
+    /// </summary>
+    /// <param name="index">The index of the item to remove.</param>
+    __both__ void Remove( uint32 index );
 
     /// <summary>
-    /// Removes the item at the given index.
+    /// Removes the item at the given index by moving the last item into its place. Does not preserve order.
     /// </summary>
     /// <param name="index">The index of the item to remove.</param>
-    __device__ void Remove( uint32 index );
+    __both__ void SwapRemove( uint32 index );
+
+    /// <summary>
+    /// Ensures this list can hold at least the given number of items without growing.
+    /// </summary>
+    /// <param name="capacity">The number of items to make room for.</param>
+    __both__ void Reserve( uint32 capacity );
 
     /// <summary>
-    /// Resizes this list.
+    /// Resizes this list. New items are value initialized (zero for scalars); shrinking keeps the storage.
     /// </summary>
     /// <param name="size">The new size.</param>
-    __device__ void Resize( uint32 size );
+    __both__ void Resize( uint32 size );
+
+    /// <summary>
+    /// Releases any storage beyond this list's size.
+    /// </summary>
+    __both__ void ShrinkToFit();
 
     /// <summary>
     /// Gets the item at the given index.
     /// </summary>
     /// <param name="index">The index.</param>
-    __device__ const T& operator[]( uint32 index ) const;
+    __both__ const T& operator[]( uint32 index ) const;
 
     /// <summary>
     /// Gets the item at the given index.
     /// </summary>
     /// <param name="index">The index.</param>
-    __device__ T& operator[]( uint32 index );
+    __both__ T& operator[]( uint32 index );
+
+    /// <summary>
+    /// Takes another list's items, releasing this list's own.
+    /// </summary>
+    /// <param name="other">The list to take the items from. It is left empty.</param>
+    __both__ DeviceList& operator=( DeviceList&& other );
 };
 
 REX_NS_END
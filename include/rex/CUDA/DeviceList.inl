@@ -1,12 +1,26 @@
 #include "../Math/Math.hxx"
 
+#define DEVICE_LIST_MIN_CAPACITY 4
+
 REX_NS_BEGIN
 
 // create new device list
 template<typename T> DeviceList<T>::DeviceList()
-    : _items( nullptr ),
-      _size ( 0 )
+    : _items   ( nullptr ),
+      _size    ( 0 ),
+      _capacity( 0 )
+{
+}
+
+// create new device list from another list
+template<typename T> DeviceList<T>::DeviceList( DeviceList&& other )
+    : _items   ( other._items ),
+      _size    ( other._size ),
+      _capacity( other._capacity )
 {
+    other._items    = nullptr;
+    other._size     = 0;
+    other._capacity = 0;
 }
 
 // destroy device list
@@ -18,82 +32,208 @@ template<typename T> DeviceList<T>::~DeviceList()
         _items = nullptr;
     }
 
-    _size = 0;
+    _size     = 0;
+    _capacity = 0;
+}
+
+// move the items into new storage
+template<typename T> __both__ void DeviceList<T>::Reallocate( uint32 capacity )
+{
+    // create the new items
+    T* newItems = ( capacity > 0 ) ? new T[ capacity ] : nullptr;
+
+    // copy over the data
+    for ( uint32 i = 0; i < _size; ++i )
+    {
+        newItems[ i ] = _items[ i ];
+    }
+
+    // delete the old items if necessary
+    if ( _items )
+    {
+        delete[] _items;
+        _items = nullptr;
+    }
+
+    // update our data members
+    _items    = newItems;
+    _capacity = capacity;
+}
+
+// get the capacity of device list
+template<typename T> __both__ uint32 DeviceList<T>::GetCapacity() const
+{
+    return _capacity;
 }
 
 // get item in list
-template<typename T> __device__ const T& DeviceList<T>::Get( uint32 index ) const
+template<typename T> __both__ const T& DeviceList<T>::Get( uint32 index ) const
 {
     return _items[ index ];
 }
 
 // get size of device list
-template<typename T> __device__ uint32 DeviceList<T>::GetSize() const
+template<typename T> __both__ uint32 DeviceList<T>::GetSize() const
 {
     return _size;
 }
 
+// copy the items to the device
+template<typename T> __host__ bool DeviceList<T>::CopyToDevice( T*& items ) const
+{
+    items = nullptr;
+    if ( _size == 0 )
+    {
+        return true;
+    }
+
+    if ( cudaSuccess != cudaMalloc( reinterpret_cast<void**>( &items ), sizeof( T ) * _size ) )
+    {
+        items = nullptr;
+        return false;
+    }
+    if ( cudaSuccess != cudaMemcpy( items, _items, sizeof( T ) * _size, cudaMemcpyHostToDevice ) )
+    {
+        cudaFree( items );
+        items = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
 // add item to list
-template<typename T> __device__ void DeviceList<T>::Add( const T& item )
+template<typename T> __both__ void DeviceList<T>::Add( const T& item )
+{
+    if ( _size == _capacity )
+    {
+        Reallocate( Math::Max( _capacity * 2, uint32( DEVICE_LIST_MIN_CAPACITY ) ) );
+    }
+
+    _items[ _size++ ] = item;
+}
+
+// add items to list
+template<typename T> __both__ void DeviceList<T>::AddRange( const T* items, uint32 count )
 {
-    Resize( _size + 1 );
-    this->operator[]( _size - 1 ) = item;
+    // still grow geometrically so a run of small ranges stays cheap
+    if ( _size + count > _capacity )
+    {
+        Reallocate( Math::Max( _size + count, _capacity * 2 ) );
+    }
+
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        _items[ _size++ ] = items[ i ];
+    }
+}
+
+// clear list
+template<typename T> __both__ void DeviceList<T>::Clear()
+{
+    _size = 0;
 }
 
 // get item in list
-template<typename T> __device__ T& DeviceList<T>::Get( uint32 index )
+template<typename T> __both__ T& DeviceList<T>::Get( uint32 index )
 {
     return _items[ index ];
 }
 
 // remove item from the list
-template<typename T> __device__ void DeviceList<T>::Remove( uint32 index )
+template<typename T> __both__ void DeviceList<T>::Remove( uint32 index )
 {
+    if ( index >= _size )
+    {
+        return;
+    }
+
     for ( uint32 i = index; i < _size - 1; ++i )
     {
         _items[ i ] = _items[ i + 1 ];
     }
-    if ( index < _size )
+    --_size;
+}
+
+// remove item from the list w/o preserving order
+template<typename T> __both__ void DeviceList<T>::SwapRemove( uint32 index )
+{
+    if ( index >= _size )
     {
-        Resize( _size - 1 );
+        return;
     }
+
+    _items[ index ] = _items[ _size - 1 ];
+    --_size;
 }
 
-// resize list
-template<typename T> __device__ void DeviceList<T>::Resize( uint32 size )
+// reserve space in the list
+template<typename T> __both__ void DeviceList<T>::Reserve( uint32 capacity )
 {
-    // create the new items
-    T*     newItems = new T[ size ];
-    uint32 toSize   = Math::Min( _size, size );
+    if ( capacity > _capacity )
+    {
+        Reallocate( capacity );
+    }
+}
 
-    // copy over the data
-    for ( uint32 i = 0; i < toSize; ++i )
+// resize list
+template<typename T> __both__ void DeviceList<T>::Resize( uint32 size )
+{
+    // explicit sizes are usually final, so only allocate exactly what was asked for
+    if ( size > _capacity )
     {
-        newItems[ i ] = _items[ i ];
+        Reallocate( size );
     }
 
-    // delete the old items if necessary
-    if ( _items )
+    // items we're growing into may hold stale values, and new allocations of scalars aren't initialized at all
+    for ( uint32 i = _size; i < size; ++i )
     {
-        delete[] _items;
-        _items = nullptr;
+        _items[ i ] = T();
     }
 
-    // update our data members
-    _items = newItems;
-    _size  = size;
+    _size = size;
+}
+
+// release unused storage
+template<typename T> __both__ void DeviceList<T>::ShrinkToFit()
+{
+    if ( _capacity > _size )
+    {
+        Reallocate( _size );
+    }
 }
 
 // get item in list
-template<typename T> __device__ const T& DeviceList<T>::operator[]( uint32 index ) const
+template<typename T> __both__ const T& DeviceList<T>::operator[]( uint32 index ) const
 {
     return Get( index );
 }
 
 // get item in list
-template<typename T> __device__ T& DeviceList<T>::operator[]( uint32 index )
+template<typename T> __both__ T& DeviceList<T>::operator[]( uint32 index )
 {
     return Get( index );
 }
 
+// take the items from another list
+template<typename T> __both__ DeviceList<T>& DeviceList<T>::operator=( DeviceList&& other )
+{
+    if ( this != &other )
+    {
+        if ( _items )
+        {
+            delete[] _items;
+        }
+
+        _items          = other._items;
+        _size           = other._size;
+        _capacity       = other._capacity;
+        other._items    = nullptr;
+        other._size     = 0;
+        other._capacity = 0;
+    }
+
+    return *this;
+}
+
 REX_NS_END
\ No newline at end of file
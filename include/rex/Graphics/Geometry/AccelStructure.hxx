@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BVH.hxx"
+#include "Octree.hxx"
+
+/// <summary>
+/// Selects the octree as the scene's acceleration structure.
+/// </summary>
+#define REX_ACCEL_OCTREE 0
+
+/// <summary>
+/// Selects the SAH bounding volume hierarchy as the scene's acceleration structure.
+/// </summary>
+#define REX_ACCEL_BVH    1
+
+// define REX_ACCEL_STRUCTURE in the project settings to pick a different structure
+#if !defined( REX_ACCEL_STRUCTURE )
+#  define REX_ACCEL_STRUCTURE REX_ACCEL_BVH
+#endif
+
+REX_NS_BEGIN
+
+// NOTE : Every acceleration structure has the same construction, Add, Build, BuildLinear, BuildSpatial, Update,
+//        GetMemoryUsage, QueryIntersections, and QueryOcclusion methods, so anything that only needs to find
+//        geometry should use AccelStructure rather than a specific type.
+
+#if REX_ACCEL_STRUCTURE == REX_ACCEL_BVH
+/// <summary>
+/// The acceleration structure used by scenes.
+/// </summary>
+typedef BVH AccelStructure;
+#elif REX_ACCEL_STRUCTURE == REX_ACCEL_OCTREE
+/// <summary>
+/// The acceleration structure used by scenes.
+/// </summary>
+typedef Octree AccelStructure;
+#else
+#  error "Unknown acceleration structure selected by REX_ACCEL_STRUCTURE."
+#endif
+
+REX_NS_END
\ No newline at end of file
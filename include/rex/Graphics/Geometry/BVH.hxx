@@ -0,0 +1,372 @@
+#pragma once
+
+#include "Octree.hxx"
+
+// define REX_WIDE_BVH as 0 in the project settings to have host queries walk the binary nodes like the device does
+#if !defined( REX_WIDE_BVH )
+#  define REX_WIDE_BVH 1
+#endif
+
+// the deepest a BVH's builders will ever go; nodes at this depth are made into leaves, however many objects they
+// have, so that traversal stacks one entry deeper than this can never overflow
+#define REX_BVH_MAX_DEPTH 63
+
+REX_NS_BEGIN
+
+class WideBVH;
+
+/// <summary>
+/// Defines a single node in a bounding volume hierarchy.
+/// </summary>
+struct BVHNode
+{
+    BoundingBox Bounds;
+    uint32      Offset; // interior nodes: the index of the second child (the first child directly follows this node)
+                        // leaf nodes: the index of the first object
+    uint32      Count;  // the number of objects in a leaf node, or 0 for interior nodes
+
+    /// <summary>
+    /// Creates a new BVH node.
+    /// </summary>
+    __both__ BVHNode();
+};
+
+/// <summary>
+/// Defines a bounding volume hierarchy built with the surface area heuristic. Objects are added first and
+/// the hierarchy is then built all at once; the nodes are stored in one array in depth-first order.
+/// </summary>
+/// <remarks>
+/// Once objects move, the hierarchy can be refit rather than rebuilt: every object's bounds are read from its
+/// geometry again and the node bounds are recomputed from the leaves up, keeping the same tree. Refitting is much
+/// cheaper than building but the tree gets worse as objects drift away from where it was built, so Update compares
+/// the tree's surface area heuristic cost against its cost when it was built and only rebuilds once it has
+/// degraded too far.
+///
+/// BuildLinear trades tree quality for build speed. Objects are sorted along a Morton curve through their centers
+/// and the tree is split wherever the sorted codes first differ, so no split has to be searched for. The nodes
+/// are laid out the same way as the surface area heuristic's, so both are traversed the same way.
+///
+/// BuildSpatial trades build speed the other way. Where the children of the best object split would overlap, it
+/// also tries splitting space itself, clipping the objects that cross the split plane to each side and referring
+/// to them from both (Stich, Friedrich, and Dietrich, "Spatial Splits in Bounding Volume Hierarchies", 2009). Long,
+/// thin objects then stop inflating every node around them. The extra references are capped by a budget, refits
+/// grow split references back to their objects' whole bounds, and the next build of any kind drops them again.
+///
+/// Every builder stops splitting at REX_BVH_MAX_DEPTH, so the fixed-size stacks that queries and the packet tracer
+/// walk the tree with can't overflow, even for degenerate scenes where the splits barely separate anything.
+///
+/// A BVH that's only ever used on the host (see MakeHostOnly) is collapsed into a WideBVH after every build, which
+/// host queries and the packet tracer walk instead of the binary nodes. The binary nodes and the objects are then
+/// dropped, since the wide copy keeps its own compact references to the primitives, and every refit refits the wide
+/// nodes in place. The objects are only read back from the wide copy when more are added or the tree is built again.
+/// Any other BVH keeps just its binary nodes, which the device walks, since it may be built over geometry that only
+/// exists on the device.
+/// </remarks>
+class BVH
+{
+    REX_NONCOPYABLE_CLASS( BVH )
+
+    friend class PacketTracer;
+    friend class WideBVH;
+
+    BoundingBox                    _bounds;
+    DeviceList<BVHNode>            _nodes;
+    DeviceList<BoundsGeometryPair> _objects;             // dropped while a host-only tree is collapsed
+    uint32                         _nodeCount;
+    const uint32                   _maxLeafSize;
+    real32                         _builtCost;           // the hierarchy's cost right after it was last built
+    bool                           _builtLinear;         // whether the hierarchy was last built by BuildLinear
+    real32                         _spatialBudget;       // the budget the hierarchy was last built with by BuildSpatial, or 0
+    uint32                         _splitReferenceCount; // the number of extra references to objects that spatial splits added
+    WideBVH*                       _wide;                // the collapsed tree used by host queries, if the tree is host-only
+    bool                           _hostOnly;            // whether the tree is collapsed after every build
+
+    /// <summary>
+    /// Fills in the given node from a range of objects and decides whether or not to split it. Returns true
+    /// if the node was split, in which case its objects are partitioned around the split.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to build.</param>
+    /// <param name="start">The index of the first object in the node.</param>
+    /// <param name="end">The index one past the last object in the node.</param>
+    /// <param name="depth">The depth of the node in the tree.</param>
+    /// <param name="mid">The index of the first object in the second child.</param>
+    __both__ bool SplitNode( uint32 nodeIndex, uint32 start, uint32 end, uint32 depth, uint32& mid );
+
+    /// <summary>
+    /// Builds the given node from a range of objects, recursively building its children.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to build.</param>
+    /// <param name="start">The index of the first object in the node.</param>
+    /// <param name="end">The index one past the last object in the node.</param>
+    /// <param name="depth">The depth of the node in the tree.</param>
+    __both__ void BuildNode( uint32 nodeIndex, uint32 start, uint32 end, uint32 depth );
+
+    /// <summary>
+    /// Builds the given node from a range of objects, building its children on separate threads.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to build.</param>
+    /// <param name="start">The index of the first object in the node.</param>
+    /// <param name="end">The index one past the last object in the node.</param>
+    /// <param name="depth">The depth of the node in the tree.</param>
+    /// <param name="taskDepth">The number of levels below this one that may still spawn threads.</param>
+    __host__ void BuildNodeParallel( uint32 nodeIndex, uint32 start, uint32 end, uint32 depth, uint32 taskDepth );
+
+    /// <summary>
+    /// Builds the given node from a range of objects sorted by their Morton codes, splitting it where the codes'
+    /// highest differing bit changes and building its children on separate threads while there's depth left.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to build.</param>
+    /// <param name="start">The index of the first object in the node.</param>
+    /// <param name="end">The index one past the last object in the node.</param>
+    /// <param name="codes">The sorted Morton codes of every object.</param>
+    /// <param name="depth">The depth of the node in the tree.</param>
+    /// <param name="taskDepth">The number of levels below this one that may still spawn threads.</param>
+    __host__ void BuildLinearNode( uint32 nodeIndex, uint32 start, uint32 end, const uint64* codes, uint32 depth, uint32 taskDepth );
+
+    /// <summary>
+    /// Reads the objects back from the wide copy if they were dropped when the tree was collapsed, so that they can
+    /// be added to or built over again. Each object split by spatial splits comes back as one whole reference, and
+    /// the objects come back in the order the wide leaves refer to them.
+    /// </summary>
+    __host__ void RestoreObjects();
+
+    /// <summary>
+    /// Removes the extra references to objects added by the last spatial split build, leaving one whole reference
+    /// to each object in the order they were added.
+    /// </summary>
+    __host__ void RemoveSplitReferences();
+
+    /// <summary>
+    /// Moves the subtree at the given index down to another index, removing any unused nodes. Returns the
+    /// index one past the moved subtree.
+    /// </summary>
+    /// <param name="from">The index of the subtree's root.</param>
+    /// <param name="to">The index to move the subtree's root to.</param>
+    __both__ uint32 CompactNode( uint32 from, uint32 to );
+
+    /// <summary>
+    /// Compacts the built nodes and updates this BVH's bounds.
+    /// </summary>
+    __both__ void FinishBuild();
+
+    /// <summary>
+    /// Collapses the tree into the wide copy used by host queries and drops the binary nodes and objects, if this
+    /// BVH is host-only. Does nothing on the device.
+    /// </summary>
+    __both__ void UpdateWide();
+
+    /// <summary>
+    /// Refits the wide copy used by host queries in place, after the tree has been refit. Does nothing on the device.
+    /// </summary>
+    /// <param name="workerCount">The number of threads the refit may be split across.</param>
+    __both__ void RefitWide( uint32 workerCount );
+
+    /// <summary>
+    /// Checks to see if this BVH has been built but has dropped its binary nodes and objects, leaving only the wide copy.
+    /// </summary>
+    __both__ bool IsCollapsed() const;
+
+    /// <summary>
+    /// Refits a range of nodes from the last one back to the first, so that every node's children are refit before
+    /// it is. Leaves read their objects' bounds from the objects' geometry again. The range must be a whole subtree.
+    /// </summary>
+    /// <param name="start">The index of the subtree's root.</param>
+    /// <param name="end">The index one past the subtree's last node.</param>
+    __both__ void RefitNodes( uint32 start, uint32 end );
+
+    /// <summary>
+    /// Refits the subtree at the given index, refitting its children's subtrees on separate threads.
+    /// </summary>
+    /// <param name="start">The index of the subtree's root.</param>
+    /// <param name="end">The index one past the subtree's last node.</param>
+    /// <param name="taskDepth">The number of levels below this one that may still spawn threads.</param>
+    __host__ void RefitNodesParallel( uint32 start, uint32 end, uint32 taskDepth );
+
+    /// <summary>
+    /// Queries the subtree starting at the given node for the nearest piece of geometry that a given ray
+    /// intersects, only accepting hits closer than the given distance. The node's bounds are assumed to
+    /// have already been checked.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to start at.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="dist">The distance to beat on input, and the distance to the piece of geometry on output.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __both__ const Geometry* QueryIntersectionsFrom( uint32 nodeIndex, const Ray& ray, real32& dist, HitRecord& hit ) const;
+
+public:
+    /// <summary>
+    /// Creates a new BVH.
+    /// </summary>
+    /// <param name="bounds">The bounds of the objects that will be added.</param>
+    __both__ BVH( const BoundingBox& bounds );
+
+    /// <summary>
+    /// Creates a new BVH.
+    /// </summary>
+    /// <param name="min">The minimum corner of the bounds.</param>
+    /// <param name="max">The maximum corner of the bounds.</param>
+    __both__ BVH( const vec3& min, const vec3& max );
+
+    /// <summary>
+    /// Creates a new BVH.
+    /// </summary>
+    /// <param name="bounds">The bounds of the objects that will be added.</param>
+    /// <param name="maxLeafSize">The number of objects a leaf may hold before it must be split.</param>
+    __both__ BVH( const BoundingBox& bounds, uint32 maxLeafSize );
+
+    /// <summary>
+    /// Creates a new BVH from an already-built hierarchy, such as one built on the host and uploaded.
+    /// </summary>
+    /// <param name="bounds">The bounds of the hierarchy.</param>
+    /// <param name="nodes">The hierarchy's nodes.</param>
+    /// <param name="nodeCount">The number of nodes.</param>
+    /// <param name="objects">The hierarchy's objects, in the order its leaves refer to them.</param>
+    /// <param name="objectCount">The number of objects.</param>
+    __both__ BVH( const BoundingBox& bounds, const BVHNode* nodes, uint32 nodeCount, const BoundsGeometryPair* objects, uint32 objectCount );
+
+    /// <summary>
+    /// Destroys this BVH.
+    /// </summary>
+    __both__ ~BVH();
+
+    /// <summary>
+    /// Gets this BVH's bounds.
+    /// </summary>
+    __both__ const BoundingBox& GetBounds() const;
+
+    /// <summary>
+    /// Gets the expected cost of tracing a ray through this BVH by the surface area heuristic, in units of the cost
+    /// of testing one object.
+    /// </summary>
+    __both__ real32 GetCost() const;
+
+    /// <summary>
+    /// Gets the expected cost of tracing a ray through this BVH right after it was last built.
+    /// </summary>
+    __both__ real32 GetBuiltCost() const;
+
+    /// <summary>
+    /// Gets the number of bytes used by this BVH's nodes and objects, including its collapsed copy for host queries.
+    /// </summary>
+    __host__ uint64 GetMemoryUsage() const;
+
+    /// <summary>
+    /// Queries this BVH for the nearest piece of geometry that a given ray intersects, and fills in the shade
+    /// point data for it.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="dist">The distance to the piece of geometry.</param>
+    /// <param name="sp">The shade point data.</param>
+    __both__ const Geometry* QueryIntersections( const Ray& ray, real32& dist, ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Queries this BVH for the nearest piece of geometry that a given ray intersects, only recording the hit.
+    /// The geometry can fill in the shade point data for it later.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="dist">The distance to the piece of geometry.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __both__ const Geometry* QueryIntersections( const Ray& ray, real32& dist, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Queries this BVH to see if anything blocks the given ray between a small epsilon and the given
+    /// distance. Returns as soon as any blocker is found.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmax">The distance along the ray to check up to.</param>
+    __both__ bool QueryOcclusion( const Ray& ray, real32 tmax ) const;
+
+    /// <summary>
+    /// Adds the given piece of geometry to this BVH. The BVH must be rebuilt before it can be queried.
+    /// </summary>
+    /// <param name="geometry">The piece of geometry to add. Each of its primitives is added separately.</param>
+    __both__ bool Add( const Geometry* geometry );
+
+    /// <summary>
+    /// Adds the given piece of geometry to this BVH. The BVH must be rebuilt before it can be queried.
+    /// </summary>
+    /// <param name="geometry">The piece of geometry to add.</param>
+    /// <param name="bounds">The bounds of the given object.</param>
+    __both__ bool Add( const Geometry* geometry, const BoundingBox& bounds );
+
+    /// <summary>
+    /// Adds one of the given piece of geometry's primitives to this BVH. The BVH must be rebuilt before it can
+    /// be queried.
+    /// </summary>
+    /// <param name="geometry">The piece of geometry to add.</param>
+    /// <param name="primitive">The index of the primitive to add.</param>
+    /// <param name="bounds">The bounds of the given primitive.</param>
+    __both__ bool Add( const Geometry* geometry, uint32 primitive, const BoundingBox& bounds );
+
+    /// <summary>
+    /// Adds a range of objects to this BVH at once. Returns false if any of them had no geometry. The BVH must be
+    /// rebuilt before it can be queried.
+    /// </summary>
+    /// <param name="objects">The objects and their bounds.</param>
+    /// <param name="count">The number of objects.</param>
+    __both__ bool AddRange( const BoundsGeometryPair* objects, uint32 count );
+
+    /// <summary>
+    /// Builds the hierarchy over every object that has been added.
+    /// </summary>
+    __both__ bool Build();
+
+    /// <summary>
+    /// Builds the hierarchy over every object that has been added, building the top of the tree on
+    /// separate threads. The result is the same as Build's.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to build with.</param>
+    __host__ bool BuildParallel( uint32 workerCount );
+
+    /// <summary>
+    /// Builds a linear hierarchy over every object that has been added, sorting the objects by the Morton codes
+    /// of their centers on separate threads. Building is much faster than with the surface area heuristic, but
+    /// the tree is slower to trace.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to build with.</param>
+    __host__ bool BuildLinear( uint32 workerCount );
+
+    /// <summary>
+    /// Builds a hierarchy over every object that has been added with the surface area heuristic, also splitting
+    /// objects across spatial splits where that makes the tree cheaper to trace. The top of the tree is split
+    /// across threads. Building is slower than with BuildParallel, but long, thin objects trace much faster.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to build with.</param>
+    /// <param name="budget">The number of extra references that splitting objects may add, as a fraction of the number of objects.</param>
+    __host__ bool BuildSpatial( uint32 workerCount, real32 budget );
+
+    /// <summary>
+    /// Refits this BVH to the current bounds of its objects' geometry without changing the tree.
+    /// </summary>
+    __both__ bool Refit();
+
+    /// <summary>
+    /// Refits this BVH to the current bounds of its objects' geometry without changing the tree, refitting the
+    /// top of the tree on separate threads. The result is the same as Refit's.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to refit with.</param>
+    __host__ bool RefitParallel( uint32 workerCount );
+
+    /// <summary>
+    /// Brings this BVH up to date after its objects' geometry has moved. The tree is refit, and then rebuilt if the
+    /// refit tree's cost has grown too far past its cost when it was built. Rebuilds use whichever builder built
+    /// the tree last.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to update with.</param>
+    /// <param name="rebuilt">Whether the tree had to be rebuilt.</param>
+    __host__ bool Update( uint32 workerCount, bool& rebuilt );
+
+    /// <summary>
+    /// Copies this BVH's hierarchy into a new BVH on the device, returning null if the copy fails. Geometry
+    /// pointers are copied as-is, so they must already refer to device objects.
+    /// </summary>
+    __host__ BVH* UploadToDevice() const;
+
+    /// <summary>
+    /// Collapses this BVH into the wide copy that host queries walk and drops its binary nodes and objects, now and
+    /// after every later build. This BVH's objects must all be host geometry, and it can't be uploaded to the device afterwards.
+    /// </summary>
+    __host__ void MakeHostOnly();
+};
+
+REX_NS_END
\ No newline at end of file
@@ -6,6 +6,20 @@
 REX_NS_BEGIN
 
 struct ShadePoint;
+class  Geometry;
+
+/// <summary>
+/// Defines the least that has to be known about a hit to shade it later. Traversal only keeps one of these for the
+/// closest hit so far, and the shading point is only filled in once the closest hit is known.
+/// </summary>
+struct HitRecord
+{
+    const Geometry* Object;     // the geometry that was hit
+    uint32          Primitive;
+    real32          T;
+    real32          Beta;       // the weight of a triangle's second vertex
+    real32          Gamma;      // the weight of a triangle's third vertex
+};
 
 /// <summary>
 /// An enumeration of possible types of geometry.
@@ -14,9 +28,15 @@ enum class GeometryType
 {
     Sphere,
     Triangle,
-    Mesh
+    Mesh,
+    MeshInstance    // keep this last, since it's used to count the types
 };
 
+/// <summary>
+/// The number of types of geometry.
+/// </summary>
+#define REX_GEOMETRY_TYPE_COUNT ( static_cast<uint32>( GeometryType::MeshInstance ) + 1 )
+
 /// <summary>
 /// Defines the base for all geometry objects.
 /// </summary>
@@ -25,60 +45,111 @@ class Geometry
     REX_NONCOPYABLE_CLASS( Geometry )
 
 protected:
-    Material*           _material;
+    uint32              _material;      // the material's index in the scene's material table
     const GeometryType  _geometryType;
 
+    /// <summary>
+    /// Creates a new piece of geometry without a material of its own.
+    /// </summary>
+    /// <param name="type">The type of this geometry.</param>
+    __both__ Geometry( GeometryType type );
+
 public:
     /// <summary>
     /// Creates a new piece of geometry.
     /// </summary>
     /// <param name="type">The type of this geometry.</param>
-    /// <param name="material">The material to use with this piece of geometry.</param>
-    template<typename T> __device__ Geometry( GeometryType type, const T& material );
+    /// <param name="material">The index of this geometry's material in the scene's material table.</param>
+    __both__ Geometry( GeometryType type, uint32 material );
 
     /// <summary>
     /// Destroys this piece of geometry.
     /// </summary>
-    __device__ virtual ~Geometry();
+    __both__ virtual ~Geometry();
 
     /// <summary>
     /// Gets this piece of geometry's bounds.
     /// </summary>
-    __device__ virtual BoundingBox GetBounds() const = 0;
+    __both__ virtual BoundingBox GetBounds() const = 0;
+
+    /// <summary>
+    /// Gets the number of primitives this piece of geometry is made of. Acceleration structures hold each primitive
+    /// separately, so geometry made of many primitives (such as a mesh) isn't treated as one big object.
+    /// </summary>
+    __both__ virtual uint32 GetPrimitiveCount() const;
 
     /// <summary>
-    /// Gets this geometric object's material.
+    /// Gets the bounds of one of this piece of geometry's primitives.
     /// </summary>
-    __device__ const Material* GetMaterial() const;
+    /// <param name="primitive">The index of the primitive.</param>
+    __both__ virtual BoundingBox GetPrimitiveBounds( uint32 primitive ) const;
+
+    /// <summary>
+    /// Gets the bounds of the part of one of this piece of geometry's primitives that lies inside the given box. If
+    /// none of it does, the bounds are empty (their minimum is past their maximum). Geometry that can't be clipped
+    /// exactly gets the overlap of the primitive's bounds and the box.
+    /// </summary>
+    /// <param name="primitive">The index of the primitive.</param>
+    /// <param name="clip">The box to clip the primitive to.</param>
+    __both__ virtual BoundingBox GetClippedPrimitiveBounds( uint32 primitive, const BoundingBox& clip ) const;
+
+    /// <summary>
+    /// Gets the index of this geometric object's material in the scene's material table.
+    /// </summary>
+    __both__ uint32 GetMaterial() const;
 
     /// <summary>
     /// Gets this piece of geometry's type.
     /// </summary>
-    __device__ GeometryType GetType() const;
+    __both__ GeometryType GetType() const;
 
     /// <summary>
-    /// Checks to see if the given ray hits this geometric object. If it does, the shading
-    /// point information is populated and the collision distance is recorded.
+    /// Fills in the shading point information for a hit found by Hit or HitPrimitive.
+    /// </summary>
+    /// <param name="ray">The ray that made the hit.</param>
+    /// <param name="hit">The hit record.</param>
+    /// <param name="sp">The shading point information.</param>
+    __both__ virtual void GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const = 0;
+
+    /// <summary>
+    /// Checks to see if the given ray hits this geometric object. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="tmin">The distance to intersection.</param>
-    /// <param name="sp">The shading point information.</param>
-    __device__ virtual bool Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) const = 0;
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const = 0;
 
     /// <summary>
     /// Performs the same thing as a normal ray hit, but for shadow rays.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="tmin">The distance to intersection.</param>
-    __device__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const = 0;
+    __both__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const = 0;
+
+    /// <summary>
+    /// Checks to see if the given ray hits one of this piece of geometry's primitives. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
+    /// </summary>
+    /// <param name="primitive">The index of the primitive.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool HitPrimitive( uint32 primitive, const Ray& ray, real32& tmin, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Performs the same thing as a normal primitive hit, but for shadow rays.
+    /// </summary>
+    /// <param name="primitive">The index of the primitive.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    __both__ virtual bool ShadowHitPrimitive( uint32 primitive, const Ray& ray, real32& tmin ) const;
 
     /// <summary>
     /// Sets this geometry's material.
     /// </summary>
-    /// <param name="material">The new material to use with this piece of geometry.</param>
-    template<typename T> __device__ void SetMaterial( const T& material );
+    /// <param name="material">The index of the new material in the scene's material table.</param>
+    __both__ void SetMaterial( uint32 material );
 };
 
-REX_NS_END
-
-#include "Geometry.inl"
\ No newline at end of file
+REX_NS_END
\ No newline at end of file
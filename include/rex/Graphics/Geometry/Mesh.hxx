@@ -0,0 +1,309 @@
+#pragma once
+
+#include "BVH.hxx"
+#include "Geometry.hxx"
+#include "Triangle.hxx"
+#include "../../CUDA/DeviceList.hxx"
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a mesh's vertices and triangle indices as plain arrays, such as ones loaded from a file.
+/// </summary>
+struct MeshData
+{
+    const real32*       PositionX;
+    const real32*       PositionY;
+    const real32*       PositionZ;
+    const real32*       NormalX;     // null if the vertices don't have normals
+    const real32*       NormalY;
+    const real32*       NormalZ;
+    const uint32*       Indices;     // three per triangle
+    const TriangleData* Triangles;   // one per triangle, or null if they haven't been computed
+    uint32              VertexCount;
+    uint32              IndexCount;
+
+    /// <summary>
+    /// Creates new, empty mesh data.
+    /// </summary>
+    __both__ MeshData();
+};
+
+/// <summary>
+/// Defines an indexed triangle mesh.
+/// </summary>
+/// <remarks>
+/// Vertex positions (and optionally normals) are stored as structure-of-arrays with one list per component, and
+/// each triangle is three indices into them, so vertices shared between triangles are only stored once. Each
+/// triangle is its own primitive, which lets acceleration structures hold triangles rather than the whole mesh.
+/// Each triangle's edges and normal are also computed as it is added so that ray tests don't have to.
+///
+/// A mesh can also use shared data in place, such as a memory-mapped mesh cache, rather than keeping its own copy.
+/// Since shared data can't be modified, meshes are moved into place with a uniform scale and offset that is applied
+/// as the vertices are used.
+///
+/// A mesh can also build a hierarchy over its own triangles, which it then uses for its own ray tests. This is what
+/// lets one mesh be drawn many times by mesh instances without its triangles being added to the scene once per copy.
+///
+/// Vertices of a mesh's own data can be moved between frames. Once they have been, Refit brings the triangle data
+/// and the hierarchy back up to date without rebuilding the hierarchy.
+/// </remarks>
+class Mesh : public Geometry
+{
+    friend class PacketTracer;
+    friend class WideBVH;
+
+    DeviceList<real32>       _positionX;
+    DeviceList<real32>       _positionY;
+    DeviceList<real32>       _positionZ;
+    DeviceList<real32>       _normalX;
+    DeviceList<real32>       _normalY;
+    DeviceList<real32>       _normalZ;
+    DeviceList<uint32>       _indices;
+    DeviceList<TriangleData> _triangles;
+    MeshData                 _data;        // points at either the lists above or shared data
+    real32                   _scale;
+    vec3                     _offset;
+    BVH*                     _hierarchy;   // null until built
+
+    /// <summary>
+    /// Clears all of this mesh's own lists.
+    /// </summary>
+    __both__ void ClearLists();
+
+    /// <summary>
+    /// Points this mesh's data at its own lists.
+    /// </summary>
+    __both__ void UpdateData();
+
+    /// <summary>
+    /// Deletes this mesh's hierarchy, if it has one.
+    /// </summary>
+    __both__ void ClearHierarchy();
+
+    /// <summary>
+    /// Gets the position of the given vertex.
+    /// </summary>
+    /// <param name="vertex">The index of the vertex.</param>
+    __both__ vec3 GetPosition( uint32 vertex ) const;
+
+    /// <summary>
+    /// Gets the points of the given triangle.
+    /// </summary>
+    /// <param name="triangle">The index of the triangle.</param>
+    /// <param name="p1">The first point in the triangle.</param>
+    /// <param name="p2">The second point in the triangle.</param>
+    /// <param name="p3">The third point in the triangle.</param>
+    __both__ void GetTrianglePoints( uint32 triangle, vec3& p1, vec3& p2, vec3& p3 ) const;
+
+    /// <summary>
+    /// Gets the intersection data of the given triangle, moved into place.
+    /// </summary>
+    /// <param name="triangle">The index of the triangle.</param>
+    __both__ TriangleData GetTriangleData( uint32 triangle ) const;
+
+    /// <summary>
+    /// Checks to see if the given ray hits the given triangle. If it does, the collision distance and the
+    /// barycentric coordinates of the triangle's second and third points are recorded.
+    /// </summary>
+    /// <param name="triangle">The index of the triangle.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="beta">The weight of the triangle's second point at the intersection.</param>
+    /// <param name="gamma">The weight of the triangle's third point at the intersection.</param>
+    __both__ bool IntersectTriangle( uint32 triangle, const Ray& ray, real32& tmin, real32& beta, real32& gamma ) const;
+
+    /// <summary>
+    /// Gets the normal at the given point on the given triangle, interpolating the vertex normals if there are any.
+    /// </summary>
+    /// <param name="triangle">The index of the triangle.</param>
+    /// <param name="beta">The weight of the triangle's second vertex.</param>
+    /// <param name="gamma">The weight of the triangle's third vertex.</param>
+    __both__ vec3 GetNormal( uint32 triangle, real32 beta, real32 gamma ) const;
+
+public:
+    /// <summary>
+    /// Creates a new, empty mesh.
+    /// </summary>
+    /// <param name="material">The index of the material to use with this mesh in the scene's material table.</param>
+    __both__ Mesh( uint32 material );
+
+    /// <summary>
+    /// Destroys this mesh.
+    /// </summary>
+    __both__ virtual ~Mesh();
+
+    /// <summary>
+    /// Gets this mesh's bounds.
+    /// </summary>
+    __both__ virtual BoundingBox GetBounds() const;
+
+    /// <summary>
+    /// Gets the number of triangles in this mesh.
+    /// </summary>
+    __both__ virtual uint32 GetPrimitiveCount() const;
+
+    /// <summary>
+    /// Gets the bounds of one of this mesh's triangles.
+    /// </summary>
+    /// <param name="primitive">The index of the triangle.</param>
+    __both__ virtual BoundingBox GetPrimitiveBounds( uint32 primitive ) const;
+
+    /// <summary>
+    /// Gets the bounds of the part of one of this mesh's triangles that lies inside the given box.
+    /// </summary>
+    /// <param name="primitive">The index of the triangle.</param>
+    /// <param name="clip">The box to clip the triangle to.</param>
+    __both__ virtual BoundingBox GetClippedPrimitiveBounds( uint32 primitive, const BoundingBox& clip ) const;
+
+    /// <summary>
+    /// Gets the number of vertices in this mesh.
+    /// </summary>
+    __both__ uint32 GetVertexCount() const;
+
+    /// <summary>
+    /// Gets the number of triangles in this mesh.
+    /// </summary>
+    __both__ uint32 GetTriangleCount() const;
+
+    /// <summary>
+    /// Checks to see if every vertex in this mesh has a normal. If not, triangles are shaded with their face normals.
+    /// </summary>
+    __both__ bool HasNormals() const;
+
+    /// <summary>
+    /// Gets this mesh's data. The positions are as they were given, before this mesh's placement is applied.
+    /// </summary>
+    __both__ const MeshData& GetData() const;
+
+    /// <summary>
+    /// Gets the uniform scale applied to every vertex in this mesh.
+    /// </summary>
+    __both__ real32 GetScale() const;
+
+    /// <summary>
+    /// Gets the offset applied to every vertex in this mesh after it is scaled.
+    /// </summary>
+    __both__ const vec3& GetOffset() const;
+
+    /// <summary>
+    /// Sets the placement of this mesh, which is applied to every vertex as it is used without modifying the
+    /// vertices themselves. The hierarchy, if there is one, is refit to match.
+    /// </summary>
+    /// <param name="scale">The uniform scale. Must be positive.</param>
+    /// <param name="offset">The offset to apply after scaling.</param>
+    __both__ void SetPlacement( real32 scale, const vec3& offset );
+
+    /// <summary>
+    /// Builds a hierarchy over this mesh's triangles, which this mesh's own ray tests then use rather than checking
+    /// every triangle. Adding triangles or replacing the data afterwards discards the hierarchy.
+    /// </summary>
+    __both__ bool BuildHierarchy();
+
+    /// <summary>
+    /// Gets this mesh's hierarchy, or null if it hasn't been built.
+    /// </summary>
+    __both__ const BVH* GetHierarchy() const;
+
+    /// <summary>
+    /// Reserves space for the given number of vertices and triangles.
+    /// </summary>
+    /// <param name="vertexCount">The number of vertices.</param>
+    /// <param name="triangleCount">The number of triangles.</param>
+    __both__ void Reserve( uint32 vertexCount, uint32 triangleCount );
+
+    /// <summary>
+    /// Adds a vertex without a normal to this mesh, returning its index.
+    /// </summary>
+    /// <param name="position">The vertex's position.</param>
+    __both__ uint32 AddVertex( const vec3& position );
+
+    /// <summary>
+    /// Adds a vertex with a normal to this mesh, returning its index.
+    /// </summary>
+    /// <param name="position">The vertex's position.</param>
+    /// <param name="normal">The vertex's normal.</param>
+    __both__ uint32 AddVertex( const vec3& position, const vec3& normal );
+
+    /// <summary>
+    /// Adds a triangle to this mesh. Returns false if any of the indices do not refer to a vertex.
+    /// </summary>
+    /// <param name="v1">The index of the triangle's first vertex.</param>
+    /// <param name="v2">The index of the triangle's second vertex.</param>
+    /// <param name="v3">The index of the triangle's third vertex.</param>
+    __both__ bool AddTriangle( uint32 v1, uint32 v2, uint32 v3 );
+
+    /// <summary>
+    /// Moves one of this mesh's vertices. Returns false if the vertex doesn't exist or this mesh is using shared
+    /// data, which can't be modified. The mesh must be refit before it is used again.
+    /// </summary>
+    /// <param name="vertex">The index of the vertex.</param>
+    /// <param name="position">The vertex's new position, before this mesh's placement is applied.</param>
+    __both__ bool SetVertexPosition( uint32 vertex, const vec3& position );
+
+    /// <summary>
+    /// Brings each triangle's intersection data and the hierarchy, if there is one, up to date after vertices
+    /// have been moved. The hierarchy keeps its shape and only has its bounds refit.
+    /// </summary>
+    __both__ void Refit();
+
+    /// <summary>
+    /// Replaces this mesh's vertices and triangles with copies of the given data. Returns false, leaving the
+    /// mesh empty, if the data has no positions, a partial triangle, or an index that does not refer to a vertex.
+    /// </summary>
+    /// <param name="data">The mesh data.</param>
+    __both__ bool SetData( const MeshData& data );
+
+    /// <summary>
+    /// Makes this mesh use the given data in place rather than copying it, which means the data must outlive this
+    /// mesh. Only the triangle data is computed (and kept by this mesh) if the given data doesn't have it. Returns
+    /// false, leaving the mesh empty, if the data has no positions, a partial triangle, or an index that does not
+    /// refer to a vertex. Adding vertices or triangles afterwards starts the mesh over with its own data.
+    /// </summary>
+    /// <param name="data">The mesh data.</param>
+    __both__ bool SetSharedData( const MeshData& data );
+
+    /// <summary>
+    /// Fills in the shading point information for a hit found by Hit or HitPrimitive.
+    /// </summary>
+    /// <param name="ray">The ray that made the hit.</param>
+    /// <param name="hit">The hit record.</param>
+    /// <param name="sp">The shading point information.</param>
+    __both__ virtual void GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Checks to see if the given ray hits this mesh. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Performs the same thing as a normal ray hit, but for shadow rays.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    __both__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const;
+
+    /// <summary>
+    /// Checks to see if the given ray hits one of this mesh's triangles. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
+    /// </summary>
+    /// <param name="primitive">The index of the triangle.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool HitPrimitive( uint32 primitive, const Ray& ray, real32& tmin, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Performs the same thing as a normal triangle hit, but for shadow rays.
+    /// </summary>
+    /// <param name="primitive">The index of the triangle.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    __both__ virtual bool ShadowHitPrimitive( uint32 primitive, const Ray& ray, real32& tmin ) const;
+};
+
+REX_NS_END
\ No newline at end of file
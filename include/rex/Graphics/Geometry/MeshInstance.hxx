@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Mesh.hxx"
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines one copy of a mesh placed in the scene with its own transform.
+/// </summary>
+/// <remarks>
+/// An instance only refers to its mesh, so a mesh drawn many times is only stored once. Rays are moved into the
+/// mesh's space with the inverse transform and tested against the mesh (and its hierarchy, if it has built one),
+/// and then the hit is moved back out. The ray's direction is transformed without being normalized, so hit
+/// distances are the same in both spaces. An instance may also override the mesh's material.
+///
+/// The mesh must outlive its instances. Its bounds are read whenever an instance's transform is set, so an instance
+/// whose mesh has been refit should have its transform set again.
+/// </remarks>
+class MeshInstance : public Geometry
+{
+    const Mesh* _mesh;
+    mat4        _transform;          // from the mesh's space to the scene
+    mat4        _inverseTransform;   // from the scene to the mesh's space
+    BoundingBox _bounds;
+
+    /// <summary>
+    /// Moves the given ray into the mesh's space.
+    /// </summary>
+    /// <param name="ray">The ray to move.</param>
+    __both__ Ray ToMeshSpace( const Ray& ray ) const;
+
+public:
+    /// <summary>
+    /// Creates a new instance that uses its mesh's material.
+    /// </summary>
+    /// <param name="mesh">The mesh to draw.</param>
+    /// <param name="transform">The transform from the mesh's space to the scene.</param>
+    __both__ MeshInstance( const Mesh* mesh, const mat4& transform );
+
+    /// <summary>
+    /// Creates a new instance that overrides its mesh's material.
+    /// </summary>
+    /// <param name="mesh">The mesh to draw.</param>
+    /// <param name="transform">The transform from the mesh's space to the scene.</param>
+    /// <param name="material">The index of the material to use instead of the mesh's in the scene's material table.</param>
+    __both__ MeshInstance( const Mesh* mesh, const mat4& transform, uint32 material );
+
+    /// <summary>
+    /// Destroys this instance.
+    /// </summary>
+    __both__ virtual ~MeshInstance();
+
+    /// <summary>
+    /// Gets this instance's bounds in the scene.
+    /// </summary>
+    __both__ virtual BoundingBox GetBounds() const;
+
+    /// <summary>
+    /// Gets the mesh this instance draws.
+    /// </summary>
+    __both__ const Mesh* GetMesh() const;
+
+    /// <summary>
+    /// Gets the transform from the mesh's space to the scene.
+    /// </summary>
+    __both__ const mat4& GetTransform() const;
+
+    /// <summary>
+    /// Sets the transform from the mesh's space to the scene, which also updates this instance's bounds.
+    /// </summary>
+    /// <param name="transform">The new transform.</param>
+    __both__ void SetTransform( const mat4& transform );
+
+    /// <summary>
+    /// Fills in the shading point information for a hit found by Hit or HitPrimitive.
+    /// </summary>
+    /// <param name="ray">The ray that made the hit.</param>
+    /// <param name="hit">The hit record.</param>
+    /// <param name="sp">The shading point information.</param>
+    __both__ virtual void GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Checks to see if the given ray hits this instance. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Performs the same thing as a normal ray hit, but for shadow rays.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    __both__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const;
+};
+
+REX_NS_END
\ No newline at end of file
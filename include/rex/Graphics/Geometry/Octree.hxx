@@ -2,76 +2,165 @@
 
 #include "../../Math/BoundingBox.hxx"
 #include "../../CUDA/DeviceList.hxx"
+#include "../../Utility/Arena.hxx"
 
 REX_NS_BEGIN
 
 class Geometry;
 struct ShadePoint;
+struct HitRecord;
 
 /// <summary>
-/// Defines a pairing between a bounding box and geometry.
+/// Defines a pairing between a bounding box and one of a piece of geometry's primitives.
 /// </summary>
 struct BoundsGeometryPair
 {
     const Geometry* Geometry;
     BoundingBox Bounds;
+    uint32 Index;
+    uint32 Primitive;
 
     /// <summary>
     /// Creates a new bounding box / geometry pairing.
     /// </summary>
-    __device__ BoundsGeometryPair();
+    __both__ BoundsGeometryPair();
+};
+
+/// <summary>
+/// Defines a single node in a flattened octree.
+/// </summary>
+struct OctreeNode
+{
+    BoundingBox Bounds;
+    uint32      FirstChild;  // the index of the first of this node's 8 contiguous children, or 0 if it has none
+    uint32      ObjectStart; // the index of this node's first entry in the object index array
+    uint32      ObjectCount; // the number of objects held directly by this node
+
+    /// <summary>
+    /// Creates a new octree node.
+    /// </summary>
+    __both__ OctreeNode();
 };
 
 /// <summary>
 /// Defines an octree meant for spatially partitioning static objects based on their bounding boxes.
 /// </summary>
+/// <remarks>
+/// Objects are inserted into a tree of nodes allocated from the root's arena, which Build() then flattens into a single
+/// node array and a single object index array before throwing the tree away. Each node's 8 children are stored
+/// together and sibling groups are laid out depth-first, so nodes refer to each other with 32-bit indices and the
+/// two arrays can be copied anywhere as-is. Object indices refer to the order in which objects were added.
+/// </remarks>
 class Octree
 {
     REX_NONCOPYABLE_CLASS( Octree )
 
+    friend class PacketTracer;
+
     BoundingBox                    _bounds;
     const uint32                   _countBeforeSubivide;
     Octree*                        _children[ 8 ];
     DeviceList<BoundsGeometryPair> _objects;
+    DeviceList<BoundsGeometryPair> _objectTable;
+    DeviceList<OctreeNode>         _nodes;
+    DeviceList<uint32>             _objectIndices;
+    Arena                          _nodeArena; // only used by the root
+    Arena*                         _arena;     // the root's node arena, which every node's children come from
 
     /// <summary>
     /// Checks to see if this octree has subdivided.
     /// </summary>
-    __device__ bool HasSubdivided() const;
+    __both__ bool HasSubdivided() const;
 
     /// <summary>
     /// Subdivides this octree.
     /// </summary>
-    __device__ void Subdivide();
+    __both__ void Subdivide();
 
     /// <summary>
-    /// Queries this octree for the nearest piece of geometry that a given ray intersects for realzies this time.
+    /// Inserts the given object into this octree or one of its children.
     /// </summary>
+    /// <param name="pair">The object and its bounds.</param>
+    __both__ bool Insert( const BoundsGeometryPair& pair );
+
+    /// <summary>
+    /// Counts the nodes in this octree, including itself.
+    /// </summary>
+    __both__ uint32 CountNodes() const;
+
+    /// <summary>
+    /// Counts the objects in this octree, including those held by its children.
+    /// </summary>
+    __both__ uint32 CountObjects() const;
+
+    /// <summary>
+    /// Copies the given octree into the flattened node array, recursively copying its children.
+    /// </summary>
+    /// <param name="source">The octree to copy.</param>
+    /// <param name="nodeIndex">The index of the node to copy into.</param>
+    /// <param name="nodeCount">The number of nodes that have been allocated so far.</param>
+    /// <param name="indexCount">The number of object indices that have been written so far.</param>
+    __both__ void Flatten( const Octree* source, uint32 nodeIndex, uint32& nodeCount, uint32& indexCount );
+
+    /// <summary>
+    /// Destroys this octree's children.
+    /// </summary>
+    __both__ void DestroyChildren();
+
+    /// <summary>
+    /// Releases the tree of nodes once it has been flattened.
+    /// </summary>
+    __both__ void ReleaseTree();
+
+    /// <summary>
+    /// Gets the value to XOR child numbers with so that visiting children 0 through 7 visits them front-to-back
+    /// along the given direction.
+    /// </summary>
+    /// <param name="direction">The direction.</param>
+    __both__ static uint32 GetChildOrder( const vec3& direction );
+
+    /// <summary>
+    /// Queries the given node for the nearest piece of geometry that a given ray intersects for realzies this time.
+    /// The node's bounds are assumed to have already been checked, and only hits closer than the given distance
+    /// are accepted.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to query.</param>
     /// <param name="ray">The ray to check.</param>
-    /// <param name="dist">The distance to the piece of geometry.</param>
-    /// <param name="sp">The shade point data.</param>
-    __device__ const Geometry* QueryIntersectionsForReal( const Ray& ray, real32& dist, ShadePoint& sp ) const;
+    /// <param name="invDirection">The inverse of the ray's direction.</param>
+    /// <param name="dist">The distance to beat on input, and the distance to the piece of geometry on output.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __both__ const Geometry* QueryIntersectionsForReal( uint32 nodeIndex, const Ray& ray, const vec3& invDirection, real32& dist, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Queries the given node to see if anything blocks the given ray before the given distance. The node's
+    /// bounds are assumed to have already been checked.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node to query.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="invDirection">The inverse of the ray's direction.</param>
+    /// <param name="tmax">The distance along the ray to check up to.</param>
+    __both__ bool QueryOcclusion( uint32 nodeIndex, const Ray& ray, const vec3& invDirection, real32 tmax ) const;
 
 public:
     /// <summary>
     /// Creates a new octree.
     /// </summary>
     /// <param name="bounds">The octree's bounds.</param>
-    __device__ Octree( const BoundingBox& bounds );
+    __both__ Octree( const BoundingBox& bounds );
 
     /// <summary>
     /// Creates a new octree.
     /// </summary>
     /// <param name="min">The minimum corner of the bounds.</param>
     /// <param name="max">The maximum corner of the bounds.</param>
-    __device__ Octree( const vec3& min, const vec3& max );
+    __both__ Octree( const vec3& min, const vec3& max );
 
     /// <summary>
     /// Creates a new octree.
     /// </summary>
     /// <param name="bounds">The octree's bounds.</param>
     /// <param name="maxItemCount">The maximum number of items to allow per-node before that node subdivides.</param>
-    __device__ Octree( const BoundingBox& bounds, uint32 maxItemCount );
+    __both__ Octree( const BoundingBox& bounds, uint32 maxItemCount );
 
     /// <summary>
     /// Creates a new octree.
@@ -79,45 +168,141 @@ public:
     /// <param name="min">The minimum corner of the bounds.</param>
     /// <param name="max">The maximum corner of the bounds.</param>
     /// <param name="maxItemCount">The maximum number of items to allow per-node before that node subdivides.</param>
-    __device__ Octree( const vec3& min, const vec3& max, uint32 maxItemCount );
+    __both__ Octree( const vec3& min, const vec3& max, uint32 maxItemCount );
+
+    /// <summary>
+    /// Creates a new octree from an already-flattened one, such as one built on the host and uploaded.
+    /// </summary>
+    /// <param name="bounds">The octree's bounds.</param>
+    /// <param name="nodes">The flattened nodes.</param>
+    /// <param name="nodeCount">The number of nodes.</param>
+    /// <param name="objectIndices">The flattened object indices.</param>
+    /// <param name="indexCount">The number of object indices.</param>
+    /// <param name="objects">The objects, in the order they were added.</param>
+    /// <param name="objectCount">The number of objects.</param>
+    __both__ Octree( const BoundingBox& bounds, const OctreeNode* nodes, uint32 nodeCount, const uint32* objectIndices, uint32 indexCount, const BoundsGeometryPair* objects, uint32 objectCount );
 
     /// <summary>
     /// Destroys this octree.
     /// </summary>
-    __device__ ~Octree();
+    __both__ ~Octree();
 
     /// <summary>
     /// Gets this octree's bounds.
     /// </summary>
-    __device__ const BoundingBox& GetBounds() const;
+    __both__ const BoundingBox& GetBounds() const;
 
     /// <summary>
-    /// Queries this octree for the nearest piece of geometry that a given ray intersects.
+    /// Gets this octree's flattened nodes. The first node is the root.
+    /// </summary>
+    __both__ const DeviceList<OctreeNode>& GetNodes() const;
+
+    /// <summary>
+    /// Gets this octree's flattened object indices.
+    /// </summary>
+    __both__ const DeviceList<uint32>& GetObjectIndices() const;
+
+    /// <summary>
+    /// Gets the number of bytes used by this octree's flattened nodes, object indices, and objects.
+    /// </summary>
+    __host__ uint64 GetMemoryUsage() const;
+
+    /// <summary>
+    /// Queries this octree for the nearest piece of geometry that a given ray intersects, and fills in the shade
+    /// point data for it.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="dist">The distance to the piece of geometry.</param>
     /// <param name="sp">The shade point data.</param>
-    __device__ const Geometry* QueryIntersections( const Ray& ray, real32& dist, ShadePoint& sp ) const;
+    __both__ const Geometry* QueryIntersections( const Ray& ray, real32& dist, ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Queries this octree for the nearest piece of geometry that a given ray intersects, only recording the hit.
+    /// The geometry can fill in the shade point data for it later.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="dist">The distance to the piece of geometry.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __both__ const Geometry* QueryIntersections( const Ray& ray, real32& dist, HitRecord& hit ) const;
 
     /// <summary>
-    /// Queries this octree to see if the given shadow ray intersects anything.
+    /// Queries this octree to see if anything blocks the given ray between a small epsilon and the given
+    /// distance. Returns as soon as any blocker is found.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
-    /// <param name="dist">The distance to collision.</param>
-    __device__ bool QueryShadowRay( const Ray& ray, real32& dist ) const;
+    /// <param name="tmax">The distance along the ray to check up to.</param>
+    __both__ bool QueryOcclusion( const Ray& ray, real32 tmax ) const;
 
     /// <summary>
-    /// Adds the given bounding box to this octree.
+    /// Adds the given bounding box to this octree. Objects can only be added before the octree is built.
     /// </summary>
-    /// <param name="geometry">The piece of geometry to add.</param>
-    __device__ bool Add( const Geometry* geometry );
+    /// <param name="geometry">The piece of geometry to add. Each of its primitives is added separately.</param>
+    __both__ bool Add( const Geometry* geometry );
 
     /// <summary>
-    /// Adds the given bounding box to this octree.
+    /// Adds the given bounding box to this octree. Objects can only be added before the octree is built.
     /// </summary>
     /// <param name="geometry">The piece of geometry to add.</param>
     /// <param name="geometry">The bounds of the given object.</param>
-    __device__ bool Add( const Geometry* geometry, const BoundingBox& bounds );
+    __both__ bool Add( const Geometry* geometry, const BoundingBox& bounds );
+
+    /// <summary>
+    /// Adds one of the given piece of geometry's primitives to this octree. Objects can only be added before the
+    /// octree is built.
+    /// </summary>
+    /// <param name="geometry">The piece of geometry to add.</param>
+    /// <param name="primitive">The index of the primitive to add.</param>
+    /// <param name="bounds">The bounds of the given primitive.</param>
+    __both__ bool Add( const Geometry* geometry, uint32 primitive, const BoundingBox& bounds );
+
+    /// <summary>
+    /// Adds a range of objects to this octree at once. Returns false if any of them had no geometry or did not fit.
+    /// Objects can only be added before the octree is built.
+    /// </summary>
+    /// <param name="objects">The objects and their bounds.</param>
+    /// <param name="count">The number of objects.</param>
+    __both__ bool AddRange( const BoundsGeometryPair* objects, uint32 count );
+
+    /// <summary>
+    /// Flattens this octree once every object has been added. The octree must be built before it can be queried.
+    /// </summary>
+    __both__ bool Build();
+
+    /// <summary>
+    /// Flattens this octree once every object has been added, flattening the root's children on separate
+    /// threads. The result is the same as Build's.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to flatten with.</param>
+    __host__ bool BuildParallel( uint32 workerCount );
+
+    /// <summary>
+    /// Flattens this octree the same way as BuildParallel. Objects are placed in an octree's cells as they are
+    /// added, so it has no slower, better build to trade away.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to flatten with.</param>
+    __host__ bool BuildLinear( uint32 workerCount );
+
+    /// <summary>
+    /// Flattens this octree the same way as BuildParallel. Objects are already placed in every cell they overlap,
+    /// so there are no spatial splits to add.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to flatten with.</param>
+    /// <param name="budget">Unused.</param>
+    __host__ bool BuildSpatial( uint32 workerCount, real32 budget );
+
+    /// <summary>
+    /// Brings this octree up to date after its objects' geometry has moved. An octree's cells are fixed in space,
+    /// so there is nothing to refit: the root grows to fit every object where it is now, and the tree is rebuilt.
+    /// </summary>
+    /// <param name="workerCount">The number of threads to update with.</param>
+    /// <param name="rebuilt">Whether the tree had to be rebuilt, which is always the case.</param>
+    __host__ bool Update( uint32 workerCount, bool& rebuilt );
+
+    /// <summary>
+    /// Copies this octree's flattened arrays into a new octree on the device, returning null if the copy fails.
+    /// Geometry pointers are copied as-is, so they must already refer to device objects.
+    /// </summary>
+    __host__ Octree* UploadToDevice() const;
 };
 
 REX_NS_END
\ No newline at end of file
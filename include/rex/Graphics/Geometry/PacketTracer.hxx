@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../../Math/RayPacket.hxx"
+#include "../../Math/BoundingBox.hxx"
+#include "BVH.hxx"
+#include "Octree.hxx"
+#include "WideBVH.hxx"
+
+REX_NS_BEGIN
+
+class Triangle;
+class Sphere;
+class Mesh;
+struct TriangleData;
+
+/// <summary>
+/// Defines a host-side tracer that walks an acceleration structure with an entire ray packet at once. Boxes and the
+/// built-in geometry types are tested against every lane in SIMD; once a packet has diverged to the
+/// point where few lanes are left, the remaining lanes fall back to single-ray traversal.
+/// </summary>
+class PacketTracer
+{
+    REX_STATIC_CLASS( PacketTracer )
+
+    /// <summary>
+    /// Tests the given lanes of a packet against a bounding box, culling lanes whose current hit is closer
+    /// than the box. Returns the mask of lanes that enter the box.
+    /// </summary>
+    /// <param name="bounds">The bounding box.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to test.</param>
+    __host__ static uint32 IntersectBounds( const BoundingBox& bounds, const RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Tests the given lanes of a packet against a triangle, recording closer hits in the packet.
+    /// </summary>
+    /// <param name="triangle">The triangle's precomputed intersection data.</param>
+    /// <param name="geometry">The piece of geometry the triangle belongs to.</param>
+    /// <param name="primitive">The primitive of the piece of geometry that the triangle is.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to test.</param>
+    __host__ static void IntersectTriangle( const TriangleData& triangle, const Geometry* geometry, uint32 primitive, RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Tests the given lanes of a packet against a sphere, recording closer hits in the packet.
+    /// </summary>
+    /// <param name="sphere">The sphere.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to test.</param>
+    __host__ static void IntersectSphere( const Sphere* sphere, RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Tests the given lanes of a packet against a piece of geometry's primitive with single rays.
+    /// </summary>
+    /// <param name="geometry">The piece of geometry.</param>
+    /// <param name="primitive">The primitive of the piece of geometry to test.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to test.</param>
+    __host__ static void IntersectGeometry( const Geometry* geometry, uint32 primitive, RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Tests the given lanes of a packet against one of a piece of geometry's primitives, with whichever test suits
+    /// its type.
+    /// </summary>
+    /// <param name="geometry">The piece of geometry.</param>
+    /// <param name="primitive">The primitive of the piece of geometry to test.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to test.</param>
+    __host__ static void IntersectPrimitive( const Geometry* geometry, uint32 primitive, RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Tests the given lanes of a packet against an object's bounds and then the object itself.
+    /// </summary>
+    /// <param name="pair">The object and its bounds.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to test.</param>
+    __host__ static void IntersectObject( const BoundsGeometryPair& pair, RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Traces the given lanes of a packet through an octree node and its children. The lanes are assumed
+    /// to have already been tested against the node's bounds.
+    /// </summary>
+    /// <param name="octree">The octree.</param>
+    /// <param name="nodeIndex">The index of the node to trace through.</param>
+    /// <param name="packet">The ray packet.</param>
+    /// <param name="mask">The lanes to trace.</param>
+    __host__ static void TraceNode( const Octree* octree, uint32 nodeIndex, RayPacket& packet, uint32 mask );
+
+    /// <summary>
+    /// Traces every active lane of a packet through a BVH's wide copy, recording the closest piece of geometry,
+    /// its primitive, and its distance for each lane.
+    /// </summary>
+    /// <param name="wide">The wide copy of the BVH.</param>
+    /// <param name="packet">The ray packet.</param>
+    __host__ static void TraceWide( const WideBVH* wide, RayPacket& packet );
+
+public:
+    /// <summary>
+    /// Traces every active lane of a packet through an octree, recording the closest piece of geometry,
+    /// its primitive, and its distance for each lane. Lanes that hit nothing have null geometry.
+    /// </summary>
+    /// <param name="octree">The octree.</param>
+    /// <param name="packet">The ray packet.</param>
+    __host__ static void Trace( const Octree* octree, RayPacket& packet );
+
+    /// <summary>
+    /// Traces every active lane of a packet through a BVH, recording the closest piece of geometry,
+    /// its primitive, and its distance for each lane. Lanes that hit nothing have null geometry.
+    /// </summary>
+    /// <param name="bvh">The BVH.</param>
+    /// <param name="packet">The ray packet.</param>
+    __host__ static void Trace( const BVH* bvh, RayPacket& packet );
+};
+
+REX_NS_END
\ No newline at end of file
@@ -3,8 +3,6 @@
 #include "Geometry.hxx"
 #include "../../Math/Math.hxx"
 
-// TODO : Make get and set methods for the radius and center ?
-
 REX_NS_BEGIN
 
 /// <summary>
@@ -12,6 +10,9 @@ REX_NS_BEGIN
 /// </summary>
 class Sphere : public Geometry
 {
+    friend class PacketTracer;
+    friend class WideBVH;
+
     vec3 _center;
     real32  _radius;
 
@@ -19,44 +20,72 @@ public:
     /// <summary>
     /// Creates a new sphere.
     /// </summary>
-    /// <param name="material">The material to use with this sphere.</param>
-    template<typename T> __device__ Sphere( const T& material );
+    /// <param name="material">The index of the material to use with this sphere in the scene's material table.</param>
+    __both__ Sphere( uint32 material );
 
     /// <summary>
     /// Creates a new sphere.
     /// </summary>
-    /// <param name="material">The material to use with this sphere.</param>
+    /// <param name="material">The index of the material to use with this sphere in the scene's material table.</param>
     /// <param name="center">The initial center of the sphere.</param>
     /// <param name="radius">The initial radius of the sphere.</param>
-    template<typename T> __device__ Sphere( const T& material, const vec3& center, real32 radius );
+    __both__ Sphere( uint32 material, const vec3& center, real32 radius );
 
     /// <summary>
     /// Destroys this sphere.
     /// </summary>
-    __device__ virtual ~Sphere();
+    __both__ virtual ~Sphere();
 
     /// <summary>
     /// Gets this sphere's bounds.
     /// </summary>
-    __device__ virtual BoundingBox GetBounds() const;
+    __both__ virtual BoundingBox GetBounds() const;
+
+    /// <summary>
+    /// Gets this sphere's center.
+    /// </summary>
+    __both__ const vec3& GetCenter() const;
+
+    /// <summary>
+    /// Gets this sphere's radius.
+    /// </summary>
+    __both__ real32 GetRadius() const;
+
+    /// <summary>
+    /// Sets this sphere's center.
+    /// </summary>
+    /// <param name="center">The new center.</param>
+    __both__ void SetCenter( const vec3& center );
+
+    /// <summary>
+    /// Sets this sphere's radius.
+    /// </summary>
+    /// <param name="radius">The new radius.</param>
+    __both__ void SetRadius( real32 radius );
+
+    /// <summary>
+    /// Fills in the shading point information for a hit found by Hit or HitPrimitive.
+    /// </summary>
+    /// <param name="ray">The ray that made the hit.</param>
+    /// <param name="hit">The hit record.</param>
+    /// <param name="sp">The shading point information.</param>
+    __both__ virtual void GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const;
 
     /// <summary>
-    /// Checks to see if the given ray hits this sphere. If it does, the shading
-    /// point information is populated and the collision distance is recorded.
+    /// Checks to see if the given ray hits this sphere. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="tmin">The distance to intersection.</param>
-    /// <param name="sp">The shading point information.</param>
-    __device__ virtual bool Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) const;
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const;
 
     /// <summary>
     /// Performs the same thing as a normal ray hit, but for shadow rays.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="tmin">The distance to intersection.</param>
-    __device__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const;
+    __both__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const;
 };
 
-REX_NS_END
-
-#include "Sphere.inl"
\ No newline at end of file
+REX_NS_END
\ No newline at end of file
@@ -2,65 +2,150 @@
 
 #include "Geometry.hxx"
 
+// define REX_WATERTIGHT_TRIANGLES as 1 in the project settings to trade some speed for triangle tests that never let
+// rays slip between triangles that share an edge
+#if !defined( REX_WATERTIGHT_TRIANGLES )
+#  define REX_WATERTIGHT_TRIANGLES 0
+#endif
+
 REX_NS_BEGIN
 
+/// <summary>
+/// Defines the data needed to intersect a ray with a triangle that can be computed ahead of time.
+/// </summary>
+struct TriangleData
+{
+    vec3 Origin;   // the triangle's first point
+    vec3 Edge1;    // from the first point to the second
+    vec3 Edge2;    // from the first point to the third
+    vec3 Normal;   // the normalized geometric normal
+
+    /// <summary>
+    /// Creates new, empty triangle data.
+    /// </summary>
+    __both__ TriangleData();
+
+    /// <summary>
+    /// Creates new triangle data.
+    /// </summary>
+    /// <param name="p1">The first point in the triangle.</param>
+    /// <param name="p2">The second point in the triangle.</param>
+    /// <param name="p3">The third point in the triangle.</param>
+    __both__ TriangleData( const vec3& p1, const vec3& p2, const vec3& p3 );
+
+    /// <summary>
+    /// Checks to see if the given ray hits this triangle. If it does, the collision distance and the
+    /// barycentric coordinates of the second and third points are recorded.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="beta">The weight of the second point at the intersection.</param>
+    /// <param name="gamma">The weight of the third point at the intersection.</param>
+    __both__ bool Intersect( const Ray& ray, real32& tmin, real32& beta, real32& gamma ) const;
+};
+
 /// <summary>
 /// Defines a triangle.
 /// </summary>
 class Triangle : public Geometry
 {
-    vec3 _p1;
-    vec3 _p2;
-    vec3 _p3;
+    friend class PacketTracer;
+    friend class WideBVH;
+
+    vec3         _p1;
+    vec3         _p2;
+    vec3         _p3;
+    TriangleData _data;
 
 public:
     /// <summary>
     /// Creates a new triangle.
     /// </summary>
-    /// <param name="material">The material to use with this triangle.</param>
-    template<typename T> __device__ Triangle( const T& material );
+    /// <param name="material">The index of the material to use with this triangle in the scene's material table.</param>
+    __both__ Triangle( uint32 material );
 
     /// <summary>
     /// Creates a new triangle.
     /// </summary>
-    /// <param name="material">The material to use with this triangle.</param>
+    /// <param name="material">The index of the material to use with this triangle in the scene's material table.</param>
     /// <param name="p1">The first point in this triangle.</param>
     /// <param name="p2">The second point in this triangle.</param>
     /// <param name="p3">The third point in this triangle.</param>
-    template<typename T> __device__ Triangle( const T& material, const vec3& p1, const vec3& p2, const vec3& p3 );
+    __both__ Triangle( uint32 material, const vec3& p1, const vec3& p2, const vec3& p3 );
 
     /// <summary>
     /// Destroys this triangle.
     /// </summary>
-    __device__ virtual ~Triangle();
+    __both__ virtual ~Triangle();
 
     /// <summary>
     /// Gets this triangle's bounds.
     /// </summary>
-    __device__ virtual BoundingBox GetBounds() const;
+    __both__ virtual BoundingBox GetBounds() const;
+
+    /// <summary>
+    /// Gets the bounds of the part of this triangle that lies inside the given box.
+    /// </summary>
+    /// <param name="primitive">The index of the primitive, which is always 0.</param>
+    /// <param name="clip">The box to clip this triangle to.</param>
+    __both__ virtual BoundingBox GetClippedPrimitiveBounds( uint32 primitive, const BoundingBox& clip ) const;
+
+    /// <summary>
+    /// Gets the bounds of the part of the triangle made of the given points that lies inside the given box. If none
+    /// of it does, the bounds are empty (their minimum is past their maximum).
+    /// </summary>
+    /// <param name="p1">The first point in the triangle.</param>
+    /// <param name="p2">The second point in the triangle.</param>
+    /// <param name="p3">The third point in the triangle.</param>
+    /// <param name="clip">The box to clip the triangle to.</param>
+    __both__ static BoundingBox GetClippedBounds( const vec3& p1, const vec3& p2, const vec3& p3, const BoundingBox& clip );
 
     /// <summary>
     /// Gets this triangle's normal.
     /// </summary>
-    __device__ vec3 GetNormal() const;
+    __both__ vec3 GetNormal() const;
 
     /// <summary>
-    /// Checks to see if the given ray hits this triangle. If it does, the shading
-    /// point information is populated and the collision distance is recorded.
+    /// Checks to see if the given ray hits the triangle made of the given points without letting the ray slip
+    /// between triangles that share an edge. If it does, the collision distance and the barycentric coordinates
+    /// of the second and third points are recorded.
     /// </summary>
+    /// <remarks>
+    /// This is the watertight test from Woop, Benthin, and Wald (JCGT 2013). It works on the points themselves
+    /// rather than precomputed edges, so shared edges give the same answer from both sides.
+    /// </remarks>
+    /// <param name="p1">The first point in the triangle.</param>
+    /// <param name="p2">The second point in the triangle.</param>
+    /// <param name="p3">The third point in the triangle.</param>
     /// <param name="ray">The ray to check.</param>
     /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="beta">The weight of the second point at the intersection.</param>
+    /// <param name="gamma">The weight of the third point at the intersection.</param>
+    __both__ static bool IntersectWatertight( const vec3& p1, const vec3& p2, const vec3& p3, const Ray& ray, real32& tmin, real32& beta, real32& gamma );
+
+    /// <summary>
+    /// Fills in the shading point information for a hit found by Hit or HitPrimitive.
+    /// </summary>
+    /// <param name="ray">The ray that made the hit.</param>
+    /// <param name="hit">The hit record.</param>
     /// <param name="sp">The shading point information.</param>
-    __device__ virtual bool Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) const;
+    __both__ virtual void GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Checks to see if the given ray hits this triangle. If it does, the hit
+    /// record is filled in and the collision distance is recorded.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmin">The distance to intersection.</param>
+    /// <param name="hit">The hit record.</param>
+    __both__ virtual bool Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const;
 
     /// <summary>
     /// Performs the same thing as a normal ray hit, but for shadow rays.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="tmin">The distance to intersection.</param>
-    __device__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const;
+    __both__ virtual bool ShadowHit( const Ray& ray, real32& tmin ) const;
 };
 
-REX_NS_END
-
-#include "Triangle.inl"
\ No newline at end of file
+REX_NS_END
\ No newline at end of file
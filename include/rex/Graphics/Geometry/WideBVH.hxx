@@ -0,0 +1,292 @@
+#pragma once
+
+#include "../../Math/Simd.hxx"
+#include "BVH.hxx"
+#include <vector>
+
+REX_NS_BEGIN
+
+// define REX_QUANTIZED_BVH as 8 in the project settings to store the wide nodes' child bounds in that many bits per
+// plane instead of 16, or as 0 to store them as full floats
+#if !defined( REX_QUANTIZED_BVH )
+#  define REX_QUANTIZED_BVH 16
+#endif
+
+#if REX_QUANTIZED_BVH == 8
+/// <summary>
+/// The type of one quantized bounding plane.
+/// </summary>
+typedef uint8 QuantizedPlane;
+#elif REX_QUANTIZED_BVH == 16
+/// <summary>
+/// The type of one quantized bounding plane.
+/// </summary>
+typedef uint16 QuantizedPlane;
+#elif REX_QUANTIZED_BVH != 0
+#  error "REX_QUANTIZED_BVH must be 0, 8, or 16."
+#endif
+
+#if REX_QUANTIZED_BVH
+/// <summary>
+/// Defines a single node in a wide BVH. The bounds of up to one child per SIMD lane are stored side by side, one
+/// array per component, as whole steps across the box around every child so that they take a fraction of the space.
+/// </summary>
+struct WideBVHNode
+{
+    real32         Origin[ 3 ];              // the corner of the box around every child that the planes step from
+    real32         Scale [ 3 ];              // the size of one step along each axis
+    QuantizedPlane MinX  [ REX_SIMD_WIDTH ]; // rounded down, so the stored bounds always contain the real ones
+    QuantizedPlane MinY  [ REX_SIMD_WIDTH ];
+    QuantizedPlane MinZ  [ REX_SIMD_WIDTH ];
+    QuantizedPlane MaxX  [ REX_SIMD_WIDTH ]; // rounded up
+    QuantizedPlane MaxY  [ REX_SIMD_WIDTH ];
+    QuantizedPlane MaxZ  [ REX_SIMD_WIDTH ];
+    uint32         Offset[ REX_SIMD_WIDTH ]; // interior children: the index of the child's node
+                                             // leaf children: the index of the child's first primitive
+    uint32         Count [ REX_SIMD_WIDTH ]; // leaf children: the number of each type of object (see WideBVH)
+                                             // interior children: 0
+    uint32         ChildCount;               // the children fill the first lanes, and the rest are never hit
+};
+
+#else
+/// <summary>
+/// Defines a single node in a wide BVH. The bounds of up to one child per SIMD lane are stored side by side, one
+/// array per component, so that a ray can be tested against every child with one slab test.
+/// </summary>
+struct WideBVHNode
+{
+    alignas( REX_SIMD_ALIGNMENT ) real32 MinX[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 MinY[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 MinZ[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 MaxX[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 MaxY[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 MaxZ[ REX_SIMD_WIDTH ];
+    uint32 Offset[ REX_SIMD_WIDTH ]; // interior children: the index of the child's node
+                                     // leaf children: the index of the child's first primitive
+    uint32 Count [ REX_SIMD_WIDTH ]; // leaf children: the number of each type of object (see WideBVH)
+                                     // interior children: 0
+    uint32 ChildCount;               // the children fill the first lanes, and the rest are never hit
+};
+#endif
+
+/// <summary>
+/// Defines one primitive in a wide BVH's leaves.
+/// </summary>
+struct WideBVHPrimitive
+{
+    uint32 Geometry;  // the index of the primitive's geometry in the wide BVH's geometry table
+    uint32 Primitive; // the index of the primitive within its geometry
+};
+
+/// <summary>
+/// Defines the hits found by testing a ray against one primitive per SIMD lane.
+/// </summary>
+struct WideBVHLaneHits;
+
+/// <summary>
+/// Defines a host-side copy of a BVH whose binary nodes have been collapsed into nodes with one child per SIMD lane.
+/// </summary>
+/// <remarks>
+/// Each wide node is made by repeatedly opening up the largest interior child of a binary node until every lane
+/// is used, so a ray takes roughly half as many steps to reach a leaf and every step reads whole cache lines of
+/// boxes it actually tests. When REX_QUANTIZED_BVH is set, those boxes are also stored in a fraction of the space.
+///
+/// The leaves refer to a compact copy of the source's objects, which keeps only the index of each primitive and of
+/// its geometry in a table, so the source's objects (and their boxes) aren't needed once the wide copy is built. Host-
+/// only BVHs drop them, and get them back from this copy when they're added to or built again.
+///
+/// The leaves don't call into their primitives' geometry to test them. Instead, the primitives in each leaf are
+/// grouped by type (triangles, whether on their own or in meshes, then spheres, then everything else) with the size
+/// of each group packed into the leaf's count, and a ray is tested against a leaf's triangles or spheres one per SIMD
+/// lane at once, with each lane's primitive read straight from its geometry. The lanes run the same tests as
+/// the geometry does, so the nearest lane's hit is recorded as it is, with no virtual calls. Other geometry, such as
+/// mesh instances, is still hit through its geometry. The wide copy must be rebuilt whenever the source is built
+/// again, but refits keep the same primitives in the same leaves, so the wide nodes are refit in place instead, from
+/// the primitives' new bounds.
+/// </remarks>
+class WideBVH
+{
+    REX_NONCOPYABLE_CLASS( WideBVH )
+
+    friend class PacketTracer;
+
+    WideBVHNode*                  _nodes;      // kept in aligned memory so the boxes can be loaded straight into registers
+    uint32                        _nodeCount;
+    uint32                        _nodeCapacity;
+    std::vector<WideBVHPrimitive> _primitives; // grouped by type within each leaf
+    std::vector<const Geometry*>  _geometry;
+
+    /// <summary>
+    /// Adds an empty node to the end of the node list, growing the list if it's full. Returns false if the list
+    /// couldn't be grown.
+    /// </summary>
+    /// <param name="index">The index of the new node.</param>
+    __host__ bool AddNode( uint32& index );
+
+    /// <summary>
+    /// Groups the primitives in one of the source BVH's leaves by type, and makes the wide child that refers to them.
+    /// Leaves too big for their counts to be packed are split across a subtree of nodes instead. Returns false if
+    /// those nodes couldn't be allocated.
+    /// </summary>
+    /// <param name="bvh">The source BVH.</param>
+    /// <param name="offset">The index of the leaf's first object, which is also the index of its first primitive.</param>
+    /// <param name="count">The number of objects in the leaf.</param>
+    /// <param name="childOffset">The offset of the wide child.</param>
+    /// <param name="childCount">The packed count of the wide child, or 0 if it's a node.</param>
+    __host__ bool AddLeaf( BVH& bvh, uint32 offset, uint32 count, uint32& childOffset, uint32& childCount );
+
+    /// <summary>
+    /// Gets the number of objects in a leaf child from its packed count.
+    /// </summary>
+    /// <param name="count">The packed count.</param>
+    __host__ static uint32 GetLeafSize( uint32 count );
+
+    /// <summary>
+    /// Collapses the subtree at the given binary node into wide nodes. Returns false if the nodes couldn't be
+    /// allocated.
+    /// </summary>
+    /// <param name="bvh">The source BVH.</param>
+    /// <param name="binaryIndex">The index of the binary node. It must be an interior node.</param>
+    /// <param name="nodeIndex">The index of the binary node's wide node.</param>
+    __host__ bool CollapseNode( BVH& bvh, uint32 binaryIndex, uint32& nodeIndex );
+
+    /// <summary>
+    /// Refits a run of nodes from the last one back to the first, so that every node's children are refit before it
+    /// is. The run must be a whole subtree, or a run of whole sibling subtrees.
+    /// </summary>
+    /// <param name="start">The index of the run's first node.</param>
+    /// <param name="end">The index one past the run's last node.</param>
+    /// <param name="nodeBounds">The box around each node's children, which is written as each node is refit.</param>
+    __host__ void RefitNodes( uint32 start, uint32 end, BoundingBox* nodeBounds );
+
+    /// <summary>
+    /// Gets the current bounds of one of the leaves' primitives from its geometry.
+    /// </summary>
+    /// <param name="index">The index of the primitive.</param>
+    __host__ BoundingBox GetPrimitiveBounds( uint32 index ) const;
+
+    /// <summary>
+    /// Gets the bounds of one of a node's children, as they're tested during traversal.
+    /// </summary>
+    /// <param name="node">The node.</param>
+    /// <param name="child">The index of the child.</param>
+    __host__ static BoundingBox GetChildBounds( const WideBVHNode& node, uint32 child );
+
+    /// <summary>
+    /// Queries part of this wide BVH for the nearest piece of geometry that a given ray intersects before the given
+    /// distance, only recording the hit if there is one.
+    /// </summary>
+    /// <param name="offset">The index of the node to start from, or of the first primitive of the leaf to start from.</param>
+    /// <param name="count">The packed count of the leaf to start from, or 0 to start from a node.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="dist">The distance to check up to, and then the distance to the piece of geometry.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __host__ const Geometry* QueryIntersectionsFrom( uint32 offset, uint32 count, const Ray& ray, real32& dist, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Tests a ray against up to one triangle per SIMD lane at once. Returns the mask of triangles the ray hits
+    /// before the given distance, and writes where it hits each of them.
+    /// </summary>
+    /// <param name="primitives">The triangles. Bit N of the mask refers to primitive N.</param>
+    /// <param name="count">The number of triangles left, of which only the first REX_SIMD_WIDTH are tested.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmax">The distance a triangle must be hit before.</param>
+    /// <param name="hits">The hit in each lane.</param>
+    __host__ uint32 IntersectTriangles( const WideBVHPrimitive* primitives, uint32 count, const Ray& ray, real32 tmax, WideBVHLaneHits& hits ) const;
+
+    /// <summary>
+    /// Tests a ray against up to one sphere per SIMD lane at once. Returns the mask of spheres the ray hits before
+    /// the given distance, and writes where it hits each of them.
+    /// </summary>
+    /// <param name="primitives">The spheres. Bit N of the mask refers to primitive N.</param>
+    /// <param name="count">The number of spheres left, of which only the first REX_SIMD_WIDTH are tested.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmax">The distance a sphere must be hit before.</param>
+    /// <param name="hits">The hit in each lane.</param>
+    __host__ uint32 IntersectSpheres( const WideBVHPrimitive* primitives, uint32 count, const Ray& ray, real32 tmax, WideBVHLaneHits& hits ) const;
+
+    /// <summary>
+    /// Records the nearest of the given lanes' hits, if there are any. Returns true if a hit was recorded.
+    /// </summary>
+    /// <param name="primitives">The lanes' primitives. Bit N of the mask refers to primitive N.</param>
+    /// <param name="mask">The lanes that were hit.</param>
+    /// <param name="hits">The hit in each lane.</param>
+    /// <param name="dist">The distance to the nearest hit.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __host__ bool RecordNearestHit( const WideBVHPrimitive* primitives, uint32 mask, const WideBVHLaneHits& hits, real32& dist, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Tests a ray against every child of a wide node at once. Returns the mask of children the ray enters before
+    /// the given distance, and writes the distance at which the ray enters each child.
+    /// </summary>
+    /// <param name="node">The node.</param>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="invDirection">The inverse of the ray's direction.</param>
+    /// <param name="tmax">The distance a child must be entered before.</param>
+    /// <param name="entries">The entry distance of each child. Must be aligned to REX_SIMD_ALIGNMENT.</param>
+    __host__ static uint32 IntersectChildren( const WideBVHNode& node, const Ray& ray, const vec3& invDirection, real32 tmax, real32* entries );
+
+public:
+    /// <summary>
+    /// Creates a new, empty wide BVH.
+    /// </summary>
+    __host__ WideBVH();
+
+    /// <summary>
+    /// Destroys this wide BVH.
+    /// </summary>
+    __host__ ~WideBVH();
+
+    /// <summary>
+    /// Rebuilds this wide BVH by collapsing the given BVH's nodes and copying its objects' primitives, grouped by type
+    /// within each leaf, which reads each object's geometry. Returns false if the BVH isn't host-only (see
+    /// BVH::MakeHostOnly) or if the nodes couldn't be allocated.
+    /// </summary>
+    /// <param name="bvh">The source BVH, which must have been built.</param>
+    __host__ bool Build( BVH& bvh );
+
+    /// <summary>
+    /// Refits this wide BVH's nodes in place to the current bounds of its primitives' geometry, and returns the box
+    /// around all of them.
+    /// </summary>
+    /// <param name="workerCount">The number of threads the refit may be split across.</param>
+    __host__ BoundingBox Refit( uint32 workerCount );
+
+    /// <summary>
+    /// Gets the source BVH's objects back from the primitives the leaves refer to, with their bounds read from their
+    /// geometry again, in the order the leaves refer to them.
+    /// </summary>
+    /// <param name="objects">The list to fill with the objects.</param>
+    /// <param name="unique">True to keep only the first reference to each primitive, such as after spatial splits.</param>
+    __host__ void GetObjects( std::vector<BoundsGeometryPair>& objects, bool unique ) const;
+
+    /// <summary>
+    /// Gets the surface area heuristic cost of this wide BVH, weighting each child by the chance that a ray through
+    /// the root hits it.
+    /// </summary>
+    /// <param name="traversalCost">The cost of visiting a node, relative to testing one object.</param>
+    __host__ real32 GetCost( real32 traversalCost ) const;
+
+    /// <summary>
+    /// Gets the number of bytes used by this wide BVH's nodes and by its references to their primitives.
+    /// </summary>
+    __host__ uint64 GetMemoryUsage() const;
+
+    /// <summary>
+    /// Queries this wide BVH for the nearest piece of geometry that a given ray intersects, only recording the hit.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="dist">The distance to the piece of geometry.</param>
+    /// <param name="hit">The hit record of the nearest hit.</param>
+    __host__ const Geometry* QueryIntersections( const Ray& ray, real32& dist, HitRecord& hit ) const;
+
+    /// <summary>
+    /// Queries this wide BVH to see if anything blocks the given ray between a small epsilon and the given
+    /// distance. Returns as soon as any blocker is found.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="tmax">The distance along the ray to check up to.</param>
+    __host__ bool QueryOcclusion( const Ray& ray, real32 tmax ) const;
+};
+
+REX_NS_END
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../../Config.hxx"
+#include "../../CUDA/DeviceList.hxx"
+#include "Light.hxx"
+
+/// <summary>
+/// The most lights a light table hands out at once.
+/// </summary>
+#define REX_LIGHT_BATCH_SIZE 8
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a list of directional lights stored one array per component.
+/// </summary>
+struct LightTableDirectionalList
+{
+    DeviceList<real32> DirectionX;   // towards the light
+    DeviceList<real32> DirectionY;
+    DeviceList<real32> DirectionZ;
+    DeviceList<real32> RadianceR;    // already multiplied by the radiance scale
+    DeviceList<real32> RadianceG;
+    DeviceList<real32> RadianceB;
+    DeviceList<bool>   CastsShadows;
+};
+
+/// <summary>
+/// Defines a list of point lights stored one array per component.
+/// </summary>
+struct LightTablePointList
+{
+    DeviceList<real32> PositionX;
+    DeviceList<real32> PositionY;
+    DeviceList<real32> PositionZ;
+    DeviceList<real32> RadianceR;    // already multiplied by the radiance scale
+    DeviceList<real32> RadianceG;
+    DeviceList<real32> RadianceB;
+    DeviceList<bool>   CastsShadows;
+};
+
+/// <summary>
+/// Defines a batch of lights of the same type as seen from one shading point.
+/// </summary>
+struct LightBatch
+{
+    real32    DirectionX  [ REX_LIGHT_BATCH_SIZE ]; // from the shading point towards the light
+    real32    DirectionY  [ REX_LIGHT_BATCH_SIZE ];
+    real32    DirectionZ  [ REX_LIGHT_BATCH_SIZE ];
+    real32    Angle       [ REX_LIGHT_BATCH_SIZE ]; // the cosine between the shading normal and the direction
+    real32    Distance    [ REX_LIGHT_BATCH_SIZE ]; // how far a shadow ray has to go to reach the light
+    Color     Radiance    [ REX_LIGHT_BATCH_SIZE ];
+    bool      CastsShadows[ REX_LIGHT_BATCH_SIZE ];
+    LightType Type;
+    uint32    Count;
+};
+
+/// <summary>
+/// Defines every light in a scene that shading loops over.
+/// </summary>
+/// <remarks>
+/// Each kind of light is stored in a list of its own, one array per component, and shading asks for the lights a
+/// batch at a time. A batch only holds one kind of light, so filling it in is a fixed-size loop over the arrays
+/// (which the compiler can turn into SIMD code on the host) rather than a few virtual calls per light. The ambient
+/// light isn't in the table, since it doesn't come from a direction.
+///
+/// The table copies the lights when they're added, so changes to a light afterwards don't reach the table.
+/// </remarks>
+class LightTable
+{
+    REX_NONCOPYABLE_CLASS( LightTable )
+
+    LightTableDirectionalList _directional;
+    LightTablePointList       _point;
+
+public:
+    /// <summary>
+    /// Creates a new light table.
+    /// </summary>
+    __both__ LightTable();
+
+    /// <summary>
+    /// Destroys this light table.
+    /// </summary>
+    __both__ ~LightTable();
+
+    /// <summary>
+    /// Adds a light to this table.
+    /// </summary>
+    /// <param name="light">The light to add.</param>
+    /// <returns>False if the light's type can't be stored in a table, otherwise true.</returns>
+    __both__ bool Add( const Light& light );
+
+    /// <summary>
+    /// Removes every light from this table.
+    /// </summary>
+    __both__ void Clear();
+
+    /// <summary>
+    /// Gets a batch of lights as seen from a shading point. Lights are numbered across every list, so the next
+    /// batch starts at the given index plus the batch's count.
+    /// </summary>
+    /// <param name="sp">The shading point information containing hit data.</param>
+    /// <param name="first">The index of the first light in the batch.</param>
+    /// <param name="batch">The batch to fill in.</param>
+    /// <returns>False if the index is past the last light, otherwise true.</returns>
+    __both__ bool GetBatch( const ShadePoint& sp, uint32 first, LightBatch& batch ) const;
+
+    /// <summary>
+    /// Gets the number of bytes that have been allocated for lights.
+    /// </summary>
+    __both__ uint64 GetBytesUsed() const;
+
+    /// <summary>
+    /// Gets the number of bytes reserved for lights.
+    /// </summary>
+    __both__ uint64 GetBytesReserved() const;
+
+    /// <summary>
+    /// Gets the ray that checks whether one of a batch's lights is blocked from a shading point. The ray only has
+    /// to go as far as the batch's distance to the light.
+    /// </summary>
+    /// <param name="sp">The shading point information containing hit data.</param>
+    /// <param name="batch">The batch the light is in.</param>
+    /// <param name="light">The index of the light in the batch.</param>
+    __both__ static Ray GetShadowRay( const ShadePoint& sp, const LightBatch& batch, uint32 light );
+
+    /// <summary>
+    /// Gets the number of lights in this table.
+    /// </summary>
+    __both__ uint32 GetSize() const;
+
+    /// <summary>
+    /// Checks to see if one of a batch's lights is blocked from a shading point.
+    /// </summary>
+    /// <param name="sp">The shading point information containing hit data.</param>
+    /// <param name="batch">The batch the light is in.</param>
+    /// <param name="light">The index of the light in the batch.</param>
+    __both__ static bool IsInShadow( const ShadePoint& sp, const LightBatch& batch, uint32 light );
+};
+
+REX_NS_END
\ No newline at end of file
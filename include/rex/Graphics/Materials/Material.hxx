@@ -2,9 +2,15 @@
 
 #include "../../Config.hxx"
 #include "../../CUDA/DeviceList.hxx"
+#include "../../Utility/Arena.hxx"
 #include "../Geometry/Octree.hxx"
 #include "../Color.hxx"
 
+/// <summary>
+/// The material index of geometry that doesn't have a material of its own.
+/// </summary>
+#define REX_NO_MATERIAL 0xFFFFFFFFU
+
 REX_NS_BEGIN
 
 struct ShadePoint;
@@ -26,26 +32,19 @@ enum class MaterialType
 class Material
 {
 protected:
-    friend class Geometry;
-
     MaterialType _type;
 
-    /// <summary>
-    /// Copies this material for geometry.
-    /// </summary>
-    __device__ virtual Material* Copy() const = 0;
-
 public:
     /// <summary>
     /// Creates a new material.
     /// </summary>
     /// <param name="type">The material type.</param>
-    __device__ Material( MaterialType type );
+    __both__ Material( MaterialType type );
 
     /// <summary>
     /// Destroys this material.
     /// </summary>
-    __device__ virtual ~Material();
+    __both__ virtual ~Material();
 
     /// <summary>
     /// Gets an area light shaded color given hit point data.
@@ -53,12 +52,12 @@ public:
     /// <param name="sp">The hit point data.</param>
     /// <param name="lights">All of the lights in the current scene.</param>
     /// <param name="octree">The octree containing the objects to pass to the lights.</param>
-    __device__ virtual Color AreaLightShade( ShadePoint& sp ) const;
+    __both__ virtual Color AreaLightShade( ShadePoint& sp ) const;
 
     /// <summary>
     /// Gets this material's type.
     /// </summary>
-    __device__ MaterialType GetType() const;
+    __both__ MaterialType GetType() const;
 
     /// <summary>
     /// Gets a shaded color given hit point data.
@@ -66,7 +65,7 @@ public:
     /// <param name="sp">The hit point data.</param>
     /// <param name="lights">All of the lights in the current scene.</param>
     /// <param name="octree">The octree containing the objects to pass to the lights.</param>
-    __device__ virtual Color Shade( ShadePoint& sp ) const;
+    __both__ virtual Color Shade( ShadePoint& sp ) const;
 };
 
 REX_NS_END
\ No newline at end of file
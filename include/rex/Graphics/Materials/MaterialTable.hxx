@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../../Config.hxx"
+#include "../../CUDA/DeviceList.hxx"
+#include "PhongMaterial.hxx"
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines where one of a material table's materials is stored.
+/// </summary>
+struct MaterialTableEntry
+{
+    MaterialType Type;
+    uint32       Index;   // the index of the material in the list for its type
+};
+
+/// <summary>
+/// Defines every material in a scene. Geometry refers to its material by its index in the table.
+/// </summary>
+/// <remarks>
+/// Each kind of material is stored by value in a list of its own, and each index refers to an entry that says which
+/// list the material is in. Adding a material that's already in the table gives back the existing index, so a
+/// scene only stores each distinct material once no matter how much geometry uses it. Materials are found by
+/// hashing their parameters into an open addressed table of entry indices. Shading switches on the
+/// entry's type and calls the material directly, so it doesn't go through each material's virtual table.
+/// </remarks>
+class MaterialTable
+{
+    REX_NONCOPYABLE_CLASS( MaterialTable )
+
+    DeviceList<MaterialTableEntry> _entries;
+    DeviceList<MatteMaterial>      _matte;
+    DeviceList<PhongMaterial>      _phong;
+    DeviceList<uint32>             _buckets;   // one more than an entry's index, or 0 if the bucket is empty
+
+    /// <summary>
+    /// Hashes the parameters of one of this table's materials.
+    /// </summary>
+    /// <param name="entry">The material's entry.</param>
+    __both__ uint32 Hash( const MaterialTableEntry& entry ) const;
+
+    /// <summary>
+    /// Puts an entry in the first empty bucket for its hash.
+    /// </summary>
+    /// <param name="index">The entry's index.</param>
+    /// <param name="hash">The hash of the entry's material.</param>
+    __both__ void Insert( uint32 index, uint32 hash );
+
+    /// <summary>
+    /// Rebuilds the buckets with room for twice as many entries.
+    /// </summary>
+    __both__ void Rehash();
+
+public:
+    /// <summary>
+    /// Creates a new material table.
+    /// </summary>
+    __both__ MaterialTable();
+
+    /// <summary>
+    /// Destroys this material table.
+    /// </summary>
+    __both__ ~MaterialTable();
+
+    /// <summary>
+    /// Adds a material to this table, or finds the same material if it's already in it.
+    /// </summary>
+    /// <param name="material">The material to add.</param>
+    /// <returns>The material's index, or REX_NO_MATERIAL if its type can't be stored in a table.</returns>
+    __both__ uint32 Add( const Material& material );
+
+    /// <summary>
+    /// Removes every material from this table.
+    /// </summary>
+    __both__ void Clear();
+
+    /// <summary>
+    /// Gets one of this table's materials, or null if the index isn't in the table.
+    /// </summary>
+    /// <param name="index">The material's index.</param>
+    __both__ const Material* Get( uint32 index ) const;
+
+    /// <summary>
+    /// Gets how much of the light arriving from a direction one of this table's materials reflects towards the
+    /// viewer, or black if the index isn't in the table.
+    /// </summary>
+    /// <param name="index">The index of the material.</param>
+    /// <param name="sp">The hit point data.</param>
+    /// <param name="wo">The direction towards the viewer.</param>
+    /// <param name="wi">The direction towards the light.</param>
+    __both__ Color GetBRDF( uint32 index, const ShadePoint& sp, const vec3& wo, const vec3& wi ) const;
+
+    /// <summary>
+    /// Gets the number of bytes that have been allocated for materials.
+    /// </summary>
+    __both__ uint64 GetBytesUsed() const;
+
+    /// <summary>
+    /// Gets the number of bytes reserved for materials.
+    /// </summary>
+    __both__ uint64 GetBytesReserved() const;
+
+    /// <summary>
+    /// Gets the number of distinct materials in this table.
+    /// </summary>
+    __both__ uint32 GetSize() const;
+
+    /// <summary>
+    /// Gets a shaded color given hit point data.
+    /// </summary>
+    /// <param name="index">The index of the material to shade with.</param>
+    /// <param name="sp">The hit point data.</param>
+    __both__ Color Shade( uint32 index, ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Gets the color one of this table's materials reflects from the scene's ambient light, or magenta if the
+    /// index isn't in the table.
+    /// </summary>
+    /// <param name="index">The index of the material to shade with.</param>
+    /// <param name="sp">The hit point data.</param>
+    __both__ Color ShadeAmbient( uint32 index, ShadePoint& sp ) const;
+};
+
+REX_NS_END
\ No newline at end of file
@@ -11,16 +11,9 @@ REX_NS_BEGIN
 class MatteMaterial : public Material
 {
 protected:
-    friend class Geometry;
-
     LambertianBRDF _ambient;
     LambertianBRDF _diffuse;
 
-    /// <summary>
-    /// Copies this material for geometry.
-    /// </summary>
-    __device__ virtual Material* Copy() const;
-
     /// <summary>
     /// Creates a new matte material.
     /// </summary>
@@ -28,19 +21,19 @@ protected:
     /// <param name="ka">The initial ambient coefficient.</param>
     /// <param name="kd">The initial diffuse coefficient.</param>
     /// <param name="type">The actual material type.</param>
-    __device__ MatteMaterial( const Color& color, real32 ka, real32 kd, MaterialType type );
+    __both__ MatteMaterial( const Color& color, real32 ka, real32 kd, MaterialType type );
 
 public:
     /// <summary>
     /// Creates a new matte material.
     /// </summary>
-    __device__ MatteMaterial();
+    __both__ MatteMaterial();
 
     /// <summary>
     /// Creates a new matte material.
     /// </summary>
     /// <param name="color">The initial material color.</param>
-    __device__ MatteMaterial( const Color& color );
+    __both__ MatteMaterial( const Color& color );
 
     /// <summary>
     /// Creates a new matte material.
@@ -48,12 +41,12 @@ public:
     /// <param name="color">The initial material color.</param>
     /// <param name="ka">The initial ambient coefficient.</param>
     /// <param name="kd">The initial diffuse coefficient.</param>
-    __device__ MatteMaterial( const Color& color, real32 ka, real32 kd );
+    __both__ MatteMaterial( const Color& color, real32 ka, real32 kd );
 
     /// <summary>
     /// Destroys this matte material.
     /// </summary>
-    __device__ virtual ~MatteMaterial();
+    __both__ virtual ~MatteMaterial();
 
     /// <summary>
     /// Gets an area light shaded color given hit point data.
@@ -61,22 +54,31 @@ public:
     /// <param name="sp">The hit point data.</param>
     /// <param name="lights">All of the lights in the current scene.</param>
     /// <param name="octree">The octree containing the objects to pass to the lights.</param>
-    __device__ virtual Color AreaLightShade( ShadePoint& sp ) const;
+    __both__ virtual Color AreaLightShade( ShadePoint& sp ) const;
 
     /// <summary>
     /// Gets the ambient BRDF's diffuse coefficient.
     /// </summary>
-    __device__ real32 GetAmbientCoefficient() const;
+    __both__ real32 GetAmbientCoefficient() const;
+
+    /// <summary>
+    /// Gets how much of the light arriving from a direction is reflected towards the viewer. This doesn't look at
+    /// the scene's lights, so the caller decides which lights reach the hit point.
+    /// </summary>
+    /// <param name="sp">The hit point data.</param>
+    /// <param name="wo">The direction towards the viewer.</param>
+    /// <param name="wi">The direction towards the light.</param>
+    __both__ Color GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const;
 
     /// <summary>
     /// Gets this material's color.
     /// </summary>
-    __device__ Color GetColor() const;
+    __both__ Color GetColor() const;
 
     /// <summary>
     /// Gets the diffuse BRDF's diffuse coefficient.
     /// </summary>
-    __device__ real32 GetDiffuseCoefficient() const;
+    __both__ real32 GetDiffuseCoefficient() const;
 
     /// <summary>
     /// Gets a shaded color given hit point data.
@@ -84,19 +86,25 @@ public:
     /// <param name="sp">The hit point data.</param>
     /// <param name="lights">All of the lights in the current scene.</param>
     /// <param name="octree">The octree containing the objects to pass to the lights.</param>
-    __device__ virtual Color Shade( ShadePoint& sp ) const;
+    __both__ virtual Color Shade( ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Gets the color reflected from the scene's ambient light given hit point data.
+    /// </summary>
+    /// <param name="sp">The hit point data.</param>
+    __both__ Color ShadeAmbient( ShadePoint& sp ) const;
     
     /// <summary>
     /// Sets the ambient BRDF's diffuse coefficient.
     /// </summary>
     /// <param name="ka">The new ambient coefficient.</param>
-    __device__ virtual void SetAmbientCoefficient( real32 ka );
+    __both__ virtual void SetAmbientCoefficient( real32 ka );
 
     /// <summary>
     /// Sets this material's color.
     /// </summary>
     /// <param name="color">The new color.</param>
-    __device__ virtual void SetColor( const Color& color );
+    __both__ virtual void SetColor( const Color& color );
 
     /// <summary>
     /// Sets this material's color.
@@ -104,13 +112,13 @@ public:
     /// <param name="r">The new color's red component..</param>
     /// <param name="g">The new color's green component..</param>
     /// <param name="b">The new color's blue component..</param>
-    __device__ virtual void SetColor( real32 r, real32 g, real32 b );
+    __both__ virtual void SetColor( real32 r, real32 g, real32 b );
 
     /// <summary>
     /// Sets the diffuse BRDF's diffuse coefficient.
     /// </summary>
     /// <param name="kd">The new diffuse coefficient.</param>
-    __device__ virtual void SetDiffuseCoefficient( real32 kd );
+    __both__ virtual void SetDiffuseCoefficient( real32 kd );
 };
 
 REX_NS_END
\ No newline at end of file
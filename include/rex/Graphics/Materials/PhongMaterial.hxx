@@ -11,26 +11,19 @@ REX_NS_BEGIN
 class PhongMaterial : public MatteMaterial
 {
 protected:
-    friend class Geometry;
-
     GlossySpecularBRDF _specular;
 
-    /// <summary>
-    /// Copies this material for geometry.
-    /// </summary>
-    __device__ virtual Material* Copy() const;
-
 public:
     /// <summary>
     /// Creates a new Phong material.
     /// </summary>
-    __device__ PhongMaterial();
+    __both__ PhongMaterial();
 
     /// <summary>
     /// Creates a new Phong material.
     /// </summary>
     /// <param name="color">The initial material color.</param>
-    __device__ PhongMaterial( const Color& color );
+    __both__ PhongMaterial( const Color& color );
 
     /// <summary>
     /// Creates a new Phong material.
@@ -40,12 +33,12 @@ public:
     /// <param name="kd">The initial diffuse coefficient.</param>
     /// <param name="ks">The initial specular coefficient.</param>
     /// <param name="pow">The initial specular power.</param>
-    __device__ PhongMaterial( const Color& color, real32 ka, real32 kd, real32 ks, real32 pow );
+    __both__ PhongMaterial( const Color& color, real32 ka, real32 kd, real32 ks, real32 pow );
 
     /// <summary>
     /// Destroys this Phong material.
     /// </summary>
-    __device__ virtual ~PhongMaterial();
+    __both__ virtual ~PhongMaterial();
 
     /// <summary>
     /// Gets an area light shaded color given hit point data.
@@ -53,17 +46,26 @@ public:
     /// <param name="sp">The hit point data.</param>
     /// <param name="lights">All of the lights in the current scene.</param>
     /// <param name="octree">The octree containing the objects to pass to the lights.</param>
-    __device__ virtual Color AreaLightShade( ShadePoint& sp ) const;
+    __both__ virtual Color AreaLightShade( ShadePoint& sp ) const;
+
+    /// <summary>
+    /// Gets how much of the light arriving from a direction is reflected towards the viewer, including the
+    /// specular highlight.
+    /// </summary>
+    /// <param name="sp">The hit point data.</param>
+    /// <param name="wo">The direction towards the viewer.</param>
+    /// <param name="wi">The direction towards the light.</param>
+    __both__ Color GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const;
 
     /// <summary>
     /// Gets the specular coefficient.
     /// </summary>
-    __device__ real32 GetSpecularCoefficient() const;
+    __both__ real32 GetSpecularCoefficient() const;
 
     /// <summary>
     /// Gets the specular power.
     /// </summary>
-    __device__ real32 GetSpecularPower() const;
+    __both__ real32 GetSpecularPower() const;
 
     /// <summary>
     /// Gets a shaded color given hit point data.
@@ -71,19 +73,19 @@ public:
     /// <param name="sp">The hit point data.</param>
     /// <param name="lights">All of the lights in the current scene.</param>
     /// <param name="octree">The octree containing the objects to pass to the lights.</param>
-    __device__ virtual Color Shade( ShadePoint& sp ) const;
+    __both__ virtual Color Shade( ShadePoint& sp ) const;
 
     /// <summary>
     /// Sets the ambient BRDF's diffuse coefficient.
     /// </summary>
     /// <param name="ka">The new ambient coefficient.</param>
-    __device__ virtual void SetAmbientCoefficient( real32 ka );
+    __both__ virtual void SetAmbientCoefficient( real32 ka );
 
     /// <summary>
     /// Sets this material's color.
     /// </summary>
     /// <param name="color">The new color.</param>
-    __device__ virtual void SetColor( const Color& color );
+    __both__ virtual void SetColor( const Color& color );
 
     /// <summary>
     /// Sets this material's color.
@@ -91,25 +93,25 @@ public:
     /// <param name="r">The new color's red component..</param>
     /// <param name="g">The new color's green component..</param>
     /// <param name="b">The new color's blue component..</param>
-    __device__ virtual void SetColor( real32 r, real32 g, real32 b );
+    __both__ virtual void SetColor( real32 r, real32 g, real32 b );
 
     /// <summary>
     /// Sets the diffuse BRDF's diffuse coefficient.
     /// </summary>
     /// <param name="kd">The new diffuse coefficient.</param>
-    __device__ virtual void SetDiffuseCoefficient( real32 kd );
+    __both__ virtual void SetDiffuseCoefficient( real32 kd );
 
     /// <summary>
     /// Sets the specular coefficient.
     /// </summary>
     /// <param name="ks">The new coefficient.</param>
-    __device__ void SetSpecularCoefficient( real32 ks );
+    __both__ void SetSpecularCoefficient( real32 ks );
 
     /// <summary>
     /// Sets the specular power.
     /// </summary>
     /// <param name="pow">The new power.</param>
-    __device__ void SetSpecularPower( real32 pow );
+    __both__ void SetSpecularPower( real32 pow );
 };
 
 REX_NS_END
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../Config.hxx"
+#include "../Math/BoundingBox.hxx"
+#include "Geometry/Mesh.hxx"
+#include "Color.hxx"
+#include <vector>
+
+REX_NS_BEGIN
+
+struct ImportedMesh;
+
+/// <summary>
+/// Defines the header at the start of a mesh cache file.
+/// </summary>
+struct MeshCacheHeader
+{
+    char   Magic[ 8 ];
+    uint32 Version;
+    uint32 MeshCount;
+    uint32 MaterialCount;
+    uint32 Layout;          // the layout of the mesh table entries and triangle data the cache was written with
+    uint64 SourceSize;      // the size of the model file the cache was written from
+    int64  SourceTime;      // the modification time of the model file the cache was written from
+    uint64 FileSize;        // the size of the cache file itself
+};
+
+/// <summary>
+/// Defines the table entry for one mesh in a mesh cache file. Every offset is from the start of the file.
+/// </summary>
+struct MeshCacheEntry
+{
+    uint32 VertexCount;
+    uint32 IndexCount;
+    uint32 Material;
+    uint32 Flags;
+    real32 BoundsMin[ 3 ];
+    real32 BoundsMax[ 3 ];
+    uint64 PositionOffset[ 3 ];
+    uint64 NormalOffset[ 3 ];
+    uint64 IndexOffset;
+    uint64 TriangleOffset;
+};
+
+/// <summary>
+/// Defines a memory-mapped mesh cache, which holds every mesh imported from one model file.
+/// </summary>
+/// <remarks>
+/// A cache file is a header, a table of meshes, a table of material colors, and then each mesh's positions,
+/// normals, indices, and precomputed triangle data as separate arrays aligned to 64 bytes. Files are written in
+/// the host's byte order. Opening a cache maps the whole file, checks the tables, and checks that every index
+/// names one of its mesh's vertices. Nothing else is read, so the mesh data handed out points straight into the
+/// mapping and is only paged in as it is used. Caches written with a different triangle layout are rejected.
+/// </remarks>
+class MeshCache
+{
+    REX_NONCOPYABLE_CLASS( MeshCache )
+
+    const uint8* _memory;
+    uint64       _size;
+
+    /// <summary>
+    /// Gets the header of the mapped file.
+    /// </summary>
+    __host__ const MeshCacheHeader* GetHeader() const;
+
+    /// <summary>
+    /// Gets the given mesh's table entry.
+    /// </summary>
+    /// <param name="mesh">The index of the mesh.</param>
+    __host__ const MeshCacheEntry* GetEntry( uint32 mesh ) const;
+
+    /// <summary>
+    /// Checks that the mapped file's tables are complete and that every array lies inside of the file.
+    /// </summary>
+    __host__ bool Validate() const;
+
+public:
+    /// <summary>
+    /// Creates a new, closed mesh cache.
+    /// </summary>
+    __host__ MeshCache();
+
+    /// <summary>
+    /// Destroys this mesh cache, unmapping its file.
+    /// </summary>
+    __host__ ~MeshCache();
+
+    /// <summary>
+    /// Gets the path of the cache file for the given model file.
+    /// </summary>
+    /// <param name="sourcePath">The path to the model file.</param>
+    __host__ static String GetCachePath( const String& sourcePath );
+
+    /// <summary>
+    /// Writes the cache file for the given model file. Returns false if the file could not be written.
+    /// </summary>
+    /// <param name="sourcePath">The path to the model file the meshes were imported from.</param>
+    /// <param name="meshes">The meshes that were imported from the model file.</param>
+    __host__ static bool Write( const String& sourcePath, const std::vector<const ImportedMesh*>& meshes );
+
+    /// <summary>
+    /// Maps the cache file for the given model file, closing any file that was already open. Returns false if
+    /// there is no cache file, it is damaged, or it was written from an older version of the model file. If the
+    /// model file itself is missing, the cache is used as-is.
+    /// </summary>
+    /// <param name="sourcePath">The path to the model file.</param>
+    __host__ bool Open( const String& sourcePath );
+
+    /// <summary>
+    /// Unmaps the cache file. Mesh data from this cache may not be used afterwards.
+    /// </summary>
+    __host__ void Close();
+
+    /// <summary>
+    /// Checks to see if a cache file is mapped.
+    /// </summary>
+    __host__ bool IsOpen() const;
+
+    /// <summary>
+    /// Gets the number of meshes in the cache.
+    /// </summary>
+    __host__ uint32 GetMeshCount() const;
+
+    /// <summary>
+    /// Gets the total number of triangles in the cache.
+    /// </summary>
+    __host__ uint64 GetTriangleCount() const;
+
+    /// <summary>
+    /// Gets the data of the given mesh, which points into the mapped file.
+    /// </summary>
+    /// <param name="mesh">The index of the mesh.</param>
+    __host__ MeshData GetMeshData( uint32 mesh ) const;
+
+    /// <summary>
+    /// Gets the bounds of the given mesh.
+    /// </summary>
+    /// <param name="mesh">The index of the mesh.</param>
+    __host__ BoundingBox GetMeshBounds( uint32 mesh ) const;
+
+    /// <summary>
+    /// Gets the index of the given mesh's material.
+    /// </summary>
+    /// <param name="mesh">The index of the mesh.</param>
+    __host__ uint32 GetMeshMaterial( uint32 mesh ) const;
+
+    /// <summary>
+    /// Gets the number of materials in the cache.
+    /// </summary>
+    __host__ uint32 GetMaterialCount() const;
+
+    /// <summary>
+    /// Gets the diffuse color of the given material.
+    /// </summary>
+    /// <param name="material">The index of the material.</param>
+    __host__ Color GetMaterialColor( uint32 material ) const;
+};
+
+REX_NS_END
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../Config.hxx"
+#include "Geometry/Mesh.hxx"
+#include "Color.hxx"
+#include <vector>
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a mesh that was imported from a model file, along with the storage for its data.
+/// </summary>
+struct ImportedMesh
+{
+    std::vector<real32> PositionX;
+    std::vector<real32> PositionY;
+    std::vector<real32> PositionZ;
+    std::vector<real32> NormalX;
+    std::vector<real32> NormalY;
+    std::vector<real32> NormalZ;
+    std::vector<uint32> Indices;
+    Color               Diffuse;
+    uint32              File;     // the index of the file the mesh came from
+
+    /// <summary>
+    /// Gets this mesh's data, which refers to this mesh's storage.
+    /// </summary>
+    __host__ MeshData GetData() const;
+
+    /// <summary>
+    /// Gets this mesh's bounds.
+    /// </summary>
+    __host__ BoundingBox GetBounds() const;
+};
+
+/// <summary>
+/// Defines a model importer, which reads model files through Assimp and converts them into meshes.
+/// </summary>
+/// <remarks>
+/// Files are imported in two phases, each spread across worker threads: the import phase has Assimp read and
+/// triangulate every file, and the convert phase turns each file's Assimp meshes into structure-of-arrays
+/// vertex data with node transforms already applied. Each phase is timed separately. Meshes are always stored
+/// in the order their files were added, no matter which worker finished first.
+/// </remarks>
+class ModelImporter
+{
+    REX_NONCOPYABLE_CLASS( ModelImporter )
+
+    std::vector<String>       _paths;
+    std::vector<ImportedMesh> _meshes;
+    real64                    _importTime;
+    real64                    _convertTime;
+
+public:
+    /// <summary>
+    /// Creates a new model importer.
+    /// </summary>
+    __host__ ModelImporter();
+
+    /// <summary>
+    /// Destroys this model importer.
+    /// </summary>
+    __host__ ~ModelImporter();
+
+    /// <summary>
+    /// Adds a file to be imported.
+    /// </summary>
+    /// <param name="path">The path to the file.</param>
+    __host__ void AddFile( const String& path );
+
+    /// <summary>
+    /// Gets the number of files that have been added.
+    /// </summary>
+    __host__ uint32 GetFileCount() const;
+
+    /// <summary>
+    /// Gets the meshes from the last import.
+    /// </summary>
+    __host__ std::vector<ImportedMesh>& GetMeshes();
+
+    /// <summary>
+    /// Gets the meshes from the last import.
+    /// </summary>
+    __host__ const std::vector<ImportedMesh>& GetMeshes() const;
+
+    /// <summary>
+    /// Gets the total number of triangles from the last import.
+    /// </summary>
+    __host__ uint64 GetTriangleCount() const;
+
+    /// <summary>
+    /// Gets the time, in seconds, that the last import spent reading files.
+    /// </summary>
+    __host__ real64 GetImportTime() const;
+
+    /// <summary>
+    /// Gets the time, in seconds, that the last import spent converting files into meshes.
+    /// </summary>
+    __host__ real64 GetConvertTime() const;
+
+    /// <summary>
+    /// Imports every file that has been added, replacing the meshes from any previous import. Returns false if
+    /// any file failed to import, although the meshes of every file that did import are still kept.
+    /// </summary>
+    /// <param name="workerCount">The number of worker threads to import with.</param>
+    __host__ bool Import( uint32 workerCount );
+};
+
+REX_NS_END
\ No newline at end of file
@@ -5,23 +5,29 @@
 #include "../GL/GLTexture2D.hxx"
 #include "../GL/GLWindow.hxx"
 #include "../Utility/Image.hxx"
-#include "Geometry/Octree.hxx"
+#include "Geometry/AccelStructure.hxx"
 #include "Lights/AmbientLight.hxx"
 #include "Camera.hxx"
+#include "SceneArena.hxx"
 #include "ShadePoint.hxx"
 #include "ViewPlane.hxx"
+#include <functional>
+#include <vector>
 
 struct GLFWwindow; // forward declare
 
 REX_NS_BEGIN
 
+class MeshCache;
+
 /// <summary>
 /// An enumeration of possible render modes for the scene.
 /// </summary>
 enum class SceneRenderMode
 {
     ToImage,
-    ToOpenGL
+    ToOpenGL,
+    ToHostImage
 };
 
 /// <summary>
@@ -31,17 +37,32 @@ class Scene
 {
     REX_NONCOPYABLE_CLASS( Scene )
 
-    const SceneRenderMode  _renderMode;
-    ViewPlane              _viewPlane;
-    Color                  _backgroundColor;
-    Camera                 _camera;
-    DeviceList<Light*>*    _lights;
-    AmbientLight*          _ambientLight;
-    DeviceList<Geometry*>* _geometry;
-    Octree*                _octree;
-    GLWindow*              _window;
-    GLTexture2D*           _texture;
-    Image*                 _image;
+    const SceneRenderMode   _renderMode;
+    ViewPlane               _viewPlane;
+    Color                   _backgroundColor;
+    Camera                  _camera;
+    DeviceList<Light*>*     _lights;
+    AmbientLight*           _ambientLight;
+    DeviceList<Geometry*>*  _geometry;
+    DeviceList<Geometry*>*  _instancedGeometry; // geometry only drawn through instances
+    AccelStructure*         _accelStructure;
+    SceneArena*             _arena;
+    MaterialTable*          _materials;         // lives in the arena
+    LightTable*             _lightTable;        // lives in the arena
+    GLWindow*               _window;
+    GLTexture2D*            _texture;
+    Image*                  _image;
+    uint32                  _hostTileSize;
+    uint32                  _hostWorkerCount;
+    bool                    _hostPacketTracing;
+    bool                    _hostWavefront;
+    bool                    _linearAccelBuild;
+    real32                  _spatialSplitBudget;
+    real64                  _accelBuildTime;
+    real64                  _accelBytesPerPrimitive;
+    uint32                  _modelInstanceCount;
+    std::vector<String>     _modelPaths;
+    std::vector<MeshCache*> _meshCaches; // mapped model data used in place by host-only scenes
 
     /// <summary>
     /// Performs pre-render actions.
@@ -115,6 +136,55 @@ public:
     /// <param name="fullscreen">Whether or not to be building for a fullscreen window (only applies when rendering to OpenGL).</param>
     __host__ bool Build( uint16 width, uint16 height, int32 samples, bool fullscreen );
 
+    /// <summary>
+    /// Adds a model file to import when this scene is built. If any models are added, they replace the
+    /// default geometry and are arranged in a grid around the origin.
+    /// </summary>
+    /// <param name="path">The path to the model file.</param>
+    __host__ void AddModel( const String& path );
+
+    /// <summary>
+    /// Sets the number of copies of each model to place in the scene. With more than one, every copy is an instance
+    /// that shares its model's meshes, so memory only grows with the number of distinct models.
+    /// </summary>
+    /// <param name="count">The number of copies of each model.</param>
+    __host__ void SetModelInstanceCount( uint32 count );
+
+    /// <summary>
+    /// Updates this scene's geometry between frames, then refits the acceleration structure to match (or rebuilds
+    /// it once refitting has made it too slow to trace). Only host scenes can be updated.
+    /// </summary>
+    /// <param name="update">Called once for each geometry object, from several threads at once.</param>
+    /// <remarks>
+    /// Meshes drawn through instances aren't visited themselves; move their instances instead.
+    /// </remarks>
+    __host__ bool UpdateGeometry( const std::function<void( Geometry* )>& update );
+
+    /// <summary>
+    /// Sets whether the acceleration structure is built as a linear hierarchy, which builds much faster but traces
+    /// more slowly than one built with the surface area heuristic.
+    /// </summary>
+    /// <param name="enabled">True to build a linear hierarchy, false to use the surface area heuristic.</param>
+    __host__ void SetLinearAccelBuild( bool enabled );
+
+    /// <summary>
+    /// Sets how many extra references to primitives the acceleration structure may add by splitting primitives
+    /// across spatial splits, which builds more slowly but traces long, thin primitives much faster. Ignored when
+    /// building a linear hierarchy, or when not rendering to a host image.
+    /// </summary>
+    /// <param name="budget">The number of extra references as a fraction of the number of primitives, or 0 to not split primitives.</param>
+    __host__ void SetSpatialSplitBudget( real32 budget );
+
+    /// <summary>
+    /// Gets how long the last build took to build the acceleration structure, in seconds.
+    /// </summary>
+    __host__ real64 GetAccelBuildTime() const;
+
+    /// <summary>
+    /// Gets how many bytes the acceleration structure built by the last build uses on the host for each primitive.
+    /// </summary>
+    __host__ real64 GetAccelBytesPerPrimitive() const;
+
     /// <summary>
     /// Gets this scene's camera.
     /// </summary>
@@ -124,6 +194,33 @@ public:
     /// Renders this scene.
     /// </summary>
     __host__ void Render();
+
+    /// <summary>
+    /// Sets the size of the tiles the view plane is split into when rendering on the host.
+    /// </summary>
+    /// <param name="tileSize">The width and height of each tile, in pixels.</param>
+    __host__ void SetHostTileSize( uint32 tileSize );
+
+    /// <summary>
+    /// Sets the number of worker threads to use when rendering on the host and when building the scene.
+    /// </summary>
+    /// <param name="workerCount">The number of worker threads, or 0 to use every hardware thread.</param>
+    __host__ void SetHostWorkerCount( uint32 workerCount );
+
+    /// <summary>
+    /// Sets whether or not primary rays are traced in SIMD packets when rendering on the host.
+    /// </summary>
+    /// <param name="enabled">True to trace packets, false to trace single rays.</param>
+    __host__ void SetHostPacketTracing( bool enabled );
+
+    /// <summary>
+    /// Sets whether or not the scene is rendered as a wavefront when rendering on the host. Instead of taking each
+    /// pixel from its camera ray to its color at once, every stage (generating rays, tracing them, sorting the hits
+    /// by material, shading, and tracing shadow rays) runs over a whole batch of rays before the next one starts,
+    /// and the time spent in each stage is logged.
+    /// </summary>
+    /// <param name="enabled">True to render as a wavefront, false to render each pixel at once.</param>
+    __host__ void SetHostWavefront( bool enabled );
 };
 
 REX_NS_END
\ No newline at end of file
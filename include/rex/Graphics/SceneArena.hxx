@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../Config.hxx"
+#include "../Utility/Arena.hxx"
+#include "Geometry/Geometry.hxx"
+#include "Lights/LightTable.hxx"
+#include "Materials/MaterialTable.hxx"
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines the memory every object in a scene is created in. Each kind of object gets an arena of its own, so
+/// objects of the same type sit next to each other, and the whole scene is released at once. Materials are kept in
+/// a table that geometry refers to by index, and lights are copied into a table that shading loops over.
+/// </summary>
+/// <remarks>
+/// Meshes own their vertex data, so the scene destroys every piece of geometry it added before releasing the arena.
+/// </remarks>
+class SceneArena
+{
+    REX_NONCOPYABLE_CLASS( SceneArena )
+
+    Arena         _geometry[ REX_GEOMETRY_TYPE_COUNT ]; // one per geometry type
+    MaterialTable _materials;
+    Arena         _lights;
+    LightTable    _lightTable;
+
+public:
+    /// <summary>
+    /// Creates a new scene arena.
+    /// </summary>
+    __both__ SceneArena();
+
+    /// <summary>
+    /// Destroys this scene arena, releasing all of its memory.
+    /// </summary>
+    __both__ ~SceneArena();
+
+    /// <summary>
+    /// Gets the arena that geometry of the given type is created in.
+    /// </summary>
+    /// <param name="type">The geometry type.</param>
+    __both__ Arena& GetGeometryArena( GeometryType type );
+
+    /// <summary>
+    /// Gets the table that every material in the scene is added to.
+    /// </summary>
+    __both__ MaterialTable& GetMaterialTable();
+
+    /// <summary>
+    /// Gets the arena that lights are created in.
+    /// </summary>
+    __both__ Arena& GetLightArena();
+
+    /// <summary>
+    /// Gets the table that shading reads the scene's lights from.
+    /// </summary>
+    __both__ LightTable& GetLightTable();
+
+    /// <summary>
+    /// Gets the number of bytes that have been allocated for scene objects.
+    /// </summary>
+    __both__ uint64 GetBytesUsed() const;
+
+    /// <summary>
+    /// Gets the number of bytes reserved for scene objects.
+    /// </summary>
+    __both__ uint64 GetBytesReserved() const;
+
+    /// <summary>
+    /// Releases every scene object at once.
+    /// </summary>
+    __both__ void Release();
+};
+
+REX_NS_END
\ No newline at end of file
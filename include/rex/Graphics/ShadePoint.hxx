@@ -4,28 +4,28 @@
 #include "../Math/Ray.hxx"
 #include "../Math/Math.hxx"
 #include "Lights/AmbientLight.hxx"
-#include "Geometry/Octree.hxx"
+#include "Geometry/AccelStructure.hxx"
+#include "Materials/Material.hxx"
 #include "Color.hxx"
 
 REX_NS_BEGIN
 
 class Scene;
-class Material;
+class LightTable;
 
 /// <summary>
 /// Defines shading point information.
 /// </summary>
 struct ShadePoint
 {
-    Ray                 Ray;
-    vec3                HitPoint;
-    vec3                Normal;
-    real32              T;
-    const Material*     Material;
-    const AmbientLight* AmbientLight;
-    const Octree*       Octree;
-    const Light* const* Lights;
-    uint32              LightCount;
+    Ray                   Ray;
+    vec3                  HitPoint;
+    vec3                  Normal;
+    real32                T;
+    uint32                Material;       // the index of the hit material in the scene's material table
+    const AmbientLight*   AmbientLight;
+    const AccelStructure* AccelStructure;
+    const LightTable*     Lights;
 
     /// <summary>
     /// Creates a new shade point.
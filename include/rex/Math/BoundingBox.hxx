@@ -75,12 +75,38 @@ public:
     /// </summary>
     __both__ vec3 GetSize() const;
 
+    /// <summary>
+    /// Gets the surface area of the bounding box.
+    /// </summary>
+    __both__ real32 GetSurfaceArea() const;
+
+    /// <summary>
+    /// Grows this bounding box to contain the given bounding box.
+    /// </summary>
+    /// <param name="bbox">The bounding box.</param>
+    __both__ void Merge( const BoundingBox& bbox );
+
+    /// <summary>
+    /// Grows this bounding box to contain the given point.
+    /// </summary>
+    /// <param name="point">The point.</param>
+    __both__ void Merge( const vec3& point );
+
     /// <summary>
     /// Checks to see if this bounding box intersects the given ray.
     /// </summary>
     /// <param name="ray">The ray to check.</param>
     /// <param name="dist">The distance to the collision.</param>
     __both__ bool Intersects( const Ray& ray, real32& dist ) const;
+
+    /// <summary>
+    /// Checks to see if this bounding box intersects the given ray, using a precomputed inverse of the ray's
+    /// direction so that it can be shared between many boxes.
+    /// </summary>
+    /// <param name="ray">The ray to check.</param>
+    /// <param name="invDirection">The inverse of the ray's direction.</param>
+    /// <param name="dist">The distance to the collision.</param>
+    __both__ bool Intersects( const Ray& ray, const vec3& invDirection, real32& dist ) const;
 };
 
 REX_NS_END
\ No newline at end of file
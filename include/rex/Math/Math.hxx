@@ -96,6 +96,13 @@ public:
     /// <param name="value">The value to round.</param>
     __both__ static int64 Round( real64 value );
 
+    /// <summary>
+    /// Gets the Z-order (Morton) code of the given 2D coordinates by interleaving their lower 16 bits.
+    /// </summary>
+    /// <param name="x">The X coordinate.</param>
+    /// <param name="y">The Y coordinate.</param>
+    __both__ static uint32 Morton2D( uint32 x, uint32 y );
+
     /// <summary>
     /// Transforms the given 3-dimensional vector by the given matrix.
     /// </summary>
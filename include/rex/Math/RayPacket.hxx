@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Simd.hxx"
+#include "Ray.hxx"
+
+REX_NS_BEGIN
+
+class Geometry;
+
+/// <summary>
+/// Defines a packet of rays stored as structure-of-arrays so that each component can be loaded straight
+/// into a SIMD register. Only lanes in the active mask are traced.
+/// </summary>
+struct RayPacket
+{
+    alignas( REX_SIMD_ALIGNMENT ) real32 OriginX     [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 OriginY     [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 OriginZ     [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 DirectionX  [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 DirectionY  [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 DirectionZ  [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 InvDirectionX[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 InvDirectionY[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 InvDirectionZ[ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 T           [ REX_SIMD_WIDTH ];
+    const Geometry*                      Object      [ REX_SIMD_WIDTH ];
+    uint32                               Primitive   [ REX_SIMD_WIDTH ];
+    uint32                               ActiveMask;
+
+    /// <summary>
+    /// Creates a new, empty ray packet.
+    /// </summary>
+    __host__ RayPacket();
+
+    /// <summary>
+    /// Sets the ray in the given lane, activating the lane and resetting its hit information.
+    /// </summary>
+    /// <param name="lane">The lane.</param>
+    /// <param name="ray">The ray.</param>
+    __host__ void SetRay( uint32 lane, const Ray& ray );
+
+    /// <summary>
+    /// Gets the ray in the given lane.
+    /// </summary>
+    /// <param name="lane">The lane.</param>
+    __host__ Ray GetRay( uint32 lane ) const;
+};
+
+REX_NS_END
\ No newline at end of file
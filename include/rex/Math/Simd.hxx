@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../Config.hxx"
+
+// NOTE : This header uses CPU intrinsics, so nothing in it may be used from device code.
+
+#if defined( __AVX2__ )
+#  include <immintrin.h>
+
+/// <summary>
+/// The number of lanes in a SIMD register.
+/// </summary>
+#  define REX_SIMD_WIDTH 8
+#else
+#  include <emmintrin.h>
+#  include <string.h>
+#  define REX_SIMD_WIDTH 4
+#endif
+
+/// <summary>
+/// The alignment, in bytes, required by SIMD loads and stores.
+/// </summary>
+#define REX_SIMD_ALIGNMENT ( REX_SIMD_WIDTH * 4 )
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a SIMD register's worth of real values. Comparisons return lane masks where
+/// every bit of a "true" lane is set.
+/// </summary>
+class SimdReal
+{
+#if REX_SIMD_WIDTH == 8
+    typedef __m256 NativeType;
+#else
+    typedef __m128 NativeType;
+#endif
+
+    NativeType _value;
+
+public:
+    /// <summary>
+    /// Creates a new SIMD real with every lane set to zero.
+    /// </summary>
+    __host__ SimdReal();
+
+    /// <summary>
+    /// Creates a new SIMD real.
+    /// </summary>
+    /// <param name="all">The value to use for every lane.</param>
+    __host__ SimdReal( real32 all );
+
+    /// <summary>
+    /// Creates a new SIMD real.
+    /// </summary>
+    /// <param name="value">The native register value.</param>
+    __host__ explicit SimdReal( NativeType value );
+
+    /// <summary>
+    /// Loads a SIMD real from aligned memory.
+    /// </summary>
+    /// <param name="values">The values to load. Must be aligned to REX_SIMD_ALIGNMENT.</param>
+    __host__ static SimdReal Load( const real32* values );
+
+    /// <summary>
+    /// Loads a SIMD real from unaligned memory.
+    /// </summary>
+    /// <param name="values">The values to load.</param>
+    __host__ static SimdReal LoadUnaligned( const real32* values );
+
+    /// <summary>
+    /// Loads a SIMD real from unaligned 8-bit unsigned integers, one per lane.
+    /// </summary>
+    /// <param name="values">The values to load.</param>
+    __host__ static SimdReal LoadUInt8( const uint8* values );
+
+    /// <summary>
+    /// Loads a SIMD real from unaligned 16-bit unsigned integers, one per lane.
+    /// </summary>
+    /// <param name="values">The values to load.</param>
+    __host__ static SimdReal LoadUInt16( const uint16* values );
+
+    /// <summary>
+    /// Creates a lane mask from the given bit mask, where bit N corresponds to lane N.
+    /// </summary>
+    /// <param name="bits">The bit mask.</param>
+    __host__ static SimdReal FromBits( uint32 bits );
+
+    /// <summary>
+    /// Gets the lane-wise minimum of two SIMD reals.
+    /// </summary>
+    /// <param name="a">The first value.</param>
+    /// <param name="b">The second value.</param>
+    __host__ static SimdReal Min( const SimdReal& a, const SimdReal& b );
+
+    /// <summary>
+    /// Gets the lane-wise maximum of two SIMD reals.
+    /// </summary>
+    /// <param name="a">The first value.</param>
+    /// <param name="b">The second value.</param>
+    __host__ static SimdReal Max( const SimdReal& a, const SimdReal& b );
+
+    /// <summary>
+    /// Gets the lane-wise square root of a SIMD real.
+    /// </summary>
+    /// <param name="value">The value.</param>
+    __host__ static SimdReal Sqrt( const SimdReal& value );
+
+    /// <summary>
+    /// Selects lanes from one of two values based on a lane mask.
+    /// </summary>
+    /// <param name="mask">The lane mask.</param>
+    /// <param name="a">The value to use where the mask is set.</param>
+    /// <param name="b">The value to use where the mask is not set.</param>
+    __host__ static SimdReal Select( const SimdReal& mask, const SimdReal& a, const SimdReal& b );
+
+    /// <summary>
+    /// Gets the bit mask of this lane mask, where bit N corresponds to lane N.
+    /// </summary>
+    __host__ uint32 ToBits() const;
+
+    /// <summary>
+    /// Stores this SIMD real to aligned memory.
+    /// </summary>
+    /// <param name="values">The values to store to. Must be aligned to REX_SIMD_ALIGNMENT.</param>
+    __host__ void Store( real32* values ) const;
+
+    __host__ SimdReal operator+( const SimdReal& other ) const;
+    __host__ SimdReal operator-( const SimdReal& other ) const;
+    __host__ SimdReal operator*( const SimdReal& other ) const;
+    __host__ SimdReal operator/( const SimdReal& other ) const;
+    __host__ SimdReal operator&( const SimdReal& other ) const;
+    __host__ SimdReal operator|( const SimdReal& other ) const;
+    __host__ SimdReal operator<( const SimdReal& other ) const;
+    __host__ SimdReal operator<=( const SimdReal& other ) const;
+    __host__ SimdReal operator>( const SimdReal& other ) const;
+    __host__ SimdReal operator>=( const SimdReal& other ) const;
+};
+
+REX_NS_END
+
+#include "Simd.inl"
\ No newline at end of file
@@ -0,0 +1,213 @@
+REX_NS_BEGIN
+
+#if REX_SIMD_WIDTH == 8
+
+// create zeroed SIMD real
+inline SimdReal::SimdReal()
+    : _value( _mm256_setzero_ps() )
+{
+}
+
+// create SIMD real w/ value
+inline SimdReal::SimdReal( real32 all )
+    : _value( _mm256_set1_ps( all ) )
+{
+}
+
+// create SIMD real w/ native value
+inline SimdReal::SimdReal( NativeType value )
+    : _value( value )
+{
+}
+
+// load from aligned memory
+inline SimdReal SimdReal::Load( const real32* values )
+{
+    return SimdReal( _mm256_load_ps( values ) );
+}
+
+// load from unaligned memory
+inline SimdReal SimdReal::LoadUnaligned( const real32* values )
+{
+    return SimdReal( _mm256_loadu_ps( values ) );
+}
+
+// load from 8-bit integers
+inline SimdReal SimdReal::LoadUInt8( const uint8* values )
+{
+    const __m128i bytes = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( values ) );
+    return SimdReal( _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( bytes ) ) );
+}
+
+// load from 16-bit integers
+inline SimdReal SimdReal::LoadUInt16( const uint16* values )
+{
+    const __m128i shorts = _mm_loadu_si128( reinterpret_cast<const __m128i*>( values ) );
+    return SimdReal( _mm256_cvtepi32_ps( _mm256_cvtepu16_epi32( shorts ) ) );
+}
+
+// create lane mask from bits
+inline SimdReal SimdReal::FromBits( uint32 bits )
+{
+    const __m256i laneBits = _mm256_setr_epi32( 1, 2, 4, 8, 16, 32, 64, 128 );
+    const __m256i masked   = _mm256_and_si256( _mm256_set1_epi32( static_cast<int32>( bits ) ), laneBits );
+    return SimdReal( _mm256_castsi256_ps( _mm256_cmpeq_epi32( masked, laneBits ) ) );
+}
+
+// get lane-wise minimum
+inline SimdReal SimdReal::Min( const SimdReal& a, const SimdReal& b )
+{
+    return SimdReal( _mm256_min_ps( a._value, b._value ) );
+}
+
+// get lane-wise maximum
+inline SimdReal SimdReal::Max( const SimdReal& a, const SimdReal& b )
+{
+    return SimdReal( _mm256_max_ps( a._value, b._value ) );
+}
+
+// get lane-wise square root
+inline SimdReal SimdReal::Sqrt( const SimdReal& value )
+{
+    return SimdReal( _mm256_sqrt_ps( value._value ) );
+}
+
+// select lanes based on a mask
+inline SimdReal SimdReal::Select( const SimdReal& mask, const SimdReal& a, const SimdReal& b )
+{
+    return SimdReal( _mm256_blendv_ps( b._value, a._value, mask._value ) );
+}
+
+// get the bits of a lane mask
+inline uint32 SimdReal::ToBits() const
+{
+    return static_cast<uint32>( _mm256_movemask_ps( _value ) );
+}
+
+// store to aligned memory
+inline void SimdReal::Store( real32* values ) const
+{
+    _mm256_store_ps( values, _value );
+}
+
+inline SimdReal SimdReal::operator+ ( const SimdReal& other ) const { return SimdReal( _mm256_add_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator- ( const SimdReal& other ) const { return SimdReal( _mm256_sub_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator* ( const SimdReal& other ) const { return SimdReal( _mm256_mul_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator/ ( const SimdReal& other ) const { return SimdReal( _mm256_div_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator& ( const SimdReal& other ) const { return SimdReal( _mm256_and_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator| ( const SimdReal& other ) const { return SimdReal( _mm256_or_ps ( _value, other._value ) ); }
+inline SimdReal SimdReal::operator< ( const SimdReal& other ) const { return SimdReal( _mm256_cmp_ps( _value, other._value, _CMP_LT_OQ ) ); }
+inline SimdReal SimdReal::operator<=( const SimdReal& other ) const { return SimdReal( _mm256_cmp_ps( _value, other._value, _CMP_LE_OQ ) ); }
+inline SimdReal SimdReal::operator> ( const SimdReal& other ) const { return SimdReal( _mm256_cmp_ps( _value, other._value, _CMP_GT_OQ ) ); }
+inline SimdReal SimdReal::operator>=( const SimdReal& other ) const { return SimdReal( _mm256_cmp_ps( _value, other._value, _CMP_GE_OQ ) ); }
+
+#else
+
+// create zeroed SIMD real
+inline SimdReal::SimdReal()
+    : _value( _mm_setzero_ps() )
+{
+}
+
+// create SIMD real w/ value
+inline SimdReal::SimdReal( real32 all )
+    : _value( _mm_set1_ps( all ) )
+{
+}
+
+// create SIMD real w/ native value
+inline SimdReal::SimdReal( NativeType value )
+    : _value( value )
+{
+}
+
+// load from aligned memory
+inline SimdReal SimdReal::Load( const real32* values )
+{
+    return SimdReal( _mm_load_ps( values ) );
+}
+
+// load from unaligned memory
+inline SimdReal SimdReal::LoadUnaligned( const real32* values )
+{
+    return SimdReal( _mm_loadu_ps( values ) );
+}
+
+// load from 8-bit integers
+inline SimdReal SimdReal::LoadUInt8( const uint8* values )
+{
+    int32 packed;
+    memcpy( &packed, values, sizeof( packed ) );
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i bytes  = _mm_cvtsi32_si128( packed );
+    const __m128i shorts = _mm_unpacklo_epi8( bytes, zero );
+    return SimdReal( _mm_cvtepi32_ps( _mm_unpacklo_epi16( shorts, zero ) ) );
+}
+
+// load from 16-bit integers
+inline SimdReal SimdReal::LoadUInt16( const uint16* values )
+{
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i shorts = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( values ) );
+    return SimdReal( _mm_cvtepi32_ps( _mm_unpacklo_epi16( shorts, zero ) ) );
+}
+
+// create lane mask from bits
+inline SimdReal SimdReal::FromBits( uint32 bits )
+{
+    const __m128i laneBits = _mm_setr_epi32( 1, 2, 4, 8 );
+    const __m128i masked   = _mm_and_si128( _mm_set1_epi32( static_cast<int32>( bits ) ), laneBits );
+    return SimdReal( _mm_castsi128_ps( _mm_cmpeq_epi32( masked, laneBits ) ) );
+}
+
+// get lane-wise minimum
+inline SimdReal SimdReal::Min( const SimdReal& a, const SimdReal& b )
+{
+    return SimdReal( _mm_min_ps( a._value, b._value ) );
+}
+
+// get lane-wise maximum
+inline SimdReal SimdReal::Max( const SimdReal& a, const SimdReal& b )
+{
+    return SimdReal( _mm_max_ps( a._value, b._value ) );
+}
+
+// get lane-wise square root
+inline SimdReal SimdReal::Sqrt( const SimdReal& value )
+{
+    return SimdReal( _mm_sqrt_ps( value._value ) );
+}
+
+// select lanes based on a mask (SSE2 doesn't have blendv)
+inline SimdReal SimdReal::Select( const SimdReal& mask, const SimdReal& a, const SimdReal& b )
+{
+    return SimdReal( _mm_or_ps( _mm_and_ps( mask._value, a._value ),
+                                _mm_andnot_ps( mask._value, b._value ) ) );
+}
+
+// get the bits of a lane mask
+inline uint32 SimdReal::ToBits() const
+{
+    return static_cast<uint32>( _mm_movemask_ps( _value ) );
+}
+
+// store to aligned memory
+inline void SimdReal::Store( real32* values ) const
+{
+    _mm_store_ps( values, _value );
+}
+
+inline SimdReal SimdReal::operator+ ( const SimdReal& other ) const { return SimdReal( _mm_add_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator- ( const SimdReal& other ) const { return SimdReal( _mm_sub_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator* ( const SimdReal& other ) const { return SimdReal( _mm_mul_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator/ ( const SimdReal& other ) const { return SimdReal( _mm_div_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator& ( const SimdReal& other ) const { return SimdReal( _mm_and_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator| ( const SimdReal& other ) const { return SimdReal( _mm_or_ps ( _value, other._value ) ); }
+inline SimdReal SimdReal::operator< ( const SimdReal& other ) const { return SimdReal( _mm_cmplt_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator<=( const SimdReal& other ) const { return SimdReal( _mm_cmple_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator> ( const SimdReal& other ) const { return SimdReal( _mm_cmpgt_ps( _value, other._value ) ); }
+inline SimdReal SimdReal::operator>=( const SimdReal& other ) const { return SimdReal( _mm_cmpge_ps( _value, other._value ) ); }
+
+#endif
+
+REX_NS_END
\ No newline at end of file
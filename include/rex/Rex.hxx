@@ -8,26 +8,37 @@
 #include "GL/GLTexture2D.hxx"
 #include "Graphics/BRDFs/GlossySpecularBRDF.hxx"
 #include "Graphics/BRDFs/LambertianBRDF.hxx"
+#include "Graphics/Geometry/AccelStructure.hxx"
+#include "Graphics/Geometry/BVH.hxx"
 #include "Graphics/Geometry/Geometry.hxx"
+#include "Graphics/Geometry/Mesh.hxx"
+#include "Graphics/Geometry/MeshInstance.hxx"
 #include "Graphics/Geometry/Octree.hxx"
 #include "Graphics/Geometry/Sphere.hxx"
 #include "Graphics/Geometry/Triangle.hxx"
 #include "Graphics/Lights/AmbientLight.hxx"
 #include "Graphics/Lights/DirectionalLight.hxx"
+#include "Graphics/Lights/LightTable.hxx"
 #include "Graphics/Lights/PointLight.hxx"
 #include "Graphics/Materials/EmissiveMaterial.hxx"
+#include "Graphics/Materials/MaterialTable.hxx"
 #include "Graphics/Materials/MatteMaterial.hxx"
 #include "Graphics/Materials/PhongMaterial.hxx"
+#include "Graphics/MeshCache.hxx"
 #include "Graphics/Camera.hxx"
 #include "Graphics/Color.hxx"
+#include "Graphics/ModelImporter.hxx"
 #include "Graphics/Scene.hxx"
+#include "Graphics/SceneArena.hxx"
 #include "Graphics/ShadePoint.hxx"
 #include "Graphics/TextureRenderer.hxx"
 #include "Graphics/ViewPlane.hxx"
 #include "Math/BoundingBox.hxx"
 #include "Math/Math.hxx"
 #include "Math/Ray.hxx"
+#include "Utility/Arena.hxx"
 #include "Utility/GC.hxx"
 #include "Utility/Image.hxx"
 #include "Utility/Logger.hxx"
+#include "Utility/TileScheduler.hxx"
 #include "Utility/Timer.hxx"
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../Config.hxx"
+#include "../CUDA.hxx"
+#include <new>
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a bump allocator. Memory is handed out from large blocks in the order it is requested, and is only
+/// ever released all at once.
+/// </summary>
+/// <remarks>
+/// The arena never calls the destructors of the objects created in it. Objects that own memory of their own, such
+/// as meshes with their vertex lists, must be destroyed by whoever created them before the arena is released.
+/// </remarks>
+class Arena
+{
+    REX_NONCOPYABLE_CLASS( Arena )
+
+    /// <summary>
+    /// Defines the header at the start of each block of memory.
+    /// </summary>
+    struct Block
+    {
+        Block* Next;
+        uint64 Size;
+        uint64 Used;
+    };
+
+    Block*       _blocks;
+    const uint64 _blockSize;
+    uint64       _bytesUsed;
+    uint64       _bytesReserved;
+
+    /// <summary>
+    /// Attempts to allocate memory from the given block.
+    /// </summary>
+    /// <param name="block">The block.</param>
+    /// <param name="size">The number of bytes to allocate.</param>
+    /// <param name="alignment">The alignment of the memory. Must be a power of two.</param>
+    __both__ static void* AllocateFrom( Block* block, uint64 size, uint64 alignment );
+
+    /// <summary>
+    /// Creates a new block of memory.
+    /// </summary>
+    /// <param name="size">The number of usable bytes in the block.</param>
+    __both__ Block* CreateBlock( uint64 size );
+
+public:
+    /// <summary>
+    /// Creates a new arena.
+    /// </summary>
+    __both__ Arena();
+
+    /// <summary>
+    /// Creates a new arena.
+    /// </summary>
+    /// <param name="blockSize">The size of each block of memory. Larger allocations get a block of their own.</param>
+    __both__ Arena( uint64 blockSize );
+
+    /// <summary>
+    /// Destroys this arena, releasing all of its memory.
+    /// </summary>
+    __both__ ~Arena();
+
+    /// <summary>
+    /// Allocates memory from this arena. Returns null if the memory could not be allocated.
+    /// </summary>
+    /// <param name="size">The number of bytes to allocate.</param>
+    /// <param name="alignment">The alignment of the memory. Must be a power of two.</param>
+    __both__ void* Allocate( uint64 size, uint64 alignment );
+
+    /// <summary>
+    /// Creates a new object in this arena. Returns null if the memory could not be allocated.
+    /// </summary>
+    /// <param name="args">The arguments to pass into the type's constructor.</param>
+    template<typename T, typename ... Args> __both__ T* Create( const Args& ... args );
+
+    /// <summary>
+    /// Gets the number of bytes that have been allocated from this arena.
+    /// </summary>
+    __both__ uint64 GetBytesUsed() const;
+
+    /// <summary>
+    /// Gets the number of bytes this arena has reserved for its blocks.
+    /// </summary>
+    __both__ uint64 GetBytesReserved() const;
+
+    /// <summary>
+    /// Releases all of this arena's memory at once.
+    /// </summary>
+    __both__ void Release();
+};
+
+REX_NS_END
+
+#include "Arena.inl"
\ No newline at end of file
@@ -0,0 +1,15 @@
+REX_NS_BEGIN
+
+// create a new object in the arena
+template<typename T, typename ... Args> __both__ T* Arena::Create( const Args& ... args )
+{
+    void* memory = Allocate( sizeof( T ), alignof( T ) );
+    if ( !memory )
+    {
+        return nullptr;
+    }
+
+    return new ( memory ) T( args... );
+}
+
+REX_NS_END
\ No newline at end of file
@@ -26,6 +26,14 @@ public:
     /// <param name="height">The image's height.</param>
     __host__ Image( uint16 width, uint16 height );
 
+    /// <summary>
+    /// Creates a new image.
+    /// </summary>
+    /// <param name="width">The image's width.</param>
+    /// <param name="height">The image's height.</param>
+    /// <param name="useDevice">Whether or not to allocate device pixels for this image.</param>
+    __host__ Image( uint16 width, uint16 height, bool useDevice );
+
     /// <summary>
     /// Destroys this image.
     /// </summary>
@@ -61,6 +69,11 @@ public:
     /// Gets this image's device memory.
     /// </summary>
     __host__ uchar4* GetDeviceMemory();
+
+    /// <summary>
+    /// Gets this image's host memory.
+    /// </summary>
+    __host__ uchar4* GetHostMemory();
 };
 
 REX_NS_END
\ No newline at end of file
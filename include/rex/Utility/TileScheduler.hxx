@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../Config.hxx"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a rectangular tile of pixels.
+/// </summary>
+struct Tile
+{
+    uint32 StartX;
+    uint32 StartY;
+    uint32 EndX;
+    uint32 EndY;
+};
+
+/// <summary>
+/// Defines a work-stealing tile scheduler. Tiles are ordered along a Z-order (Morton) curve and split into
+/// one contiguous run per worker; workers take tiles from the front of their own queue and steal from the
+/// back of everyone else's once theirs runs dry.
+/// </summary>
+class TileScheduler
+{
+    REX_NONCOPYABLE_CLASS( TileScheduler )
+
+    /// <summary>
+    /// Defines a single worker's tile queue.
+    /// </summary>
+    struct WorkerQueue
+    {
+        std::mutex       Mutex;
+        std::deque<Tile> Tiles;
+    };
+
+    std::vector<WorkerQueue*> _queues;
+    uint32                    _tileSize;
+    uint32                    _tileCount;
+
+    /// <summary>
+    /// Attempts to take a tile from the front of a worker's own queue.
+    /// </summary>
+    /// <param name="worker">The worker.</param>
+    /// <param name="tile">The tile that was taken.</param>
+    __host__ bool PopTile( uint32 worker, Tile& tile );
+
+    /// <summary>
+    /// Attempts to steal a tile from the back of another worker's queue.
+    /// </summary>
+    /// <param name="victim">The worker to steal from.</param>
+    /// <param name="tile">The tile that was stolen.</param>
+    __host__ bool StealTile( uint32 victim, Tile& tile );
+
+public:
+    /// <summary>
+    /// Creates a new tile scheduler.
+    /// </summary>
+    /// <param name="width">The width of the area to split into tiles.</param>
+    /// <param name="height">The height of the area to split into tiles.</param>
+    /// <param name="tileSize">The width and height of each tile. Edge tiles are clipped rather than padded.</param>
+    /// <param name="workerCount">The number of workers that will be requesting tiles.</param>
+    __host__ TileScheduler( uint32 width, uint32 height, uint32 tileSize, uint32 workerCount );
+
+    /// <summary>
+    /// Destroys this tile scheduler.
+    /// </summary>
+    __host__ ~TileScheduler();
+
+    /// <summary>
+    /// Gets the total number of tiles.
+    /// </summary>
+    __host__ uint32 GetTileCount() const;
+
+    /// <summary>
+    /// Gets the size of each tile.
+    /// </summary>
+    __host__ uint32 GetTileSize() const;
+
+    /// <summary>
+    /// Gets the number of workers.
+    /// </summary>
+    __host__ uint32 GetWorkerCount() const;
+
+    /// <summary>
+    /// Gets the next tile for the given worker. Returns false once every tile has been handed out.
+    /// </summary>
+    /// <param name="worker">The worker's index.</param>
+    /// <param name="tile">The next tile.</param>
+    __host__ bool GetNextTile( uint32 worker, Tile& tile );
+};
+
+REX_NS_END
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include <rex/Utility/Arena.hxx>
+#include <rex/Math/Math.hxx>
+
+#define DEFAULT_BLOCK_SIZE ( 64 * 1024 )
+
+REX_NS_BEGIN
+
+// create a new arena
+__both__ Arena::Arena()
+    : Arena( DEFAULT_BLOCK_SIZE )
+{
+}
+
+// create a new arena w/ block size
+__both__ Arena::Arena( uint64 blockSize )
+    : _blocks       ( nullptr )
+    , _blockSize    ( Math::Max( blockSize, uint64( 1024 ) ) )
+    , _bytesUsed    ( 0 )
+    , _bytesReserved( 0 )
+{
+}
+
+// destroy this arena
+__both__ Arena::~Arena()
+{
+    Release();
+}
+
+// allocate memory from a block
+__both__ void* Arena::AllocateFrom( Block* block, uint64 size, uint64 alignment )
+{
+    // the usable memory starts right after the header
+    const uint64 base   = reinterpret_cast<uint64>( block + 1 );
+    const uint64 offset = ( ( base + block->Used + alignment - 1 ) & ~( alignment - 1 ) ) - base;
+    if ( offset + size > block->Size )
+    {
+        return nullptr;
+    }
+
+    block->Used = offset + size;
+    return reinterpret_cast<void*>( base + offset );
+}
+
+// create a new block of memory
+__both__ Arena::Block* Arena::CreateBlock( uint64 size )
+{
+    uint8* memory = new uint8[ sizeof( Block ) + size ];
+    if ( !memory )
+    {
+        return nullptr;
+    }
+
+    Block* block = reinterpret_cast<Block*>( memory );
+    block->Next  = nullptr;
+    block->Size  = size;
+    block->Used  = 0;
+
+    _bytesReserved += size;
+    return block;
+}
+
+// allocate memory
+__both__ void* Arena::Allocate( uint64 size, uint64 alignment )
+{
+    // try the current block first
+    void* memory = _blocks ? AllocateFrom( _blocks, size, alignment ) : nullptr;
+    if ( !memory )
+    {
+        // allocations that are large relative to a block get a block of their own, which goes behind the current
+        // block so that the rest of the current block can still be used
+        const bool   isLarge = ( size > _blockSize / 4 );
+        const uint64 needed  = size + alignment;
+        Block*       block   = CreateBlock( isLarge ? needed : Math::Max( _blockSize, needed ) );
+        if ( !block )
+        {
+            return nullptr;
+        }
+
+        if ( isLarge && _blocks )
+        {
+            block->Next   = _blocks->Next;
+            _blocks->Next = block;
+        }
+        else
+        {
+            block->Next = _blocks;
+            _blocks     = block;
+        }
+
+        memory = AllocateFrom( block, size, alignment );
+    }
+
+    _bytesUsed += size;
+    return memory;
+}
+
+// get the number of bytes used
+__both__ uint64 Arena::GetBytesUsed() const
+{
+    return _bytesUsed;
+}
+
+// get the number of bytes reserved
+__both__ uint64 Arena::GetBytesReserved() const
+{
+    return _bytesReserved;
+}
+
+// release all memory
+__both__ void Arena::Release()
+{
+    while ( _blocks )
+    {
+        Block* next = _blocks->Next;
+        delete[] reinterpret_cast<uint8*>( _blocks );
+        _blocks = next;
+    }
+
+    _bytesUsed     = 0;
+    _bytesReserved = 0;
+}
+
+REX_NS_END
\ No newline at end of file
@@ -3,12 +3,12 @@
 REX_NS_BEGIN
 
 // create BRDF
-__device__ BRDF::BRDF()
+__both__ BRDF::BRDF()
 {
 }
 
 // destroy BRDF
-__device__ BRDF::~BRDF()
+__both__ BRDF::~BRDF()
 {
 }
 
@@ -0,0 +1,1671 @@
+#include <rex/Graphics/Geometry/BVH.hxx>
+#include <rex/Graphics/Geometry/WideBVH.hxx>
+#include <rex/Graphics/Geometry/Geometry.hxx>
+#include <rex/Graphics/ShadePoint.hxx>
+#include <rex/Math/Math.hxx>
+#include <rex/Utility/Logger.hxx>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+#define DEFAULT_MAX_LEAF_SIZE      4
+#define SAH_BIN_COUNT              12
+#define SAH_TRAVERSAL_COST         1.0f // relative to the cost of intersecting one object
+#define TRAVERSAL_STACK_SIZE       ( REX_BVH_MAX_DEPTH + 1 ) // a ray never waits on more than one node per level
+#define PARALLEL_BUILD_MIN_OBJECTS 4096 // subtrees smaller than this aren't worth a thread
+#define PARALLEL_REFIT_MIN_NODES   8192 // the same, but for refitting
+#define REFIT_MAX_COST_RATIO       1.5f // how much worse than when it was built a refit tree may get before a rebuild
+#define MORTON_WIDE_MIN_OBJECTS    ( 1U << 16 ) // past this, 10 bits per axis leaves too many objects sharing a code
+#define RADIX_BITS                 8
+#define RADIX_BUCKET_COUNT         ( 1U << RADIX_BITS )
+#define SPATIAL_BIN_COUNT          16
+#define SPATIAL_SPLIT_MIN_OVERLAP  1.0e-5f // how much of the root's area an object split's children must overlap by before a spatial split is tried
+#define SPATIAL_SPLIT_MAX_DEPTH    48      // past this only object splits are tried, since spatial splits this deep mostly just duplicate references
+
+
+REX_NS_BEGIN
+
+// get the number of threads' worth of levels to split a tree's work across
+__host__ static uint32 GetTaskDepth( uint32 workerCount )
+{
+    uint32 taskDepth = 0;
+    while ( ( 1U << taskDepth ) < workerCount )
+    {
+        ++taskDepth;
+    }
+    return taskDepth;
+}
+
+// get the SAH bin that a centroid falls into
+__both__ static uint32 GetBinIndex( real32 centroid, real32 min, real32 scale )
+{
+    uint32 bin = static_cast<uint32>( ( centroid - min ) * scale );
+    return Math::Min( bin, uint32( SAH_BIN_COUNT - 1 ) );
+}
+
+// get a bounding box that contains nothing, ready to be merged into
+__both__ static BoundingBox GetEmptyBounds()
+{
+    return BoundingBox( vec3( Math::HugeValue() ), vec3( -Math::HugeValue() ) );
+}
+
+// find the cheapest split of some objects by binning their centers along each axis, and return whether there is one
+__both__ static bool FindObjectSplit( const BoundsGeometryPair* objects, uint32 count, const BoundingBox& centroidBounds, real32& bestCost, int32& bestAxis, uint32& bestSplit )
+{
+    bestCost  = Math::HugeValue();
+    bestAxis  = -1;
+    bestSplit = 0;
+    for ( int32 axis = 0; axis < 3; ++axis )
+    {
+        const real32 cmin = centroidBounds.GetMin()[ axis ];
+        const real32 cmax = centroidBounds.GetMax()[ axis ];
+        if ( cmax <= cmin )
+        {
+            continue;
+        }
+        const real32 scale = SAH_BIN_COUNT / ( cmax - cmin );
+
+        // fill the bins
+        uint32 binCounts[ SAH_BIN_COUNT ];
+        vec3   binMins  [ SAH_BIN_COUNT ];
+        vec3   binMaxs  [ SAH_BIN_COUNT ];
+        for ( uint32 b = 0; b < SAH_BIN_COUNT; ++b )
+        {
+            binCounts[ b ] = 0;
+            binMins  [ b ] = vec3(  Math::HugeValue() );
+            binMaxs  [ b ] = vec3( -Math::HugeValue() );
+        }
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            const BoundingBox& objBounds = objects[ i ].Bounds;
+            const uint32       b         = GetBinIndex( objBounds.GetCenter()[ axis ], cmin, scale );
+            binCounts[ b ] += 1;
+            binMins  [ b ]  = glm::min( binMins[ b ], objBounds.GetMin() );
+            binMaxs  [ b ]  = glm::max( binMaxs[ b ], objBounds.GetMax() );
+        }
+
+        // sweep in from the left to get the left side of each split
+        real32      leftAreas [ SAH_BIN_COUNT - 1 ];
+        uint32      leftCounts[ SAH_BIN_COUNT - 1 ];
+        BoundingBox side      = GetEmptyBounds();
+        uint32      sideCount = 0;
+        for ( uint32 b = 0; b < SAH_BIN_COUNT - 1; ++b )
+        {
+            if ( binCounts[ b ] > 0 )
+            {
+                side.Merge( BoundingBox( binMins[ b ], binMaxs[ b ] ) );
+                sideCount += binCounts[ b ];
+            }
+            leftCounts[ b ] = sideCount;
+            leftAreas [ b ] = sideCount > 0 ? side.GetSurfaceArea() : 0.0f;
+        }
+
+        // then sweep in from the right, costing each split as we go
+        side      = GetEmptyBounds();
+        sideCount = 0;
+        for ( uint32 b = SAH_BIN_COUNT - 1; b > 0; --b )
+        {
+            if ( binCounts[ b ] > 0 )
+            {
+                side.Merge( BoundingBox( binMins[ b ], binMaxs[ b ] ) );
+                sideCount += binCounts[ b ];
+            }
+
+            const uint32 split = b - 1;
+            if ( sideCount == 0 || leftCounts[ split ] == 0 )
+            {
+                continue;
+            }
+
+            const real32 cost = leftCounts[ split ] * leftAreas[ split ] + sideCount * side.GetSurfaceArea();
+            if ( cost < bestCost )
+            {
+                bestCost  = cost;
+                bestAxis  = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    return bestAxis >= 0;
+}
+
+// spread the low 10 bits of a value out so there are two zero bits between each of them
+__host__ static uint64 SpreadBits10( uint64 value )
+{
+    value &= 0x3FF;
+    value  = ( value | ( value << 16 ) ) & 0x30000FF;
+    value  = ( value | ( value <<  8 ) ) & 0x300F00F;
+    value  = ( value | ( value <<  4 ) ) & 0x30C30C3;
+    value  = ( value | ( value <<  2 ) ) & 0x9249249;
+    return value;
+}
+
+// spread the low 21 bits of a value out so there are two zero bits between each of them
+__host__ static uint64 SpreadBits21( uint64 value )
+{
+    value &= 0x1FFFFF;
+    value  = ( value | ( value << 32 ) ) & 0x1F00000000FFFFULL;
+    value  = ( value | ( value << 16 ) ) & 0x1F0000FF0000FFULL;
+    value  = ( value | ( value <<  8 ) ) & 0x100F00F00F00F00FULL;
+    value  = ( value | ( value <<  4 ) ) & 0x10C30C30C30C30C3ULL;
+    value  = ( value | ( value <<  2 ) ) & 0x1249249249249249ULL;
+    return value;
+}
+
+// get the Morton code of a point given in [0, 1] on each axis, w/ the given number of bits per axis
+__host__ static uint64 GetMortonCode( const vec3& point, uint32 axisBits )
+{
+    const real32 scale = static_cast<real32>( ( 1U << axisBits ) - 1 );
+    const uint64 x     = static_cast<uint64>( Math::Clamp( point.x, 0.0f, 1.0f ) * scale );
+    const uint64 y     = static_cast<uint64>( Math::Clamp( point.y, 0.0f, 1.0f ) * scale );
+    const uint64 z     = static_cast<uint64>( Math::Clamp( point.z, 0.0f, 1.0f ) * scale );
+
+    return ( axisBits > 10 ) ? ( SpreadBits21( x ) << 2 ) | ( SpreadBits21( y ) << 1 ) | SpreadBits21( z )
+                             : ( SpreadBits10( x ) << 2 ) | ( SpreadBits10( y ) << 1 ) | SpreadBits10( z );
+}
+
+// get the index of the highest set bit of a non-zero value
+__host__ static uint32 GetHighestBit( uint64 value )
+{
+    uint32 bit = 0;
+    for ( uint32 step = 32; step > 0; step >>= 1 )
+    {
+        if ( value >> step )
+        {
+            value >>= step;
+            bit    += step;
+        }
+    }
+    return bit;
+}
+
+// run a function over a range split evenly across threads, passing each its worker index and sub-range
+template<typename F> __host__ static void RunParallel( uint32 count, uint32 workerCount, const F& func )
+{
+    auto runRange = [ &func, count, workerCount ]( uint32 worker )
+    {
+        const uint32 start = static_cast<uint32>( uint64( count ) *   worker       / workerCount );
+        const uint32 end   = static_cast<uint32>( uint64( count ) * ( worker + 1 ) / workerCount );
+        func( worker, start, end );
+    };
+
+    std::vector<std::thread> workers;
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        workers.emplace_back( runRange, i );
+    }
+    runRange( 0 );
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+}
+
+// sort the given codes and their values w/ a parallel least significant digit radix sort
+__host__ static void SortMortonCodes( std::vector<uint64>& codes, std::vector<uint32>& values, uint32 codeBits, uint32 workerCount )
+{
+    const uint32        count = static_cast<uint32>( codes.size() );
+    std::vector<uint64> codesTemp( count );
+    std::vector<uint32> valuesTemp( count );
+    std::vector<uint32> offsets( workerCount * RADIX_BUCKET_COUNT );
+
+    for ( uint32 shift = 0; shift < codeBits; shift += RADIX_BITS )
+    {
+        // every worker counts the digits in its own part of the codes
+        std::fill( offsets.begin(), offsets.end(), 0 );
+        RunParallel( count, workerCount, [ &codes, &offsets, shift ]( uint32 worker, uint32 start, uint32 end )
+        {
+            uint32* counts = &offsets[ worker * RADIX_BUCKET_COUNT ];
+            for ( uint32 i = start; i < end; ++i )
+            {
+                ++counts[ ( codes[ i ] >> shift ) & ( RADIX_BUCKET_COUNT - 1 ) ];
+            }
+        } );
+
+        // each worker writes its part of a bucket after the earlier workers' parts, which keeps the sort stable
+        uint32 total = 0;
+        for ( uint32 bucket = 0; bucket < RADIX_BUCKET_COUNT; ++bucket )
+        {
+            for ( uint32 worker = 0; worker < workerCount; ++worker )
+            {
+                const uint32 bucketCount = offsets[ worker * RADIX_BUCKET_COUNT + bucket ];
+                offsets[ worker * RADIX_BUCKET_COUNT + bucket ] = total;
+                total += bucketCount;
+            }
+        }
+
+        RunParallel( count, workerCount, [ &, shift ]( uint32 worker, uint32 start, uint32 end )
+        {
+            uint32* next = &offsets[ worker * RADIX_BUCKET_COUNT ];
+            for ( uint32 i = start; i < end; ++i )
+            {
+                const uint32 to = next[ ( codes[ i ] >> shift ) & ( RADIX_BUCKET_COUNT - 1 ) ]++;
+                codesTemp [ to ] = codes [ i ];
+                valuesTemp[ to ] = values[ i ];
+            }
+        } );
+
+        codes.swap( codesTemp );
+        values.swap( valuesTemp );
+    }
+}
+
+/// <summary>
+/// Defines the state shared by every task of a spatial split build.
+/// </summary>
+struct SpatialBuildState
+{
+    real32             RootArea;    // the surface area of the bounds of every object
+    uint32             MaxLeafSize;
+    std::atomic<int64> Budget;      // the number of references that splitting objects may still add
+};
+
+/// <summary>
+/// Defines a subtree built on its own thread by a spatial split build, before it's moved into place.
+/// </summary>
+struct SpatialSubtree
+{
+    std::vector<BVHNode>            Nodes;
+    std::vector<BoundsGeometryPair> Objects;
+};
+
+// check if a bounding box contains nothing
+__host__ static bool IsEmpty( const BoundingBox& bounds )
+{
+    const vec3& min = bounds.GetMin();
+    const vec3& max = bounds.GetMax();
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+// get the position of one of the evenly spaced planes between a node's spatial split bins
+__host__ static real32 GetSpatialPlane( const BoundingBox& bounds, uint32 axis, uint32 plane )
+{
+    // the outer planes are the node's own, so every object falls inside the bins
+    const real32 min = bounds.GetMin()[ axis ];
+    const real32 max = bounds.GetMax()[ axis ];
+    if ( plane == 0 )
+    {
+        return min;
+    }
+    if ( plane == SPATIAL_BIN_COUNT )
+    {
+        return max;
+    }
+    return min + ( max - min ) * plane / SPATIAL_BIN_COUNT;
+}
+
+// get the spatial split bin that a position falls into
+__host__ static uint32 GetSpatialBinIndex( real32 position, real32 min, real32 scale )
+{
+    const real32 bin = ( position - min ) * scale;
+    return ( bin <= 0.0f ) ? 0 : Math::Min( static_cast<uint32>( bin ), uint32( SPATIAL_BIN_COUNT - 1 ) );
+}
+
+// get the bounds of the part of an object between two planes along an axis
+__host__ static BoundingBox ClipObject( const BoundsGeometryPair& object, uint32 axis, real32 min, real32 max )
+{
+    // objects that have already been split keep to their own part
+    vec3 clipMin = object.Bounds.GetMin();
+    vec3 clipMax = object.Bounds.GetMax();
+    clipMin[ axis ] = Math::Max( clipMin[ axis ], min );
+    clipMax[ axis ] = Math::Min( clipMax[ axis ], max );
+    return object.Geometry->GetClippedPrimitiveBounds( object.Primitive, BoundingBox( clipMin, clipMax ) );
+}
+
+// find the cheapest spatial split of some objects by binning the parts of them between evenly spaced planes, and return whether there is one
+__host__ static bool FindSpatialSplit( const std::vector<BoundsGeometryPair>& objects, const BoundingBox& bounds, real32& bestCost, int32& bestAxis, uint32& bestSplit )
+{
+    bestCost  = Math::HugeValue();
+    bestAxis  = -1;
+    bestSplit = 0;
+    for ( int32 axis = 0; axis < 3; ++axis )
+    {
+        const real32 min = bounds.GetMin()[ axis ];
+        const real32 max = bounds.GetMax()[ axis ];
+        if ( max <= min )
+        {
+            continue;
+        }
+        const real32 scale = SPATIAL_BIN_COUNT / ( max - min );
+
+        // objects are counted in the bins they start and end in, and their parts are added to every bin they cross
+        uint32 entries[ SPATIAL_BIN_COUNT ];
+        uint32 exits  [ SPATIAL_BIN_COUNT ];
+        vec3   binMins[ SPATIAL_BIN_COUNT ];
+        vec3   binMaxs[ SPATIAL_BIN_COUNT ];
+        for ( uint32 b = 0; b < SPATIAL_BIN_COUNT; ++b )
+        {
+            entries[ b ] = 0;
+            exits  [ b ] = 0;
+            binMins[ b ] = vec3(  Math::HugeValue() );
+            binMaxs[ b ] = vec3( -Math::HugeValue() );
+        }
+        for ( const BoundsGeometryPair& object : objects )
+        {
+            const uint32 first = GetSpatialBinIndex( object.Bounds.GetMin()[ axis ], min, scale );
+            const uint32 last  = GetSpatialBinIndex( object.Bounds.GetMax()[ axis ], min, scale );
+            entries[ first ] += 1;
+            exits  [ last  ] += 1;
+            for ( uint32 b = first; b <= last; ++b )
+            {
+                const BoundingBox part = ( first == last ) ? object.Bounds
+                                                           : ClipObject( object, axis, GetSpatialPlane( bounds, axis, b ), GetSpatialPlane( bounds, axis, b + 1 ) );
+                if ( !IsEmpty( part ) )
+                {
+                    binMins[ b ] = glm::min( binMins[ b ], part.GetMin() );
+                    binMaxs[ b ] = glm::max( binMaxs[ b ], part.GetMax() );
+                }
+            }
+        }
+
+        // sweep in from the left to get the left side of each split
+        real32      leftAreas [ SPATIAL_BIN_COUNT - 1 ];
+        uint32      leftCounts[ SPATIAL_BIN_COUNT - 1 ];
+        BoundingBox side      = GetEmptyBounds();
+        uint32      sideCount = 0;
+        for ( uint32 b = 0; b < SPATIAL_BIN_COUNT - 1; ++b )
+        {
+            side.Merge( BoundingBox( binMins[ b ], binMaxs[ b ] ) );
+            sideCount += entries[ b ];
+            leftCounts[ b ] = sideCount;
+            leftAreas [ b ] = IsEmpty( side ) ? 0.0f : side.GetSurfaceArea();
+        }
+
+        // then sweep in from the right, costing each split as we go
+        side      = GetEmptyBounds();
+        sideCount = 0;
+        for ( uint32 b = SPATIAL_BIN_COUNT - 1; b > 0; --b )
+        {
+            side.Merge( BoundingBox( binMins[ b ], binMaxs[ b ] ) );
+            sideCount += exits[ b ];
+
+            const uint32 split = b - 1;
+            if ( sideCount == 0 || leftCounts[ split ] == 0 || IsEmpty( side ) )
+            {
+                continue;
+            }
+
+            const real32 cost = leftCounts[ split ] * leftAreas[ split ] + sideCount * side.GetSurfaceArea();
+            if ( cost < bestCost )
+            {
+                bestCost  = cost;
+                bestAxis  = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    return bestAxis >= 0;
+}
+
+// split some objects at a plane, putting objects that cross it on both sides while the budget lasts and the split pays off
+__host__ static void PartitionSpatial( const std::vector<BoundsGeometryPair>& objects, uint32 axis, real32 plane, SpatialBuildState& state, std::vector<BoundsGeometryPair>& left, std::vector<BoundsGeometryPair>& right )
+{
+    // start with the objects on one side of the plane, and the parts of the crossing objects on each side
+    std::vector<uint32>             crossing;
+    std::vector<BoundsGeometryPair> leftParts;
+    std::vector<BoundsGeometryPair> rightParts;
+    BoundingBox                     leftBounds  = GetEmptyBounds();
+    BoundingBox                     rightBounds = GetEmptyBounds();
+    for ( uint32 i = 0; i < objects.size(); ++i )
+    {
+        const BoundsGeometryPair& object = objects[ i ];
+        if ( object.Bounds.GetMax()[ axis ] <= plane )
+        {
+            left.push_back( object );
+            leftBounds.Merge( object.Bounds );
+        }
+        else if ( object.Bounds.GetMin()[ axis ] >= plane )
+        {
+            right.push_back( object );
+            rightBounds.Merge( object.Bounds );
+        }
+        else
+        {
+            BoundsGeometryPair leftPart  = object;
+            BoundsGeometryPair rightPart = object;
+            leftPart .Bounds = ClipObject( object, axis, -Math::HugeValue(), plane );
+            rightPart.Bounds = ClipObject( object, axis, plane, Math::HugeValue() );
+            if ( !IsEmpty( leftPart.Bounds ) )
+            {
+                leftBounds.Merge( leftPart.Bounds );
+            }
+            if ( !IsEmpty( rightPart.Bounds ) )
+            {
+                rightBounds.Merge( rightPart.Bounds );
+            }
+            crossing  .push_back( i );
+            leftParts .push_back( leftPart );
+            rightParts.push_back( rightPart );
+        }
+    }
+
+    // a crossing object is kept whole on one side instead whenever that's cheaper (Stich et al.'s reference unsplitting)
+    uint32 leftCount  = static_cast<uint32>( left .size() + crossing.size() );
+    uint32 rightCount = static_cast<uint32>( right.size() + crossing.size() );
+    for ( uint32 i = 0; i < crossing.size(); ++i )
+    {
+        const BoundsGeometryPair& object       = objects[ crossing[ i ] ];
+        const bool                reachesLeft  = !IsEmpty( leftParts [ i ].Bounds );
+        const bool                reachesRight = !IsEmpty( rightParts[ i ].Bounds );
+        if ( !reachesLeft || !reachesRight )
+        {
+            // the geometry itself only reaches one side, even though its bounds cross the plane
+            if ( reachesLeft )
+            {
+                left.push_back( leftParts[ i ] );
+                --rightCount;
+            }
+            else
+            {
+                right.push_back( reachesRight ? rightParts[ i ] : object );
+                --leftCount;
+            }
+            continue;
+        }
+
+        BoundingBox leftWith  = leftBounds;
+        BoundingBox rightWith = rightBounds;
+        leftWith .Merge( object.Bounds );
+        rightWith.Merge( object.Bounds );
+        const real32 leftArea    = IsEmpty( leftBounds )  ? 0.0f : leftBounds .GetSurfaceArea();
+        const real32 rightArea   = IsEmpty( rightBounds ) ? 0.0f : rightBounds.GetSurfaceArea();
+        const real32 splitCost   = leftArea * leftCount + rightArea * rightCount;
+        const real32 toLeftCost  = leftWith.GetSurfaceArea() * leftCount + rightArea * ( rightCount - 1 );
+        const real32 toRightCost = leftArea * ( leftCount - 1 ) + rightWith.GetSurfaceArea() * rightCount;
+
+        bool duplicate = splitCost < Math::Min( toLeftCost, toRightCost );
+        if ( duplicate && state.Budget.fetch_sub( 1 ) <= 0 )
+        {
+            state.Budget.fetch_add( 1 );
+            duplicate = false;
+        }
+
+        if ( duplicate )
+        {
+            left .push_back( leftParts [ i ] );
+            right.push_back( rightParts[ i ] );
+        }
+        else if ( toLeftCost <= toRightCost )
+        {
+            left.push_back( object );
+            leftBounds = leftWith;
+            --rightCount;
+        }
+        else
+        {
+            right.push_back( object );
+            rightBounds = rightWith;
+            --leftCount;
+        }
+    }
+}
+
+// move a subtree that was built on its own into place at the ends of the given lists
+__host__ static void AppendSubtree( const SpatialSubtree& subtree, std::vector<BVHNode>& nodes, std::vector<BoundsGeometryPair>& objects )
+{
+    const uint32 nodeOffset   = static_cast<uint32>( nodes  .size() );
+    const uint32 objectOffset = static_cast<uint32>( objects.size() );
+    for ( BVHNode node : subtree.Nodes )
+    {
+        node.Offset += ( node.Count > 0 ) ? objectOffset : nodeOffset;
+        nodes.push_back( node );
+    }
+    objects.insert( objects.end(), subtree.Objects.begin(), subtree.Objects.end() );
+}
+
+// build a node of a spatial split hierarchy and its children, adding them to the ends of the given lists
+__host__ static void BuildSpatialNode( std::vector<BoundsGeometryPair>& objects, SpatialBuildState& state, uint32 depth, uint32 taskDepth, std::vector<BVHNode>& nodes, std::vector<BoundsGeometryPair>& leafObjects )
+{
+    const uint32 count = static_cast<uint32>( objects.size() );
+
+    // get the bounds of the objects and the bounds of their centers
+    BoundingBox bounds         = GetEmptyBounds();
+    BoundingBox centroidBounds = GetEmptyBounds();
+    for ( const BoundsGeometryPair& object : objects )
+    {
+        bounds.Merge( object.Bounds );
+        centroidBounds.Merge( object.Bounds.GetCenter() );
+    }
+
+    // the children are added right after us, so hold on to our index rather than the node itself
+    const uint32 nodeIndex = static_cast<uint32>( nodes.size() );
+    nodes.emplace_back();
+    nodes[ nodeIndex ].Bounds = bounds;
+
+    // find the best object split, and look for a spatial split wherever that split's children would overlap
+    real32     objectCost      = Math::HugeValue();
+    int32      objectAxis      = -1;
+    uint32     objectSplit     = 0;
+    real32     spatialCost     = Math::HugeValue();
+    int32      spatialAxis     = -1;
+    uint32     spatialSplit    = 0;
+    const bool canSplitObjects = count > 1 && FindObjectSplit( objects.data(), count, centroidBounds, objectCost, objectAxis, objectSplit );
+    if ( count > 1 && depth < SPATIAL_SPLIT_MAX_DEPTH && state.Budget.load() > 0 )
+    {
+        // objects whose centers all coincide can only be told apart by cutting them
+        bool overlaps = true;
+        if ( canSplitObjects )
+        {
+            const real32 cmin        = centroidBounds.GetMin()[ objectAxis ];
+            const real32 scale       = SAH_BIN_COUNT / ( centroidBounds.GetMax()[ objectAxis ] - cmin );
+            BoundingBox  leftBounds  = GetEmptyBounds();
+            BoundingBox  rightBounds = GetEmptyBounds();
+            for ( const BoundsGeometryPair& object : objects )
+            {
+                const bool toLeft = GetBinIndex( object.Bounds.GetCenter()[ objectAxis ], cmin, scale ) <= objectSplit;
+                ( toLeft ? leftBounds : rightBounds ).Merge( object.Bounds );
+            }
+
+            const BoundingBox overlap( glm::max( leftBounds.GetMin(), rightBounds.GetMin() ), glm::min( leftBounds.GetMax(), rightBounds.GetMax() ) );
+            overlaps = !IsEmpty( overlap ) && overlap.GetSurfaceArea() > SPATIAL_SPLIT_MIN_OVERLAP * state.RootArea;
+        }
+        if ( overlaps )
+        {
+            FindSpatialSplit( objects, bounds, spatialCost, spatialAxis, spatialSplit );
+        }
+    }
+
+    // stay a leaf if splitting wouldn't pay for itself, just like SplitNode
+    const real32 area      = bounds.GetSurfaceArea();
+    const real32 bestCost  = Math::Min( objectCost, spatialCost );
+    const real32 splitCost = SAH_TRAVERSAL_COST + ( area > 0.0f ? bestCost / area : 0.0f );
+    bool         leaf      = count <= 1 || depth >= REX_BVH_MAX_DEPTH || ( !canSplitObjects && spatialAxis < 0 ) || ( splitCost >= count && count <= state.MaxLeafSize );
+
+    std::vector<BoundsGeometryPair> left;
+    std::vector<BoundsGeometryPair> right;
+    if ( !leaf )
+    {
+        if ( spatialAxis >= 0 && spatialCost < objectCost )
+        {
+            PartitionSpatial( objects, spatialAxis, GetSpatialPlane( bounds, spatialAxis, spatialSplit + 1 ), state, left, right );
+        }
+
+        // fall back to the object split if the spatial split couldn't separate anything
+        if ( left.empty() || right.empty() )
+        {
+            left.clear();
+            right.clear();
+            if ( canSplitObjects )
+            {
+                const real32 cmin  = centroidBounds.GetMin()[ objectAxis ];
+                const real32 scale = SAH_BIN_COUNT / ( centroidBounds.GetMax()[ objectAxis ] - cmin );
+                for ( const BoundsGeometryPair& object : objects )
+                {
+                    const bool toLeft = GetBinIndex( object.Bounds.GetCenter()[ objectAxis ], cmin, scale ) <= objectSplit;
+                    ( toLeft ? left : right ).push_back( object );
+                }
+                if ( left.empty() || right.empty() )
+                {
+                    left .assign( objects.begin(), objects.begin() + count / 2 );
+                    right.assign( objects.begin() + count / 2, objects.end() );
+                }
+            }
+            else
+            {
+                leaf = true;
+            }
+        }
+    }
+
+    if ( leaf )
+    {
+        nodes[ nodeIndex ].Offset = static_cast<uint32>( leafObjects.size() );
+        nodes[ nodeIndex ].Count  = count;
+        leafObjects.insert( leafObjects.end(), objects.begin(), objects.end() );
+        return;
+    }
+
+    // the children have their own copies, so ours can go before they're built
+    std::vector<BoundsGeometryPair>().swap( objects );
+    nodes[ nodeIndex ].Count = 0;
+    if ( taskDepth > 0 && count >= PARALLEL_BUILD_MIN_OBJECTS )
+    {
+        // each side is built into its own lists, which are then moved into place behind us
+        SpatialSubtree leftTree;
+        SpatialSubtree rightTree;
+        std::thread    task( [ &left, &state, &leftTree, depth, taskDepth ]()
+        {
+            BuildSpatialNode( left, state, depth + 1, taskDepth - 1, leftTree.Nodes, leftTree.Objects );
+        } );
+        BuildSpatialNode( right, state, depth + 1, taskDepth - 1, rightTree.Nodes, rightTree.Objects );
+        task.join();
+
+        AppendSubtree( leftTree, nodes, leafObjects );
+        nodes[ nodeIndex ].Offset = static_cast<uint32>( nodes.size() );
+        AppendSubtree( rightTree, nodes, leafObjects );
+    }
+    else
+    {
+        BuildSpatialNode( left, state, depth + 1, 0, nodes, leafObjects );
+        nodes[ nodeIndex ].Offset = static_cast<uint32>( nodes.size() );
+        BuildSpatialNode( right, state, depth + 1, 0, nodes, leafObjects );
+    }
+}
+
+// create a new BVH node
+__both__ BVHNode::BVHNode()
+    : Bounds( vec3(), vec3() )
+    , Offset( 0 )
+    , Count ( 0 )
+{
+}
+
+// create a BVH w/ bounds
+__both__ BVH::BVH( const BoundingBox& bounds )
+    : BVH( bounds, DEFAULT_MAX_LEAF_SIZE )
+{
+}
+
+// create a BVH w/ min and max corner
+__both__ BVH::BVH( const vec3& min, const vec3& max )
+    : BVH( BoundingBox( min, max ), DEFAULT_MAX_LEAF_SIZE )
+{
+}
+
+// create a BVH w/ bounds and max leaf size
+__both__ BVH::BVH( const BoundingBox& bounds, uint32 maxLeafSize )
+    : _bounds             ( bounds )
+    , _nodeCount          ( 0 )
+    , _maxLeafSize        ( Math::Max( maxLeafSize, 1U ) )
+    , _builtCost          ( 0.0f )
+    , _builtLinear        ( false )
+    , _spatialBudget      ( 0.0f )
+    , _splitReferenceCount( 0 )
+    , _wide               ( nullptr )
+    , _hostOnly           ( false )
+{
+}
+
+// create a BVH from an already-built hierarchy
+__both__ BVH::BVH( const BoundingBox& bounds, const BVHNode* nodes, uint32 nodeCount, const BoundsGeometryPair* objects, uint32 objectCount )
+    : BVH( bounds, DEFAULT_MAX_LEAF_SIZE )
+{
+    _nodes.AddRange( nodes, nodeCount );
+    _objects.AddRange( objects, objectCount );
+    _nodeCount = nodeCount;
+    _builtCost = GetCost();
+}
+
+// destroy this BVH
+__both__ BVH::~BVH()
+{
+#if !defined( __CUDA_ARCH__ )
+    delete _wide;
+    _wide = nullptr;
+#endif
+    _nodeCount = 0;
+}
+
+// get the BVH's bounds
+__both__ const BoundingBox& BVH::GetBounds() const
+{
+    return _bounds;
+}
+
+// get the SAH cost of the hierarchy
+__both__ real32 BVH::GetCost() const
+{
+    if ( _nodeCount == 0 )
+    {
+        return 0.0f;
+    }
+
+#if REX_WIDE_BVH && !defined( __CUDA_ARCH__ )
+    if ( IsCollapsed() )
+    {
+        return _wide->GetCost( SAH_TRAVERSAL_COST );
+    }
+#endif
+
+    // each node costs what it takes to visit it, weighted by the chance that a ray through the root hits it
+    const real32 rootArea = _nodes[ 0 ].Bounds.GetSurfaceArea();
+    if ( rootArea <= 0.0f )
+    {
+        return static_cast<real32>( _objects.GetSize() );
+    }
+
+    real32 cost = 0.0f;
+    for ( uint32 i = 0; i < _nodeCount; ++i )
+    {
+        const BVHNode& node = _nodes[ i ];
+        const real32   area = node.Bounds.GetSurfaceArea() / rootArea;
+        cost += area * ( ( node.Count > 0 ) ? static_cast<real32>( node.Count ) : SAH_TRAVERSAL_COST );
+    }
+    return cost;
+}
+
+// get the SAH cost of the hierarchy when it was built
+__both__ real32 BVH::GetBuiltCost() const
+{
+    return _builtCost;
+}
+
+// get the number of bytes used by this BVH
+__host__ uint64 BVH::GetMemoryUsage() const
+{
+    uint64 bytes = static_cast<uint64>( _nodes.GetSize() ) * sizeof( BVHNode )
+                 + static_cast<uint64>( _objects.GetSize() ) * sizeof( BoundsGeometryPair );
+#if REX_WIDE_BVH
+    if ( _wide )
+    {
+        bytes += _wide->GetMemoryUsage();
+    }
+#endif
+    return bytes;
+}
+
+// add the given piece of geometry to this BVH
+__both__ bool BVH::Add( const Geometry* geometry )
+{
+    // ensure we were given a valid piece of geometry
+    if ( !geometry )
+    {
+        return false;
+    }
+
+    // each primitive gets its own entry so that big pieces of geometry are split up like everything else
+    bool         allAdded       = true;
+    const uint32 primitiveCount = geometry->GetPrimitiveCount();
+    for ( uint32 i = 0; i < primitiveCount; ++i )
+    {
+        allAdded = Add( geometry, i, geometry->GetPrimitiveBounds( i ) ) && allAdded;
+    }
+
+    return allAdded;
+}
+
+// add the given piece of geometry to this BVH
+__both__ bool BVH::Add( const Geometry* geometry, const BoundingBox& bounds )
+{
+    return Add( geometry, 0, bounds );
+}
+
+// add one of the given piece of geometry's primitives to this BVH
+__both__ bool BVH::Add( const Geometry* geometry, uint32 primitive, const BoundingBox& bounds )
+{
+    // ensure we were given a valid piece of geometry
+    if ( !geometry )
+    {
+        return false;
+    }
+#if !defined( __CUDA_ARCH__ )
+    RestoreObjects();
+#endif
+
+    BoundsGeometryPair pair;
+    pair.Bounds    = bounds;
+    pair.Geometry  = geometry;
+    pair.Index     = _objects.GetSize();
+    pair.Primitive = primitive;
+    _objects.Add( pair );
+
+    // the old hierarchy no longer covers everything
+    _nodeCount = 0;
+
+    return true;
+}
+
+// add a range of objects to this BVH
+__both__ bool BVH::AddRange( const BoundsGeometryPair* objects, uint32 count )
+{
+    if ( !objects )
+    {
+        return false;
+    }
+#if !defined( __CUDA_ARCH__ )
+    RestoreObjects();
+#endif
+
+    // make room for everything up front
+    bool allAdded = true;
+    _objects.Reserve( _objects.GetSize() + count );
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        if ( !objects[ i ].Geometry )
+        {
+            allAdded = false;
+            continue;
+        }
+
+        BoundsGeometryPair pair = objects[ i ];
+        pair.Index              = _objects.GetSize();
+        _objects.Add( pair );
+    }
+
+    // the old hierarchy no longer covers everything
+    _nodeCount = 0;
+
+    return allAdded;
+}
+
+// build the hierarchy
+__both__ bool BVH::Build()
+{
+#if !defined( __CUDA_ARCH__ )
+    RestoreObjects();
+    RemoveSplitReferences();
+#endif
+    const uint32 objectCount = _objects.GetSize();
+    if ( objectCount == 0 )
+    {
+        _nodeCount = 0;
+        return true;
+    }
+
+    // a binary tree with N leaves has at most 2N - 1 nodes, so allocate that up front and trim it afterwards
+    _nodes.Resize( objectCount * 2 - 1 );
+    BuildNode( 0, 0, objectCount, 0 );
+    FinishBuild();
+    _builtLinear   = false;
+    _spatialBudget = 0.0f;
+
+    return true;
+}
+
+// build the hierarchy w/ the top of the tree split across threads
+__host__ bool BVH::BuildParallel( uint32 workerCount )
+{
+    RestoreObjects();
+    RemoveSplitReferences();
+    const uint32 objectCount = _objects.GetSize();
+    if ( objectCount == 0 )
+    {
+        _nodeCount = 0;
+        return true;
+    }
+
+    // every subtree writes to its own range of nodes and objects, so the tasks never touch each other
+    _nodes.Resize( objectCount * 2 - 1 );
+    BuildNodeParallel( 0, 0, objectCount, 0, GetTaskDepth( workerCount ) );
+    FinishBuild();
+    _builtLinear   = false;
+    _spatialBudget = 0.0f;
+
+    return true;
+}
+
+// build a linear hierarchy from the objects' Morton codes
+__host__ bool BVH::BuildLinear( uint32 workerCount )
+{
+    RestoreObjects();
+    RemoveSplitReferences();
+    const uint32 objectCount = _objects.GetSize();
+    if ( objectCount == 0 )
+    {
+        _nodeCount = 0;
+        return true;
+    }
+    workerCount = Math::Max( workerCount, 1U );
+
+    // the codes cover the bounds of the objects' centers
+    std::vector<BoundingBox> workerBounds( workerCount, GetEmptyBounds() );
+    RunParallel( objectCount, workerCount, [ this, &workerBounds ]( uint32 worker, uint32 start, uint32 end )
+    {
+        for ( uint32 i = start; i < end; ++i )
+        {
+            workerBounds[ worker ].Merge( _objects[ i ].Bounds.GetCenter() );
+        }
+    } );
+    BoundingBox centroidBounds = GetEmptyBounds();
+    for ( const auto& bounds : workerBounds )
+    {
+        centroidBounds.Merge( bounds );
+    }
+
+    // big scenes need the wider codes to keep objects apart, but the narrower ones take half as many sorting passes
+    const uint32        axisBits = ( objectCount >= MORTON_WIDE_MIN_OBJECTS ) ? 21 : 10;
+    const vec3          origin   = centroidBounds.GetMin();
+    const vec3          extent   = centroidBounds.GetMax() - origin;
+    const vec3          scale    = vec3( extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                                         extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                                         extent.z > 0.0f ? 1.0f / extent.z : 0.0f );
+    std::vector<uint64> codes  ( objectCount );
+    std::vector<uint32> indices( objectCount );
+    RunParallel( objectCount, workerCount, [ & ]( uint32, uint32 start, uint32 end )
+    {
+        for ( uint32 i = start; i < end; ++i )
+        {
+            codes  [ i ] = GetMortonCode( ( _objects[ i ].Bounds.GetCenter() - origin ) * scale, axisBits );
+            indices[ i ] = i;
+        }
+    } );
+    SortMortonCodes( codes, indices, axisBits * 3, workerCount );
+
+    // put the objects in the same order as their codes
+    std::vector<BoundsGeometryPair> sorted( objectCount );
+    RunParallel( objectCount, workerCount, [ this, &sorted, &indices ]( uint32, uint32 start, uint32 end )
+    {
+        for ( uint32 i = start; i < end; ++i )
+        {
+            sorted[ i ] = _objects[ indices[ i ] ];
+        }
+    } );
+    _objects.Clear();
+    _objects.AddRange( sorted.data(), objectCount );
+
+    _nodes.Resize( objectCount * 2 - 1 );
+    BuildLinearNode( 0, 0, objectCount, codes.data(), 0, GetTaskDepth( workerCount ) );
+    FinishBuild();
+    _builtLinear   = true;
+    _spatialBudget = 0.0f;
+
+    return true;
+}
+
+// build the hierarchy w/ spatial splits
+__host__ bool BVH::BuildSpatial( uint32 workerCount, real32 budget )
+{
+    RestoreObjects();
+    RemoveSplitReferences();
+    const uint32 objectCount = _objects.GetSize();
+    if ( objectCount == 0 )
+    {
+        _nodeCount = 0;
+        return true;
+    }
+    budget = Math::Max( budget, 0.0f );
+
+    BoundingBox bounds = GetEmptyBounds();
+    for ( uint32 i = 0; i < objectCount; ++i )
+    {
+        bounds.Merge( _objects[ i ].Bounds );
+    }
+
+    SpatialBuildState state;
+    state.RootArea    = bounds.GetSurfaceArea();
+    state.MaxLeafSize = _maxLeafSize;
+    state.Budget      = static_cast<int64>( objectCount * static_cast<real64>( budget ) );
+
+    // the tree can't be laid out ahead of time when objects may be split, so it's built into lists as it goes
+    std::vector<BoundsGeometryPair> objects( &_objects[ 0 ], &_objects[ 0 ] + objectCount );
+    std::vector<BVHNode>            nodes;
+    std::vector<BoundsGeometryPair> leafObjects;
+    nodes      .reserve( objectCount * 2 );
+    leafObjects.reserve( objectCount );
+    BuildSpatialNode( objects, state, 0, GetTaskDepth( workerCount ), nodes, leafObjects );
+
+    _objects.Clear();
+    _objects.AddRange( leafObjects.data(), static_cast<uint32>( leafObjects.size() ) );
+    _nodes.Clear();
+    _nodes.AddRange( nodes.data(), static_cast<uint32>( nodes.size() ) );
+    _splitReferenceCount = static_cast<uint32>( leafObjects.size() ) - objectCount;
+    FinishBuild();
+    _builtLinear   = false;
+    _spatialBudget = budget;
+
+    return true;
+}
+
+// get the objects back from the wide copy if they were dropped
+__host__ void BVH::RestoreObjects()
+{
+#if REX_WIDE_BVH
+    if ( !IsCollapsed() )
+    {
+        return;
+    }
+
+    // the wide copy refers to each split object once per reference, so it's asked for just one of each
+    std::vector<BoundsGeometryPair> objects;
+    _wide->GetObjects( objects, _splitReferenceCount > 0 );
+    _objects.Clear();
+    _objects.AddRange( objects.data(), static_cast<uint32>( objects.size() ) );
+    _splitReferenceCount = 0;
+    _nodeCount           = 0;
+#endif
+}
+
+// remove the extra references added by a spatial split build
+__host__ void BVH::RemoveSplitReferences()
+{
+    if ( _splitReferenceCount == 0 )
+    {
+        return;
+    }
+
+    // every reference to an object shares its index, so keep one of each and put them back in the order they were added
+    std::vector<BoundsGeometryPair> objects;
+    std::vector<bool>               kept;
+    objects.reserve( _objects.GetSize() - _splitReferenceCount );
+    for ( uint32 i = 0; i < _objects.GetSize(); ++i )
+    {
+        BoundsGeometryPair pair = _objects[ i ];
+        if ( pair.Index >= kept.size() )
+        {
+            kept.resize( pair.Index + 1, false );
+        }
+        if ( !kept[ pair.Index ] )
+        {
+            kept[ pair.Index ] = true;
+            pair.Bounds        = pair.Geometry->GetPrimitiveBounds( pair.Primitive );
+            objects.push_back( pair );
+        }
+    }
+    std::sort( objects.begin(), objects.end(), []( const BoundsGeometryPair& a, const BoundsGeometryPair& b )
+    {
+        return a.Index < b.Index;
+    } );
+
+    _objects.Clear();
+    _objects.AddRange( objects.data(), static_cast<uint32>( objects.size() ) );
+    _splitReferenceCount = 0;
+    _nodeCount           = 0;
+}
+
+// refit the hierarchy
+__both__ bool BVH::Refit()
+{
+    if ( _nodeCount == 0 )
+    {
+        return true;
+    }
+
+    // without the binary nodes or objects, the wide copy reads its primitives' bounds again itself
+    if ( !IsCollapsed() )
+    {
+        RefitNodes( 0, _nodeCount );
+        _bounds = _nodes[ 0 ].Bounds;
+    }
+    RefitWide( 1 );
+    return true;
+}
+
+// refit the hierarchy w/ the top of the tree split across threads
+__host__ bool BVH::RefitParallel( uint32 workerCount )
+{
+    if ( _nodeCount == 0 )
+    {
+        return true;
+    }
+
+    // like building, every subtree only touches its own nodes and objects
+    if ( !IsCollapsed() )
+    {
+        RefitNodesParallel( 0, _nodeCount, GetTaskDepth( workerCount ) );
+        _bounds = _nodes[ 0 ].Bounds;
+    }
+    RefitWide( workerCount );
+    return true;
+}
+
+// refit the hierarchy, rebuilding it if it has degraded too far
+__host__ bool BVH::Update( uint32 workerCount, bool& rebuilt )
+{
+    rebuilt = false;
+    if ( !RefitParallel( workerCount ) )
+    {
+        return false;
+    }
+
+    // the objects already have their new bounds, so a rebuild can start straight away
+    if ( GetCost() <= _builtCost * REFIT_MAX_COST_RATIO )
+    {
+        return true;
+    }
+
+    rebuilt = true;
+    if ( _builtLinear )
+    {
+        return BuildLinear( workerCount );
+    }
+    return ( _spatialBudget > 0.0f ) ? BuildSpatial( workerCount, _spatialBudget ) : BuildParallel( workerCount );
+}
+
+// create a BVH on the device from an uploaded hierarchy
+__global__ static void BVHUploadKernel( BVH** bvh, vec3 min, vec3 max, const BVHNode* nodes, uint32 nodeCount, const BoundsGeometryPair* objects, uint32 objectCount )
+{
+    *bvh = new BVH( BoundingBox( min, max ), nodes, nodeCount, objects, objectCount );
+}
+
+// collapse the tree for host queries, now and after every later build
+__host__ void BVH::MakeHostOnly()
+{
+    _hostOnly = true;
+
+    // a tree that's already built is collapsed straight away
+    if ( _nodeCount > 0 && !IsCollapsed() )
+    {
+        UpdateWide();
+        _builtCost = GetCost();
+    }
+}
+
+// copy this BVH to the device
+__host__ BVH* BVH::UploadToDevice() const
+{
+    BVHNode*            nodes   = nullptr;
+    BoundsGeometryPair* objects = nullptr;
+    BVH**               bvh     = nullptr;
+    BVH*                result  = nullptr;
+
+    // the device walks the binary nodes, which host-only BVHs don't keep
+    if ( IsCollapsed() )
+    {
+        REX_DEBUG_LOG( "Failed to copy BVH to device. It only keeps the nodes used on the host." );
+        return nullptr;
+    }
+
+    if ( !_nodes.CopyToDevice( nodes ) || !_objects.CopyToDevice( objects ) ||
+         cudaSuccess != cudaMalloc( (void**)( &bvh ), sizeof( BVH* ) ) )
+    {
+        REX_DEBUG_LOG( "Failed to copy BVH to device." );
+    }
+    else
+    {
+        BVHUploadKernel<<<1, 1>>>( bvh, _bounds.GetMin(), _bounds.GetMax(), nodes, _nodeCount, objects, _objects.GetSize() );
+
+        cudaError_t err = cudaGetLastError();
+        if ( err == cudaSuccess )
+        {
+            err = cudaDeviceSynchronize();
+        }
+        if ( err == cudaSuccess )
+        {
+            err = cudaMemcpy( &result, bvh, sizeof( BVH* ), cudaMemcpyDeviceToHost );
+        }
+        if ( err != cudaSuccess )
+        {
+            REX_DEBUG_LOG( "Failed to create BVH on device. Reason: ", cudaGetErrorString( err ) );
+            result = nullptr;
+        }
+        else if ( !result )
+        {
+            REX_DEBUG_LOG( "Failed to create BVH on device. The device heap is too small for its ", _nodeCount, " nodes and ", _objects.GetSize(), " objects." );
+        }
+    }
+
+    // the device BVH has its own copies now (on the device heap, which the scene makes room for before building)
+    cudaFree( nodes );
+    cudaFree( objects );
+    cudaFree( bvh );
+
+    return result;
+}
+
+// build a node in the hierarchy
+__both__ void BVH::BuildNode( uint32 nodeIndex, uint32 start, uint32 end, uint32 depth )
+{
+    uint32 mid = 0;
+    if ( SplitNode( nodeIndex, start, end, depth, mid ) )
+    {
+        BuildNode( nodeIndex + 1, start, mid, depth + 1 );
+        BuildNode( _nodes[ nodeIndex ].Offset, mid, end, depth + 1 );
+    }
+}
+
+// build a node in the hierarchy, building its children on separate threads while there's depth left
+__host__ void BVH::BuildNodeParallel( uint32 nodeIndex, uint32 start, uint32 end, uint32 depth, uint32 taskDepth )
+{
+    if ( taskDepth == 0 || end - start < PARALLEL_BUILD_MIN_OBJECTS )
+    {
+        BuildNode( nodeIndex, start, end, depth );
+        return;
+    }
+
+    uint32 mid = 0;
+    if ( SplitNode( nodeIndex, start, end, depth, mid ) )
+    {
+        const uint32 second = _nodes[ nodeIndex ].Offset;
+        std::thread  task( [ this, nodeIndex, start, mid, depth, taskDepth ]()
+        {
+            BuildNodeParallel( nodeIndex + 1, start, mid, depth + 1, taskDepth - 1 );
+        } );
+        BuildNodeParallel( second, mid, end, depth + 1, taskDepth - 1 );
+        task.join();
+    }
+}
+
+// build a node in a linear hierarchy
+__host__ void BVH::BuildLinearNode( uint32 nodeIndex, uint32 start, uint32 end, const uint64* codes, uint32 depth, uint32 taskDepth )
+{
+    BVHNode&     node  = _nodes[ nodeIndex ];
+    const uint32 count = end - start;
+    if ( count <= _maxLeafSize || depth >= REX_BVH_MAX_DEPTH )
+    {
+        node.Bounds = GetEmptyBounds();
+        node.Offset = start;
+        node.Count  = count;
+        for ( uint32 i = start; i < end; ++i )
+        {
+            node.Bounds.Merge( _objects[ i ].Bounds );
+        }
+        return;
+    }
+
+    // the codes all share the bits above the highest one that differs, so the objects split where that bit turns on
+    uint32 mid = start + count / 2;
+    if ( codes[ start ] != codes[ end - 1 ] )
+    {
+        const uint64 bit  = 1ULL << GetHighestBit( codes[ start ] ^ codes[ end - 1 ] );
+        uint32       low  = start + 1;
+        uint32       high = end - 1;
+        while ( low < high )
+        {
+            const uint32 probe = low + ( high - low ) / 2;
+            if ( codes[ probe ] & bit )
+            {
+                high = probe;
+            }
+            else
+            {
+                low = probe + 1;
+            }
+        }
+        mid = low;
+    }
+
+    // just like the surface area heuristic's nodes, the first child's subtree gets room for every node it could need
+    const uint32 second = nodeIndex + ( mid - start ) * 2;
+    node.Offset = second;
+    node.Count  = 0;
+    if ( taskDepth == 0 || count < PARALLEL_BUILD_MIN_OBJECTS )
+    {
+        BuildLinearNode( nodeIndex + 1, start, mid, codes, depth + 1, 0 );
+        BuildLinearNode( second,        mid,   end, codes, depth + 1, 0 );
+    }
+    else
+    {
+        std::thread task( [ this, nodeIndex, start, mid, codes, depth, taskDepth ]()
+        {
+            BuildLinearNode( nodeIndex + 1, start, mid, codes, depth + 1, taskDepth - 1 );
+        } );
+        BuildLinearNode( second, mid, end, codes, depth + 1, taskDepth - 1 );
+        task.join();
+    }
+
+    BoundingBox bounds = _nodes[ nodeIndex + 1 ].Bounds;
+    bounds.Merge( _nodes[ second ].Bounds );
+    node.Bounds = bounds;
+}
+
+// refit a subtree's nodes
+__both__ void BVH::RefitNodes( uint32 start, uint32 end )
+{
+    // children always come after their parent, so going backwards refits them first
+    for ( uint32 i = end; i > start; --i )
+    {
+        BVHNode& node = _nodes[ i - 1 ];
+        if ( node.Count > 0 )
+        {
+            BoundingBox bounds = GetEmptyBounds();
+            for ( uint32 j = node.Offset; j < node.Offset + node.Count; ++j )
+            {
+                BoundsGeometryPair& pair = _objects[ j ];
+                pair.Bounds = pair.Geometry->GetPrimitiveBounds( pair.Primitive );
+                bounds.Merge( pair.Bounds );
+            }
+            node.Bounds = bounds;
+        }
+        else
+        {
+            BoundingBox bounds = _nodes[ i ].Bounds;
+            bounds.Merge( _nodes[ node.Offset ].Bounds );
+            node.Bounds = bounds;
+        }
+    }
+}
+
+// refit a subtree's nodes, refitting its children on separate threads while there's depth left
+__host__ void BVH::RefitNodesParallel( uint32 start, uint32 end, uint32 taskDepth )
+{
+    const BVHNode& node = _nodes[ start ];
+    if ( taskDepth == 0 || node.Count > 0 || end - start < PARALLEL_REFIT_MIN_NODES )
+    {
+        RefitNodes( start, end );
+        return;
+    }
+
+    // the first child's subtree runs up to the second child, and the second child's runs to the end of ours
+    const uint32 second = node.Offset;
+    std::thread  task( [ this, start, second, taskDepth ]()
+    {
+        RefitNodesParallel( start + 1, second, taskDepth - 1 );
+    } );
+    RefitNodesParallel( second, end, taskDepth - 1 );
+    task.join();
+
+    BoundingBox bounds = _nodes[ start + 1 ].Bounds;
+    bounds.Merge( _nodes[ second ].Bounds );
+    _nodes[ start ].Bounds = bounds;
+}
+
+// pack the built nodes together and trim the node list
+__both__ void BVH::FinishBuild()
+{
+    _nodeCount = CompactNode( 0, 0 );
+    _nodes.Resize( _nodeCount );
+    _nodes.ShrinkToFit();
+
+    // the cost is measured on whichever nodes are kept, since refits are compared against it
+    _bounds = _nodes[ 0 ].Bounds;
+    UpdateWide();
+    _builtCost = GetCost();
+}
+
+// collapse the tree for host queries
+__both__ void BVH::UpdateWide()
+{
+#if REX_WIDE_BVH && !defined( __CUDA_ARCH__ )
+    // trees headed for the device are never walked here, and their objects may point to geometry that only exists
+    // on the device, so only host-only trees are collapsed
+    if ( !_hostOnly )
+    {
+        return;
+    }
+
+    if ( !_wide )
+    {
+        _wide = new WideBVH();
+    }
+
+    // host queries can still walk the binary nodes, so a wide copy that can't be built is just dropped
+    if ( !_wide->Build( *this ) )
+    {
+        delete _wide;
+        _wide = nullptr;
+    }
+    else
+    {
+        // the wide copy keeps its own references to the primitives, so the objects are only restored when needed
+        _nodes.Clear();
+        _nodes.ShrinkToFit();
+        _objects.Clear();
+        _objects.ShrinkToFit();
+    }
+#endif
+}
+
+// refit the wide copy of the tree
+__both__ void BVH::RefitWide( uint32 workerCount )
+{
+#if REX_WIDE_BVH && !defined( __CUDA_ARCH__ )
+    if ( _wide )
+    {
+        // the box around the wide copy's primitives is the same as the binary root's would be
+        _bounds = _wide->Refit( workerCount );
+    }
+#endif
+}
+
+// check if only the wide copy of the tree is kept
+__both__ bool BVH::IsCollapsed() const
+{
+    return ( _nodeCount > 0 ) && ( _nodes.GetSize() == 0 );
+}
+
+// move a subtree down to the given index
+__both__ uint32 BVH::CompactNode( uint32 from, uint32 to )
+{
+    // subtrees are visited in the same order they're laid out, so we only ever overwrite nodes we've already moved
+    const BVHNode node = _nodes[ from ];
+    _nodes[ to ] = node;
+    if ( node.Count > 0 )
+    {
+        return to + 1;
+    }
+
+    const uint32 second = CompactNode( from + 1, to + 1 );
+    _nodes[ to ].Offset = second;
+    return CompactNode( node.Offset, second );
+}
+
+// find the split for a node in the hierarchy
+__both__ bool BVH::SplitNode( uint32 nodeIndex, uint32 start, uint32 end, uint32 depth, uint32& mid )
+{
+    const uint32 count = end - start;
+
+    // get the bounds of the objects and the bounds of their centers
+    BoundingBox bounds         = GetEmptyBounds();
+    BoundingBox centroidBounds = GetEmptyBounds();
+    for ( uint32 i = start; i < end; ++i )
+    {
+        bounds.Merge( _objects[ i ].Bounds );
+        centroidBounds.Merge( _objects[ i ].Bounds.GetCenter() );
+    }
+
+    // start off as a leaf
+    BVHNode& node = _nodes[ nodeIndex ];
+    node.Bounds   = bounds;
+    node.Offset   = start;
+    node.Count    = count;
+    if ( count <= 1 || depth >= REX_BVH_MAX_DEPTH )
+    {
+        return false;
+    }
+
+
+    // find the cheapest split by binning the object centers along each axis
+    real32 bestCost  = Math::HugeValue();
+    int32  bestAxis  = -1;
+    uint32 bestSplit = 0;
+    FindObjectSplit( &_objects[ start ], count, centroidBounds, bestCost, bestAxis, bestSplit );
+
+    // if every center is in the same place then there's nothing to split
+    if ( bestAxis < 0 )
+    {
+        return false;
+    }
+
+    // stay a leaf if splitting wouldn't pay for itself
+    const real32 area      = bounds.GetSurfaceArea();
+    const real32 splitCost = SAH_TRAVERSAL_COST + ( area > 0.0f ? bestCost / area : 0.0f );
+    if ( splitCost >= count && count <= _maxLeafSize )
+    {
+        return false;
+    }
+
+
+    // partition the objects around the split
+    const real32 cmin  = centroidBounds.GetMin()[ bestAxis ];
+    const real32 scale = SAH_BIN_COUNT / ( centroidBounds.GetMax()[ bestAxis ] - cmin );
+    uint32       last  = end;
+    mid = start;
+    while ( mid < last )
+    {
+        if ( GetBinIndex( _objects[ mid ].Bounds.GetCenter()[ bestAxis ], cmin, scale ) <= bestSplit )
+        {
+            ++mid;
+        }
+        else
+        {
+            --last;
+            BoundsGeometryPair temp = _objects[ mid ];
+            _objects[ mid  ]        = _objects[ last ];
+            _objects[ last ]        = temp;
+        }
+    }
+    if ( mid == start || mid == end )
+    {
+        mid = start + count / 2;
+    }
+
+
+    // the first child directly follows us, and a subtree over N objects never needs more than 2N - 1 nodes,
+    // so the second child's spot is known up front (the gaps left by bigger leaves are compacted out later)
+    _nodes[ nodeIndex ].Offset = nodeIndex + ( mid - start ) * 2;
+    _nodes[ nodeIndex ].Count  = 0;
+    return true;
+}
+
+// query the intersections of the given ray and fill in the shade point of the closest hit
+__both__ const Geometry* BVH::QueryIntersections( const Ray& ray, real32& dist, ShadePoint& sp ) const
+{
+    // the shade point is only worth filling in once the closest hit is known
+    HitRecord       hit;
+    const Geometry* geom = QueryIntersections( ray, dist, hit );
+    if ( geom )
+    {
+        geom->GetShadePoint( ray, hit, sp );
+    }
+    return geom;
+}
+
+// query the intersections of the given ray and return the closest hit object
+__both__ const Geometry* BVH::QueryIntersections( const Ray& ray, real32& dist, HitRecord& hit ) const
+{
+#if REX_WIDE_BVH && !defined( __CUDA_ARCH__ )
+    // the host has SIMD to test several children at once
+    if ( _wide && _nodeCount > 0 )
+    {
+        return _wide->QueryIntersections( ray, dist, hit );
+    }
+#endif
+
+    // reset the distance
+    dist = Math::HugeValue();
+
+
+    // make sure the ray even intersects us
+    real32 tempDist = 0.0;
+    if ( ( _nodeCount > 0 ) && _nodes[ 0 ].Bounds.Intersects( ray, tempDist ) )
+    {
+        return QueryIntersectionsFrom( 0, ray, dist, hit );
+    }
+
+
+    // if we don't, then return nothing
+    return nullptr;
+}
+
+// query the intersections of the given ray, starting at a given node
+__both__ const Geometry* BVH::QueryIntersectionsFrom( uint32 nodeIndex, const Ray& ray, real32& dist, HitRecord& hit ) const
+{
+    const Geometry* closest   = nullptr;
+    real32          tempDist  = 0.0;
+    HitRecord       tempHit;
+    uint32          stack    [ TRAVERSAL_STACK_SIZE ];
+    real32          stackDist[ TRAVERSAL_STACK_SIZE ];
+    uint32          stackSize = 0;
+    uint32          index     = nodeIndex;
+
+    while ( true )
+    {
+        const BVHNode& node = _nodes[ index ];
+        if ( node.Count > 0 )
+        {
+            // check the leaf's objects
+            for ( uint32 i = node.Offset; i < node.Offset + node.Count; ++i )
+            {
+                const BoundsGeometryPair& pair = _objects[ i ];
+                if ( pair.Bounds.Intersects( ray, tempDist ) && ( tempDist < dist ) )
+                {
+                    if ( pair.Geometry->HitPrimitive( pair.Primitive, ray, tempDist, tempHit ) && ( tempDist < dist ) )
+                    {
+                        closest = pair.Geometry;
+                        dist    = tempDist;
+                        hit     = tempHit;
+                    }
+                }
+            }
+        }
+        else
+        {
+            // visit the nearer child first, skipping any child that starts past our closest hit
+            uint32 first      = index + 1;
+            uint32 second     = node.Offset;
+            real32 firstDist  = 0.0;
+            real32 secondDist = 0.0;
+            bool   hitFirst   = _nodes[ first  ].Bounds.Intersects( ray, firstDist  ) && ( firstDist  < dist );
+            bool   hitSecond  = _nodes[ second ].Bounds.Intersects( ray, secondDist ) && ( secondDist < dist );
+
+            if ( hitFirst && hitSecond )
+            {
+                if ( secondDist < firstDist )
+                {
+                    uint32 tempIndex = first;
+                    first            = second;
+                    second           = tempIndex;
+                    secondDist       = firstDist;
+                }
+
+                stack    [ stackSize ] = second;
+                stackDist[ stackSize ] = secondDist;
+                ++stackSize;
+                index = first;
+                continue;
+            }
+            else if ( hitFirst || hitSecond )
+            {
+                index = hitFirst ? first : second;
+                continue;
+            }
+        }
+
+        // go back to the next subtree that could still have something closer
+        bool resumed = false;
+        while ( stackSize > 0 && !resumed )
+        {
+            --stackSize;
+            if ( stackDist[ stackSize ] < dist )
+            {
+                index   = stack[ stackSize ];
+                resumed = true;
+            }
+        }
+        if ( !resumed )
+        {
+            break;
+        }
+    }
+
+    return closest;
+}
+
+// checks to see if anything blocks the given ray
+__both__ bool BVH::QueryOcclusion( const Ray& ray, real32 tmax ) const
+{
+    if ( _nodeCount == 0 )
+    {
+        return false;
+    }
+
+#if REX_WIDE_BVH && !defined( __CUDA_ARCH__ )
+    if ( _wide )
+    {
+        return _wide->QueryOcclusion( ray, tmax );
+    }
+#endif
+
+    const vec3 invDirection = 1.0f / ray.Direction;
+    real32     d            = 0.0;
+    uint32     stack[ TRAVERSAL_STACK_SIZE ];
+    uint32     stackSize    = 0;
+
+    stack[ stackSize++ ] = 0;
+    while ( stackSize > 0 )
+    {
+        // skip any node the ray misses or only reaches after it runs out
+        const uint32   index = stack[ --stackSize ];
+        const BVHNode& node  = _nodes[ index ];
+        if ( !node.Bounds.Intersects( ray, invDirection, d ) || ( d >= tmax ) )
+        {
+            continue;
+        }
+
+        if ( node.Count > 0 )
+        {
+            // any blocker at all will do, so stop at the first one
+            for ( uint32 i = node.Offset; i < node.Offset + node.Count; ++i )
+            {
+                const BoundsGeometryPair& pair = _objects[ i ];
+                if ( pair.Geometry->ShadowHitPrimitive( pair.Primitive, ray, d ) && ( d < tmax ) )
+                {
+                    return true;
+                }
+            }
+        }
+        else
+        {
+            stack[ stackSize++ ] = node.Offset;
+            stack[ stackSize++ ] = index + 1;
+        }
+    }
+
+    return false;
+}
+
+REX_NS_END
\ No newline at end of file
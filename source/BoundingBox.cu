@@ -73,22 +73,46 @@ vec3 BoundingBox::GetSize() const
     return _max - _min;
 }
 
+// get surface area
+real32 BoundingBox::GetSurfaceArea() const
+{
+    vec3 size = GetSize();
+    return 2.0f * ( size.x * size.y + size.y * size.z + size.z * size.x );
+}
+
+// grow to contain a bounding box
+void BoundingBox::Merge( const BoundingBox& bbox )
+{
+    _min = glm::min( _min, bbox._min );
+    _max = glm::max( _max, bbox._max );
+}
+
+// grow to contain a point
+void BoundingBox::Merge( const vec3& point )
+{
+    _min = glm::min( _min, point );
+    _max = glm::max( _max, point );
+}
+
 // check for ray-box intersection
 bool BoundingBox::Intersects( const Ray& ray, real32& dist ) const
+{
+    return Intersects( ray, 1.0f / ray.Direction, dist );
+}
+
+// check for ray-box intersection w/ the inverse ray direction
+bool BoundingBox::Intersects( const Ray& ray, const vec3& invDirection, real32& dist ) const
 {
     // adapted from http://gamedev.stackexchange.com/a/18459/46507
     // NOTE : We're assuming the ray direction is a unit vector here
 
-    // get inverse of direction
-    vec3 dirfrac = 1.0f / ray.Direction;
-
     // get helpers
-    real32 t1 = ( _min.x - ray.Origin.x ) * dirfrac.x;
-    real32 t2 = ( _max.x - ray.Origin.x ) * dirfrac.x;
-    real32 t3 = ( _min.y - ray.Origin.y ) * dirfrac.y;
-    real32 t4 = ( _max.y - ray.Origin.y ) * dirfrac.y;
-    real32 t5 = ( _min.z - ray.Origin.z ) * dirfrac.z;
-    real32 t6 = ( _max.z - ray.Origin.z ) * dirfrac.z;
+    real32 t1 = ( _min.x - ray.Origin.x ) * invDirection.x;
+    real32 t2 = ( _max.x - ray.Origin.x ) * invDirection.x;
+    real32 t3 = ( _min.y - ray.Origin.y ) * invDirection.y;
+    real32 t4 = ( _max.y - ray.Origin.y ) * invDirection.y;
+    real32 t5 = ( _min.z - ray.Origin.z ) * invDirection.z;
+    real32 t6 = ( _max.z - ray.Origin.z ) * invDirection.z;
 
 
     real32 tmin = Math::Max( Math::Max( Math::Min( t1, t2 ), Math::Min( t3, t4 ) ), Math::Min( t5, t6 ) );
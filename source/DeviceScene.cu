@@ -12,8 +12,15 @@ void LaunchRenderKernel( const dim3& blocks, const dim3& grid, DeviceSceneData*
 __global__ void SceneRenderKernel( DeviceSceneData* sd )
 {
     // get the image coordinates
-    const int32      x  = ( blockIdx.x * blockDim.x ) + threadIdx.x;
-    const int32      y  = ( blockIdx.y * blockDim.y ) + threadIdx.y;
+    const int32 x = ( blockIdx.x * blockDim.x ) + threadIdx.x;
+    const int32 y = ( blockIdx.y * blockDim.y ) + threadIdx.y;
+
+    RenderScenePixel( sd, x, y );
+}
+
+// renders a single pixel of the scene
+__both__ void RenderScenePixel( const DeviceSceneData* sd, int32 x, int32 y )
+{
     const ViewPlane& vp = sd->ViewPlane;
 
     if ( x >= vp.Width || y >= vp.Height )
@@ -23,24 +30,23 @@ __global__ void SceneRenderKernel( DeviceSceneData* sd )
 
 
     // prepare for the tracing!!
-    const Octree* octree     = sd->Octree;
-    const real32  invSamples = 1.0f / vp.SampleCount;
-    const int32   n          = static_cast<int32>( sqrtf( vp.SampleCount ) );
-    const real32  invn       = 1.0f / n;
-    Color         color      = Color::Black();
-    real32        t          = 0.0f;
-    int32         sy         = 0;
-    int32         sx         = 0;
-    Ray           ray        = Ray( sd->Camera.GetPosition(), vec3( 0, 0, 1 ) );
-    vec2          samplePoint;
-    ShadePoint    shadePoint;
+    const AccelStructure* accel      = sd->AccelStructure;
+    const real32          invSamples = 1.0f / vp.SampleCount;
+    const int32           n          = static_cast<int32>( sqrtf( vp.SampleCount ) );
+    const real32          invn       = 1.0f / n;
+    Color                 color      = Color::Black();
+    real32                t          = 0.0f;
+    int32                 sy         = 0;
+    int32                 sx         = 0;
+    Ray                   ray        = Ray( sd->Camera.GetPosition(), vec3( 0, 0, 1 ) );
+    vec2                  samplePoint;
+    ShadePoint            shadePoint;
 
 
     // configure the shade point
-    shadePoint.Octree       = sd->Octree;
-    shadePoint.AmbientLight = sd->AmbientLight;
-    shadePoint.LightCount   = sd->Lights->GetSize();
-    shadePoint.Lights       = &( sd->Lights->Get( 0 ) );
+    shadePoint.AccelStructure = sd->AccelStructure;
+    shadePoint.AmbientLight   = sd->AmbientLight;
+    shadePoint.Lights         = sd->Lights;
 
 
     // sample the scene!
@@ -58,15 +64,14 @@ __global__ void SceneRenderKernel( DeviceSceneData* sd )
 
 
             // hit the objects in the scene
-            const Geometry* geom = octree->QueryIntersections( ray, t, shadePoint );
+            const Geometry* geom = accel->QueryIntersections( ray, t, shadePoint );
             if ( geom )
             {
                 shadePoint.Ray = ray;
                 shadePoint.T = t;
 
                 // add to the color if the ray hit
-                const Material* mat = shadePoint.Material;
-                color += mat->Shade( shadePoint );
+                color += sd->Materials->Shade( shadePoint.Material, shadePoint );
             }
             else
             {
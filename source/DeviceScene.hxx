@@ -9,9 +9,10 @@ REX_NS_BEGIN
 /// </summary>
 struct DeviceSceneData
 {
-    const DeviceList<Light*>* Lights;
+    const LightTable*         Lights;
     const AmbientLight*       AmbientLight;
-    const Octree*             Octree;
+    const MaterialTable*      Materials;
+    const AccelStructure*     AccelStructure;
     const Camera              Camera;
     const ViewPlane           ViewPlane;
     const Color               BackgroundColor;
@@ -24,6 +25,14 @@ struct DeviceSceneData
 /// <param name="sd">The scene data.</param>
 __global__ void SceneRenderKernel( DeviceSceneData* sd );
 
+/// <summary>
+/// Traces, shades, and writes a single pixel of the scene. Shared by the device kernel and the host renderer.
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="x">The pixel's X coordinate.</param>
+/// <param name="y">The pixel's Y coordinate.</param>
+__both__ void RenderScenePixel( const DeviceSceneData* sd, int32 x, int32 y );
+
 /// <summary>
 /// Launches the scene render kernel.
 /// </summary>
@@ -3,26 +3,72 @@
 
 REX_NS_BEGIN
 
+// create a new piece of geometry without a material
+__both__ Geometry::Geometry( GeometryType type )
+    : _material    ( REX_NO_MATERIAL ),
+      _geometryType( type )
+{
+}
+
+// create a new piece of geometry
+__both__ Geometry::Geometry( GeometryType type, uint32 material )
+    : _material    ( material ),
+      _geometryType( type )
+{
+}
+
 // destroys this piece of geometry
-__device__ Geometry::~Geometry()
+__both__ Geometry::~Geometry()
+{
+}
+
+// get the number of primitives (most geometry is a single primitive)
+__both__ uint32 Geometry::GetPrimitiveCount() const
+{
+    return 1;
+}
+
+// get the bounds of a primitive
+__both__ BoundingBox Geometry::GetPrimitiveBounds( uint32 ) const
 {
-    if ( _material )
-    {
-        delete _material;
-        _material = nullptr;
-    }
+    return GetBounds();
 }
 
-// get device material
-__device__ const Material* Geometry::GetMaterial() const
+// get the bounds of the part of a primitive inside a box
+__both__ BoundingBox Geometry::GetClippedPrimitiveBounds( uint32 primitive, const BoundingBox& clip ) const
+{
+    const BoundingBox bounds = GetPrimitiveBounds( primitive );
+    return BoundingBox( glm::max( bounds.GetMin(), clip.GetMin() ), glm::min( bounds.GetMax(), clip.GetMax() ) );
+}
+
+// get material index
+__both__ uint32 Geometry::GetMaterial() const
 {
     return _material;
 }
 
 // get geometry type
-__device__ GeometryType Geometry::GetType() const
+__both__ GeometryType Geometry::GetType() const
 {
     return _geometryType;
 }
 
+// shade-hit a primitive
+__both__ bool Geometry::HitPrimitive( uint32, const Ray& ray, real32& tmin, HitRecord& hit ) const
+{
+    return Hit( ray, tmin, hit );
+}
+
+// shadow-hit a primitive
+__both__ bool Geometry::ShadowHitPrimitive( uint32, const Ray& ray, real32& tmin ) const
+{
+    return ShadowHit( ray, tmin );
+}
+
+// set material index
+__both__ void Geometry::SetMaterial( uint32 material )
+{
+    _material = material;
+}
+
 REX_NS_END
\ No newline at end of file
@@ -3,13 +3,13 @@
 REX_NS_BEGIN
 
 // create g-s BRDF
-__device__ GlossySpecularBRDF::GlossySpecularBRDF()
+__both__ GlossySpecularBRDF::GlossySpecularBRDF()
     : GlossySpecularBRDF( 0.0f, Color::Black(), 0.0f )
 {
 }
 
 // create g-s BRDF w/ coefficient, color, power
-__device__ GlossySpecularBRDF::GlossySpecularBRDF( real32 ks, const Color& color, real32 pow )
+__both__ GlossySpecularBRDF::GlossySpecularBRDF( real32 ks, const Color& color, real32 pow )
     : _coefficient( ks )
     , _color      ( color )
     , _power      ( pow )
@@ -17,20 +17,20 @@ __device__ GlossySpecularBRDF::GlossySpecularBRDF( real32 ks, const Color& color
 }
 
 // destroy gs- BRDF
-__device__ GlossySpecularBRDF::~GlossySpecularBRDF()
+__both__ GlossySpecularBRDF::~GlossySpecularBRDF()
 {
     _coefficient = 0.0f;
     _power = 0.0f;
 }
 
 // get bi-hemispherical reflectance (rho)
-__device__ Color GlossySpecularBRDF::GetBHR( const ShadePoint& sp, const vec3& wo ) const
+__both__ Color GlossySpecularBRDF::GetBHR( const ShadePoint& sp, const vec3& wo ) const
 {
     return Color::Magenta();
 }
 
 // get BRDF (f)
-__device__ Color GlossySpecularBRDF::GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
+__both__ Color GlossySpecularBRDF::GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
 {
     // from Suffern, 284
 
@@ -52,37 +52,37 @@ __device__ Color GlossySpecularBRDF::GetBRDF( const ShadePoint& sp, const vec3&
 }
 
 // get specular coefficient
-__device__ real32 GlossySpecularBRDF::GetSpecularCoefficient() const
+__both__ real32 GlossySpecularBRDF::GetSpecularCoefficient() const
 {
     return _coefficient;
 }
 
 // get color
-__device__ const Color& GlossySpecularBRDF::GetSpecularColor() const
+__both__ const Color& GlossySpecularBRDF::GetSpecularColor() const
 {
     return _color;
 }
 
 // get power
-__device__ real32 GlossySpecularBRDF::GetSpecularPower() const
+__both__ real32 GlossySpecularBRDF::GetSpecularPower() const
 {
     return _power;
 }
 
 // set ks
-__device__ void GlossySpecularBRDF::SetSpecularCoefficient( real32 ks )
+__both__ void GlossySpecularBRDF::SetSpecularCoefficient( real32 ks )
 {
     _coefficient = ks;
 }
 
 // set color
-__device__ void GlossySpecularBRDF::SetSpecularColor( const Color& color )
+__both__ void GlossySpecularBRDF::SetSpecularColor( const Color& color )
 {
     _color = color;
 }
 
 // set color w/ components
-__device__ void GlossySpecularBRDF::SetSpecularColor( real32 r, real32 g, real32 b )
+__both__ void GlossySpecularBRDF::SetSpecularColor( real32 r, real32 g, real32 b )
 {
     _color.R = r;
     _color.G = g;
@@ -90,7 +90,7 @@ __device__ void GlossySpecularBRDF::SetSpecularColor( real32 r, real32 g, real32
 }
 
 // set power
-__device__ void GlossySpecularBRDF::SetSpecularPower( real32 pow )
+__both__ void GlossySpecularBRDF::SetSpecularPower( real32 pow )
 {
     _power = pow;
 }
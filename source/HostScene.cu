@@ -0,0 +1,152 @@
+#include "HostScene.hxx"
+#include <rex/Graphics/Geometry/PacketTracer.hxx>
+#include <thread>
+#include <vector>
+
+REX_NS_BEGIN
+
+// renders a horizontal span of pixels by tracing their primary rays as packets
+static void RenderScenePixelSpan( const DeviceSceneData* sd, uint32 x, uint32 y, uint32 count )
+{
+    const ViewPlane& vp = sd->ViewPlane;
+
+    // prepare for the tracing!! (this mirrors RenderScenePixel, one lane per pixel)
+    const AccelStructure* accel      = sd->AccelStructure;
+    const real32          invSamples = 1.0f / vp.SampleCount;
+    const int32           n          = static_cast<int32>( sqrtf( vp.SampleCount ) );
+    const real32          invn       = 1.0f / n;
+    const vec3            origin     = sd->Camera.GetPosition();
+    Color                 colors[ REX_SIMD_WIDTH ];
+    real32                t          = 0.0f;
+    vec2                  samplePoint;
+    ShadePoint            shadePoint;
+    HitRecord             hit;
+    RayPacket             packet;
+
+
+    // configure the shade point
+    shadePoint.AccelStructure = sd->AccelStructure;
+    shadePoint.AmbientLight   = sd->AmbientLight;
+    shadePoint.Lights         = sd->Lights;
+
+
+    // sample the scene, one packet per sub-pixel offset
+    for ( uint32 lane = 0; lane < count; ++lane )
+    {
+        colors[ lane ] = Color::Black();
+    }
+    for ( int32 sy = 0; sy < n; ++sy )
+    {
+        for ( int32 sx = 0; sx < n; ++sx )
+        {
+            // fill the packet with each pixel's ray
+            packet.ActiveMask = 0;
+            samplePoint.y     = y - ( 0.5f * vp.Height ) + ( ( sy + 0.5f ) * invn );
+            for ( uint32 lane = 0; lane < count; ++lane )
+            {
+                samplePoint.x = ( x + lane ) - ( 0.5f * vp.Width ) + ( ( sx + 0.5f ) * invn );
+                packet.SetRay( lane, Ray( origin, sd->Camera.GetRayDirection( samplePoint ) ) );
+            }
+
+
+            // hit the objects in the scene
+            PacketTracer::Trace( accel, packet );
+
+
+            // shade each lane's hit
+            for ( uint32 lane = 0; lane < count; ++lane )
+            {
+                const Geometry* geom = packet.Object[ lane ];
+                const Ray       ray  = packet.GetRay( lane );
+
+                // the packet only knows what was hit, so have the primitive record the hit (the rare lane where
+                // the two tests disagree at an edge just gets the full single-ray query instead)
+                if ( geom && !geom->HitPrimitive( packet.Primitive[ lane ], ray, t, hit ) )
+                {
+                    geom = accel->QueryIntersections( ray, t, hit );
+                }
+
+                if ( geom )
+                {
+                    geom->GetShadePoint( ray, hit, shadePoint );
+                    shadePoint.Ray = ray;
+                    shadePoint.T   = t;
+
+                    // add to the color if the ray hit
+                    colors[ lane ] += sd->Materials->Shade( shadePoint.Material, shadePoint );
+                }
+                else
+                {
+                    colors[ lane ] += sd->BackgroundColor;
+                }
+            }
+        }
+    }
+
+
+    // set the pixels!
+    for ( uint32 lane = 0; lane < count; ++lane )
+    {
+        colors[ lane ] *= invSamples;
+        sd->Pixels[ ( x + lane ) + y * vp.Width ] = colors[ lane ].ToUChar4();
+    }
+}
+
+// renders the scene on the host
+void LaunchHostRender( const DeviceSceneData* sceneData, uint32 tileSize, uint32 workerCount, bool usePackets )
+{
+    const ViewPlane& vp = sceneData->ViewPlane;
+
+    // figure out how many workers we need
+    if ( workerCount == 0 )
+    {
+        workerCount = Math::Max( std::thread::hardware_concurrency(), 1U );
+    }
+
+
+    // split the view plane up between the workers
+    TileScheduler scheduler( vp.Width, vp.Height, tileSize, workerCount );
+
+    // each worker keeps asking for tiles (stealing when its own run is done) until there are none left
+    auto worker = [ & ]( uint32 index )
+    {
+        Tile tile;
+        while ( scheduler.GetNextTile( index, tile ) )
+        {
+            for ( uint32 y = tile.StartY; y < tile.EndY; ++y )
+            {
+                if ( usePackets )
+                {
+                    for ( uint32 x = tile.StartX; x < tile.EndX; x += REX_SIMD_WIDTH )
+                    {
+                        RenderScenePixelSpan( sceneData, x, y, Math::Min<uint32>( REX_SIMD_WIDTH, tile.EndX - x ) );
+                    }
+                }
+                else
+                {
+                    for ( uint32 x = tile.StartX; x < tile.EndX; ++x )
+                    {
+                        RenderScenePixel( sceneData, x, y );
+                    }
+                }
+            }
+        }
+    };
+
+
+    // start the workers, with this thread acting as the first one
+    std::vector<std::thread> workers;
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        workers.push_back( std::thread( worker, i ) );
+    }
+    worker( 0 );
+
+    // wait for everyone to finish
+    for ( auto& thread : workers )
+    {
+        thread.join();
+    }
+}
+
+REX_NS_END
\ No newline at end of file
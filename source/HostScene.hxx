@@ -0,0 +1,17 @@
+#pragma once
+
+#include "DeviceScene.hxx"
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Renders the scene on the host. The view plane is split into Morton-ordered tiles which are handed out to
+/// worker threads through a work-stealing tile scheduler.
+/// </summary>
+/// <param name="sceneData">The scene data. The pixels must point to host memory.</param>
+/// <param name="tileSize">The width and height of each tile, in pixels.</param>
+/// <param name="workerCount">The number of worker threads to use, or 0 to use every hardware thread.</param>
+/// <param name="usePackets">True to trace primary rays in SIMD packets, false to trace them one at a time.</param>
+__host__ void LaunchHostRender( const DeviceSceneData* sceneData, uint32 tileSize, uint32 workerCount, bool usePackets );
+
+REX_NS_END
\ No newline at end of file
@@ -0,0 +1,623 @@
+#include "HostWavefront.hxx"
+#include <rex/Graphics/Geometry/PacketTracer.hxx>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// the most camera rays in one batch (a pixel's samples are never split between batches)
+#define WAVEFRONT_BATCH_SIZE ( 64 * 1024 )
+
+// the number of queue entries a worker takes at a time (a multiple of the SIMD width, so packets stay full)
+#define WAVEFRONT_CHUNK_SIZE 256
+
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a batch's camera rays and what became of them, one array per component. Every camera ray starts at the
+/// camera, so only their directions are stored.
+/// </summary>
+struct WavefrontRayQueue
+{
+    std::vector<real32>    DirectionX;
+    std::vector<real32>    DirectionY;
+    std::vector<real32>    DirectionZ;
+    std::vector<HitRecord> Hits;        // the hit's geometry is null if the ray missed
+    std::vector<Color>     Colors;      // only set for rays that hit something
+};
+
+/// <summary>
+/// Defines the camera rays in a batch that hit something, ordered by the material they're shaded with.
+/// </summary>
+struct WavefrontHitQueue
+{
+    std::vector<uint32> Rays;           // the index of each hit's camera ray, after sorting
+    std::vector<uint32> Keys;           // the material of each camera ray, before sorting
+    std::vector<uint32> Offsets;        // each worker's count of each material's hits, and then where it places them
+    uint32              KeyCount;       // the number of materials, plus one for hits without a material
+    uint32              Count;
+};
+
+/// <summary>
+/// Defines the shadow rays queued by one worker while shading, one array per component. A camera ray's shadow rays
+/// are next to each other and in the same order as the lights.
+/// </summary>
+struct WavefrontShadowQueue
+{
+    std::vector<real32> OriginX;
+    std::vector<real32> OriginY;
+    std::vector<real32> OriginZ;
+    std::vector<real32> DirectionX;
+    std::vector<real32> DirectionY;
+    std::vector<real32> DirectionZ;
+    std::vector<real32> Distance;       // how far the ray has to go to reach the light
+    std::vector<real32> RadianceR;      // what the light adds to the camera ray's color if it isn't blocked
+    std::vector<real32> RadianceG;
+    std::vector<real32> RadianceB;
+    std::vector<uint32> Rays;           // the index of the camera ray that was shaded
+    std::vector<uint8>  CastsShadows;   // lights that don't cast shadows are queued too, but never traced
+    std::vector<uint8>  Blocked;
+
+    /// <summary>
+    /// Removes every shadow ray from this queue, keeping the memory around for the next batch.
+    /// </summary>
+    void Clear()
+    {
+        OriginX.clear();
+        OriginY.clear();
+        OriginZ.clear();
+        DirectionX.clear();
+        DirectionY.clear();
+        DirectionZ.clear();
+        Distance.clear();
+        RadianceR.clear();
+        RadianceG.clear();
+        RadianceB.clear();
+        Rays.clear();
+        CastsShadows.clear();
+        Blocked.clear();
+    }
+};
+
+/// <summary>
+/// Defines a point every worker has to reach before any of them carry on to the next stage.
+/// </summary>
+class WavefrontBarrier
+{
+    std::mutex              _mutex;
+    std::condition_variable _released;
+    uint32                  _workerCount;
+    uint32                  _waiting;
+    uint32                  _generation;
+
+public:
+    /// <summary>
+    /// Creates a new barrier.
+    /// </summary>
+    /// <param name="workerCount">The number of workers that wait on the barrier.</param>
+    explicit WavefrontBarrier( uint32 workerCount )
+        : _workerCount( workerCount )
+        , _waiting( 0 )
+        , _generation( 0 )
+    {
+    }
+
+    /// <summary>
+    /// Waits for every worker to reach the barrier.
+    /// </summary>
+    /// <param name="finish">Called by the last worker to arrive, before the others are let go.</param>
+    template<class Finish> void Wait( const Finish& finish )
+    {
+        std::unique_lock<std::mutex> lock( _mutex );
+        const uint32                 generation = _generation;
+        if ( ++_waiting == _workerCount )
+        {
+            finish();
+            _waiting = 0;
+            ++_generation;
+            _released.notify_all();
+            return;
+        }
+
+        _released.wait( lock, [ & ]() { return _generation != generation; } );
+    }
+};
+
+/// <summary>
+/// Works through a stage's items a chunk at a time until every worker has taken them all.
+/// </summary>
+/// <param name="next">The next item to hand out, which has to be reset before each stage.</param>
+/// <param name="itemCount">The number of items.</param>
+/// <param name="chunkSize">The number of items handed out at a time.</param>
+/// <param name="work">Called with the range of items to work on.</param>
+template<class Work> static void RunChunks( std::atomic<uint32>& next, uint32 itemCount, uint32 chunkSize, const Work& work )
+{
+    for ( uint32 start = next.fetch_add( chunkSize ); start < itemCount; start = next.fetch_add( chunkSize ) )
+    {
+        work( start, Math::Min( start + chunkSize, itemCount ) );
+    }
+}
+
+/// <summary>
+/// Splits a range of every worker's shadow rays, taken as one queue after another, into a range of each queue.
+/// </summary>
+/// <param name="offsets">Where each queue starts, followed by the total number of shadow rays.</param>
+/// <param name="start">The first shadow ray.</param>
+/// <param name="end">The shadow ray to stop at.</param>
+/// <param name="work">Called with the index of a queue and the range of its shadow rays to work on.</param>
+template<class Work> static void SplitShadowRange( const std::vector<uint32>& offsets, uint32 start, uint32 end, const Work& work )
+{
+    // the last queue starting at or before the range holds its first ray, skipping over any empty queues
+    uint32 queue = static_cast<uint32>( std::upper_bound( offsets.begin(), offsets.end(), start ) - offsets.begin() ) - 1;
+    while ( start < end )
+    {
+        const uint32 queueEnd = Math::Min( end, offsets[ queue + 1 ] );
+        if ( queueEnd > start )
+        {
+            work( queue, start - offsets[ queue ], queueEnd - offsets[ queue ] );
+        }
+        start = queueEnd;
+        ++queue;
+    }
+}
+
+/// <summary>
+/// Gets the material a hit is shaded with, without filling in its shade point.
+/// </summary>
+/// <param name="hit">The hit.</param>
+static uint32 GetHitMaterial( const HitRecord& hit )
+{
+    // instances without a material of their own are shaded with their mesh's
+    uint32 material = hit.Object->GetMaterial();
+    if ( material == REX_NO_MATERIAL && hit.Object->GetType() == GeometryType::MeshInstance )
+    {
+        material = static_cast<const MeshInstance*>( hit.Object )->GetMesh()->GetMaterial();
+    }
+    return material;
+}
+
+/// <summary>
+/// Makes the camera rays for a range of a batch's pixels.
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="firstPixel">The index of the batch's first pixel in the view plane.</param>
+/// <param name="start">The first pixel in the batch to make rays for.</param>
+/// <param name="end">The pixel in the batch to stop at.</param>
+/// <param name="rays">The batch's camera rays.</param>
+static void GenerateRays( const DeviceSceneData* sd, uint32 firstPixel, uint32 start, uint32 end, WavefrontRayQueue& rays )
+{
+    const ViewPlane& vp   = sd->ViewPlane;
+    const int32      n    = static_cast<int32>( sqrtf( vp.SampleCount ) );
+    const real32     invn = 1.0f / n;
+    vec2             samplePoint;
+
+    // the samples are in the same order as RenderScenePixel's, so both add up to the same colors
+    for ( uint32 pixel = start; pixel < end; ++pixel )
+    {
+        const int32 x   = static_cast<int32>( ( firstPixel + pixel ) % vp.Width );
+        const int32 y   = static_cast<int32>( ( firstPixel + pixel ) / vp.Width );
+        uint32      ray = pixel * n * n;
+        for ( int32 sy = 0; sy < n; ++sy )
+        {
+            for ( int32 sx = 0; sx < n; ++sx, ++ray )
+            {
+                samplePoint.x = x - ( 0.5f * vp.Width  ) + ( ( sx + 0.5f ) * invn );
+                samplePoint.y = y - ( 0.5f * vp.Height ) + ( ( sy + 0.5f ) * invn );
+
+                const vec3 direction = sd->Camera.GetRayDirection( samplePoint );
+                rays.DirectionX[ ray ] = direction.x;
+                rays.DirectionY[ ray ] = direction.y;
+                rays.DirectionZ[ ray ] = direction.z;
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Finds the closest hit of a range of a batch's camera rays.
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="usePackets">True to trace the rays in SIMD packets, false to trace them one at a time.</param>
+/// <param name="start">The first ray to trace.</param>
+/// <param name="end">The ray to stop at.</param>
+/// <param name="rays">The batch's camera rays.</param>
+static void TraceRays( const DeviceSceneData* sd, bool usePackets, uint32 start, uint32 end, WavefrontRayQueue& rays )
+{
+    const AccelStructure* accel  = sd->AccelStructure;
+    const vec3            origin = sd->Camera.GetPosition();
+    real32                t      = 0.0f;
+    RayPacket             packet;
+
+    if ( !usePackets )
+    {
+        for ( uint32 i = start; i < end; ++i )
+        {
+            const Ray ray = Ray( origin, vec3( rays.DirectionX[ i ], rays.DirectionY[ i ], rays.DirectionZ[ i ] ) );
+            rays.Hits[ i ].Object = accel->QueryIntersections( ray, t, rays.Hits[ i ] );
+        }
+        return;
+    }
+
+    // neighbouring camera rays go in the same packet, which is where they're most alike
+    for ( uint32 first = start; first < end; first += REX_SIMD_WIDTH )
+    {
+        const uint32 count = Math::Min<uint32>( REX_SIMD_WIDTH, end - first );
+
+        packet.ActiveMask = 0;
+        for ( uint32 lane = 0; lane < count; ++lane )
+        {
+            const uint32 i = first + lane;
+            packet.SetRay( lane, Ray( origin, vec3( rays.DirectionX[ i ], rays.DirectionY[ i ], rays.DirectionZ[ i ] ) ) );
+        }
+        PacketTracer::Trace( accel, packet );
+
+        // the packet only knows what was hit, so have the primitive record the hit (the rare lane where the two
+        // tests disagree at an edge just gets the full single-ray query instead)
+        for ( uint32 lane = 0; lane < count; ++lane )
+        {
+            HitRecord&      hit  = rays.Hits[ first + lane ];
+            const Geometry* geom = packet.Object[ lane ];
+            const Ray       ray  = packet.GetRay( lane );
+            if ( geom && !geom->HitPrimitive( packet.Primitive[ lane ], ray, t, hit ) )
+            {
+                geom = accel->QueryIntersections( ray, t, hit );
+            }
+            hit.Object = geom;
+        }
+    }
+}
+
+/// <summary>
+/// Counts how many of a worker's slice of a batch's hits go with each material. Each worker counts and places the
+/// hits in its own slice, so the batch's hits are ordered by material with a counting sort that runs on every worker
+/// (there are far fewer materials than hits).
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="rays">The batch's camera rays.</param>
+/// <param name="start">The first ray in the worker's slice.</param>
+/// <param name="end">The ray to stop at.</param>
+/// <param name="worker">The worker's index.</param>
+/// <param name="hits">The batch's hits.</param>
+static void CountHits( const DeviceSceneData* sd, const WavefrontRayQueue& rays, uint32 start, uint32 end, uint32 worker, WavefrontHitQueue& hits )
+{
+    // anything without a material in the table goes after everything else
+    const uint32 materialCount = sd->Materials->GetSize();
+    uint32*      counts        = &hits.Offsets[ worker * hits.KeyCount ];
+    std::fill( counts, counts + hits.KeyCount, 0 );
+    for ( uint32 i = start; i < end; ++i )
+    {
+        if ( rays.Hits[ i ].Object )
+        {
+            hits.Keys[ i ] = Math::Min( GetHitMaterial( rays.Hits[ i ] ), materialCount );
+            ++counts[ hits.Keys[ i ] ];
+        }
+    }
+}
+
+/// <summary>
+/// Turns every worker's counts into where its hits for each material start. A material's hits are placed one
+/// worker's slice after another, so the rays stay in order within each material.
+/// </summary>
+/// <param name="workerCount">The number of workers.</param>
+/// <param name="hits">The batch's hits.</param>
+static void PlaceHits( uint32 workerCount, WavefrontHitQueue& hits )
+{
+    uint32 offset = 0;
+    for ( uint32 key = 0; key < hits.KeyCount; ++key )
+    {
+        for ( uint32 worker = 0; worker < workerCount; ++worker )
+        {
+            const uint32 count = hits.Offsets[ worker * hits.KeyCount + key ];
+            hits.Offsets[ worker * hits.KeyCount + key ] = offset;
+            offset += count;
+        }
+    }
+    hits.Count = offset;
+}
+
+/// <summary>
+/// Puts each of a worker's slice of a batch's hits in its sorted place.
+/// </summary>
+/// <param name="rays">The batch's camera rays.</param>
+/// <param name="start">The first ray in the worker's slice.</param>
+/// <param name="end">The ray to stop at.</param>
+/// <param name="worker">The worker's index.</param>
+/// <param name="hits">The batch's hits.</param>
+static void ScatterHits( const WavefrontRayQueue& rays, uint32 start, uint32 end, uint32 worker, WavefrontHitQueue& hits )
+{
+    uint32* offsets = &hits.Offsets[ worker * hits.KeyCount ];
+    for ( uint32 i = start; i < end; ++i )
+    {
+        if ( rays.Hits[ i ].Object )
+        {
+            hits.Rays[ offsets[ hits.Keys[ i ] ]++ ] = i;
+        }
+    }
+}
+
+/// <summary>
+/// Shades a range of a batch's sorted hits with the ambient light, and queues a shadow ray for each light that
+/// reaches the front of the surface.
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="start">The first hit to shade.</param>
+/// <param name="end">The hit to stop at.</param>
+/// <param name="hits">The batch's sorted hits.</param>
+/// <param name="rays">The batch's camera rays.</param>
+/// <param name="shadows">The worker's shadow ray queue.</param>
+static void ShadeHits( const DeviceSceneData* sd, uint32 start, uint32 end, const WavefrontHitQueue& hits, WavefrontRayQueue& rays, WavefrontShadowQueue& shadows )
+{
+    const MaterialTable* materials = sd->Materials;
+    const vec3           origin    = sd->Camera.GetPosition();
+    ShadePoint           shadePoint;
+    LightBatch           batch;
+
+    // configure the shade point
+    shadePoint.AccelStructure = sd->AccelStructure;
+    shadePoint.AmbientLight   = sd->AmbientLight;
+    shadePoint.Lights         = sd->Lights;
+
+    for ( uint32 i = start; i < end; ++i )
+    {
+        const uint32     index = hits.Rays[ i ];
+        const HitRecord& hit   = rays.Hits[ index ];
+        const Ray        ray   = Ray( origin, vec3( rays.DirectionX[ index ], rays.DirectionY[ index ], rays.DirectionZ[ index ] ) );
+
+        hit.Object->GetShadePoint( ray, hit, shadePoint );
+        shadePoint.Ray = ray;
+        shadePoint.T   = hit.T;
+
+        // geometry without a material is shaded the same as RenderScenePixel would
+        const uint32 material = shadePoint.Material;
+        if ( material >= materials->GetSize() )
+        {
+            rays.Colors[ index ] = materials->Shade( material, shadePoint );
+            continue;
+        }
+        rays.Colors[ index ] = materials->ShadeAmbient( material, shadePoint );
+
+        // queue up the lights the same way the materials go through them, leaving the shadows for later
+        const vec3 wo = -ray.Direction;
+        for ( uint32 first = 0; sd->Lights->GetBatch( shadePoint, first, batch ); first += batch.Count )
+        {
+            for ( uint32 light = 0; light < batch.Count; ++light )
+            {
+                if ( batch.Angle[ light ] > 0.0f )
+                {
+                    const vec3  wi        = vec3( batch.DirectionX[ light ], batch.DirectionY[ light ], batch.DirectionZ[ light ] );
+                    const Color radiance  = materials->GetBRDF( material, shadePoint, wo, wi ) * batch.Radiance[ light ] * batch.Angle[ light ];
+                    const Ray   shadowRay = LightTable::GetShadowRay( shadePoint, batch, light );
+
+                    shadows.OriginX     .push_back( shadowRay.Origin.x );
+                    shadows.OriginY     .push_back( shadowRay.Origin.y );
+                    shadows.OriginZ     .push_back( shadowRay.Origin.z );
+                    shadows.DirectionX  .push_back( shadowRay.Direction.x );
+                    shadows.DirectionY  .push_back( shadowRay.Direction.y );
+                    shadows.DirectionZ  .push_back( shadowRay.Direction.z );
+                    shadows.Distance    .push_back( batch.Distance[ light ] );
+                    shadows.RadianceR   .push_back( radiance.R );
+                    shadows.RadianceG   .push_back( radiance.G );
+                    shadows.RadianceB   .push_back( radiance.B );
+                    shadows.Rays        .push_back( index );
+                    shadows.CastsShadows.push_back( batch.CastsShadows[ light ] );
+                    shadows.Blocked     .push_back( 0 );
+                }
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Finds which of a range of a queue's shadow rays are blocked.
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="start">The first shadow ray to trace.</param>
+/// <param name="end">The shadow ray to stop at.</param>
+/// <param name="shadows">The shadow ray queue.</param>
+static void TraceShadowRays( const DeviceSceneData* sd, uint32 start, uint32 end, WavefrontShadowQueue& shadows )
+{
+    const AccelStructure* accel = sd->AccelStructure;
+    for ( uint32 i = start; i < end; ++i )
+    {
+        if ( shadows.CastsShadows[ i ] )
+        {
+            const Ray ray = Ray( vec3( shadows.OriginX   [ i ], shadows.OriginY   [ i ], shadows.OriginZ   [ i ] ),
+                                 vec3( shadows.DirectionX[ i ], shadows.DirectionY[ i ], shadows.DirectionZ[ i ] ) );
+            shadows.Blocked[ i ] = accel->QueryOcclusion( ray, shadows.Distance[ i ] );
+        }
+    }
+}
+
+/// <summary>
+/// Adds the lights that a range of a queue's shadow rays found unblocked to their camera rays' colors. A camera
+/// ray's shadow rays are next to each other in one queue, so a range only adds up the camera rays whose first shadow
+/// ray is in it, which keeps two workers from ever adding to the same color.
+/// </summary>
+/// <param name="shadows">The shadow ray queue.</param>
+/// <param name="start">The first shadow ray in the range.</param>
+/// <param name="end">The shadow ray the range stops at.</param>
+/// <param name="rays">The batch's camera rays.</param>
+static void AccumulateLights( const WavefrontShadowQueue& shadows, uint32 start, uint32 end, WavefrontRayQueue& rays )
+{
+    const uint32 count = static_cast<uint32>( shadows.Rays.size() );
+
+    // skip the rest of a camera ray that started before the range, and finish the one that runs past its end
+    uint32 i = start;
+    while ( i > 0 && i < count && shadows.Rays[ i ] == shadows.Rays[ i - 1 ] )
+    {
+        ++i;
+    }
+    for ( ; i < count && ( i < end || shadows.Rays[ i ] == shadows.Rays[ i - 1 ] ); ++i )
+    {
+        if ( !shadows.Blocked[ i ] )
+        {
+            rays.Colors[ shadows.Rays[ i ] ] += Color( shadows.RadianceR[ i ], shadows.RadianceG[ i ], shadows.RadianceB[ i ] );
+        }
+    }
+}
+
+/// <summary>
+/// Averages the samples of a range of a batch's pixels and writes the pixels.
+/// </summary>
+/// <param name="sd">The scene data.</param>
+/// <param name="firstPixel">The index of the batch's first pixel in the view plane.</param>
+/// <param name="start">The first pixel in the batch to write.</param>
+/// <param name="end">The pixel in the batch to stop at.</param>
+/// <param name="rays">The batch's camera rays.</param>
+static void WritePixels( const DeviceSceneData* sd, uint32 firstPixel, uint32 start, uint32 end, const WavefrontRayQueue& rays )
+{
+    const ViewPlane& vp         = sd->ViewPlane;
+    const real32     invSamples = 1.0f / vp.SampleCount;
+    const uint32     n          = static_cast<uint32>( sqrtf( vp.SampleCount ) );
+
+    for ( uint32 pixel = start; pixel < end; ++pixel )
+    {
+        Color color = Color::Black();
+        for ( uint32 ray = pixel * n * n; ray < ( pixel + 1 ) * n * n; ++ray )
+        {
+            color += rays.Hits[ ray ].Object ? rays.Colors[ ray ] : sd->BackgroundColor;
+        }
+
+        color *= invSamples;
+        sd->Pixels[ firstPixel + pixel ] = color.ToUChar4();
+    }
+}
+
+// renders the scene on the host a stage at a time
+void LaunchWavefrontRender( const DeviceSceneData* sceneData, uint32 workerCount, bool usePackets, WavefrontStageTimes& times )
+{
+    const ViewPlane& vp              = sceneData->ViewPlane;
+    const uint32     n               = static_cast<uint32>( sqrtf( vp.SampleCount ) );
+    const uint32     samplesPerPixel = Math::Max<uint32>( n * n, 1 );
+    const uint32     pixelCount      = static_cast<uint32>( vp.Width ) * vp.Height;
+    const uint32     pixelsPerBatch  = Math::Max<uint32>( WAVEFRONT_BATCH_SIZE / samplesPerPixel, 1 );
+    const uint32     raysPerBatch    = pixelsPerBatch * samplesPerPixel;
+    Timer            timer;
+
+    // figure out how many workers we need
+    if ( workerCount == 0 )
+    {
+        workerCount = Math::Max( std::thread::hardware_concurrency(), 1U );
+    }
+
+
+    // the queues are sized for a full batch once, and then reused by every batch
+    WavefrontRayQueue                 rays;
+    WavefrontHitQueue                 hits;
+    std::vector<WavefrontShadowQueue> shadows( workerCount );
+    std::vector<uint32>               shadowOffsets( workerCount + 1, 0 );
+    rays.DirectionX.resize( raysPerBatch );
+    rays.DirectionY.resize( raysPerBatch );
+    rays.DirectionZ.resize( raysPerBatch );
+    rays.Hits      .resize( raysPerBatch );
+    rays.Colors    .resize( raysPerBatch );
+    hits.Rays      .resize( raysPerBatch );
+    hits.Keys      .resize( raysPerBatch );
+    hits.KeyCount  = sceneData->Materials->GetSize() + 1;
+    hits.Offsets   .resize( workerCount * hits.KeyCount );
+    hits.Count     = 0;
+    times          = WavefrontStageTimes();
+
+
+    // the last worker to finish a stage times it and gets the next one ready
+    WavefrontBarrier    barrier( workerCount );
+    std::atomic<uint32> next( 0 );
+    auto                endStage = [ & ]( real64& time )
+    {
+        timer.Stop();
+        time += timer.GetElapsed();
+        timer.Start();
+        next = 0;
+    };
+
+    // every worker pushes each batch through every stage in turn, waiting for the others between stages
+    auto worker = [ & ]( uint32 index )
+    {
+        WavefrontShadowQueue& queue = shadows[ index ];
+        for ( uint32 firstPixel = 0; firstPixel < pixelCount; firstPixel += pixelsPerBatch )
+        {
+            const uint32 batchPixels = Math::Min( pixelsPerBatch, pixelCount - firstPixel );
+            const uint32 batchRays   = batchPixels * n * n;
+            const uint32 sliceStart  = static_cast<uint32>( static_cast<uint64>( batchRays ) *   index       / workerCount );
+            const uint32 sliceEnd    = static_cast<uint32>( static_cast<uint64>( batchRays ) * ( index + 1 ) / workerCount );
+
+            RunChunks( next, batchPixels, WAVEFRONT_CHUNK_SIZE, [ & ]( uint32 start, uint32 end )
+            {
+                GenerateRays( sceneData, firstPixel, start, end, rays );
+            } );
+            barrier.Wait( [ & ]() { endStage( times.Generate ); } );
+
+            RunChunks( next, batchRays, WAVEFRONT_CHUNK_SIZE, [ & ]( uint32 start, uint32 end )
+            {
+                TraceRays( sceneData, usePackets, start, end, rays );
+            } );
+            barrier.Wait( [ & ]() { endStage( times.Trace ); } );
+
+            CountHits( sceneData, rays, sliceStart, sliceEnd, index, hits );
+            barrier.Wait( [ & ]() { PlaceHits( workerCount, hits ); } );
+            ScatterHits( rays, sliceStart, sliceEnd, index, hits );
+            barrier.Wait( [ & ]() { endStage( times.Sort ); } );
+
+            // each worker queues shadow rays in its own queue, and the last one to finish works out where each
+            // queue starts so the shadow rays can be handed out evenly across all of them
+            queue.Clear();
+            RunChunks( next, hits.Count, WAVEFRONT_CHUNK_SIZE, [ & ]( uint32 start, uint32 end )
+            {
+                ShadeHits( sceneData, start, end, hits, rays, queue );
+            } );
+            barrier.Wait( [ & ]()
+            {
+                endStage( times.Shade );
+                for ( uint32 i = 0; i < workerCount; ++i )
+                {
+                    shadowOffsets[ i + 1 ] = shadowOffsets[ i ] + static_cast<uint32>( shadows[ i ].Rays.size() );
+                }
+            } );
+
+            RunChunks( next, shadowOffsets[ workerCount ], WAVEFRONT_CHUNK_SIZE, [ & ]( uint32 start, uint32 end )
+            {
+                SplitShadowRange( shadowOffsets, start, end, [ & ]( uint32 shadowQueue, uint32 queueStart, uint32 queueEnd )
+                {
+                    TraceShadowRays( sceneData, queueStart, queueEnd, shadows[ shadowQueue ] );
+                } );
+            } );
+            barrier.Wait( [ & ]() { endStage( times.TraceShadows ); } );
+
+            RunChunks( next, shadowOffsets[ workerCount ], WAVEFRONT_CHUNK_SIZE, [ & ]( uint32 start, uint32 end )
+            {
+                SplitShadowRange( shadowOffsets, start, end, [ & ]( uint32 shadowQueue, uint32 queueStart, uint32 queueEnd )
+                {
+                    AccumulateLights( shadows[ shadowQueue ], queueStart, queueEnd, rays );
+                } );
+            } );
+            barrier.Wait( [ & ]() { next = 0; } );
+            RunChunks( next, batchPixels, WAVEFRONT_CHUNK_SIZE, [ & ]( uint32 start, uint32 end )
+            {
+                WritePixels( sceneData, firstPixel, start, end, rays );
+            } );
+            barrier.Wait( [ & ]() { endStage( times.Accumulate ); } );
+        }
+    };
+
+
+    // start the workers once for the whole render, with this thread acting as the first one
+    timer.Start();
+    std::vector<std::thread> workers;
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        workers.push_back( std::thread( worker, i ) );
+    }
+    worker( 0 );
+
+    // wait for everyone to finish
+    for ( auto& thread : workers )
+    {
+        thread.join();
+    }
+}
+
+REX_NS_END
\ No newline at end of file
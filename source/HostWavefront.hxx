@@ -0,0 +1,32 @@
+#pragma once
+
+#include "DeviceScene.hxx"
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines how long each stage of a wavefront render took, in seconds, summed over every batch.
+/// </summary>
+struct WavefrontStageTimes
+{
+    real64 Generate;        // making the camera rays
+    real64 Trace;           // finding each camera ray's closest hit
+    real64 Sort;            // ordering the hits by the material they're shaded with
+    real64 Shade;           // shading the hits and queueing a shadow ray for each light
+    real64 TraceShadows;    // finding which of the shadow rays are blocked
+    real64 Accumulate;      // adding up the unblocked lights and writing the pixels
+};
+
+/// <summary>
+/// Renders the scene on the host as a stream of stages instead of one pixel at a time. The view plane is rendered
+/// in batches of camera rays, and each stage runs over the whole batch on every worker before the next one starts:
+/// the camera rays are generated, traced, sorted by material, and shaded, then the shadow rays queued by shading are
+/// traced and the unblocked lights are added to the pixels.
+/// </summary>
+/// <param name="sceneData">The scene data. The pixels must point to host memory.</param>
+/// <param name="workerCount">The number of worker threads to use, or 0 to use every hardware thread.</param>
+/// <param name="usePackets">True to trace camera rays in SIMD packets, false to trace them one at a time.</param>
+/// <param name="times">The time spent in each stage.</param>
+__host__ void LaunchWavefrontRender( const DeviceSceneData* sceneData, uint32 workerCount, bool usePackets, WavefrontStageTimes& times );
+
+REX_NS_END
\ No newline at end of file
@@ -15,6 +15,12 @@ REX_NS_BEGIN
 
 // create image w/ width and height
 Image::Image( uint16 width, uint16 height )
+    : Image( width, height, true )
+{
+}
+
+// create image w/ width, height, and whether or not to use the device
+Image::Image( uint16 width, uint16 height, bool useDevice )
     : _width( width )
     , _height( height )
     , _dPixels( nullptr )
@@ -24,6 +30,12 @@ Image::Image( uint16 width, uint16 height )
     const uint32 cudaSize  = arraySize * sizeof( uchar4 );
     _hPixels.resize( arraySize );
 
+    // host-only images never touch the device
+    if ( !useDevice )
+    {
+        return;
+    }
+
 
     // create device pixels
     if ( cudaSuccess != cudaMalloc( reinterpret_cast<void**>( &_dPixels ), cudaSize ) )
@@ -88,4 +100,10 @@ uchar4* Image::GetDeviceMemory()
     return _dPixels;
 }
 
+// get image host memory
+uchar4* Image::GetHostMemory()
+{
+    return &( _hPixels[ 0 ] );
+}
+
 REX_NS_END
\ No newline at end of file
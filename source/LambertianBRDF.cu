@@ -4,56 +4,56 @@
 REX_NS_BEGIN
 
 // create Lambertian BRDF
-__device__ LambertianBRDF::LambertianBRDF()
+__both__ LambertianBRDF::LambertianBRDF()
     : LambertianBRDF( 0.0f, Color::Black() )
 {
 }
 
 // create Lambertian BRDF w/ coefficient, color
-__device__ LambertianBRDF::LambertianBRDF( real32 kd, const Color& dc )
+__both__ LambertianBRDF::LambertianBRDF( real32 kd, const Color& dc )
     : _coefficient( kd ),
       _color( dc )
 {
 }
 
 // destroy Lambertian BRDF
-__device__ LambertianBRDF::~LambertianBRDF()
+__both__ LambertianBRDF::~LambertianBRDF()
 {
     _coefficient = 0.0f;
 }
 
 // get bi-hemispherical reflectance
-__device__ Color LambertianBRDF::GetBHR( const ShadePoint& sp, const vec3& wo ) const
+__both__ Color LambertianBRDF::GetBHR( const ShadePoint& sp, const vec3& wo ) const
 {
     return _coefficient * _color;
 }
 
 // get BRDF
-__device__ Color LambertianBRDF::GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
+__both__ Color LambertianBRDF::GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
 {
     return _coefficient * _color * Math::InvPi();
 }
 
 // get diffuse color
-__device__ Color LambertianBRDF::GetDiffuseColor() const
+__both__ Color LambertianBRDF::GetDiffuseColor() const
 {
     return _color;
 }
 
 // get diffuse reflection coefficient
-__device__ real32 LambertianBRDF::GetDiffuseCoefficient() const
+__both__ real32 LambertianBRDF::GetDiffuseCoefficient() const
 {
     return _coefficient;
 }
 
 // set diffuse color
-__device__ void LambertianBRDF::SetDiffuseColor( const Color& color )
+__both__ void LambertianBRDF::SetDiffuseColor( const Color& color )
 {
     _color = color;
 }
 
 // set diffuse reflection coefficient
-__device__ void LambertianBRDF::SetDiffuseCoefficient( real32 coeff )
+__both__ void LambertianBRDF::SetDiffuseCoefficient( real32 coeff )
 {
     _coefficient = coeff;
 }
@@ -0,0 +1,188 @@
+#include <rex/Graphics/Lights/LightTable.hxx>
+#include <rex/Graphics/Lights/DirectionalLight.hxx>
+#include <rex/Graphics/Lights/PointLight.hxx>
+#include <rex/Graphics/ShadePoint.hxx>
+#include <rex/Math/Math.hxx>
+
+
+// how far shadow rays towards directional lights start from the shading point
+#define DIRECTIONAL_SHADOW_OFFSET 0.001f
+
+// the number of bytes each light takes up in its list
+#define LIGHT_SIZE ( 6 * sizeof( real32 ) + sizeof( bool ) )
+
+
+REX_NS_BEGIN
+
+// create a new light table
+__both__ LightTable::LightTable()
+{
+}
+
+// destroy this light table
+__both__ LightTable::~LightTable()
+{
+}
+
+// add a light
+__both__ bool LightTable::Add( const Light& light )
+{
+    switch ( light.GetType() )
+    {
+        case LightType::Directional:
+        {
+            const DirectionalLight& directional = static_cast<const DirectionalLight&>( light );
+            const vec3&             direction   = directional.GetDirection();
+            const Color             radiance    = directional.GetRadianceScale() * directional.GetColor();
+            _directional.DirectionX.Add( direction.x );
+            _directional.DirectionY.Add( direction.y );
+            _directional.DirectionZ.Add( direction.z );
+            _directional.RadianceR.Add( radiance.R );
+            _directional.RadianceG.Add( radiance.G );
+            _directional.RadianceB.Add( radiance.B );
+            _directional.CastsShadows.Add( light.CastsShadows() );
+            return true;
+        }
+
+        case LightType::Point:
+        {
+            const PointLight& point    = static_cast<const PointLight&>( light );
+            const vec3&       position = point.GetPosition();
+            const Color       radiance = point.GetRadianceScale() * point.GetColor();
+            _point.PositionX.Add( position.x );
+            _point.PositionY.Add( position.y );
+            _point.PositionZ.Add( position.z );
+            _point.RadianceR.Add( radiance.R );
+            _point.RadianceG.Add( radiance.G );
+            _point.RadianceB.Add( radiance.B );
+            _point.CastsShadows.Add( light.CastsShadows() );
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+// remove every light
+__both__ void LightTable::Clear()
+{
+    _directional.DirectionX.Clear();
+    _directional.DirectionY.Clear();
+    _directional.DirectionZ.Clear();
+    _directional.RadianceR.Clear();
+    _directional.RadianceG.Clear();
+    _directional.RadianceB.Clear();
+    _directional.CastsShadows.Clear();
+
+    _point.PositionX.Clear();
+    _point.PositionY.Clear();
+    _point.PositionZ.Clear();
+    _point.RadianceR.Clear();
+    _point.RadianceG.Clear();
+    _point.RadianceB.Clear();
+    _point.CastsShadows.Clear();
+}
+
+// get a batch of lights as seen from a shading point
+__both__ bool LightTable::GetBatch( const ShadePoint& sp, uint32 first, LightBatch& batch ) const
+{
+    const uint32 directionalCount = _directional.DirectionX.GetSize();
+    const uint32 pointCount       = _point.PositionX.GetSize();
+
+    if ( first < directionalCount )
+    {
+        const LightTableDirectionalList& list = _directional;
+
+        batch.Type  = LightType::Directional;
+        batch.Count = Math::Min( directionalCount - first, uint32( REX_LIGHT_BATCH_SIZE ) );
+        for ( uint32 i = 0; i < batch.Count; ++i )
+        {
+            batch.DirectionX  [ i ] = list.DirectionX[ first + i ];
+            batch.DirectionY  [ i ] = list.DirectionY[ first + i ];
+            batch.DirectionZ  [ i ] = list.DirectionZ[ first + i ];
+            batch.Distance    [ i ] = Math::HugeValue();
+            batch.Radiance    [ i ] = Color( list.RadianceR[ first + i ], list.RadianceG[ first + i ], list.RadianceB[ first + i ] );
+            batch.CastsShadows[ i ] = list.CastsShadows[ first + i ];
+        }
+    }
+    else if ( first - directionalCount < pointCount )
+    {
+        const LightTablePointList& list  = _point;
+        const uint32               start = first - directionalCount;
+
+        batch.Type  = LightType::Point;
+        batch.Count = Math::Min( pointCount - start, uint32( REX_LIGHT_BATCH_SIZE ) );
+        for ( uint32 i = 0; i < batch.Count; ++i )
+        {
+            const real32 x         = list.PositionX[ start + i ] - sp.HitPoint.x;
+            const real32 y         = list.PositionY[ start + i ] - sp.HitPoint.y;
+            const real32 z         = list.PositionZ[ start + i ] - sp.HitPoint.z;
+            const real32 length    = sqrtf( x * x + y * y + z * z );
+            const real32 invLength = 1.0f / length;
+
+            batch.DirectionX  [ i ] = x * invLength;
+            batch.DirectionY  [ i ] = y * invLength;
+            batch.DirectionZ  [ i ] = z * invLength;
+            batch.Distance    [ i ] = length;
+            batch.Radiance    [ i ] = Color( list.RadianceR[ start + i ], list.RadianceG[ start + i ], list.RadianceB[ start + i ] );
+            batch.CastsShadows[ i ] = list.CastsShadows[ start + i ];
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    // every kind of light gets its angle the same way
+    for ( uint32 i = 0; i < batch.Count; ++i )
+    {
+        batch.Angle[ i ] = sp.Normal.x * batch.DirectionX[ i ]
+                         + sp.Normal.y * batch.DirectionY[ i ]
+                         + sp.Normal.z * batch.DirectionZ[ i ];
+    }
+
+    return true;
+}
+
+// get the number of bytes used
+__both__ uint64 LightTable::GetBytesUsed() const
+{
+    return static_cast<uint64>( _directional.DirectionX.GetSize() ) * LIGHT_SIZE
+         + static_cast<uint64>( _point.PositionX.GetSize() )        * LIGHT_SIZE;
+}
+
+// get the number of bytes reserved
+__both__ uint64 LightTable::GetBytesReserved() const
+{
+    return static_cast<uint64>( _directional.DirectionX.GetCapacity() ) * LIGHT_SIZE
+         + static_cast<uint64>( _point.PositionX.GetCapacity() )        * LIGHT_SIZE;
+}
+
+// get the shadow ray towards a light
+__both__ Ray LightTable::GetShadowRay( const ShadePoint& sp, const LightBatch& batch, uint32 light )
+{
+    // directional lights are infinitely far away, so their shadow rays start a little off the surface instead
+    const vec3   direction = vec3( batch.DirectionX[ light ], batch.DirectionY[ light ], batch.DirectionZ[ light ] );
+    const real32 offset    = ( batch.Type == LightType::Directional ) ? DIRECTIONAL_SHADOW_OFFSET : 0.0f;
+    return Ray( sp.HitPoint + direction * offset, direction );
+}
+
+// get the number of lights
+__both__ uint32 LightTable::GetSize() const
+{
+    return _directional.DirectionX.GetSize() + _point.PositionX.GetSize();
+}
+
+// check if a light is blocked
+__both__ bool LightTable::IsInShadow( const ShadePoint& sp, const LightBatch& batch, uint32 light )
+{
+    if ( !batch.CastsShadows[ light ] )
+    {
+        return false;
+    }
+
+    return sp.AccelStructure->QueryOcclusion( GetShadowRay( sp, batch, light ), batch.Distance[ light ] );
+}
+
+REX_NS_END
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include <rex/Rex.hxx>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
+#include <vector>
 #if defined( _WIN32 ) || defined( _WIN64 )
 #  define WIN32_LEAN_AND_MEAN
 #  define VC_EXTRALEAN
@@ -10,6 +14,7 @@
 #  define mkdir _mkdir
 #else
 #  include <sys/stat.h>
+#  include <dirent.h>
 #  define mkdir(path) mkdir(path, S_IRWXU)
 #endif
 
@@ -23,16 +28,35 @@ struct LaunchParameters
     int32 RenderHeight;
     int32 SampleCount;
     int32 FrameCount;
+    int32 TileSize;
+    int32 WorkerCount;
+    int32 InstanceCount;
     bool  Fullscreen;
+    bool  UsePackets;
+    bool  UseWavefront;
+    bool  Animate;
+    bool  LinearBuild;
+    real32 SpatialBudget;
+    bool  BenchmarkAccel;
+    vector<String> ModelPaths;
 
     LaunchParameters()
     {
-        RenderMode   = SceneRenderMode::ToOpenGL;
-        RenderWidth  = 640;
-        RenderHeight = 480;
-        Fullscreen   = false;
-        FrameCount   = 1;
-        SampleCount  = 1;
+        RenderMode     = SceneRenderMode::ToOpenGL;
+        RenderWidth    = 640;
+        RenderHeight   = 480;
+        Fullscreen     = false;
+        FrameCount     = 1;
+        SampleCount    = 1;
+        TileSize       = 16;
+        WorkerCount    = 0;
+        InstanceCount  = 1;
+        UsePackets     = true;
+        UseWavefront   = false;
+        Animate        = false;
+        LinearBuild    = false;
+        SpatialBudget  = 0.0f;
+        BenchmarkAccel = false;
     }
 };
 
@@ -60,6 +84,11 @@ LaunchParameters GetPaunchParameters( int32 argc, char** argv )
             {
                 params.RenderMode = SceneRenderMode::ToImage;
             }
+            // Image, rendered on the host
+            else if ( 0 == strcmp( argv[ i + 1 ], "cpu" ) )
+            {
+                params.RenderMode = SceneRenderMode::ToHostImage;
+            }
             i += 1;
         }
         // check for fullscreen
@@ -92,18 +121,83 @@ LaunchParameters GetPaunchParameters( int32 argc, char** argv )
             params.SampleCount = atoi( argv[ i + 1 ] );
             i += 1;
         }
+        // check for host render tile size
+        else if ( 0 == strcmp( argv[ i ], "--tile-size" ) && i < argc - 1 )
+        {
+            params.TileSize = atoi( argv[ i + 1 ] );
+            i += 1;
+        }
+        // check for host render worker count
+        else if ( 0 == strcmp( argv[ i ], "--workers" ) && i < argc - 1 )
+        {
+            params.WorkerCount = atoi( argv[ i + 1 ] );
+            i += 1;
+        }
+        // check for disabling host packet tracing
+        else if ( 0 == strcmp( argv[ i ], "--no-packets" ) )
+        {
+            params.UsePackets = false;
+        }
+        // check for rendering on the host a stage at a time
+        else if ( 0 == strcmp( argv[ i ], "--wavefront" ) )
+        {
+            params.UseWavefront = true;
+        }
+        // check for a model to import (can be given more than once)
+        else if ( 0 == strcmp( argv[ i ], "--model" ) && i < argc - 1 )
+        {
+            params.ModelPaths.push_back( argv[ i + 1 ] );
+            i += 1;
+        }
+        // check for the number of copies of each model
+        else if ( 0 == strcmp( argv[ i ], "--model-instances" ) && i < argc - 1 )
+        {
+            params.InstanceCount = atoi( argv[ i + 1 ] );
+            i += 1;
+        }
+        // check for moving the geometry between frames
+        else if ( 0 == strcmp( argv[ i ], "--animate" ) )
+        {
+            params.Animate = true;
+        }
+        // check for building a linear acceleration structure
+        else if ( 0 == strcmp( argv[ i ], "--linear-bvh" ) )
+        {
+            params.LinearBuild = true;
+        }
+        // check for building with spatial splits, given the budget for extra references
+        else if ( 0 == strcmp( argv[ i ], "--spatial-bvh" ) && i < argc - 1 )
+        {
+            // the budget is a fraction of the object count, so anything that isn't a non-negative number is ignored
+            char*        end    = nullptr;
+            const real64 budget = strtod( argv[ i + 1 ], &end );
+            if ( end == argv[ i + 1 ] || *end != '\0' || !( budget >= 0.0 ) )
+            {
+                REX_DEBUG_LOG( "Ignoring spatial split budget '", argv[ i + 1 ], "'. It must be a non-negative number." );
+            }
+            else
+            {
+                params.SpatialBudget = static_cast<real32>( budget );
+            }
+            i += 1;
+        }
+        // check for comparing the acceleration structure builders
+        else if ( 0 == strcmp( argv[ i ], "--benchmark-accel" ) )
+        {
+            params.BenchmarkAccel = true;
+        }
     }
 
     return params;
 }
 
 /// <summary>
-/// Renders a frame.
+/// Moves the camera to where it should be for a frame.
 /// </summary>
-/// <param name="scene">The scene to render.</param>
+/// <param name="scene">The scene whose camera to move.</param>
 /// <param name="currFrame">The current frame.</param>
 /// <param name="totalFrames">The total number of frames.</param>
-void RenderFrame( Scene& scene, uint32 currFrame, uint32 totalFrames )
+void PlaceCamera( Scene& scene, uint32 currFrame, uint32 totalFrames )
 {
     // get the camera's position
     const real32 distance = 100.0f;
@@ -113,6 +207,17 @@ void RenderFrame( Scene& scene, uint32 currFrame, uint32 totalFrames )
 
     // tell the camera to look at the center of the world from our position
     scene.GetCamera().LookAt( vec3( x, 10.0f, z ), vec3() );
+}
+
+/// <summary>
+/// Renders a frame.
+/// </summary>
+/// <param name="scene">The scene to render.</param>
+/// <param name="currFrame">The current frame.</param>
+/// <param name="totalFrames">The total number of frames.</param>
+void RenderFrame( Scene& scene, uint32 currFrame, uint32 totalFrames )
+{
+    PlaceCamera( scene, currFrame, totalFrames );
 
 
 
@@ -121,7 +226,7 @@ void RenderFrame( Scene& scene, uint32 currFrame, uint32 totalFrames )
     {
         // get image name
         ostringstream stream;
-        stream << "render\\img" << currFrame << ".png";
+        stream << "render/img" << currFrame << ".png";
         string fname = stream.str();
 
         // save the image
@@ -129,6 +234,43 @@ void RenderFrame( Scene& scene, uint32 currFrame, uint32 totalFrames )
     }
 }
 
+/// <summary>
+/// Moves the scene's geometry a little further around the Y axis before the next frame.
+/// </summary>
+/// <param name="scene">The scene to animate.</param>
+void AnimateScene( Scene& scene )
+{
+    const real32 angle    = Math::TwoPi() / 90.0f;
+    const mat4   rotation = glm::rotate( angle, vec3( 0.0f, 1.0f, 0.0f ) );
+
+    scene.UpdateGeometry( [ &rotation ]( Geometry* geometry )
+    {
+        switch ( geometry->GetType() )
+        {
+            case GeometryType::Sphere:
+            {
+                Sphere* sphere = static_cast<Sphere*>( geometry );
+                sphere->SetCenter( vec3( rotation * glm::vec4( sphere->GetCenter(), 1.0f ) ) );
+                break;
+            }
+            case GeometryType::Mesh:
+            {
+                Mesh* mesh = static_cast<Mesh*>( geometry );
+                mesh->SetPlacement( mesh->GetScale(), vec3( rotation * glm::vec4( mesh->GetOffset(), 1.0f ) ) );
+                break;
+            }
+            case GeometryType::MeshInstance:
+            {
+                MeshInstance* instance = static_cast<MeshInstance*>( geometry );
+                instance->SetTransform( rotation * instance->GetTransform() );
+                break;
+            }
+            default:
+                break;
+        }
+    } );
+}
+
 /// <summary>
 /// Prints information about the given CUDA device.
 /// </summary>
@@ -190,6 +332,11 @@ bool PrintCudaDeviceInfo( int32 device )
 void RunOpenGLScene( const LaunchParameters& params )
 {
     Scene scene( SceneRenderMode::ToOpenGL );
+    scene.SetModelInstanceCount( static_cast<uint32>( Math::Max( params.InstanceCount, 1 ) ) );
+    for ( const auto& path : params.ModelPaths )
+    {
+        scene.AddModel( path );
+    }
     if ( scene.Build( params.RenderWidth, params.RenderHeight, params.SampleCount, params.Fullscreen ) )
     {
         scene.Render();
@@ -202,7 +349,18 @@ void RunOpenGLScene( const LaunchParameters& params )
 /// <param name="frameCount">The total number of frames.</param>
 void RunImageScene( const LaunchParameters& params )
 {
-    Scene scene( SceneRenderMode::ToImage );
+    Scene scene( params.RenderMode );
+    scene.SetHostTileSize( params.TileSize );
+    scene.SetHostWorkerCount( params.WorkerCount );
+    scene.SetHostPacketTracing( params.UsePackets );
+    scene.SetHostWavefront( params.UseWavefront );
+    scene.SetLinearAccelBuild( params.LinearBuild );
+    scene.SetSpatialSplitBudget( params.SpatialBudget );
+    scene.SetModelInstanceCount( static_cast<uint32>( Math::Max( params.InstanceCount, 1 ) ) );
+    for ( const auto& path : params.ModelPaths )
+    {
+        scene.AddModel( path );
+    }
     if ( scene.Build( params.RenderWidth, params.RenderHeight, params.SampleCount ) )
     {
         // create our output directory
@@ -212,6 +370,10 @@ void RunImageScene( const LaunchParameters& params )
         uint32 uFrameCount = static_cast<uint32>( params.FrameCount );
         for ( uint32 i = 0; i < uFrameCount; ++i )
         {
+            if ( params.Animate && i > 0 )
+            {
+                AnimateScene( scene );
+            }
             RenderFrame( scene, i, uFrameCount );
         }
 
@@ -225,6 +387,123 @@ void RunImageScene( const LaunchParameters& params )
     }
 }
 
+/// <summary>
+/// Gets the paths to every model in the content directory, sorted by name.
+/// </summary>
+vector<String> GetContentModels()
+{
+    // the directory is relative to the project directory, which is where Visual Studio runs from
+    static const char* ContentDirectory = "../content/";
+    static const char* ModelExtension   = ".fbx";
+
+    vector<String> names;
+#if defined( _WIN32 ) || defined( _WIN64 )
+    WIN32_FIND_DATAA findData;
+    HANDLE           find = FindFirstFileA( ( String( ContentDirectory ) + "*" + ModelExtension ).c_str(), &findData );
+    if ( find != INVALID_HANDLE_VALUE )
+    {
+        do
+        {
+            if ( !( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) )
+            {
+                names.push_back( findData.cFileName );
+            }
+        } while ( FindNextFileA( find, &findData ) );
+        FindClose( find );
+    }
+#else
+    if ( DIR* directory = opendir( ContentDirectory ) )
+    {
+        const size_t extensionLength = strlen( ModelExtension );
+        while ( const dirent* entry = readdir( directory ) )
+        {
+            const size_t length = strlen( entry->d_name );
+            if ( length > extensionLength && 0 == strcmp( entry->d_name + length - extensionLength, ModelExtension ) )
+            {
+                names.push_back( entry->d_name );
+            }
+        }
+        closedir( directory );
+    }
+#endif
+
+    // sort the names so every run loads the models in the same order
+    sort( names.begin(), names.end() );
+
+    vector<String> paths;
+    for ( const auto& name : names )
+    {
+        paths.push_back( ContentDirectory + name );
+    }
+    return paths;
+}
+
+/// <summary>
+/// Builds and renders the same scene with each acceleration structure builder on the host, and compares how long
+/// each took to build and to trace. With no models given, every model in the content directory is used.
+/// </summary>
+void RunAccelBenchmark( const LaunchParameters& params )
+{
+    vector<String> modelPaths = params.ModelPaths;
+    if ( modelPaths.empty() )
+    {
+        modelPaths = GetContentModels();
+    }
+    if ( modelPaths.empty() )
+    {
+        REX_DEBUG_LOG( "No models to benchmark. Give one with --model, or run from the project directory." );
+        return;
+    }
+
+    // spatial splits get room for 30% more references unless a budget was given
+    const char*  builderNames[ 3 ] = { "SAH", "Linear", "Spatial" };
+    real64       buildTimes  [ 3 ] = { 0.0, 0.0, 0.0 };
+    real64       traceTimes  [ 3 ] = { 0.0, 0.0, 0.0 };
+    real64       memoryUsages[ 3 ] = { 0.0, 0.0, 0.0 };
+    const uint32 frameCount        = static_cast<uint32>( params.FrameCount );
+    const real32 spatialBudget     = ( params.SpatialBudget > 0.0f ) ? params.SpatialBudget : 0.3f;
+    for ( uint32 builder = 0; builder < 3; ++builder )
+    {
+        Scene scene( SceneRenderMode::ToHostImage );
+        scene.SetHostTileSize( params.TileSize );
+        scene.SetHostWorkerCount( params.WorkerCount );
+        scene.SetHostPacketTracing( params.UsePackets );
+        scene.SetHostWavefront( params.UseWavefront );
+        scene.SetLinearAccelBuild( builder == 1 );
+        scene.SetSpatialSplitBudget( ( builder == 2 ) ? spatialBudget : 0.0f );
+        scene.SetModelInstanceCount( static_cast<uint32>( Math::Max( params.InstanceCount, 1 ) ) );
+        for ( const auto& path : modelPaths )
+        {
+            scene.AddModel( path );
+        }
+        if ( !scene.Build( params.RenderWidth, params.RenderHeight, params.SampleCount ) )
+        {
+            return;
+        }
+
+        // every builder renders the same frames from the same places
+        Timer timer;
+        timer.Start();
+        for ( uint32 i = 0; i < frameCount; ++i )
+        {
+            PlaceCamera( scene, i, frameCount );
+            scene.Render();
+        }
+        timer.Stop();
+
+        buildTimes  [ builder ] = scene.GetAccelBuildTime();
+        traceTimes  [ builder ] = timer.GetElapsed() / frameCount;
+        memoryUsages[ builder ] = scene.GetAccelBytesPerPrimitive();
+    }
+
+    REX_DEBUG_LOG( "Acceleration structure benchmark (", modelPaths.size(), " models, ", frameCount, " frames):" );
+    for ( uint32 builder = 0; builder < 3; ++builder )
+    {
+        REX_DEBUG_LOG( "  ", builderNames[ builder ], ": build ", buildTimes[ builder ] * 1000.0, " ms, trace ",
+                       traceTimes[ builder ] * 1000.0, " ms per frame, ", memoryUsages[ builder ], " bytes per primitive" );
+    }
+}
+
 /// <summary>
 /// The program entry point.
 /// </summary>
@@ -232,14 +511,16 @@ void RunImageScene( const LaunchParameters& params )
 /// <param name="argv">The argument values.</param>
 int32 main( int32 argc, char** argv )
 {
-    // ensure we can configure the CUDA device
-    if ( !PrintCudaDeviceInfo( 0 ) )
+    // get the launch parameters
+    LaunchParameters params = GetPaunchParameters( argc, argv );
+
+    // ensure we can configure the CUDA device (host renders and benchmarks don't need one)
+    if ( params.RenderMode != SceneRenderMode::ToHostImage && !params.BenchmarkAccel && !PrintCudaDeviceInfo( 0 ) )
     {
         return -1;
     }
 
-    // get the launch parameters and ensure they're legit
-    LaunchParameters params = GetPaunchParameters( argc, argv );
+    // ensure the launch parameters are legit
     if ( params.RenderHeight < 1 || params.RenderWidth < 1 )
     {
         REX_DEBUG_LOG( "ERROR: Cannot render with dimensions less than 1x1." );
@@ -252,19 +533,29 @@ int32 main( int32 argc, char** argv )
         REX_DEBUG_LOG( "Given sample count: ", params.SampleCount );
         return -1;
     }
-    else if ( params.RenderMode == SceneRenderMode::ToImage && params.FrameCount < 1 )
+    else if ( ( params.RenderMode != SceneRenderMode::ToOpenGL || params.BenchmarkAccel ) && params.FrameCount < 1 )
     {
         REX_DEBUG_LOG( "ERROR: Cannot render to less than 1 image." );
         REX_DEBUG_LOG( "Given frame count: ", params.FrameCount );
         return -1;
     }
+    else if ( params.TileSize < 1 || params.WorkerCount < 0 )
+    {
+        REX_DEBUG_LOG( "ERROR: Host renders need a tile size of at least 1 and a non-negative worker count." );
+        REX_DEBUG_LOG( "Given tile size: ", params.TileSize, ", worker count: ", params.WorkerCount );
+        return -1;
+    }
 
     // run the scene
-    if ( params.RenderMode == SceneRenderMode::ToOpenGL )
+    if ( params.BenchmarkAccel )
+    {
+        RunAccelBenchmark( params );
+    }
+    else if ( params.RenderMode == SceneRenderMode::ToOpenGL )
     {
         RunOpenGLScene( params );
     }
-    else if ( params.RenderMode == SceneRenderMode::ToImage )
+    else
     {
         RunImageScene( params );
     }
@@ -0,0 +1,291 @@
+#include <rex/Graphics/Materials/MaterialTable.hxx>
+#include <rex/Graphics/ShadePoint.hxx>
+#include <rex/Utility/Logger.hxx>
+#include <cstring>
+
+#define MIN_BUCKET_COUNT 16     // must be a power of two
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Checks to see if two matte materials shade the same way.
+/// </summary>
+/// <param name="a">The first material.</param>
+/// <param name="b">The second material.</param>
+__both__ static bool IsSameMatte( const MatteMaterial& a, const MatteMaterial& b )
+{
+    return a.GetColor()              == b.GetColor()
+        && a.GetAmbientCoefficient() == b.GetAmbientCoefficient()
+        && a.GetDiffuseCoefficient() == b.GetDiffuseCoefficient();
+}
+
+/// <summary>
+/// Checks to see if two Phong materials shade the same way.
+/// </summary>
+/// <param name="a">The first material.</param>
+/// <param name="b">The second material.</param>
+__both__ static bool IsSamePhong( const PhongMaterial& a, const PhongMaterial& b )
+{
+    return IsSameMatte( a, b )
+        && a.GetSpecularCoefficient() == b.GetSpecularCoefficient()
+        && a.GetSpecularPower()       == b.GetSpecularPower();
+}
+
+/// <summary>
+/// Mixes a real number into a hash.
+/// </summary>
+/// <param name="hash">The hash so far.</param>
+/// <param name="value">The value to mix in.</param>
+__both__ static uint32 HashReal( uint32 hash, real32 value )
+{
+    // adding zero folds -0 into +0, since the two compare equal
+    value += 0.0f;
+    uint32 bits = 0;
+    memcpy( &bits, &value, sizeof( bits ) );
+
+    // FNV-1a a word at a time, with a shift so the high bits reach the bucket index too
+    hash = ( hash ^ bits ) * 16777619U;
+    return hash ^ ( hash >> 15 );
+}
+
+/// <summary>
+/// Hashes the parameters of a matte material.
+/// </summary>
+/// <param name="matte">The material.</param>
+__both__ static uint32 HashMatte( const MatteMaterial& matte )
+{
+    uint32 hash = 2166136261U;
+    hash = HashReal( hash, matte.GetColor().R );
+    hash = HashReal( hash, matte.GetColor().G );
+    hash = HashReal( hash, matte.GetColor().B );
+    hash = HashReal( hash, matte.GetAmbientCoefficient() );
+    hash = HashReal( hash, matte.GetDiffuseCoefficient() );
+    return hash;
+}
+
+/// <summary>
+/// Hashes the parameters of a Phong material.
+/// </summary>
+/// <param name="phong">The material.</param>
+__both__ static uint32 HashPhong( const PhongMaterial& phong )
+{
+    uint32 hash = HashMatte( phong );
+    hash = HashReal( hash, phong.GetSpecularCoefficient() );
+    hash = HashReal( hash, phong.GetSpecularPower() );
+    return hash;
+}
+
+// create a new material table
+__both__ MaterialTable::MaterialTable()
+{
+}
+
+// destroy this material table
+__both__ MaterialTable::~MaterialTable()
+{
+}
+
+// add a material, reusing an identical one if there is one
+__both__ uint32 MaterialTable::Add( const Material& material )
+{
+    const MaterialType type = material.GetType();
+    uint32             hash = 0;
+    switch ( type )
+    {
+        case MaterialType::Matte: hash = HashMatte( static_cast<const MatteMaterial&>( material ) ); break;
+        case MaterialType::Phong: hash = HashPhong( static_cast<const PhongMaterial&>( material ) ); break;
+        default:
+        {
+#if !defined( __CUDA_ARCH__ )
+            REX_DEBUG_LOG( "Failed to add material. Only matte and Phong materials can be stored in a table, so its geometry will shade magenta." );
+#else
+            printf( "Failed to add material. Only matte and Phong materials can be stored in a table, so its geometry will shade magenta.\n" );
+#endif
+            return REX_NO_MATERIAL;
+        }
+    }
+
+    // look for the same material, stepping to the next bucket on collisions
+    const uint32 mask = _buckets.GetSize() - 1;
+    for ( uint32 bucket = hash & mask; _buckets.GetSize() > 0 && _buckets[ bucket ] != 0; bucket = ( bucket + 1 ) & mask )
+    {
+        const uint32              index = _buckets[ bucket ] - 1;
+        const MaterialTableEntry& entry = _entries[ index ];
+        if ( entry.Type != type )
+        {
+            continue;
+        }
+
+        const bool same = ( type == MaterialType::Matte )
+                        ? IsSameMatte( _matte[ entry.Index ], static_cast<const MatteMaterial&>( material ) )
+                        : IsSamePhong( _phong[ entry.Index ], static_cast<const PhongMaterial&>( material ) );
+        if ( same )
+        {
+            return index;
+        }
+    }
+
+    // store the new material in the list for its type
+    MaterialTableEntry entry = { type, 0 };
+    if ( type == MaterialType::Matte )
+    {
+        entry.Index = _matte.GetSize();
+        _matte.Add( static_cast<const MatteMaterial&>( material ) );
+    }
+    else
+    {
+        entry.Index = _phong.GetSize();
+        _phong.Add( static_cast<const PhongMaterial&>( material ) );
+    }
+    _entries.Add( entry );
+
+    // keeping the buckets at most half full keeps the probes short
+    const uint32 index = _entries.GetSize() - 1;
+    if ( _entries.GetSize() * 2 > _buckets.GetSize() )
+    {
+        Rehash();
+    }
+    else
+    {
+        Insert( index, hash );
+    }
+    return index;
+}
+
+// remove every material
+__both__ void MaterialTable::Clear()
+{
+    _entries.Clear();
+    _matte.Clear();
+    _phong.Clear();
+    _buckets.Clear();
+}
+
+// get a material
+__both__ const Material* MaterialTable::Get( uint32 index ) const
+{
+    if ( index >= _entries.GetSize() )
+    {
+        return nullptr;
+    }
+
+    const MaterialTableEntry& entry = _entries[ index ];
+    switch ( entry.Type )
+    {
+        case MaterialType::Matte: return &_matte[ entry.Index ];
+        case MaterialType::Phong: return &_phong[ entry.Index ];
+        default:                  return nullptr;
+    }
+}
+
+// get the BRDF of a material for a light direction
+__both__ Color MaterialTable::GetBRDF( uint32 index, const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
+{
+    if ( index >= _entries.GetSize() )
+    {
+        return Color::Black();
+    }
+
+    const MaterialTableEntry& entry = _entries[ index ];
+    switch ( entry.Type )
+    {
+        case MaterialType::Matte: return _matte[ entry.Index ].MatteMaterial::GetBRDF( sp, wo, wi );
+        case MaterialType::Phong: return _phong[ entry.Index ].PhongMaterial::GetBRDF( sp, wo, wi );
+        default:                  return Color::Black();
+    }
+}
+
+// get the number of bytes used
+__both__ uint64 MaterialTable::GetBytesUsed() const
+{
+    return static_cast<uint64>( _entries.GetSize() ) * sizeof( MaterialTableEntry )
+         + static_cast<uint64>( _matte.GetSize() )   * sizeof( MatteMaterial )
+         + static_cast<uint64>( _phong.GetSize() )   * sizeof( PhongMaterial )
+         + static_cast<uint64>( _buckets.GetSize() ) * sizeof( uint32 );
+}
+
+// get the number of bytes reserved
+__both__ uint64 MaterialTable::GetBytesReserved() const
+{
+    return static_cast<uint64>( _entries.GetCapacity() ) * sizeof( MaterialTableEntry )
+         + static_cast<uint64>( _matte.GetCapacity() )   * sizeof( MatteMaterial )
+         + static_cast<uint64>( _phong.GetCapacity() )   * sizeof( PhongMaterial )
+         + static_cast<uint64>( _buckets.GetCapacity() ) * sizeof( uint32 );
+}
+
+// hash one of the materials
+__both__ uint32 MaterialTable::Hash( const MaterialTableEntry& entry ) const
+{
+    return ( entry.Type == MaterialType::Matte ) ? HashMatte( _matte[ entry.Index ] )
+                                                 : HashPhong( _phong[ entry.Index ] );
+}
+
+// put an entry in the first empty bucket for its hash
+__both__ void MaterialTable::Insert( uint32 index, uint32 hash )
+{
+    const uint32 mask   = _buckets.GetSize() - 1;
+    uint32       bucket = hash & mask;
+    while ( _buckets[ bucket ] != 0 )
+    {
+        bucket = ( bucket + 1 ) & mask;
+    }
+    _buckets[ bucket ] = index + 1;
+}
+
+// rebuild the buckets with room for twice as many entries
+__both__ void MaterialTable::Rehash()
+{
+    // resizing from empty leaves every bucket empty
+    const uint32 bucketCount = Math::Max( static_cast<uint32>( MIN_BUCKET_COUNT ), _buckets.GetSize() * 2 );
+    _buckets.Clear();
+    _buckets.Resize( bucketCount );
+
+    for ( uint32 i = 0; i < _entries.GetSize(); ++i )
+    {
+        Insert( i, Hash( _entries[ i ] ) );
+    }
+}
+
+// get the number of materials
+__both__ uint32 MaterialTable::GetSize() const
+{
+    return _entries.GetSize();
+}
+
+// shade with a material
+__both__ Color MaterialTable::Shade( uint32 index, ShadePoint& sp ) const
+{
+    if ( index >= _entries.GetSize() )
+    {
+        return Color::Magenta();
+    }
+
+    // the qualified calls skip the virtual tables
+    const MaterialTableEntry& entry = _entries[ index ];
+    switch ( entry.Type )
+    {
+        case MaterialType::Matte: return _matte[ entry.Index ].MatteMaterial::Shade( sp );
+        case MaterialType::Phong: return _phong[ entry.Index ].PhongMaterial::Shade( sp );
+        default:                  return Color::Magenta();
+    }
+}
+
+// shade with a material's ambient light
+__both__ Color MaterialTable::ShadeAmbient( uint32 index, ShadePoint& sp ) const
+{
+    if ( index >= _entries.GetSize() )
+    {
+        return Color::Magenta();
+    }
+
+    // both kinds of material reflect the ambient light the same way
+    const MaterialTableEntry& entry = _entries[ index ];
+    switch ( entry.Type )
+    {
+        case MaterialType::Matte: return _matte[ entry.Index ].MatteMaterial::ShadeAmbient( sp );
+        case MaterialType::Phong: return _phong[ entry.Index ].MatteMaterial::ShadeAmbient( sp );
+        default:                  return Color::Magenta();
+    }
+}
+
+REX_NS_END
\ No newline at end of file
@@ -54,6 +54,24 @@ int64 Math::Round( real64 value )
         : Math::Ceiling( value - 0.5 );
 }
 
+// spreads the lower 16 bits of a value out to the even bits
+static __both__ uint32 SpreadBits2D( uint32 value )
+{
+    // derived from https://fgiesen.wordpress.com/2009/12/13/decoding-morton-codes/
+    value &= 0x0000FFFF;
+    value  = ( value | ( value << 8 ) ) & 0x00FF00FF;
+    value  = ( value | ( value << 4 ) ) & 0x0F0F0F0F;
+    value  = ( value | ( value << 2 ) ) & 0x33333333;
+    value  = ( value | ( value << 1 ) ) & 0x55555555;
+    return value;
+}
+
+// get 2D Morton code
+uint32 Math::Morton2D( uint32 x, uint32 y )
+{
+    return SpreadBits2D( x ) | ( SpreadBits2D( y ) << 1 );
+}
+
 // transform a vec3
 vec3 Math::Transform( const vec3& vec, const mat4& mat )
 {
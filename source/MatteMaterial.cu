@@ -1,29 +1,30 @@
 #include <rex/Graphics/Materials/MatteMaterial.hxx>
+#include <rex/Graphics/Lights/LightTable.hxx>
 #include <rex/Graphics/Scene.hxx>
 #include <rex/Utility/GC.hxx>
 
 REX_NS_BEGIN
 
 // create material
-__device__ MatteMaterial::MatteMaterial()
+__both__ MatteMaterial::MatteMaterial()
     : MatteMaterial( Color::White(), 0.0f, 0.0f, MaterialType::Matte )
 {
 }
 
 // create material w/ color
-__device__ MatteMaterial::MatteMaterial( const Color& color )
+__both__ MatteMaterial::MatteMaterial( const Color& color )
     : MatteMaterial( color, 0.0f, 0.0f, MaterialType::Matte )
 {
 }
 
 // create material w/ color, ambient coefficient, and diffuse coefficient
-__device__ MatteMaterial::MatteMaterial( const Color& color, real32 ka, real32 kd )
+__both__ MatteMaterial::MatteMaterial( const Color& color, real32 ka, real32 kd )
     : MatteMaterial( color, ka, kd, MaterialType::Matte )
 {
 }
 
 // create material w/ color, ambient coefficient, diffuse coefficient, and material type
-__device__ MatteMaterial::MatteMaterial( const Color& color, real32 ka, real32 kd, MaterialType type )
+__both__ MatteMaterial::MatteMaterial( const Color& color, real32 ka, real32 kd, MaterialType type )
     : Material( type ),
       _ambient( ka, color ),
       _diffuse( kd, color )
@@ -31,126 +32,101 @@ __device__ MatteMaterial::MatteMaterial( const Color& color, real32 ka, real32 k
 }
 
 // destroy material
-__device__ MatteMaterial::~MatteMaterial()
+__both__ MatteMaterial::~MatteMaterial()
 {
 }
 
 // get area light shaded color
-__device__ Color MatteMaterial::AreaLightShade( ShadePoint& sp ) const
+__both__ Color MatteMaterial::AreaLightShade( ShadePoint& sp ) const
 {
-    // adapted from Suffern, 332
-    vec3  wo    = -sp.Ray.Direction;
-    Color color = _ambient.GetBHR( sp, wo ) * sp.AmbientLight->GetRadiance( sp );
-
-    for ( uint32 i = 0; i < sp.LightCount; ++i )
-    {
-        const Light* light  = sp.Lights[ i ];
-        vec3         wi     = light->GetLightDirection( sp );
-        real32       angle  = glm::dot( sp.Normal, wi );
-        
-        if ( angle > 0.0f )
-        {
-            // calculate shadow information
-            Ray   shadowRay   = Ray( sp.HitPoint, wi );
-            bool  isInShadow  = light->CastsShadows() && light->IsInShadow( shadowRay, sp );
-            Color diffuse     = _diffuse.GetBRDF( sp, wo, wi );
-            Color shadowColor = diffuse * light->GetRadiance( sp ) * angle
-                              * light->GetGeometricFactor( sp ) * light->GetGeometricArea( sp );
-
-            // calculate the color with a branchless conditional
-            color += Color::Lerp( shadowColor,
-                                  Color::Black(),
-                                  static_cast<real32>( isInShadow ) );
-        }
-    }
-
-    return color;
+    // none of the table's lights have an area, so their geometric factors and areas would all be one
+    return MatteMaterial::Shade( sp );
 }
 
-// copy this material
-__device__ Material* MatteMaterial::Copy() const
+// get ka
+__both__ real32 MatteMaterial::GetAmbientCoefficient() const
 {
-    // create the copy of the material
-    MatteMaterial* mat = new MatteMaterial( _ambient.GetDiffuseColor(),
-                                            _ambient.GetDiffuseCoefficient(),
-                                            _diffuse.GetDiffuseCoefficient() );
-    return mat;
+    return _ambient.GetDiffuseCoefficient();
 }
 
-// get ka
-__device__ real32 MatteMaterial::GetAmbientCoefficient() const
+// get the BRDF for a light direction
+__both__ Color MatteMaterial::GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
 {
-    return _ambient.GetDiffuseCoefficient();
+    return _diffuse.GetBRDF( sp, wo, wi );
 }
 
 // get color
-__device__ Color MatteMaterial::GetColor() const
+__both__ Color MatteMaterial::GetColor() const
 {
     // both ambient and diffuse have the same color
     return _ambient.GetDiffuseColor();
 }
 
 // get kd
-__device__ real32 MatteMaterial::GetDiffuseCoefficient() const
+__both__ real32 MatteMaterial::GetDiffuseCoefficient() const
 {
     return _diffuse.GetDiffuseCoefficient();
 }
 
 // get shaded color
-__device__ Color MatteMaterial::Shade( ShadePoint& sp ) const
+__both__ Color MatteMaterial::Shade( ShadePoint& sp ) const
 {
     // from Suffern, 271
-    vec3  wo    = -sp.Ray.Direction;
-    Color color = _ambient.GetBHR( sp, wo ) * sp.AmbientLight->GetRadiance( sp );
+    vec3       wo    = -sp.Ray.Direction;
+    Color      color = MatteMaterial::ShadeAmbient( sp );
+    LightBatch batch;
 
-    // go through all of the lights in the scene
-    for ( uint32 i = 0; i < sp.LightCount; ++i )
+    // go through all of the lights in the scene a batch at a time
+    for ( uint32 first = 0; sp.Lights->GetBatch( sp, first, batch ); first += batch.Count )
     {
-        const Light*  light = sp.Lights[ i ];
-        vec3          wi    = light->GetLightDirection( sp );
-        real32        angle = glm::dot( sp.Normal, wi );
-
-
-        if ( angle > 0.0f )
+        for ( uint32 i = 0; i < batch.Count; ++i )
         {
-            // calculate shadow information
-            Ray   shadowRay   = Ray( sp.HitPoint, wi );
-            bool  isInShadow  = light->CastsShadows() && light->IsInShadow( shadowRay, sp );
-            Color diffuse     = _diffuse.GetBRDF( sp, wo, wi );
-            Color shadowColor = diffuse * light->GetRadiance( sp ) * angle;
-
-            // calculate the color with a branchless conditional
-            color += Color::Lerp( shadowColor,
-                                  Color::Black(),
-                                  static_cast<real32>( isInShadow ) );
+            if ( batch.Angle[ i ] > 0.0f )
+            {
+                // calculate shadow information
+                vec3  wi          = vec3( batch.DirectionX[ i ], batch.DirectionY[ i ], batch.DirectionZ[ i ] );
+                bool  isInShadow  = LightTable::IsInShadow( sp, batch, i );
+                Color shadowColor = MatteMaterial::GetBRDF( sp, wo, wi ) * batch.Radiance[ i ] * batch.Angle[ i ];
+
+                // calculate the color with a branchless conditional
+                color += Color::Lerp( shadowColor,
+                                      Color::Black(),
+                                      static_cast<real32>( isInShadow ) );
+            }
         }
     }
 
     return color;
 }
 
+// get the ambient shaded color
+__both__ Color MatteMaterial::ShadeAmbient( ShadePoint& sp ) const
+{
+    return _ambient.GetBHR( sp, -sp.Ray.Direction ) * sp.AmbientLight->GetRadiance( sp );
+}
+
 // set ka
-__device__ void MatteMaterial::SetAmbientCoefficient( real32 ka )
+__both__ void MatteMaterial::SetAmbientCoefficient( real32 ka )
 {
     _ambient.SetDiffuseCoefficient( ka );
 }
 
 // set color
-__device__ void MatteMaterial::SetColor( const Color& color )
+__both__ void MatteMaterial::SetColor( const Color& color )
 {
     _ambient.SetDiffuseColor( color );
     _diffuse.SetDiffuseColor( color );
 }
 
 // set color w/ components
-__device__ void MatteMaterial::SetColor( real32 r, real32 g, real32 b )
+__both__ void MatteMaterial::SetColor( real32 r, real32 g, real32 b )
 {
     Color color = Color( r, g, b );
     SetColor( color );
 }
 
 // set kd
-__device__ void MatteMaterial::SetDiffuseCoefficient( real32 kd )
+__both__ void MatteMaterial::SetDiffuseCoefficient( real32 kd )
 {
     _diffuse.SetDiffuseCoefficient( kd );
 }
@@ -0,0 +1,573 @@
+#include <rex/Graphics/Geometry/Mesh.hxx>
+#include <rex/Graphics/ShadePoint.hxx>
+
+REX_NS_BEGIN
+
+// create empty mesh data
+__both__ MeshData::MeshData()
+    : PositionX  ( nullptr )
+    , PositionY  ( nullptr )
+    , PositionZ  ( nullptr )
+    , NormalX    ( nullptr )
+    , NormalY    ( nullptr )
+    , NormalZ    ( nullptr )
+    , Indices    ( nullptr )
+    , Triangles  ( nullptr )
+    , VertexCount( 0 )
+    , IndexCount ( 0 )
+{
+}
+
+// create a triangle's intersection data from the given mesh data
+__both__ static TriangleData CreateTriangleData( const MeshData& data, uint32 triangle )
+{
+    const uint32 v1 = data.Indices[ triangle * 3     ];
+    const uint32 v2 = data.Indices[ triangle * 3 + 1 ];
+    const uint32 v3 = data.Indices[ triangle * 3 + 2 ];
+    return TriangleData( vec3( data.PositionX[ v1 ], data.PositionY[ v1 ], data.PositionZ[ v1 ] ),
+                         vec3( data.PositionX[ v2 ], data.PositionY[ v2 ], data.PositionZ[ v2 ] ),
+                         vec3( data.PositionX[ v3 ], data.PositionY[ v3 ], data.PositionZ[ v3 ] ) );
+}
+
+// create a new mesh
+__both__ Mesh::Mesh( uint32 material )
+    : Geometry  ( GeometryType::Mesh, material )
+    , _scale    ( 1.0f )
+    , _hierarchy( nullptr )
+{
+}
+
+// destroy mesh
+__both__ Mesh::~Mesh()
+{
+    ClearHierarchy();
+}
+
+// get mesh bounds
+__both__ BoundingBox Mesh::GetBounds() const
+{
+    // the hierarchy already knows, and is kept up to date with the vertices
+    if ( _hierarchy )
+    {
+        return _hierarchy->GetBounds();
+    }
+
+    const uint32 vertexCount = GetVertexCount();
+    if ( vertexCount == 0 )
+    {
+        return BoundingBox( vec3(), vec3() );
+    }
+
+    vec3 min = GetPosition( 0 );
+    vec3 max = min;
+    for ( uint32 i = 1; i < vertexCount; ++i )
+    {
+        const vec3 position = GetPosition( i );
+        min = glm::min( min, position );
+        max = glm::max( max, position );
+    }
+
+    return BoundingBox( min, max );
+}
+
+// get the number of triangles
+__both__ uint32 Mesh::GetPrimitiveCount() const
+{
+    return GetTriangleCount();
+}
+
+// get the bounds of a triangle
+__both__ BoundingBox Mesh::GetPrimitiveBounds( uint32 primitive ) const
+{
+    vec3 p1, p2, p3;
+    GetTrianglePoints( primitive, p1, p2, p3 );
+
+    vec3 min = glm::min( glm::min( p1, p2 ), p3 );
+    vec3 max = glm::max( glm::max( p1, p2 ), p3 );
+    return BoundingBox( min, max );
+}
+
+// get the bounds of the part of a triangle inside a box
+__both__ BoundingBox Mesh::GetClippedPrimitiveBounds( uint32 primitive, const BoundingBox& clip ) const
+{
+    vec3 p1, p2, p3;
+    GetTrianglePoints( primitive, p1, p2, p3 );
+    return Triangle::GetClippedBounds( p1, p2, p3, clip );
+}
+
+// get the vertex count
+__both__ uint32 Mesh::GetVertexCount() const
+{
+    return _data.VertexCount;
+}
+
+// get the triangle count
+__both__ uint32 Mesh::GetTriangleCount() const
+{
+    return _data.IndexCount / 3;
+}
+
+// check if every vertex has a normal
+__both__ bool Mesh::HasNormals() const
+{
+    return _data.NormalX != nullptr;
+}
+
+// get the mesh data
+__both__ const MeshData& Mesh::GetData() const
+{
+    return _data;
+}
+
+// get the scale
+__both__ real32 Mesh::GetScale() const
+{
+    return _scale;
+}
+
+// get the offset
+__both__ const vec3& Mesh::GetOffset() const
+{
+    return _offset;
+}
+
+// set the placement
+__both__ void Mesh::SetPlacement( real32 scale, const vec3& offset )
+{
+    _scale  = scale;
+    _offset = offset;
+
+    // every triangle moves the same way, so the hierarchy stays just as good once it's refit
+    if ( _hierarchy )
+    {
+        _hierarchy->Refit();
+    }
+}
+
+// build the triangle hierarchy
+__both__ bool Mesh::BuildHierarchy()
+{
+    ClearHierarchy();
+
+    _hierarchy = new BVH( GetBounds() );
+    if ( !_hierarchy->Add( this ) || !_hierarchy->Build() )
+    {
+        ClearHierarchy();
+        return false;
+    }
+
+#if !defined( __CUDA_ARCH__ )
+    // hierarchies built on the host are only ever walked on the host
+    _hierarchy->MakeHostOnly();
+#endif
+    return true;
+}
+
+// get the triangle hierarchy
+__both__ const BVH* Mesh::GetHierarchy() const
+{
+    return _hierarchy;
+}
+
+// delete the triangle hierarchy
+__both__ void Mesh::ClearHierarchy()
+{
+    if ( _hierarchy )
+    {
+        delete _hierarchy;
+        _hierarchy = nullptr;
+    }
+}
+
+// clear the lists
+__both__ void Mesh::ClearLists()
+{
+    _positionX.Clear();
+    _positionY.Clear();
+    _positionZ.Clear();
+    _normalX  .Clear();
+    _normalY  .Clear();
+    _normalZ  .Clear();
+    _indices  .Clear();
+    _triangles.Clear();
+}
+
+// point the mesh data at the lists
+__both__ void Mesh::UpdateData()
+{
+    // normals only count if every vertex has one
+    const uint32 vertexCount = _positionX.GetSize();
+    const bool   hasNormals  = ( vertexCount > 0 ) && ( _normalX.GetSize() == vertexCount );
+
+    _data.PositionX   = ( vertexCount > 0 ) ? &_positionX[ 0 ] : nullptr;
+    _data.PositionY   = ( vertexCount > 0 ) ? &_positionY[ 0 ] : nullptr;
+    _data.PositionZ   = ( vertexCount > 0 ) ? &_positionZ[ 0 ] : nullptr;
+    _data.NormalX     = hasNormals ? &_normalX[ 0 ] : nullptr;
+    _data.NormalY     = hasNormals ? &_normalY[ 0 ] : nullptr;
+    _data.NormalZ     = hasNormals ? &_normalZ[ 0 ] : nullptr;
+    _data.Indices     = ( _indices  .GetSize() > 0 ) ? &_indices  [ 0 ] : nullptr;
+    _data.Triangles   = ( _triangles.GetSize() > 0 ) ? &_triangles[ 0 ] : nullptr;
+    _data.VertexCount = vertexCount;
+    _data.IndexCount  = _indices.GetSize();
+}
+
+// get a vertex's position
+__both__ vec3 Mesh::GetPosition( uint32 vertex ) const
+{
+    const vec3 position( _data.PositionX[ vertex ], _data.PositionY[ vertex ], _data.PositionZ[ vertex ] );
+    return position * _scale + _offset;
+}
+
+// get a triangle's points
+__both__ void Mesh::GetTrianglePoints( uint32 triangle, vec3& p1, vec3& p2, vec3& p3 ) const
+{
+    const uint32 index = triangle * 3;
+    p1 = GetPosition( _data.Indices[ index     ] );
+    p2 = GetPosition( _data.Indices[ index + 1 ] );
+    p3 = GetPosition( _data.Indices[ index + 2 ] );
+}
+
+// get a triangle's intersection data
+__both__ TriangleData Mesh::GetTriangleData( uint32 triangle ) const
+{
+    // the normal doesn't change under a positive uniform scale
+    TriangleData data = _data.Triangles[ triangle ];
+    data.Origin = data.Origin * _scale + _offset;
+    data.Edge1 *= _scale;
+    data.Edge2 *= _scale;
+    return data;
+}
+
+// intersect a ray with a triangle
+__both__ bool Mesh::IntersectTriangle( uint32 triangle, const Ray& ray, real32& tmin, real32& beta, real32& gamma ) const
+{
+#if REX_WATERTIGHT_TRIANGLES
+    vec3 p1, p2, p3;
+    GetTrianglePoints( triangle, p1, p2, p3 );
+    return Triangle::IntersectWatertight( p1, p2, p3, ray, tmin, beta, gamma );
+#else
+    return GetTriangleData( triangle ).Intersect( ray, tmin, beta, gamma );
+#endif
+}
+
+// get the normal at a point on a triangle
+__both__ vec3 Mesh::GetNormal( uint32 triangle, real32 beta, real32 gamma ) const
+{
+    // without vertex normals every point on the triangle just uses the face normal
+    if ( !HasNormals() )
+    {
+        return _data.Triangles[ triangle ].Normal;
+    }
+
+    const uint32 index = triangle * 3;
+    const uint32 v1    = _data.Indices[ index     ];
+    const uint32 v2    = _data.Indices[ index + 1 ];
+    const uint32 v3    = _data.Indices[ index + 2 ];
+
+    const real32 alpha  = real32( 1.0 ) - beta - gamma;
+    const vec3   normal = alpha * vec3( _data.NormalX[ v1 ], _data.NormalY[ v1 ], _data.NormalZ[ v1 ] )
+                        + beta  * vec3( _data.NormalX[ v2 ], _data.NormalY[ v2 ], _data.NormalZ[ v2 ] )
+                        + gamma * vec3( _data.NormalX[ v3 ], _data.NormalY[ v3 ], _data.NormalZ[ v3 ] );
+    return glm::normalize( normal );
+}
+
+// reserve space for vertices and triangles
+__both__ void Mesh::Reserve( uint32 vertexCount, uint32 triangleCount )
+{
+    _positionX.Reserve( vertexCount );
+    _positionY.Reserve( vertexCount );
+    _positionZ.Reserve( vertexCount );
+    _indices  .Reserve( triangleCount * 3 );
+    _triangles.Reserve( triangleCount );
+}
+
+// add a vertex without a normal
+__both__ uint32 Mesh::AddVertex( const vec3& position )
+{
+    const uint32 index = _positionX.GetSize();
+    _positionX.Add( position.x );
+    _positionY.Add( position.y );
+    _positionZ.Add( position.z );
+    UpdateData();
+    return index;
+}
+
+// add a vertex with a normal
+__both__ uint32 Mesh::AddVertex( const vec3& position, const vec3& normal )
+{
+    // normals only line up with their vertices if every vertex before this one had one too
+    if ( _normalX.GetSize() == _positionX.GetSize() )
+    {
+        if ( _normalX.GetSize() == 0 )
+        {
+            _normalX.Reserve( _positionX.GetCapacity() );
+            _normalY.Reserve( _positionY.GetCapacity() );
+            _normalZ.Reserve( _positionZ.GetCapacity() );
+        }
+
+        _normalX.Add( normal.x );
+        _normalY.Add( normal.y );
+        _normalZ.Add( normal.z );
+    }
+
+    return AddVertex( position );
+}
+
+// add a triangle
+__both__ bool Mesh::AddTriangle( uint32 v1, uint32 v2, uint32 v3 )
+{
+    const uint32 vertexCount = _positionX.GetSize();
+    if ( ( v1 >= vertexCount ) || ( v2 >= vertexCount ) || ( v3 >= vertexCount ) )
+    {
+        return false;
+    }
+
+    ClearHierarchy();
+    _indices  .Add( v1 );
+    _indices  .Add( v2 );
+    _indices  .Add( v3 );
+    _triangles.Add( TriangleData( vec3( _positionX[ v1 ], _positionY[ v1 ], _positionZ[ v1 ] ),
+                                  vec3( _positionX[ v2 ], _positionY[ v2 ], _positionZ[ v2 ] ),
+                                  vec3( _positionX[ v3 ], _positionY[ v3 ], _positionZ[ v3 ] ) ) );
+    UpdateData();
+    return true;
+}
+
+// move a vertex
+__both__ bool Mesh::SetVertexPosition( uint32 vertex, const vec3& position )
+{
+    // shared data doesn't belong to us
+    if ( vertex >= _positionX.GetSize() || _data.PositionX != &_positionX[ 0 ] )
+    {
+        return false;
+    }
+
+    _positionX[ vertex ] = position.x;
+    _positionY[ vertex ] = position.y;
+    _positionZ[ vertex ] = position.z;
+    return true;
+}
+
+// bring the triangles and hierarchy up to date with the vertices
+__both__ void Mesh::Refit()
+{
+    // only triangle data we computed ourselves can have fallen behind
+    const uint32 triangleCount = GetTriangleCount();
+    if ( _triangles.GetSize() == triangleCount )
+    {
+        for ( uint32 i = 0; i < triangleCount; ++i )
+        {
+            _triangles[ i ] = CreateTriangleData( _data, i );
+        }
+    }
+
+    if ( _hierarchy )
+    {
+        _hierarchy->Refit();
+    }
+}
+
+// replace the mesh's data
+__both__ bool Mesh::SetData( const MeshData& data )
+{
+    ClearHierarchy();
+    ClearLists();
+    UpdateData();
+
+    // ensure the data is complete before copying any of it
+    if ( !data.PositionX || !data.PositionY || !data.PositionZ || ( data.IndexCount % 3 ) != 0 ||
+         ( data.IndexCount > 0 && !data.Indices ) )
+    {
+        return false;
+    }
+    for ( uint32 i = 0; i < data.IndexCount; ++i )
+    {
+        if ( data.Indices[ i ] >= data.VertexCount )
+        {
+            return false;
+        }
+    }
+
+    _positionX.AddRange( data.PositionX, data.VertexCount );
+    _positionY.AddRange( data.PositionY, data.VertexCount );
+    _positionZ.AddRange( data.PositionZ, data.VertexCount );
+    if ( data.NormalX && data.NormalY && data.NormalZ )
+    {
+        _normalX.AddRange( data.NormalX, data.VertexCount );
+        _normalY.AddRange( data.NormalY, data.VertexCount );
+        _normalZ.AddRange( data.NormalZ, data.VertexCount );
+    }
+    _indices.AddRange( data.Indices, data.IndexCount );
+
+    const uint32 triangleCount = data.IndexCount / 3;
+    if ( data.Triangles )
+    {
+        _triangles.AddRange( data.Triangles, triangleCount );
+    }
+    else
+    {
+        _triangles.Reserve( triangleCount );
+        for ( uint32 i = 0; i < triangleCount; ++i )
+        {
+            _triangles.Add( CreateTriangleData( data, i ) );
+        }
+    }
+
+    UpdateData();
+    return true;
+}
+
+// use shared mesh data
+__both__ bool Mesh::SetSharedData( const MeshData& data )
+{
+    ClearHierarchy();
+    ClearLists();
+    UpdateData();
+
+    if ( !data.PositionX || !data.PositionY || !data.PositionZ || ( data.IndexCount % 3 ) != 0 ||
+         ( data.IndexCount > 0 && !data.Indices ) )
+    {
+        return false;
+    }
+    for ( uint32 i = 0; i < data.IndexCount; ++i )
+    {
+        if ( data.Indices[ i ] >= data.VertexCount )
+        {
+            return false;
+        }
+    }
+
+    _data = data;
+    if ( !( data.NormalX && data.NormalY && data.NormalZ ) )
+    {
+        _data.NormalX = nullptr;
+        _data.NormalY = nullptr;
+        _data.NormalZ = nullptr;
+    }
+
+    // the triangle data is the only thing we'll keep a copy of, and only if we have to
+    const uint32 triangleCount = data.IndexCount / 3;
+    if ( !data.Triangles && triangleCount > 0 )
+    {
+        _triangles.Reserve( triangleCount );
+        for ( uint32 i = 0; i < triangleCount; ++i )
+        {
+            _triangles.Add( CreateTriangleData( data, i ) );
+        }
+        _data.Triangles = &_triangles[ 0 ];
+    }
+
+    return true;
+}
+
+// fill in the shading point for a hit
+__both__ void Mesh::GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const
+{
+    sp.Normal   = GetNormal( hit.Primitive, hit.Beta, hit.Gamma );
+    sp.HitPoint = ray.Origin + hit.T * ray.Direction;
+    sp.Material = _material;
+}
+
+// hit mesh
+__both__ bool Mesh::Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const
+{
+    if ( _hierarchy )
+    {
+        return _hierarchy->QueryIntersections( ray, tmin, hit ) != nullptr;
+    }
+
+    // without an acceleration structure to narrow things down, every triangle has to be checked
+    const uint32 triangleCount = GetTriangleCount();
+    real32       closest       = Math::HugeValue();
+    uint32       closestIndex  = triangleCount;
+    real32       closestBeta   = 0.0f;
+    real32       closestGamma  = 0.0f;
+    real32       t             = 0.0f;
+    real32       beta          = 0.0f;
+    real32       gamma         = 0.0f;
+
+    for ( uint32 i = 0; i < triangleCount; ++i )
+    {
+        if ( IntersectTriangle( i, ray, t, beta, gamma ) && ( t < closest ) )
+        {
+            closest      = t;
+            closestIndex = i;
+            closestBeta  = beta;
+            closestGamma = gamma;
+        }
+    }
+
+    if ( closestIndex == triangleCount )
+    {
+        return false;
+    }
+
+    tmin          = closest;
+    hit.Object    = this;
+    hit.Primitive = closestIndex;
+    hit.T         = closest;
+    hit.Beta      = closestBeta;
+    hit.Gamma     = closestGamma;
+    return true;
+}
+
+// shadow-hit mesh
+__both__ bool Mesh::ShadowHit( const Ray& ray, real32& tmin ) const
+{
+    // the caller decides whether the hit is close enough to block anything, so it needs the nearest one
+    if ( _hierarchy )
+    {
+        HitRecord hit;
+        return _hierarchy->QueryIntersections( ray, tmin, hit ) != nullptr;
+    }
+
+    const uint32 triangleCount = GetTriangleCount();
+    real32       closest       = Math::HugeValue();
+    bool         hit           = false;
+    real32       t             = 0.0f;
+    real32       beta          = 0.0f;
+    real32       gamma         = 0.0f;
+
+    for ( uint32 i = 0; i < triangleCount; ++i )
+    {
+        if ( IntersectTriangle( i, ray, t, beta, gamma ) && ( t < closest ) )
+        {
+            closest = t;
+            hit     = true;
+        }
+    }
+
+    if ( hit )
+    {
+        tmin = closest;
+    }
+    return hit;
+}
+
+// hit a triangle
+__both__ bool Mesh::HitPrimitive( uint32 primitive, const Ray& ray, real32& tmin, HitRecord& hit ) const
+{
+    real32 beta  = 0.0f;
+    real32 gamma = 0.0f;
+    if ( !IntersectTriangle( primitive, ray, tmin, beta, gamma ) )
+    {
+        return false;
+    }
+
+    hit.Object    = this;
+    hit.Primitive = primitive;
+    hit.T         = tmin;
+    hit.Beta      = beta;
+    hit.Gamma     = gamma;
+    return true;
+}
+
+// shadow-hit a triangle
+__both__ bool Mesh::ShadowHitPrimitive( uint32 primitive, const Ray& ray, real32& tmin ) const
+{
+    real32 beta  = 0.0f;
+    real32 gamma = 0.0f;
+    return IntersectTriangle( primitive, ray, tmin, beta, gamma );
+}
+
+REX_NS_END
\ No newline at end of file
@@ -0,0 +1,484 @@
+#include <rex/Graphics/MeshCache.hxx>
+#include <rex/Graphics/ModelImporter.hxx>
+#include <rex/Utility/Logger.hxx>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined( _WIN32 ) || defined( _WIN64 )
+#  define WIN32_LEAN_AND_MEAN
+#  define VC_EXTRALEAN
+#  define NOMINMAX
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+
+// the extension added to a model file's path to get its cache file's path
+#define MESH_CACHE_EXTENSION   ".rexmesh"
+
+// the magic string and version at the start of every cache file
+#define MESH_CACHE_MAGIC       "REXMESH"
+#define MESH_CACHE_VERSION     2
+
+// the layout of the structures a cache file holds as they are, so a cache written by a build whose triangle data
+// or mesh table entries differ is rejected instead of misread
+#define MESH_CACHE_LAYOUT      ( static_cast<uint32>( sizeof( TriangleData ) ) << 16 | static_cast<uint32>( sizeof( MeshCacheEntry ) ) )
+
+// the alignment of every array in a cache file
+#define MESH_CACHE_ALIGNMENT   64
+
+// the mesh flag set when a mesh has vertex normals
+#define MESH_CACHE_HAS_NORMALS 1
+
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Gets the size and modification time of the given file. Returns false if the file doesn't exist.
+/// </summary>
+/// <param name="path">The path to the file.</param>
+/// <param name="size">The size of the file.</param>
+/// <param name="time">The modification time of the file.</param>
+static bool GetFileStamp( const String& path, uint64& size, int64& time )
+{
+    struct stat info;
+    if ( stat( path.c_str(), &info ) != 0 )
+    {
+        return false;
+    }
+
+    size = static_cast<uint64>( info.st_size );
+    time = static_cast<int64>( info.st_mtime );
+    return true;
+}
+
+/// <summary>
+/// Rounds the given file offset up to the cache's array alignment.
+/// </summary>
+/// <param name="offset">The offset.</param>
+static uint64 AlignOffset( uint64 offset )
+{
+    return ( offset + MESH_CACHE_ALIGNMENT - 1 ) & ~uint64( MESH_CACHE_ALIGNMENT - 1 );
+}
+
+/// <summary>
+/// Checks to see if the given array lies inside of a file of the given size and is aligned.
+/// </summary>
+/// <param name="offset">The offset of the array.</param>
+/// <param name="bytes">The size of the array.</param>
+/// <param name="fileSize">The size of the file.</param>
+static bool IsArrayValid( uint64 offset, uint64 bytes, uint64 fileSize )
+{
+    return ( offset % MESH_CACHE_ALIGNMENT == 0 ) && ( offset <= fileSize ) && ( bytes <= fileSize - offset );
+}
+
+// create a new mesh cache
+MeshCache::MeshCache()
+    : _memory( nullptr )
+    , _size  ( 0 )
+{
+}
+
+// destroy this mesh cache
+MeshCache::~MeshCache()
+{
+    Close();
+}
+
+// get the header
+const MeshCacheHeader* MeshCache::GetHeader() const
+{
+    return reinterpret_cast<const MeshCacheHeader*>( _memory );
+}
+
+// get a mesh's table entry
+const MeshCacheEntry* MeshCache::GetEntry( uint32 mesh ) const
+{
+    return reinterpret_cast<const MeshCacheEntry*>( _memory + sizeof( MeshCacheHeader ) ) + mesh;
+}
+
+// check that the mapped file can be used
+bool MeshCache::Validate() const
+{
+    // check the header
+    const MeshCacheHeader* header = GetHeader();
+    if ( _size < sizeof( MeshCacheHeader )                                      ||
+         memcmp( header->Magic, MESH_CACHE_MAGIC, sizeof( header->Magic ) ) != 0 ||
+         header->Version  != MESH_CACHE_VERSION                                 ||
+         header->Layout   != MESH_CACHE_LAYOUT                                  ||
+         header->FileSize != _size )
+    {
+        return false;
+    }
+
+    // check the tables
+    const uint64 tableSize = sizeof( MeshCacheEntry ) * uint64( header->MeshCount )
+                           + sizeof( real32 ) * 3     * uint64( header->MaterialCount );
+    if ( tableSize > _size - sizeof( MeshCacheHeader ) )
+    {
+        return false;
+    }
+
+    // check that every mesh's arrays are inside of the file
+    for ( uint32 i = 0; i < header->MeshCount; ++i )
+    {
+        const MeshCacheEntry* entry         = GetEntry( i );
+        const uint64          positionBytes = sizeof( real32 )       * uint64( entry->VertexCount );
+        const uint64          indexBytes    = sizeof( uint32 )       * uint64( entry->IndexCount );
+        const uint64          triangleBytes = sizeof( TriangleData ) * uint64( entry->IndexCount / 3 );
+        if ( ( entry->IndexCount % 3 ) != 0 || entry->Material >= header->MaterialCount )
+        {
+            return false;
+        }
+
+        for ( uint32 axis = 0; axis < 3; ++axis )
+        {
+            if ( !IsArrayValid( entry->PositionOffset[ axis ], positionBytes, _size ) ||
+                 ( ( entry->Flags & MESH_CACHE_HAS_NORMALS ) && !IsArrayValid( entry->NormalOffset[ axis ], positionBytes, _size ) ) )
+            {
+                return false;
+            }
+        }
+
+        if ( !IsArrayValid( entry->IndexOffset, indexBytes, _size ) || !IsArrayValid( entry->TriangleOffset, triangleBytes, _size ) )
+        {
+            return false;
+        }
+
+        // every index has to name one of the mesh's vertices, since the meshes will use the indices as they are
+        const uint32* indices = reinterpret_cast<const uint32*>( _memory + entry->IndexOffset );
+        for ( uint32 index = 0; index < entry->IndexCount; ++index )
+        {
+            if ( indices[ index ] >= entry->VertexCount )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// get the cache path for a model file
+String MeshCache::GetCachePath( const String& sourcePath )
+{
+    return sourcePath + MESH_CACHE_EXTENSION;
+}
+
+// write the cache file for a model file
+bool MeshCache::Write( const String& sourcePath, const std::vector<const ImportedMesh*>& meshes )
+{
+    const uint32 meshCount = static_cast<uint32>( meshes.size() );
+
+    // fill in the header
+    MeshCacheHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.Magic, MESH_CACHE_MAGIC, sizeof( header.Magic ) );
+    header.Version   = MESH_CACHE_VERSION;
+    header.Layout    = MESH_CACHE_LAYOUT;
+    header.MeshCount = meshCount;
+    GetFileStamp( sourcePath, header.SourceSize, header.SourceTime );
+
+
+    // give every distinct diffuse color its own material
+    std::vector<Color>          materials;
+    std::vector<MeshCacheEntry> entries( meshCount );
+    for ( uint32 i = 0; i < meshCount; ++i )
+    {
+        const Color& diffuse  = meshes[ i ]->Diffuse;
+        uint32       material = 0;
+        while ( material < materials.size() && !( materials[ material ] == diffuse ) )
+        {
+            ++material;
+        }
+        if ( material == materials.size() )
+        {
+            materials.push_back( diffuse );
+        }
+
+        memset( &entries[ i ], 0, sizeof( MeshCacheEntry ) );
+        entries[ i ].Material = material;
+    }
+    header.MaterialCount = static_cast<uint32>( materials.size() );
+
+
+    // lay out every mesh's arrays after the tables
+    uint64 offset = sizeof( MeshCacheHeader ) + sizeof( MeshCacheEntry ) * meshCount + sizeof( real32 ) * 3 * materials.size();
+    auto   place  = [ &offset ]( uint64 bytes )
+    {
+        const uint64 start = AlignOffset( offset );
+        offset = start + bytes;
+        return start;
+    };
+    for ( uint32 i = 0; i < meshCount; ++i )
+    {
+        const ImportedMesh& mesh    = *meshes[ i ];
+        const MeshData      data    = mesh.GetData();
+        const BoundingBox   bounds  = mesh.GetBounds();
+        MeshCacheEntry&     entry   = entries[ i ];
+
+        entry.VertexCount = data.VertexCount;
+        entry.IndexCount  = data.IndexCount;
+        entry.Flags       = data.NormalX ? MESH_CACHE_HAS_NORMALS : 0;
+        for ( uint32 axis = 0; axis < 3; ++axis )
+        {
+            entry.BoundsMin[ axis ] = bounds.GetMin()[ axis ];
+            entry.BoundsMax[ axis ] = bounds.GetMax()[ axis ];
+        }
+        for ( uint32 axis = 0; axis < 3; ++axis )
+        {
+            entry.PositionOffset[ axis ] = place( sizeof( real32 ) * data.VertexCount );
+        }
+        if ( data.NormalX )
+        {
+            for ( uint32 axis = 0; axis < 3; ++axis )
+            {
+                entry.NormalOffset[ axis ] = place( sizeof( real32 ) * data.VertexCount );
+            }
+        }
+        entry.IndexOffset    = place( sizeof( uint32 ) * data.IndexCount );
+        entry.TriangleOffset = place( sizeof( TriangleData ) * ( data.IndexCount / 3 ) );
+    }
+    header.FileSize = offset;
+
+
+    // now write everything out, padding up to each array
+    const String  path = GetCachePath( sourcePath );
+    std::ofstream file( path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    uint64        written = 0;
+    auto          write   = [ &file, &written ]( uint64 at, const void* bytes, uint64 count )
+    {
+        static const char padding[ MESH_CACHE_ALIGNMENT ] = { 0 };
+        file.write( padding, static_cast<std::streamsize>( at - written ) );
+        file.write( static_cast<const char*>( bytes ), static_cast<std::streamsize>( count ) );
+        written = at + count;
+    };
+    if ( !file )
+    {
+        REX_DEBUG_LOG( "Failed to create mesh cache '", path, "'." );
+        return false;
+    }
+
+    write( 0, &header, sizeof( header ) );
+    write( written, entries.data(), sizeof( MeshCacheEntry ) * meshCount );
+    for ( const Color& material : materials )
+    {
+        const real32 color[ 3 ] = { material.R, material.G, material.B };
+        write( written, color, sizeof( color ) );
+    }
+
+    std::vector<TriangleData> triangles;
+    for ( uint32 i = 0; i < meshCount; ++i )
+    {
+        const ImportedMesh&   mesh  = *meshes[ i ];
+        const MeshCacheEntry& entry = entries[ i ];
+        write( entry.PositionOffset[ 0 ], mesh.PositionX.data(), sizeof( real32 ) * entry.VertexCount );
+        write( entry.PositionOffset[ 1 ], mesh.PositionY.data(), sizeof( real32 ) * entry.VertexCount );
+        write( entry.PositionOffset[ 2 ], mesh.PositionZ.data(), sizeof( real32 ) * entry.VertexCount );
+        if ( entry.Flags & MESH_CACHE_HAS_NORMALS )
+        {
+            write( entry.NormalOffset[ 0 ], mesh.NormalX.data(), sizeof( real32 ) * entry.VertexCount );
+            write( entry.NormalOffset[ 1 ], mesh.NormalY.data(), sizeof( real32 ) * entry.VertexCount );
+            write( entry.NormalOffset[ 2 ], mesh.NormalZ.data(), sizeof( real32 ) * entry.VertexCount );
+        }
+        write( entry.IndexOffset, mesh.Indices.data(), sizeof( uint32 ) * entry.IndexCount );
+
+        // the triangle data is what lets the meshes skip all of their setup when they're loaded
+        triangles.resize( entry.IndexCount / 3 );
+        for ( uint32 t = 0; t < triangles.size(); ++t )
+        {
+            const uint32 v1 = mesh.Indices[ t * 3     ];
+            const uint32 v2 = mesh.Indices[ t * 3 + 1 ];
+            const uint32 v3 = mesh.Indices[ t * 3 + 2 ];
+            triangles[ t ] = TriangleData( vec3( mesh.PositionX[ v1 ], mesh.PositionY[ v1 ], mesh.PositionZ[ v1 ] ),
+                                           vec3( mesh.PositionX[ v2 ], mesh.PositionY[ v2 ], mesh.PositionZ[ v2 ] ),
+                                           vec3( mesh.PositionX[ v3 ], mesh.PositionY[ v3 ], mesh.PositionZ[ v3 ] ) );
+        }
+        write( entry.TriangleOffset, triangles.data(), sizeof( TriangleData ) * triangles.size() );
+    }
+
+    // don't leave a partial file behind to be rejected on every run
+    file.close();
+    if ( !file )
+    {
+        REX_DEBUG_LOG( "Failed to write mesh cache '", path, "'." );
+        std::remove( path.c_str() );
+        return false;
+    }
+    return true;
+}
+
+// map the cache file for a model file
+bool MeshCache::Open( const String& sourcePath )
+{
+    Close();
+
+    // map the whole file read-only
+    const String path = GetCachePath( sourcePath );
+#if defined( _WIN32 ) || defined( _WIN64 )
+    HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        return false;
+    }
+
+    // the view keeps the file mapped on its own, so the handles can be closed right away
+    LARGE_INTEGER size;
+    HANDLE        mapping = nullptr;
+    const void*   view    = nullptr;
+    if ( GetFileSizeEx( file, &size ) && size.QuadPart > 0 )
+    {
+        mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        view    = mapping ? MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+    }
+    if ( mapping )
+    {
+        CloseHandle( mapping );
+    }
+    CloseHandle( file );
+    if ( !view )
+    {
+        return false;
+    }
+
+    _memory = static_cast<const uint8*>( view );
+    _size   = static_cast<uint64>( size.QuadPart );
+#else
+    const int32 file = open( path.c_str(), O_RDONLY );
+    if ( file < 0 )
+    {
+        return false;
+    }
+
+    // the mapping keeps the file open on its own, so the descriptor can be closed right away
+    struct stat info;
+    void*       view = MAP_FAILED;
+    if ( fstat( file, &info ) == 0 && info.st_size > 0 )
+    {
+        view = mmap( nullptr, static_cast<size_t>( info.st_size ), PROT_READ, MAP_PRIVATE, file, 0 );
+    }
+    close( file );
+    if ( view == MAP_FAILED )
+    {
+        return false;
+    }
+
+    _memory = static_cast<const uint8*>( view );
+    _size   = static_cast<uint64>( info.st_size );
+#endif
+
+
+    // make sure the cache is one we can use
+    if ( !Validate() )
+    {
+        REX_DEBUG_LOG( "Ignoring damaged mesh cache '", path, "'." );
+        Close();
+        return false;
+    }
+
+    uint64 sourceSize = 0;
+    int64  sourceTime = 0;
+    if ( GetFileStamp( sourcePath, sourceSize, sourceTime ) &&
+         ( sourceSize != GetHeader()->SourceSize || sourceTime != GetHeader()->SourceTime ) )
+    {
+        REX_DEBUG_LOG( "Ignoring out of date mesh cache '", path, "'." );
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+// unmap the cache file
+void MeshCache::Close()
+{
+    if ( _memory )
+    {
+#if defined( _WIN32 ) || defined( _WIN64 )
+        UnmapViewOfFile( _memory );
+#else
+        munmap( const_cast<uint8*>( _memory ), static_cast<size_t>( _size ) );
+#endif
+        _memory = nullptr;
+        _size   = 0;
+    }
+}
+
+// check if a file is mapped
+bool MeshCache::IsOpen() const
+{
+    return _memory != nullptr;
+}
+
+// get the mesh count
+uint32 MeshCache::GetMeshCount() const
+{
+    return _memory ? GetHeader()->MeshCount : 0;
+}
+
+// get the total triangle count
+uint64 MeshCache::GetTriangleCount() const
+{
+    uint64 count = 0;
+    for ( uint32 i = 0; i < GetMeshCount(); ++i )
+    {
+        count += GetEntry( i )->IndexCount / 3;
+    }
+    return count;
+}
+
+// get a mesh's data
+MeshData MeshCache::GetMeshData( uint32 mesh ) const
+{
+    const MeshCacheEntry* entry = GetEntry( mesh );
+
+    MeshData data;
+    data.PositionX   = reinterpret_cast<const real32*>( _memory + entry->PositionOffset[ 0 ] );
+    data.PositionY   = reinterpret_cast<const real32*>( _memory + entry->PositionOffset[ 1 ] );
+    data.PositionZ   = reinterpret_cast<const real32*>( _memory + entry->PositionOffset[ 2 ] );
+    data.Indices     = reinterpret_cast<const uint32*>( _memory + entry->IndexOffset );
+    data.Triangles   = reinterpret_cast<const TriangleData*>( _memory + entry->TriangleOffset );
+    data.VertexCount = entry->VertexCount;
+    data.IndexCount  = entry->IndexCount;
+    if ( entry->Flags & MESH_CACHE_HAS_NORMALS )
+    {
+        data.NormalX = reinterpret_cast<const real32*>( _memory + entry->NormalOffset[ 0 ] );
+        data.NormalY = reinterpret_cast<const real32*>( _memory + entry->NormalOffset[ 1 ] );
+        data.NormalZ = reinterpret_cast<const real32*>( _memory + entry->NormalOffset[ 2 ] );
+    }
+    return data;
+}
+
+// get a mesh's bounds
+BoundingBox MeshCache::GetMeshBounds( uint32 mesh ) const
+{
+    const MeshCacheEntry* entry = GetEntry( mesh );
+    return BoundingBox( vec3( entry->BoundsMin[ 0 ], entry->BoundsMin[ 1 ], entry->BoundsMin[ 2 ] ),
+                        vec3( entry->BoundsMax[ 0 ], entry->BoundsMax[ 1 ], entry->BoundsMax[ 2 ] ) );
+}
+
+// get a mesh's material
+uint32 MeshCache::GetMeshMaterial( uint32 mesh ) const
+{
+    return GetEntry( mesh )->Material;
+}
+
+// get the material count
+uint32 MeshCache::GetMaterialCount() const
+{
+    return _memory ? GetHeader()->MaterialCount : 0;
+}
+
+// get a material's diffuse color
+Color MeshCache::GetMaterialColor( uint32 material ) const
+{
+    const real32* colors = reinterpret_cast<const real32*>( GetEntry( GetMeshCount() ) );
+    return Color( colors[ material * 3 ], colors[ material * 3 + 1 ], colors[ material * 3 + 2 ] );
+}
+
+REX_NS_END
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include <rex/Graphics/Geometry/MeshInstance.hxx>
+#include <rex/Graphics/ShadePoint.hxx>
+
+REX_NS_BEGIN
+
+// create a new mesh instance
+__both__ MeshInstance::MeshInstance( const Mesh* mesh, const mat4& transform )
+    : Geometry( GeometryType::MeshInstance )
+    , _mesh   ( mesh )
+    , _bounds ( vec3(), vec3() )
+{
+    SetTransform( transform );
+}
+
+// create a new mesh instance with its own material
+__both__ MeshInstance::MeshInstance( const Mesh* mesh, const mat4& transform, uint32 material )
+    : Geometry( GeometryType::MeshInstance, material )
+    , _mesh   ( mesh )
+    , _bounds ( vec3(), vec3() )
+{
+    SetTransform( transform );
+}
+
+// destroy mesh instance
+__both__ MeshInstance::~MeshInstance()
+{
+    _mesh = nullptr;
+}
+
+// set the transform
+__both__ void MeshInstance::SetTransform( const mat4& transform )
+{
+    _transform        = transform;
+    _inverseTransform = glm::inverse( transform );
+
+    // the scene bounds are the bounds of the mesh's transformed corners
+    const BoundingBox meshBounds = _mesh->GetBounds();
+    const vec3&       min        = meshBounds.GetMin();
+    const vec3&       max        = meshBounds.GetMax();
+    for ( uint32 i = 0; i < 8; ++i )
+    {
+        const vec3 corner( ( i & 1 ) ? max.x : min.x,
+                           ( i & 2 ) ? max.y : min.y,
+                           ( i & 4 ) ? max.z : min.z );
+        const vec3 point( _transform * glm::vec4( corner, 1.0f ) );
+        if ( i == 0 )
+        {
+            _bounds = BoundingBox( point, point );
+        }
+        else
+        {
+            _bounds.Merge( point );
+        }
+    }
+}
+
+// move a ray into the mesh's space
+__both__ Ray MeshInstance::ToMeshSpace( const Ray& ray ) const
+{
+    return Ray( vec3( _inverseTransform * glm::vec4( ray.Origin,    1.0f ) ),
+                vec3( _inverseTransform * glm::vec4( ray.Direction, 0.0f ) ) );
+}
+
+// get the instance bounds
+__both__ BoundingBox MeshInstance::GetBounds() const
+{
+    return _bounds;
+}
+
+// get the mesh
+__both__ const Mesh* MeshInstance::GetMesh() const
+{
+    return _mesh;
+}
+
+// get the transform
+__both__ const mat4& MeshInstance::GetTransform() const
+{
+    return _transform;
+}
+
+// fill in the shading point for a hit
+__both__ void MeshInstance::GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const
+{
+    _mesh->GetShadePoint( ToMeshSpace( ray ), hit, sp );
+
+    // normals go back out through the inverse transpose, which keeps them perpendicular under non-uniform scales
+    sp.Normal   = glm::normalize( vec3( glm::vec4( sp.Normal, 0.0f ) * _inverseTransform ) );
+    sp.HitPoint = ray.Origin + hit.T * ray.Direction;
+    if ( _material != REX_NO_MATERIAL )
+    {
+        sp.Material = _material;
+    }
+}
+
+// hit mesh instance
+__both__ bool MeshInstance::Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const
+{
+    // the hit distances are the same in both spaces, so the mesh's record only needs to point back at us
+    if ( !_mesh->Hit( ToMeshSpace( ray ), tmin, hit ) )
+    {
+        return false;
+    }
+
+    hit.Object = this;
+    return true;
+}
+
+// shadow-hit mesh instance
+__both__ bool MeshInstance::ShadowHit( const Ray& ray, real32& tmin ) const
+{
+    return _mesh->ShadowHit( ToMeshSpace( ray ), tmin );
+}
+
+REX_NS_END
\ No newline at end of file
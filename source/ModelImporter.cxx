@@ -0,0 +1,287 @@
+#include <rex/Graphics/ModelImporter.hxx>
+#include <rex/Utility/Logger.hxx>
+#include <rex/Utility/Timer.hxx>
+#include <rex/Math/Math.hxx>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+
+// bake node transforms into the vertices so converting only has to copy meshes, and only generate smooth
+// normals for meshes that have none
+#define IMPORT_FLAGS ( aiProcess_Triangulate            \
+                     | aiProcess_JoinIdenticalVertices  \
+                     | aiProcess_GenSmoothNormals       \
+                     | aiProcess_PreTransformVertices   \
+                     | aiProcess_SortByPType )
+
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Runs the given job once for every index in [0, count), handing indices out to workers as they finish.
+/// </summary>
+/// <param name="count">The number of indices.</param>
+/// <param name="workerCount">The number of worker threads.</param>
+/// <param name="job">The job to run.</param>
+template<typename Job> static void RunJobs( uint32 count, uint32 workerCount, const Job& job )
+{
+    std::atomic<uint32> next( 0 );
+    auto work = [ &next, &job, count ]()
+    {
+        for ( uint32 i = next++; i < count; i = next++ )
+        {
+            job( i );
+        }
+    };
+
+    // the calling thread works too
+    workerCount = Math::Min( Math::Max( workerCount, 1U ), Math::Max( count, 1U ) );
+    std::vector<std::thread> workers;
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        workers.emplace_back( work );
+    }
+    work();
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+}
+
+/// <summary>
+/// Converts an Assimp mesh into an imported mesh. Returns false if the mesh has no triangles.
+/// </summary>
+/// <param name="scene">The scene the mesh belongs to.</param>
+/// <param name="source">The Assimp mesh.</param>
+/// <param name="mesh">The mesh to fill in.</param>
+static bool ConvertMesh( const aiScene* scene, const aiMesh* source, ImportedMesh& mesh )
+{
+    // points and lines are sorted into their own meshes, which we can't render
+    if ( !( source->mPrimitiveTypes & aiPrimitiveType_TRIANGLE ) || source->mNumVertices == 0 )
+    {
+        return false;
+    }
+
+
+    // copy the vertices
+    const uint32 vertexCount = source->mNumVertices;
+    mesh.PositionX.resize( vertexCount );
+    mesh.PositionY.resize( vertexCount );
+    mesh.PositionZ.resize( vertexCount );
+    for ( uint32 i = 0; i < vertexCount; ++i )
+    {
+        mesh.PositionX[ i ] = source->mVertices[ i ].x;
+        mesh.PositionY[ i ] = source->mVertices[ i ].y;
+        mesh.PositionZ[ i ] = source->mVertices[ i ].z;
+    }
+
+    if ( source->HasNormals() )
+    {
+        mesh.NormalX.resize( vertexCount );
+        mesh.NormalY.resize( vertexCount );
+        mesh.NormalZ.resize( vertexCount );
+        for ( uint32 i = 0; i < vertexCount; ++i )
+        {
+            mesh.NormalX[ i ] = source->mNormals[ i ].x;
+            mesh.NormalY[ i ] = source->mNormals[ i ].y;
+            mesh.NormalZ[ i ] = source->mNormals[ i ].z;
+        }
+    }
+
+
+    // copy the triangles (triangulation leaves every face with three indices)
+    mesh.Indices.reserve( source->mNumFaces * 3 );
+    for ( uint32 i = 0; i < source->mNumFaces; ++i )
+    {
+        const aiFace& face = source->mFaces[ i ];
+        if ( face.mNumIndices == 3 )
+        {
+            mesh.Indices.push_back( face.mIndices[ 0 ] );
+            mesh.Indices.push_back( face.mIndices[ 1 ] );
+            mesh.Indices.push_back( face.mIndices[ 2 ] );
+        }
+    }
+
+
+    // get the material's diffuse color, falling back to white
+    aiColor3D diffuse( 1.0f, 1.0f, 1.0f );
+    if ( source->mMaterialIndex < scene->mNumMaterials )
+    {
+        scene->mMaterials[ source->mMaterialIndex ]->Get( AI_MATKEY_COLOR_DIFFUSE, diffuse );
+    }
+    mesh.Diffuse = Color( diffuse.r, diffuse.g, diffuse.b );
+
+    return mesh.Indices.size() > 0;
+}
+
+// get imported mesh data
+MeshData ImportedMesh::GetData() const
+{
+    MeshData data;
+    data.PositionX   = PositionX.data();
+    data.PositionY   = PositionY.data();
+    data.PositionZ   = PositionZ.data();
+    data.Indices     = Indices.data();
+    data.VertexCount = static_cast<uint32>( PositionX.size() );
+    data.IndexCount  = static_cast<uint32>( Indices.size() );
+    if ( NormalX.size() == PositionX.size() )
+    {
+        data.NormalX = NormalX.data();
+        data.NormalY = NormalY.data();
+        data.NormalZ = NormalZ.data();
+    }
+    return data;
+}
+
+// get imported mesh bounds
+BoundingBox ImportedMesh::GetBounds() const
+{
+    if ( PositionX.empty() )
+    {
+        return BoundingBox( vec3(), vec3() );
+    }
+
+    vec3 min( PositionX[ 0 ], PositionY[ 0 ], PositionZ[ 0 ] );
+    vec3 max = min;
+    for ( size_t i = 1; i < PositionX.size(); ++i )
+    {
+        const vec3 position( PositionX[ i ], PositionY[ i ], PositionZ[ i ] );
+        min = glm::min( min, position );
+        max = glm::max( max, position );
+    }
+    return BoundingBox( min, max );
+}
+
+// create a new model importer
+ModelImporter::ModelImporter()
+    : _importTime ( 0.0 )
+    , _convertTime( 0.0 )
+{
+}
+
+// destroy this model importer
+ModelImporter::~ModelImporter()
+{
+}
+
+// add a file to import
+void ModelImporter::AddFile( const String& path )
+{
+    _paths.push_back( path );
+}
+
+// get the file count
+uint32 ModelImporter::GetFileCount() const
+{
+    return static_cast<uint32>( _paths.size() );
+}
+
+// get the imported meshes
+std::vector<ImportedMesh>& ModelImporter::GetMeshes()
+{
+    return _meshes;
+}
+
+// get the imported meshes
+const std::vector<ImportedMesh>& ModelImporter::GetMeshes() const
+{
+    return _meshes;
+}
+
+// get the imported triangle count
+uint64 ModelImporter::GetTriangleCount() const
+{
+    uint64 count = 0;
+    for ( const auto& mesh : _meshes )
+    {
+        count += mesh.Indices.size() / 3;
+    }
+    return count;
+}
+
+// get the import phase time
+real64 ModelImporter::GetImportTime() const
+{
+    return _importTime;
+}
+
+// get the convert phase time
+real64 ModelImporter::GetConvertTime() const
+{
+    return _convertTime;
+}
+
+// import every file
+bool ModelImporter::Import( uint32 workerCount )
+{
+    const uint32 fileCount = GetFileCount();
+    _meshes.clear();
+
+
+    // have Assimp read every file (each importer owns its scene, so every file needs its own)
+    std::vector<std::unique_ptr<Assimp::Importer>> importers( fileCount );
+    std::vector<const aiScene*>                    scenes   ( fileCount, nullptr );
+    Timer                                          timer;
+
+    timer.Start();
+    RunJobs( fileCount, workerCount, [ this, &importers, &scenes ]( uint32 file )
+    {
+        importers[ file ].reset( new Assimp::Importer() );
+        scenes   [ file ] = importers[ file ]->ReadFile( _paths[ file ], IMPORT_FLAGS );
+    } );
+    timer.Stop();
+    _importTime = timer.GetElapsed();
+
+
+    // convert every file's meshes
+    std::vector<std::vector<ImportedMesh>> fileMeshes( fileCount );
+
+    timer.Start();
+    RunJobs( fileCount, workerCount, [ &scenes, &fileMeshes ]( uint32 file )
+    {
+        const aiScene* scene = scenes[ file ];
+        if ( !scene )
+        {
+            return;
+        }
+
+        fileMeshes[ file ].reserve( scene->mNumMeshes );
+        for ( uint32 i = 0; i < scene->mNumMeshes; ++i )
+        {
+            ImportedMesh mesh;
+            mesh.File = file;
+            if ( ConvertMesh( scene, scene->mMeshes[ i ], mesh ) )
+            {
+                fileMeshes[ file ].push_back( std::move( mesh ) );
+            }
+        }
+    } );
+    timer.Stop();
+    _convertTime = timer.GetElapsed();
+
+
+    // gather the meshes in file order and report any failures
+    bool allImported = true;
+    for ( uint32 file = 0; file < fileCount; ++file )
+    {
+        if ( !scenes[ file ] )
+        {
+            REX_DEBUG_LOG( "Failed to import '", _paths[ file ], "'. Reason: ", importers[ file ]->GetErrorString() );
+            allImported = false;
+            continue;
+        }
+
+        for ( auto& mesh : fileMeshes[ file ] )
+        {
+            _meshes.push_back( std::move( mesh ) );
+        }
+    }
+
+    return allImported;
+}
+
+REX_NS_END
\ No newline at end of file
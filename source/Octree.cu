@@ -5,6 +5,9 @@
 #include <rex/Math/Math.hxx>
 #include <rex/Utility/GC.hxx>
 #include <rex/Utility/Logger.hxx>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 
 #define DEFAULT_MAX_ITEM_COUNT 12
@@ -14,27 +17,39 @@
 REX_NS_BEGIN
 
 // create a new bounding box / geometry pair
-__device__ BoundsGeometryPair::BoundsGeometryPair()
-    : Bounds( vec3(), vec3() )
+__both__ BoundsGeometryPair::BoundsGeometryPair()
+    : Bounds   ( vec3(), vec3() )
+    , Index    ( 0 )
+    , Primitive( 0 )
+{
+}
+
+// create a new octree node
+__both__ OctreeNode::OctreeNode()
+    : Bounds     ( vec3(), vec3() )
+    , FirstChild ( 0 )
+    , ObjectStart( 0 )
+    , ObjectCount( 0 )
 {
 }
 
 // create an octree w/ bounds
-__device__ Octree::Octree( const BoundingBox& bounds )
+__both__ Octree::Octree( const BoundingBox& bounds )
     : Octree( bounds, DEFAULT_MAX_ITEM_COUNT )
 {
 }
 
 // create an octree w/ min and max corner
-__device__ Octree::Octree( const vec3& min, const vec3& max )
+__both__ Octree::Octree( const vec3& min, const vec3& max )
     : Octree( BoundingBox( min, max ), DEFAULT_MAX_ITEM_COUNT )
 {
 }
 
 // create an octree w/ bounds and max item count
-__device__ Octree::Octree( const BoundingBox& bounds, uint32 maxItemCount )
+__both__ Octree::Octree( const BoundingBox& bounds, uint32 maxItemCount )
     : _bounds( bounds )
     , _countBeforeSubivide( maxItemCount )
+    , _arena( &_nodeArena )
 {
     // avoid a loop but clear out the children
     _children[ 0 ] = nullptr;
@@ -48,48 +63,108 @@ __device__ Octree::Octree( const BoundingBox& bounds, uint32 maxItemCount )
 }
 
 // create an octree w/ min corner, max corner, and max item count
-__device__ Octree::Octree( const vec3& min, const vec3& max, uint32 maxItemCount )
+__both__ Octree::Octree( const vec3& min, const vec3& max, uint32 maxItemCount )
     : Octree( BoundingBox( min, max ), maxItemCount )
 {
 }
 
+// create an octree from an already-flattened one
+__both__ Octree::Octree( const BoundingBox& bounds, const OctreeNode* nodes, uint32 nodeCount, const uint32* objectIndices, uint32 indexCount, const BoundsGeometryPair* objects, uint32 objectCount )
+    : Octree( bounds, DEFAULT_MAX_ITEM_COUNT )
+{
+    _nodes.AddRange( nodes, nodeCount );
+    _objectIndices.AddRange( objectIndices, indexCount );
+    _objectTable.AddRange( objects, objectCount );
+}
+
 // destroy this octree
-__device__ Octree::~Octree()
+__both__ Octree::~Octree()
 {
+    DestroyChildren();
+}
+
+// destroy this octree's children
+__both__ void Octree::DestroyChildren()
+{
+    // the children's memory belongs to the root's arena, so they only need their destructors run
     if ( HasSubdivided() )
     {
         for ( uint32 i = 0; i < 8; ++i )
         {
-            delete _children[ i ];
+            _children[ i ]->~Octree();
             _children[ i ] = nullptr;
         }
     }
 }
 
 // get the octree's bounds
-__device__ const BoundingBox& Octree::GetBounds() const
+__both__ const BoundingBox& Octree::GetBounds() const
 {
     return _bounds;
 }
 
+// get the flattened nodes
+__both__ const DeviceList<OctreeNode>& Octree::GetNodes() const
+{
+    return _nodes;
+}
+
+// get the flattened object indices
+__both__ const DeviceList<uint32>& Octree::GetObjectIndices() const
+{
+    return _objectIndices;
+}
+
+// get the number of bytes used by this octree
+__host__ uint64 Octree::GetMemoryUsage() const
+{
+    return static_cast<uint64>( _nodes.GetSize() )         * sizeof( OctreeNode )
+         + static_cast<uint64>( _objectIndices.GetSize() ) * sizeof( uint32 )
+         + static_cast<uint64>( _objectTable.GetSize() )   * sizeof( BoundsGeometryPair );
+}
+
 // check if this octree has subdivided
-__device__ bool Octree::HasSubdivided() const
+__both__ bool Octree::HasSubdivided() const
 {
     return _children[ 0 ] != nullptr;
 }
 
+// get the child visiting order for a direction
+__both__ uint32 Octree::GetChildOrder( const vec3& direction )
+{
+    // children are numbered so that +X sets bit 1, -Y sets bit 2, and -Z sets bit 0 (see Subdivide), so
+    // flipping the bits of the axes the ray travels "backwards" along makes child 0 the one it reaches first
+    return ( direction.x < 0.0f ? 2 : 0 )
+         | ( direction.y > 0.0f ? 4 : 0 )
+         | ( direction.z > 0.0f ? 1 : 0 );
+}
+
+// query the intersections of the given ray and fill in the shade point of the closest hit
+__both__ const Geometry* Octree::QueryIntersections( const Ray& ray, real32& dist, ShadePoint& sp ) const
+{
+    // the shade point is only worth filling in once the closest hit is known
+    HitRecord       hit;
+    const Geometry* geom = QueryIntersections( ray, dist, hit );
+    if ( geom )
+    {
+        geom->GetShadePoint( ray, hit, sp );
+    }
+    return geom;
+}
+
 // query the intersections of the given ray and return the closest hit object
-__device__ const Geometry* Octree::QueryIntersections( const Ray& ray, real32& dist, ShadePoint& sp ) const
+__both__ const Geometry* Octree::QueryIntersections( const Ray& ray, real32& dist, HitRecord& hit ) const
 {
     // reset the distance
     dist = Math::HugeValue();
 
 
     // make sure the ray even intersects us
-    real32 tempDist = 0.0;
-    if ( _bounds.Intersects( ray, tempDist ) )
+    const vec3 invDirection = 1.0f / ray.Direction;
+    real32     tempDist     = 0.0;
+    if ( ( _nodes.GetSize() > 0 ) && _nodes[ 0 ].Bounds.Intersects( ray, invDirection, tempDist ) )
     {
-        return QueryIntersectionsForReal( ray, dist, sp );
+        return QueryIntersectionsForReal( 0, ray, invDirection, dist, hit );
     }
 
 
@@ -98,43 +173,42 @@ __device__ const Geometry* Octree::QueryIntersections( const Ray& ray, real32& d
 }
 
 // queries the intersections for real this time
-__device__ const Geometry* Octree::QueryIntersectionsForReal( const Ray& ray, real32& dist, ShadePoint& sp ) const
+__both__ const Geometry* Octree::QueryIntersectionsForReal( uint32 nodeIndex, const Ray& ray, const vec3& invDirection, real32& dist, HitRecord& hit ) const
 {
-    const Geometry* closest   = nullptr;
-    real32          tempDist  = 0.0;
-    ShadePoint      tempPoint = sp;
+    const OctreeNode& node      = _nodes[ nodeIndex ];
+    const Geometry*   closest   = nullptr;
+    real32            tempDist  = 0.0;
+    HitRecord         tempHit;
 
-    // check our children first
-    if ( HasSubdivided() )
+    // check our objects first, since a close hit here lets us skip entire children
+    for ( uint32 i = node.ObjectStart; i < node.ObjectStart + node.ObjectCount; ++i )
     {
-        for ( uint32 i = 0; i < 8; ++i )
+        const BoundsGeometryPair& pair = _objectTable[ _objectIndices[ i ] ];
+        if ( pair.Bounds.Intersects( ray, invDirection, tempDist ) && ( tempDist < dist ) )
         {
-            // have the child query for ray intersections
-            const Octree*   child = _children[ i ];
-            const Geometry* geom  = child->QueryIntersections( ray, tempDist, tempPoint );
-
-            // check to see if the child intersected the ray
-            if ( ( geom != nullptr ) && ( tempDist < dist ) )
+            if ( pair.Geometry->HitPrimitive( pair.Primitive, ray, tempDist, tempHit ) && ( tempDist < dist ) )
             {
-                closest = geom;
+                closest = pair.Geometry;
                 dist    = tempDist;
-                sp      = tempPoint;
+                hit     = tempHit;
             }
         }
     }
 
-    // now check our objects
-    for ( uint32 i = 0; i < _objects.GetSize(); ++i )
+    // now check our children front-to-back, skipping any that start past the closest hit so far
+    if ( node.FirstChild )
     {
-        // TODO : Would just checking for the hit be faster than doing the bounds intersect first?
-        BoundsGeometryPair pair = _objects[ i ];
-        if ( pair.Bounds.Intersects( ray, tempDist ) && ( tempDist < dist ) )
+        const uint32 order = GetChildOrder( ray.Direction );
+        for ( uint32 i = 0; i < 8; ++i )
         {
-            if ( pair.Geometry->Hit( ray, tempDist, tempPoint ) && ( tempDist < dist ) )
+            const uint32 child = node.FirstChild + ( i ^ order );
+            if ( _nodes[ child ].Bounds.Intersects( ray, invDirection, tempDist ) && ( tempDist < dist ) )
             {
-                closest = pair.Geometry;
-                dist    = tempDist;
-                sp      = tempPoint;
+                const Geometry* geom = QueryIntersectionsForReal( child, ray, invDirection, dist, hit );
+                if ( geom )
+                {
+                    closest = geom;
+                }
             }
         }
     }
@@ -142,75 +216,149 @@ __device__ const Geometry* Octree::QueryIntersectionsForReal( const Ray& ray, re
     return closest;
 }
 
-// queries the intersections of the given ray for shadows
-__device__ bool Octree::QueryShadowRay( const Ray& ray, real32& dist ) const
+// checks to see if anything blocks the given ray
+__both__ bool Octree::QueryOcclusion( const Ray& ray, real32 tmax ) const
+{
+    // ensure the ray even intersects our bounds before it runs out
+    const vec3 invDirection = 1.0f / ray.Direction;
+    real32     d            = 0.0;
+    if ( ( _nodes.GetSize() > 0 ) && _nodes[ 0 ].Bounds.Intersects( ray, invDirection, d ) && ( d < tmax ) )
+    {
+        return QueryOcclusion( 0, ray, invDirection, tmax );
+    }
+
+    return false;
+}
+
+// checks to see if anything blocks the given ray, starting at a given node
+__both__ bool Octree::QueryOcclusion( uint32 nodeIndex, const Ray& ray, const vec3& invDirection, real32 tmax ) const
 {
-    real32 d = 0.0;
-    bool hit = false;
-    dist     = Math::HugeValue();
+    const OctreeNode& node = _nodes[ nodeIndex ];
+    real32            d    = 0.0;
 
-    // ensure the ray even intersects our bounds
-    if ( !_bounds.Intersects( ray, d ) )
+    // any blocker at all will do, so stop at the first one
+    for ( uint32 i = node.ObjectStart; i < node.ObjectStart + node.ObjectCount; ++i )
     {
-        return false;
+        const BoundsGeometryPair& pair = _objectTable[ _objectIndices[ i ] ];
+        if ( pair.Bounds.Intersects( ray, invDirection, d ) && ( d < tmax ) &&
+             pair.Geometry->ShadowHitPrimitive( pair.Primitive, ray, d ) && ( d < tmax ) )
+        {
+            return true;
+        }
     }
 
-    // check the children first if we have subdivided
-    // TODO : Will this work? Should we still check our objects?
-    if ( HasSubdivided() )
+    // children are still visited front-to-back since nearby blockers are the most likely, but any child that
+    // starts past the end of the ray is skipped
+    if ( node.FirstChild )
     {
+        const uint32 order = GetChildOrder( ray.Direction );
         for ( uint32 i = 0; i < 8; ++i )
         {
-            if ( _children[ i ]->QueryShadowRay( ray, d ) && ( d < dist ) )
+            const uint32 child = node.FirstChild + ( i ^ order );
+            if ( _nodes[ child ].Bounds.Intersects( ray, invDirection, d ) && ( d < tmax ) &&
+                 QueryOcclusion( child, ray, invDirection, tmax ) )
             {
-                hit  = true;
-                dist = d;
+                return true;
             }
         }
     }
 
-    // now check all of our objects
-    uint32 count = _objects.GetSize();
-    for ( uint32 i = 0; i < count; ++i )
+    return false;
+}
+
+// add the given piece of geometry to this octree
+__both__ bool Octree::Add( const Geometry* geometry )
+{
+    // ensure we were given a valid piece of geometry
+    if ( !geometry )
     {
-        const Geometry* geom = _objects[ i ].Geometry;
-        if ( geom->ShadowHit( ray, d ) && ( d < dist ) )
-        {
-            hit  = true;
-            dist = d;
-        }
+        return false;
     }
 
-    return hit;
+    // each primitive gets its own entry so that big pieces of geometry are split up like everything else
+    bool         allAdded       = true;
+    const uint32 primitiveCount = geometry->GetPrimitiveCount();
+    for ( uint32 i = 0; i < primitiveCount; ++i )
+    {
+        allAdded = Add( geometry, i, geometry->GetPrimitiveBounds( i ) ) && allAdded;
+    }
+
+    return allAdded;
 }
 
 // add the given piece of geometry to this octree
-__device__ bool Octree::Add( const Geometry* geometry )
+__both__ bool Octree::Add( const Geometry* geometry, const BoundingBox& bounds )
 {
-    return Add( geometry, geometry->GetBounds() );
+    return Add( geometry, 0, bounds );
 }
 
-// add the given piece of geometry to this octree
-__device__ bool Octree::Add( const Geometry* geometry, const BoundingBox& bounds )
+// add one of the given piece of geometry's primitives to this octree
+__both__ bool Octree::Add( const Geometry* geometry, uint32 primitive, const BoundingBox& bounds )
 {
-    // ensure we were given a valid piece of geometry
-    if ( !geometry )
+    // ensure we were given a valid piece of geometry and haven't been flattened yet
+    if ( !geometry || ( _nodes.GetSize() > 0 ) )
     {
         return false;
     }
 
-    // make sure we contain the geometry's bounding box
-    ContainmentType ctype = _bounds.Contains( bounds );
-    if ( ctype != ContainmentType::Contains )
+
+    // create the pair
+    BoundsGeometryPair pair;
+    pair.Bounds    = bounds;
+    pair.Geometry  = geometry;
+    pair.Index     = _objectTable.GetSize();
+    pair.Primitive = primitive;
+
+
+    // insert it into the tree, remembering it in the order it was added
+    if ( Insert( pair ) )
+    {
+        _objectTable.Add( pair );
+        return true;
+    }
+    return false;
+}
+
+// add a range of objects to this octree
+__both__ bool Octree::AddRange( const BoundsGeometryPair* objects, uint32 count )
+{
+    // ensure we were given objects and haven't been flattened yet
+    if ( !objects || ( _nodes.GetSize() > 0 ) )
     {
         return false;
     }
 
 
-    // create the pair
-    BoundsGeometryPair pair;
-    pair.Bounds = bounds;
-    pair.Geometry = geometry;
+    // make room in the object table for everything up front
+    bool allAdded = true;
+    _objectTable.Reserve( _objectTable.GetSize() + count );
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        BoundsGeometryPair pair = objects[ i ];
+        pair.Index              = _objectTable.GetSize();
+
+        if ( pair.Geometry && Insert( pair ) )
+        {
+            _objectTable.Add( pair );
+        }
+        else
+        {
+            allAdded = false;
+        }
+    }
+
+    return allAdded;
+}
+
+// insert the given object into this octree
+__both__ bool Octree::Insert( const BoundsGeometryPair& pair )
+{
+    // make sure we contain the geometry's bounding box
+    ContainmentType ctype = _bounds.Contains( pair.Bounds );
+    if ( ctype != ContainmentType::Contains )
+    {
+        return false;
+    }
 
 
     // check if we can add the object to us first
@@ -231,7 +379,7 @@ __device__ bool Octree::Add( const Geometry* geometry, const BoundingBox& bounds
         // try to add the object to children first
         for ( uint32 i = 0; i < 8; ++i )
         {
-            if ( _children[ i ]->Add( geometry ) )
+            if ( _children[ i ]->Insert( pair ) )
             {
                 added = true;
                 break;
@@ -249,8 +397,253 @@ __device__ bool Octree::Add( const Geometry* geometry, const BoundingBox& bounds
     return added;
 }
 
+// count the nodes in this octree
+__both__ uint32 Octree::CountNodes() const
+{
+    uint32 count = 1;
+    if ( HasSubdivided() )
+    {
+        for ( uint32 i = 0; i < 8; ++i )
+        {
+            count += _children[ i ]->CountNodes();
+        }
+    }
+    return count;
+}
+
+// count the objects in this octree
+__both__ uint32 Octree::CountObjects() const
+{
+    uint32 count = _objects.GetSize();
+    if ( HasSubdivided() )
+    {
+        for ( uint32 i = 0; i < 8; ++i )
+        {
+            count += _children[ i ]->CountObjects();
+        }
+    }
+    return count;
+}
+
+// flatten this octree
+__both__ bool Octree::Build()
+{
+    // we can only be flattened once
+    if ( _nodes.GetSize() > 0 )
+    {
+        return true;
+    }
+
+    // size the arrays exactly so nothing has to grow while we're copying
+    _nodes.Resize( CountNodes() );
+    _objectIndices.Resize( CountObjects() );
+
+    uint32 nodeCount  = 1;
+    uint32 indexCount = 0;
+    Flatten( this, 0, nodeCount, indexCount );
+
+    ReleaseTree();
+    return true;
+}
+
+// flatten this octree w/ the root's children split across threads
+__host__ bool Octree::BuildParallel( uint32 workerCount )
+{
+    // we can only be flattened once, and there's nothing to split up if we never subdivided
+    if ( _nodes.GetSize() > 0 )
+    {
+        return true;
+    }
+    if ( workerCount <= 1 || !HasSubdivided() )
+    {
+        return Build();
+    }
+
+    _nodes.Resize( CountNodes() );
+    _objectIndices.Resize( CountObjects() );
+
+
+    // the root and its objects come first, followed by its 8 children
+    OctreeNode& root = _nodes[ 0 ];
+    root.Bounds      = _bounds;
+    root.FirstChild  = 1;
+    root.ObjectStart = 0;
+    root.ObjectCount = _objects.GetSize();
+    for ( uint32 i = 0; i < _objects.GetSize(); ++i )
+    {
+        _objectIndices[ i ] = _objects[ i ].Index;
+    }
+
+    // work out where each child's subtree would land in a single-threaded flatten so every child can go at once
+    uint32 nodeCounts [ 8 ];
+    uint32 indexCounts[ 8 ];
+    uint32 nodeCount  = 9;
+    uint32 indexCount = _objects.GetSize();
+    for ( uint32 i = 0; i < 8; ++i )
+    {
+        nodeCounts [ i ] = nodeCount;
+        indexCounts[ i ] = indexCount;
+        nodeCount       += _children[ i ]->CountNodes() - 1;
+        indexCount      += _children[ i ]->CountObjects();
+    }
+
+    std::atomic<uint32>      nextChild( 0 );
+    std::vector<std::thread> tasks;
+    for ( uint32 i = 0; i < Math::Min( workerCount, 8U ); ++i )
+    {
+        tasks.emplace_back( [ this, &nextChild, &nodeCounts, &indexCounts ]()
+        {
+            for ( uint32 child = nextChild++; child < 8; child = nextChild++ )
+            {
+                Flatten( _children[ child ], 1 + child, nodeCounts[ child ], indexCounts[ child ] );
+            }
+        } );
+    }
+    for ( auto& task : tasks )
+    {
+        task.join();
+    }
+
+    ReleaseTree();
+    return true;
+}
+
+// create an octree on the device from uploaded arrays
+__global__ static void OctreeUploadKernel( Octree** octree, vec3 min, vec3 max, const OctreeNode* nodes, uint32 nodeCount, const uint32* objectIndices, uint32 indexCount, const BoundsGeometryPair* objects, uint32 objectCount )
+{
+    *octree = new Octree( BoundingBox( min, max ), nodes, nodeCount, objectIndices, indexCount, objects, objectCount );
+}
+
+// copy this octree to the device
+__host__ Octree* Octree::UploadToDevice() const
+{
+    OctreeNode*         nodes         = nullptr;
+    uint32*             objectIndices = nullptr;
+    BoundsGeometryPair* objects       = nullptr;
+    Octree**            octree        = nullptr;
+    Octree*             result        = nullptr;
+
+    if ( !_nodes.CopyToDevice( nodes ) || !_objectIndices.CopyToDevice( objectIndices ) || !_objectTable.CopyToDevice( objects ) ||
+         cudaSuccess != cudaMalloc( (void**)( &octree ), sizeof( Octree* ) ) )
+    {
+        REX_DEBUG_LOG( "Failed to copy octree to device." );
+    }
+    else
+    {
+        OctreeUploadKernel<<<1, 1>>>( octree, _bounds.GetMin(), _bounds.GetMax(),
+                                      nodes, _nodes.GetSize(), objectIndices, _objectIndices.GetSize(), objects, _objectTable.GetSize() );
+
+        cudaError_t err = cudaGetLastError();
+        if ( err == cudaSuccess )
+        {
+            err = cudaDeviceSynchronize();
+        }
+        if ( err == cudaSuccess )
+        {
+            err = cudaMemcpy( &result, octree, sizeof( Octree* ), cudaMemcpyDeviceToHost );
+        }
+        if ( err != cudaSuccess )
+        {
+            REX_DEBUG_LOG( "Failed to create octree on device. Reason: ", cudaGetErrorString( err ) );
+            result = nullptr;
+        }
+    }
+
+    // the device octree has its own copies now
+    cudaFree( nodes );
+    cudaFree( objectIndices );
+    cudaFree( objects );
+    cudaFree( octree );
+
+    return result;
+}
+
+// flatten the octree
+__host__ bool Octree::BuildLinear( uint32 workerCount )
+{
+    return BuildParallel( workerCount );
+}
+
+// flatten the octree
+__host__ bool Octree::BuildSpatial( uint32 workerCount, real32 )
+{
+    return BuildParallel( workerCount );
+}
+
+// rebuild the octree around its objects' current bounds
+__host__ bool Octree::Update( uint32 workerCount, bool& rebuilt )
+{
+    rebuilt = true;
+    if ( _objectTable.GetSize() == 0 )
+    {
+        return true;
+    }
+
+    // start over from nothing but the object table
+    ReleaseTree();
+    _nodes.Clear();
+    _objectIndices.Clear();
+
+    BoundingBox bounds = _objectTable[ 0 ].Geometry->GetPrimitiveBounds( _objectTable[ 0 ].Primitive );
+    for ( uint32 i = 0; i < _objectTable.GetSize(); ++i )
+    {
+        BoundsGeometryPair& pair = _objectTable[ i ];
+        pair.Bounds = pair.Geometry->GetPrimitiveBounds( pair.Primitive );
+        bounds.Merge( pair.Bounds );
+    }
+    _bounds = bounds;
+
+    // the root holds everything now, so every object goes back in
+    bool allInserted = true;
+    for ( uint32 i = 0; i < _objectTable.GetSize(); ++i )
+    {
+        allInserted = Insert( _objectTable[ i ] ) && allInserted;
+    }
+
+    return BuildParallel( workerCount ) && allInserted;
+}
+
+// release the tree once it has been flattened
+__both__ void Octree::ReleaseTree()
+{
+    DestroyChildren();
+    _nodeArena.Release();
+
+    _objects.Clear();
+    _objects.ShrinkToFit();
+}
+
+// copy an octree into the flattened arrays
+__both__ void Octree::Flatten( const Octree* source, uint32 nodeIndex, uint32& nodeCount, uint32& indexCount )
+{
+    OctreeNode& node = _nodes[ nodeIndex ];
+    node.Bounds      = source->_bounds;
+    node.FirstChild  = 0;
+    node.ObjectStart = indexCount;
+    node.ObjectCount = source->_objects.GetSize();
+
+    for ( uint32 i = 0; i < source->_objects.GetSize(); ++i )
+    {
+        _objectIndices[ indexCount++ ] = source->_objects[ i ].Index;
+    }
+
+
+    // reserve all 8 children together, then fill in each of their subtrees
+    if ( source->HasSubdivided() )
+    {
+        const uint32 firstChild = nodeCount;
+        node.FirstChild         = firstChild;
+        nodeCount              += 8;
+
+        for ( uint32 i = 0; i < 8; ++i )
+        {
+            Flatten( source->_children[ i ], firstChild + i, nodeCount, indexCount );
+        }
+    }
+}
+
 // subdivides this octree
-__device__ void Octree::Subdivide()
+__both__ void Octree::Subdivide()
 {
     // get helper variables
     vec3 center( _bounds.GetCenter() );
@@ -267,31 +660,38 @@ __device__ void Octree::Subdivide()
     vec3 blf( center.x - qdim.x, center.y - qdim.y, center.z - qdim.z );
 
     // create children
-    _children[ 0 ] = new Octree( tlb - qdim, tlb + qdim ); // top left back
-    _children[ 1 ] = new Octree( tlf - qdim, tlf + qdim ); // top left front
-    _children[ 2 ] = new Octree( trb - qdim, trb + qdim ); // top right back
-    _children[ 3 ] = new Octree( trf - qdim, trf + qdim ); // top right front
-    _children[ 4 ] = new Octree( blb - qdim, blb + qdim ); // bottom left back
-    _children[ 5 ] = new Octree( blf - qdim, blf + qdim ); // bottom left front
-    _children[ 6 ] = new Octree( brb - qdim, brb + qdim ); // bottom right back
-    _children[ 7 ] = new Octree( brf - qdim, brf + qdim ); // bottom right front
+    _children[ 0 ] = _arena->Create<Octree>( tlb - qdim, tlb + qdim ); // top left back
+    _children[ 1 ] = _arena->Create<Octree>( tlf - qdim, tlf + qdim ); // top left front
+    _children[ 2 ] = _arena->Create<Octree>( trb - qdim, trb + qdim ); // top right back
+    _children[ 3 ] = _arena->Create<Octree>( trf - qdim, trf + qdim ); // top right front
+    _children[ 4 ] = _arena->Create<Octree>( blb - qdim, blb + qdim ); // bottom left back
+    _children[ 5 ] = _arena->Create<Octree>( blf - qdim, blf + qdim ); // bottom left front
+    _children[ 6 ] = _arena->Create<Octree>( brb - qdim, brb + qdim ); // bottom right back
+    _children[ 7 ] = _arena->Create<Octree>( brf - qdim, brf + qdim ); // bottom right front
+    for ( uint32 ci = 0; ci < 8; ++ci )
+    {
+        _children[ ci ]->_arena = _arena;
+    }
 
-    // go through the new children to see if we can move objects
-    for ( size_t oi = 0; oi < _objects.GetSize(); ++oi )
+    // go through the new children to see if we can move objects, keeping the ones that stay in order
+    uint32 keptCount = 0;
+    for ( uint32 oi = 0; oi < _objects.GetSize(); ++oi )
     {
-        auto& obj = _objects[ oi ];
+        const BoundsGeometryPair obj   = _objects[ oi ];
+        bool                     moved = false;
 
         // check each child to see if we can move the object
-        for ( uint32 ci = 0; ci < 8; ++ci )
+        for ( uint32 ci = 0; ci < 8 && !moved; ++ci )
         {
-            if ( _children[ ci ]->Add( obj.Geometry ) )
-            {
-                _objects.Remove( oi );
-                --oi;
-                break;
-            }
+            moved = _children[ ci ]->Insert( obj );
+        }
+
+        if ( !moved )
+        {
+            _objects[ keptCount++ ] = obj;
         }
     }
+    _objects.Resize( keptCount );
 }
 
 REX_NS_END
\ No newline at end of file
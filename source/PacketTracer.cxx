@@ -0,0 +1,464 @@
+#include <rex/Graphics/Geometry/PacketTracer.hxx>
+#include <rex/Graphics/Geometry/Mesh.hxx>
+#include <rex/Graphics/Geometry/Sphere.hxx>
+#include <rex/Graphics/Geometry/Triangle.hxx>
+#include <rex/Math/Math.hxx>
+
+
+#define TRAVERSAL_STACK_SIZE      ( REX_BVH_MAX_DEPTH + 1 )                            // one waiting node per level of the BVH
+#define WIDE_TRAVERSAL_STACK_SIZE ( ( REX_SIMD_WIDTH - 1 ) * REX_BVH_MAX_DEPTH + 1 ) // all but one of a wide node's children per level
+
+
+REX_NS_BEGIN
+
+// count the number of set lanes in a mask
+static uint32 CountLanes( uint32 mask )
+{
+    uint32 count = 0;
+    while ( mask )
+    {
+        mask &= mask - 1;
+        ++count;
+    }
+    return count;
+}
+
+// record the given lanes' hits in the packet
+static void RecordHits( RayPacket& packet, uint32 hits, const SimdReal& t, const Geometry* geometry, uint32 primitive )
+{
+    if ( !hits )
+    {
+        return;
+    }
+
+    SimdReal::Select( SimdReal::FromBits( hits ), t, SimdReal::Load( packet.T ) ).Store( packet.T );
+    for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+    {
+        if ( hits & ( 1U << lane ) )
+        {
+            packet.Object   [ lane ] = geometry;
+            packet.Primitive[ lane ] = primitive;
+        }
+    }
+}
+
+// trace a packet through an octree
+void PacketTracer::Trace( const Octree* octree, RayPacket& packet )
+{
+    if ( octree->_nodes.GetSize() == 0 )
+    {
+        return;
+    }
+
+    const uint32 mask = IntersectBounds( octree->_nodes[ 0 ].Bounds, packet, packet.ActiveMask );
+    if ( mask )
+    {
+        TraceNode( octree, 0, packet, mask );
+    }
+}
+
+// trace a packet through a BVH
+void PacketTracer::Trace( const BVH* bvh, RayPacket& packet )
+{
+    if ( bvh->_nodeCount == 0 )
+    {
+        return;
+    }
+
+#if REX_WIDE_BVH
+    // host-only BVHs only keep the wide copy, and it takes fewer steps anyway
+    if ( bvh->_wide )
+    {
+        TraceWide( bvh->_wide, packet );
+        return;
+    }
+#endif
+
+    uint32 stackNodes[ TRAVERSAL_STACK_SIZE ];
+    uint32 stackMasks[ TRAVERSAL_STACK_SIZE ];
+    uint32 stackSize = 0;
+
+    stackNodes[ stackSize ] = 0;
+    stackMasks[ stackSize ] = packet.ActiveMask;
+    ++stackSize;
+
+    while ( stackSize > 0 )
+    {
+        --stackSize;
+        const uint32   index = stackNodes[ stackSize ];
+        const BVHNode& node  = bvh->_nodes[ index ];
+
+        // lanes may have found closer hits since this node was pushed, so it's tested when it's popped
+        const uint32 mask = IntersectBounds( node.Bounds, packet, stackMasks[ stackSize ] );
+        if ( !mask )
+        {
+            continue;
+        }
+
+
+        // once only a few rays are left there's no point carrying the rest of the packet around
+        if ( CountLanes( mask ) <= REX_SIMD_WIDTH / 4 )
+        {
+            HitRecord hit;
+            for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+            {
+                if ( mask & ( 1U << lane ) )
+                {
+                    real32          dist = packet.T[ lane ];
+                    const Geometry* geom = bvh->QueryIntersectionsFrom( index, packet.GetRay( lane ), dist, hit );
+                    if ( geom )
+                    {
+                        packet.T        [ lane ] = dist;
+                        packet.Object   [ lane ] = geom;
+                        packet.Primitive[ lane ] = hit.Primitive;
+                    }
+                }
+            }
+        }
+        else if ( node.Count > 0 )
+        {
+            for ( uint32 i = node.Offset; i < node.Offset + node.Count; ++i )
+            {
+                IntersectObject( bvh->_objects[ i ], packet, mask );
+            }
+        }
+        else
+        {
+            // push the farther child first (judged by the first active ray) so the nearer one is visited first
+            uint32 first  = index + 1;
+            uint32 second = node.Offset;
+            uint32 lane   = 0;
+            while ( !( mask & ( 1U << lane ) ) )
+            {
+                ++lane;
+            }
+
+            const vec3 direction( packet.DirectionX[ lane ], packet.DirectionY[ lane ], packet.DirectionZ[ lane ] );
+            const vec3 offset = bvh->_nodes[ first ].Bounds.GetCenter() - bvh->_nodes[ second ].Bounds.GetCenter();
+            if ( glm::dot( offset, direction ) > 0.0f )
+            {
+                uint32 temp = first;
+                first       = second;
+                second      = temp;
+            }
+
+            stackNodes[ stackSize ] = second;
+            stackMasks[ stackSize ] = mask;
+            ++stackSize;
+            stackNodes[ stackSize ] = first;
+            stackMasks[ stackSize ] = mask;
+            ++stackSize;
+        }
+    }
+}
+
+// trace a packet through a wide BVH
+void PacketTracer::TraceWide( const WideBVH* wide, RayPacket& packet )
+{
+    if ( wide->_nodeCount == 0 )
+    {
+        return;
+    }
+
+    uint32 stackOffsets[ WIDE_TRAVERSAL_STACK_SIZE ];
+    uint32 stackCounts [ WIDE_TRAVERSAL_STACK_SIZE ];
+    uint32 stackMasks  [ WIDE_TRAVERSAL_STACK_SIZE ];
+    uint32 stackSize = 0;
+
+    // the root is treated like an interior child that every lane has already entered
+    stackOffsets[ stackSize ] = 0;
+    stackCounts [ stackSize ] = 0;
+    stackMasks  [ stackSize ] = packet.ActiveMask;
+    ++stackSize;
+
+    while ( stackSize > 0 )
+    {
+        --stackSize;
+        const uint32 offset = stackOffsets[ stackSize ];
+        const uint32 count  = stackCounts [ stackSize ];
+        const uint32 mask   = stackMasks  [ stackSize ];
+
+        // once only a few rays are left there's no point carrying the rest of the packet around
+        if ( CountLanes( mask ) <= REX_SIMD_WIDTH / 4 )
+        {
+            HitRecord hit;
+            for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+            {
+                if ( mask & ( 1U << lane ) )
+                {
+                    real32          dist = packet.T[ lane ];
+                    const Geometry* geom = wide->QueryIntersectionsFrom( offset, count, packet.GetRay( lane ), dist, hit );
+                    if ( geom )
+                    {
+                        packet.T        [ lane ] = dist;
+                        packet.Object   [ lane ] = geom;
+                        packet.Primitive[ lane ] = hit.Primitive;
+                    }
+                }
+            }
+        }
+        else if ( count > 0 )
+        {
+            // the leaves only keep references to their primitives, so the leaf's own box is the last one tested
+            const uint32 end = offset + WideBVH::GetLeafSize( count );
+            for ( uint32 i = offset; i < end; ++i )
+            {
+                const WideBVHPrimitive& primitive = wide->_primitives[ i ];
+                IntersectPrimitive( wide->_geometry[ primitive.Geometry ], primitive.Primitive, packet, mask );
+            }
+        }
+        else
+        {
+            // the children's boxes are kept in their parent, so lanes are culled against them before they're pushed
+            const WideBVHNode& node = wide->_nodes[ offset ];
+            uint32             lane = 0;
+            while ( !( mask & ( 1U << lane ) ) )
+            {
+                ++lane;
+            }
+            const vec3 direction( packet.DirectionX[ lane ], packet.DirectionY[ lane ], packet.DirectionZ[ lane ] );
+
+            // push the farther children first (judged by the first active ray) so the nearer ones are visited first
+            uint32 children  [ REX_SIMD_WIDTH ];
+            uint32 childMasks[ REX_SIMD_WIDTH ];
+            real32 distances [ REX_SIMD_WIDTH ];
+            uint32 childCount = 0;
+            for ( uint32 child = 0; child < node.ChildCount; ++child )
+            {
+                const BoundingBox bounds    = WideBVH::GetChildBounds( node, child );
+                const uint32      childMask = IntersectBounds( bounds, packet, mask );
+                if ( !childMask )
+                {
+                    continue;
+                }
+
+                const real32 distance = glm::dot( bounds.GetCenter(), direction );
+                uint32       i        = childCount++;
+                while ( i > 0 && distances[ i - 1 ] < distance )
+                {
+                    children  [ i ] = children  [ i - 1 ];
+                    childMasks[ i ] = childMasks[ i - 1 ];
+                    distances [ i ] = distances [ i - 1 ];
+                    --i;
+                }
+                children  [ i ] = child;
+                childMasks[ i ] = childMask;
+                distances [ i ] = distance;
+            }
+
+            for ( uint32 i = 0; i < childCount; ++i )
+            {
+                stackOffsets[ stackSize ] = node.Offset[ children[ i ] ];
+                stackCounts [ stackSize ] = node.Count [ children[ i ] ];
+                stackMasks  [ stackSize ] = childMasks[ i ];
+                ++stackSize;
+            }
+        }
+    }
+}
+
+// test a packet against a bounding box
+uint32 PacketTracer::IntersectBounds( const BoundingBox& bounds, const RayPacket& packet, uint32 mask )
+{
+    // this is the same slab test as BoundingBox::Intersects, but for every lane at once
+    const vec3&    min = bounds.GetMin();
+    const vec3&    max = bounds.GetMax();
+    const SimdReal ox  = SimdReal::Load( packet.OriginX );
+    const SimdReal oy  = SimdReal::Load( packet.OriginY );
+    const SimdReal oz  = SimdReal::Load( packet.OriginZ );
+    const SimdReal idx = SimdReal::Load( packet.InvDirectionX );
+    const SimdReal idy = SimdReal::Load( packet.InvDirectionY );
+    const SimdReal idz = SimdReal::Load( packet.InvDirectionZ );
+
+    const SimdReal t1  = ( SimdReal( min.x ) - ox ) * idx;
+    const SimdReal t2  = ( SimdReal( max.x ) - ox ) * idx;
+    const SimdReal t3  = ( SimdReal( min.y ) - oy ) * idy;
+    const SimdReal t4  = ( SimdReal( max.y ) - oy ) * idy;
+    const SimdReal t5  = ( SimdReal( min.z ) - oz ) * idz;
+    const SimdReal t6  = ( SimdReal( max.z ) - oz ) * idz;
+
+    const SimdReal tmin = SimdReal::Max( SimdReal::Max( SimdReal::Min( t1, t2 ), SimdReal::Min( t3, t4 ) ), SimdReal::Min( t5, t6 ) );
+    const SimdReal tmax = SimdReal::Min( SimdReal::Min( SimdReal::Max( t1, t2 ), SimdReal::Max( t3, t4 ) ), SimdReal::Max( t5, t6 ) );
+
+    // lanes that already hit something closer than the box can skip it entirely
+    const SimdReal hit = ( tmax >= SimdReal( 0.0f ) ) & ( tmin <= tmax ) & ( tmin < SimdReal::Load( packet.T ) );
+    return hit.ToBits() & mask;
+}
+
+// test a packet against a triangle
+void PacketTracer::IntersectTriangle( const TriangleData& triangle, const Geometry* geometry, uint32 primitive, RayPacket& packet, uint32 mask )
+{
+    // Moller-Trumbore (see TriangleData::Intersect), with the ray-dependent terms in SIMD
+
+    const SimdReal e1x    = SimdReal( triangle.Edge1.x );
+    const SimdReal e1y    = SimdReal( triangle.Edge1.y );
+    const SimdReal e1z    = SimdReal( triangle.Edge1.z );
+    const SimdReal e2x    = SimdReal( triangle.Edge2.x );
+    const SimdReal e2y    = SimdReal( triangle.Edge2.y );
+    const SimdReal e2z    = SimdReal( triangle.Edge2.z );
+    const SimdReal dx     = SimdReal::Load( packet.DirectionX );
+    const SimdReal dy     = SimdReal::Load( packet.DirectionY );
+    const SimdReal dz     = SimdReal::Load( packet.DirectionZ );
+    const SimdReal tx     = SimdReal::Load( packet.OriginX ) - SimdReal( triangle.Origin.x );
+    const SimdReal ty     = SimdReal::Load( packet.OriginY ) - SimdReal( triangle.Origin.y );
+    const SimdReal tz     = SimdReal::Load( packet.OriginZ ) - SimdReal( triangle.Origin.z );
+    const SimdReal px     = dy * e2z - dz * e2y;
+    const SimdReal py     = dz * e2x - dx * e2z;
+    const SimdReal pz     = dx * e2y - dy * e2x;
+    const SimdReal qx     = ty * e1z - tz * e1y;
+    const SimdReal qy     = tz * e1x - tx * e1z;
+    const SimdReal qz     = tx * e1y - ty * e1x;
+
+    // lanes parallel to the triangle end up with infinite or NaN values, which fail every comparison below
+    const SimdReal invDet = SimdReal( 1.0f ) / ( e1x * px + e1y * py + e1z * pz );
+    const SimdReal beta   = ( tx  * px + ty  * py + tz  * pz ) * invDet;
+    const SimdReal gamma  = ( dx  * qx + dy  * qy + dz  * qz ) * invDet;
+    const SimdReal t      = ( e2x * qx + e2y * qy + e2z * qz ) * invDet;
+
+    const SimdReal zero   = SimdReal( 0.0f );
+    const SimdReal hit    = ( beta >= zero )
+                          & ( gamma >= zero )
+                          & ( beta + gamma <= SimdReal( 1.0f ) )
+                          & ( t >= SimdReal( Math::Epsilon() ) )
+                          & ( t < SimdReal::Load( packet.T ) );
+
+    RecordHits( packet, hit.ToBits() & mask, t, geometry, primitive );
+}
+
+// test a packet against a sphere
+void PacketTracer::IntersectSphere( const Sphere* sphere, RayPacket& packet, uint32 mask )
+{
+    // from Suffern, 58 (see Sphere::Hit), with the ray-dependent terms in SIMD
+
+    const SimdReal dx    = SimdReal::Load( packet.DirectionX );
+    const SimdReal dy    = SimdReal::Load( packet.DirectionY );
+    const SimdReal dz    = SimdReal::Load( packet.DirectionZ );
+    const SimdReal tx    = SimdReal::Load( packet.OriginX ) - SimdReal( sphere->_center.x );
+    const SimdReal ty    = SimdReal::Load( packet.OriginY ) - SimdReal( sphere->_center.y );
+    const SimdReal tz    = SimdReal::Load( packet.OriginZ ) - SimdReal( sphere->_center.z );
+    const SimdReal a     = dx * dx + dy * dy + dz * dz;
+    const SimdReal b     = ( tx * dx + ty * dy + tz * dz ) * SimdReal( 2.0f );
+    const SimdReal c     = tx * tx + ty * ty + tz * tz - SimdReal( sphere->_radius * sphere->_radius );
+    const SimdReal disc  = b * b - SimdReal( 4.0f ) * a * c;
+
+    // lanes that miss end up with a NaN root, but they're masked off by the discriminant anyway
+    const SimdReal e     = SimdReal::Sqrt( disc );
+    const SimdReal denom = SimdReal( 1.0f ) / ( SimdReal( 2.0f ) * a );
+    const SimdReal eps   = SimdReal( Math::Epsilon() );
+    const SimdReal tnear = ( SimdReal( 0.0f ) - b - e ) * denom;
+    const SimdReal tfar  = ( SimdReal( 0.0f ) - b + e ) * denom;
+    const SimdReal t     = SimdReal::Select( tnear > eps, tnear, tfar );
+
+    const SimdReal hit   = ( disc >= SimdReal( 0.0f ) )
+                         & ( t > eps )
+                         & ( t < SimdReal::Load( packet.T ) );
+
+    RecordHits( packet, hit.ToBits() & mask, t, sphere, 0 );
+}
+
+// test a packet against arbitrary geometry, one ray at a time
+void PacketTracer::IntersectGeometry( const Geometry* geometry, uint32 primitive, RayPacket& packet, uint32 mask )
+{
+    HitRecord hit;
+    real32    t = 0.0f;
+    for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+    {
+        if ( ( mask & ( 1U << lane ) ) && geometry->HitPrimitive( primitive, packet.GetRay( lane ), t, hit ) && ( t < packet.T[ lane ] ) )
+        {
+            packet.T        [ lane ] = t;
+            packet.Object   [ lane ] = geometry;
+            packet.Primitive[ lane ] = primitive;
+        }
+    }
+}
+
+// trace a packet through an octree node
+void PacketTracer::TraceNode( const Octree* octree, uint32 nodeIndex, RayPacket& packet, uint32 mask )
+{
+    const OctreeNode& node = octree->_nodes[ nodeIndex ];
+
+    // once only a few rays are left there's no point carrying the rest of the packet around
+    if ( CountLanes( mask ) <= REX_SIMD_WIDTH / 4 )
+    {
+        HitRecord hit;
+        for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+        {
+            if ( mask & ( 1U << lane ) )
+            {
+                const vec3      invDirection( packet.InvDirectionX[ lane ], packet.InvDirectionY[ lane ], packet.InvDirectionZ[ lane ] );
+                real32          dist = packet.T[ lane ];
+                const Geometry* geom = octree->QueryIntersectionsForReal( nodeIndex, packet.GetRay( lane ), invDirection, dist, hit );
+                if ( geom )
+                {
+                    packet.T        [ lane ] = dist;
+                    packet.Object   [ lane ] = geom;
+                    packet.Primitive[ lane ] = hit.Primitive;
+                }
+            }
+        }
+        return;
+    }
+
+
+    // check our objects first, since close hits here let lanes skip entire children
+    for ( uint32 i = node.ObjectStart; i < node.ObjectStart + node.ObjectCount; ++i )
+    {
+        IntersectObject( octree->_objectTable[ octree->_objectIndices[ i ] ], packet, mask );
+    }
+
+    // now check our children front-to-back (judged by the first active ray), culling lanes as we go
+    if ( node.FirstChild )
+    {
+        uint32 lane = 0;
+        while ( !( mask & ( 1U << lane ) ) )
+        {
+            ++lane;
+        }
+
+        const uint32 order = Octree::GetChildOrder( vec3( packet.DirectionX[ lane ], packet.DirectionY[ lane ], packet.DirectionZ[ lane ] ) );
+        for ( uint32 i = 0; i < 8; ++i )
+        {
+            const uint32 child     = node.FirstChild + ( i ^ order );
+            const uint32 childMask = IntersectBounds( octree->_nodes[ child ].Bounds, packet, mask );
+            if ( childMask )
+            {
+                TraceNode( octree, child, packet, childMask );
+            }
+        }
+    }
+}
+
+// test a packet against an object
+void PacketTracer::IntersectObject( const BoundsGeometryPair& pair, RayPacket& packet, uint32 mask )
+{
+    mask = IntersectBounds( pair.Bounds, packet, mask );
+    if ( mask )
+    {
+        IntersectPrimitive( pair.Geometry, pair.Primitive, packet, mask );
+    }
+}
+
+// test a packet against one of a piece of geometry's primitives
+void PacketTracer::IntersectPrimitive( const Geometry* geometry, uint32 primitive, RayPacket& packet, uint32 mask )
+{
+    switch ( geometry->GetType() )
+    {
+#if !REX_WATERTIGHT_TRIANGLES
+        // the watertight test picks its axes per ray, so watertight triangles are tested one lane at a time instead
+        case GeometryType::Triangle:
+            IntersectTriangle( static_cast<const Triangle*>( geometry )->_data, geometry, 0, packet, mask );
+            break;
+        case GeometryType::Mesh:
+            IntersectTriangle( static_cast<const Mesh*>( geometry )->GetTriangleData( primitive ), geometry, primitive, packet, mask );
+            break;
+#endif
+        case GeometryType::Sphere:
+            IntersectSphere( static_cast<const Sphere*>( geometry ), packet, mask );
+            break;
+        default:
+            IntersectGeometry( geometry, primitive, packet, mask );
+            break;
+    }
+}
+
+REX_NS_END
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <rex/Graphics/Materials/PhongMaterial.hxx>
+#include <rex/Graphics/Lights/LightTable.hxx>
 #include <rex/Graphics/Scene.hxx>
 #include <rex/Graphics/ShadePoint.hxx>
 #include <rex/Utility/GC.hxx>
@@ -6,112 +7,79 @@
 REX_NS_BEGIN
 
 // create material
-__device__ PhongMaterial::PhongMaterial()
+__both__ PhongMaterial::PhongMaterial()
     : PhongMaterial( Color::White(), 0.0f, 0.0f, 0.0f, 0.0f )
 {
 }
 
 // create material w/ color
-__device__ PhongMaterial::PhongMaterial( const Color& color )
+__both__ PhongMaterial::PhongMaterial( const Color& color )
     : PhongMaterial( color, 0.0f, 0.0f, 0.0f, 0.0f )
 {
 }
 
 // create material w/ color, ambient coefficient, diffuse coefficient, specular coefficient, specular power
-__device__ PhongMaterial::PhongMaterial( const Color& color, real32 ka, real32 kd, real32 ks, real32 pow )
+__both__ PhongMaterial::PhongMaterial( const Color& color, real32 ka, real32 kd, real32 ks, real32 pow )
     : MatteMaterial( color, ka, kd, MaterialType::Phong ),
       _specular( ks, color, pow )
 {
 }
 
 // destroy material
-__device__ PhongMaterial::~PhongMaterial()
+__both__ PhongMaterial::~PhongMaterial()
 {
 }
 
 // get area light shaded color
-__device__ Color PhongMaterial::AreaLightShade( ShadePoint& sp ) const
+__both__ Color PhongMaterial::AreaLightShade( ShadePoint& sp ) const
 {
-    // adapted from Suffern, 332
-    vec3  wo    = -sp.Ray.Direction;
-    Color color = _ambient.GetBHR( sp, wo ) * sp.AmbientLight->GetRadiance( sp );
-
-    for ( uint32 i = 0; i < sp.LightCount; ++i )
-    {
-        const Light* light  = sp.Lights[ i ];
-        vec3         wi     = light->GetLightDirection( sp );
-        real32       angle  = glm::dot( sp.Normal, wi );
-        
-        if ( angle > 0.0f )
-        {
-            // calculate shadow information
-            Ray   shadowRay   = Ray( sp.HitPoint, wi );
-            bool  isInShadow  = light->CastsShadows() && light->IsInShadow( shadowRay, sp );
-            Color diffuse     = _diffuse.GetBRDF( sp, wo, wi );
-            Color specular    = _specular.GetBRDF( sp, wo, wi );
-            Color shadowColor = ( diffuse + specular ) * light->GetRadiance( sp ) * angle
-                              * light->GetGeometricFactor( sp ) * light->GetGeometricArea( sp );
-
-            // calculate the color with a branchless conditional
-            color += Color::Lerp( shadowColor,
-                                  Color::Black(),
-                                  static_cast<real32>( isInShadow ) );
-        }
-    }
-
-    return color;
+    // none of the table's lights have an area, so their geometric factors and areas would all be one
+    return PhongMaterial::Shade( sp );
 }
 
-// copy this material
-__device__ Material* PhongMaterial::Copy() const
+// get the BRDF for a light direction
+__both__ Color PhongMaterial::GetBRDF( const ShadePoint& sp, const vec3& wo, const vec3& wi ) const
 {
-    // create the copy of the material
-    PhongMaterial* mat = new PhongMaterial( _ambient.GetDiffuseColor(),
-                                            _ambient.GetDiffuseCoefficient(),
-                                            _diffuse.GetDiffuseCoefficient(),
-                                            _specular.GetSpecularCoefficient(),
-                                            _specular.GetSpecularPower() );
-    return mat;
+    return _diffuse.GetBRDF( sp, wo, wi ) + _specular.GetBRDF( sp, wo, wi );
 }
 
 // get specular coefficient
-__device__ real32 PhongMaterial::GetSpecularCoefficient() const
+__both__ real32 PhongMaterial::GetSpecularCoefficient() const
 {
     return _specular.GetSpecularCoefficient();
 }
 
 // get specular power
-__device__ real32 PhongMaterial::GetSpecularPower() const
+__both__ real32 PhongMaterial::GetSpecularPower() const
 {
     return _specular.GetSpecularPower();
 }
 
 // get shaded color
-__device__ Color PhongMaterial::Shade( ShadePoint& sp ) const
+__both__ Color PhongMaterial::Shade( ShadePoint& sp ) const
 {
     // adapted from Suffern, 285
-    vec3  wo    = -sp.Ray.Direction;
-    Color color = _ambient.GetBHR( sp, wo ) * sp.AmbientLight->GetRadiance( sp );
+    vec3       wo    = -sp.Ray.Direction;
+    Color      color = MatteMaterial::ShadeAmbient( sp );
+    LightBatch batch;
 
-    for ( uint32 i = 0; i < sp.LightCount; ++i )
+    // go through all of the lights in the scene a batch at a time
+    for ( uint32 first = 0; sp.Lights->GetBatch( sp, first, batch ); first += batch.Count )
     {
-        const Light* light  = sp.Lights[ i ];
-        vec3         wi     = light->GetLightDirection( sp );
-        real32       angle  = glm::dot( sp.Normal, wi );
-        
-        if ( angle > 0.0f )
+        for ( uint32 i = 0; i < batch.Count; ++i )
         {
-            // calculate shadow information
-            Ray   shadowRay   = Ray( sp.HitPoint, wi );
-            bool  isInShadow  = light->CastsShadows() && light->IsInShadow( shadowRay, sp );
-            Color diffuse     = _diffuse.GetBRDF( sp, wo, wi );
-            Color specular    = _specular.GetBRDF( sp, wo, wi );
-            Color shadowColor = ( diffuse + specular ) * light->GetRadiance( sp ) * angle;
-
-            // calculate the color with a branchless conditional
-            color += Color::Lerp( shadowColor,
-                                  Color::Black(),
-                                  static_cast<real32>( isInShadow ) );
+            if ( batch.Angle[ i ] > 0.0f )
+            {
+                // calculate shadow information
+                vec3  wi          = vec3( batch.DirectionX[ i ], batch.DirectionY[ i ], batch.DirectionZ[ i ] );
+                bool  isInShadow  = LightTable::IsInShadow( sp, batch, i );
+                Color shadowColor = PhongMaterial::GetBRDF( sp, wo, wi ) * batch.Radiance[ i ] * batch.Angle[ i ];
+
+                // calculate the color with a branchless conditional
+                color += Color::Lerp( shadowColor,
+                                      Color::Black(),
+                                      static_cast<real32>( isInShadow ) );
+            }
         }
     }
 
@@ -119,13 +87,13 @@ __device__ Color PhongMaterial::Shade( ShadePoint& sp ) const
 }
 
 // set ambient coefficient
-__device__ void PhongMaterial::SetAmbientCoefficient( real32 ka )
+__both__ void PhongMaterial::SetAmbientCoefficient( real32 ka )
 {
     _ambient.SetDiffuseCoefficient( ka );
 }
 
 // set color
-__device__ void PhongMaterial::SetColor( const Color& color )
+__both__ void PhongMaterial::SetColor( const Color& color )
 {
     _ambient.SetDiffuseColor( color );
     _diffuse.SetDiffuseColor( color );
@@ -133,26 +101,26 @@ __device__ void PhongMaterial::SetColor( const Color& color )
 }
 
 // set color w/ components
-__device__ void PhongMaterial::SetColor( real32 r, real32 g, real32 b )
+__both__ void PhongMaterial::SetColor( real32 r, real32 g, real32 b )
 {
     Color color = Color( r, g, b );
     SetColor( color );
 }
 
 // set diffuse coefficient
-__device__ void PhongMaterial::SetDiffuseCoefficient( real32 kd )
+__both__ void PhongMaterial::SetDiffuseCoefficient( real32 kd )
 {
     _diffuse.SetDiffuseCoefficient( kd );
 }
 
 // set specular coefficient
-__device__ void PhongMaterial::SetSpecularCoefficient( real32 ks )
+__both__ void PhongMaterial::SetSpecularCoefficient( real32 ks )
 {
     _specular.SetSpecularCoefficient( ks );
 }
 
 // set specular power
-__device__ void PhongMaterial::SetSpecularPower( real32 pow )
+__both__ void PhongMaterial::SetSpecularPower( real32 pow )
 {
     _specular.SetSpecularPower( pow );
 }
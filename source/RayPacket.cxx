@@ -0,0 +1,45 @@
+#include <rex/Math/RayPacket.hxx>
+#include <rex/Math/Math.hxx>
+
+REX_NS_BEGIN
+
+// create an empty ray packet
+RayPacket::RayPacket()
+    : ActiveMask( 0 )
+{
+    for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+    {
+        SetRay( lane, Ray( vec3( 0, 0, 0 ), vec3( 0, 0, 1 ) ) );
+    }
+    ActiveMask = 0;
+}
+
+// set a lane's ray
+void RayPacket::SetRay( uint32 lane, const Ray& ray )
+{
+    OriginX      [ lane ] = ray.Origin.x;
+    OriginY      [ lane ] = ray.Origin.y;
+    OriginZ      [ lane ] = ray.Origin.z;
+    DirectionX   [ lane ] = ray.Direction.x;
+    DirectionY   [ lane ] = ray.Direction.y;
+    DirectionZ   [ lane ] = ray.Direction.z;
+
+    // use the same reciprocal as the scalar box test so both paths agree on what they hit
+    InvDirectionX[ lane ] = 1.0f / ray.Direction.x;
+    InvDirectionY[ lane ] = 1.0f / ray.Direction.y;
+    InvDirectionZ[ lane ] = 1.0f / ray.Direction.z;
+
+    T            [ lane ] = Math::HugeValue();
+    Object       [ lane ] = nullptr;
+    Primitive    [ lane ] = 0;
+    ActiveMask           |= ( 1U << lane );
+}
+
+// get a lane's ray
+Ray RayPacket::GetRay( uint32 lane ) const
+{
+    return Ray( vec3( OriginX   [ lane ], OriginY   [ lane ], OriginZ   [ lane ] ),
+                vec3( DirectionX[ lane ], DirectionY[ lane ], DirectionZ[ lane ] ) );
+}
+
+REX_NS_END
\ No newline at end of file
@@ -1,9 +1,30 @@
 #include <rex/Rex.hxx>
 #include <GLFW/glfw3.h>
 #include <stdio.h>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+
+// the width and depth of the area imported models are arranged in
+#define MODEL_AREA_SIZE 40.0f
+
 
 REX_NS_BEGIN
 
+/// <summary>
+/// Defines an imported mesh to add to the scene.
+/// </summary>
+struct SceneMesh
+{
+    MeshData Data;
+    Color    Diffuse;
+    real32   Scale;
+    vec3     Offset;
+    uint32   File;    // the index of the model file the mesh came from
+    bool     Shared;  // whether the mesh can use the data in place rather than copying it
+};
+
 /// <summary>
 /// Defines a set of scene build data.
 /// </summary>
@@ -11,83 +32,699 @@ struct SceneBuildData
 {
     DeviceList<Light*>*    Lights;
     AmbientLight*          AmbientLight;
+    DeviceList<Geometry*>* InstancedGeometry;
     DeviceList<Geometry*>* Geometry;
-    Octree*                Octree;
+    AccelStructure*        AccelStructure;
+    SceneArena*            SceneArena;
+    MaterialTable*         Materials;
+    LightTable*            LightTable;
+    uint32                 GeometryCount;
+    uint32                 MaterialCount;
+    uint32                 UniqueMaterialCount;
+    uint64                 BytesUsed;
+    uint64                 BytesReserved;
+    const SceneMesh*       Meshes;
+    uint32                 MeshCount;
+    const mat4*            InstanceTransforms;  // InstanceCount per model file
+    uint32                 InstanceCount;
 };
 
 /// <summary>
-/// The scene build kernel.
+/// Creates all of the scene objects except for the acceleration structure. Shared by the build kernel and
+/// host-only scenes.
 /// </summary>
-__global__ void SceneBuildKernel( SceneBuildData* data )
+/// <param name="data">The build data to populate.</param>
+__both__ static void BuildSceneObjects( SceneBuildData* data )
 {
-    clock_t startTime = clock();
-
-
+    // create the lists, the arena every scene object comes from, and the ambient light
+    data->Lights            = new DeviceList<Light*>();
+    data->Geometry          = new DeviceList<Geometry*>();
+    data->InstancedGeometry = new DeviceList<Geometry*>();
+    data->SceneArena        = new SceneArena();
+    data->Materials         = &data->SceneArena->GetMaterialTable();
+    data->LightTable        = &data->SceneArena->GetLightTable();
+    data->AmbientLight      = data->SceneArena->GetLightArena().Create<AmbientLight>( Color::White(), 1.0f );
 
-    // create the lists and the ambient light
-    data->Lights       = new DeviceList<Light*>();
-    data->Geometry     = new DeviceList<Geometry*>();
-    data->AmbientLight = new AmbientLight( Color::White(), 1.0f );
+    Arena&         spheres   = data->SceneArena->GetGeometryArena( GeometryType::Sphere );
+    Arena&         triangles = data->SceneArena->GetGeometryArena( GeometryType::Triangle );
+    Arena&         meshes    = data->SceneArena->GetGeometryArena( GeometryType::Mesh );
+    Arena&         instances = data->SceneArena->GetGeometryArena( GeometryType::MeshInstance );
+    MaterialTable& materials = *data->Materials;
 
 
 
     // add a directional light
-    DirectionalLight* dl = new DirectionalLight();
+    DirectionalLight* dl = data->SceneArena->GetLightArena().Create<DirectionalLight>();
     dl->SetDirection( vec3( 1.0f, 1.0f, 1.0f ) );
     dl->SetRadianceScale( real32( 1.5f ) );
     data->Lights->Add( dl );
 
+    // copy the lights into the table that shading reads them from
+    for ( uint32 i = 0; i < data->Lights->GetSize(); ++i )
+    {
+        data->LightTable->Add( *data->Lights->Get( i ) );
+    }
+
 
 
-    // prepare some materials
+    // every material shares the same coefficients
     const real32 ka    = 0.25f;
     const real32 kd    = 0.75f;
     const real32 ks    = 0.30f;
     const real32 kpow  = 2.00f;
-    const PhongMaterial white ( Color::White(),  ka, kd, ks, kpow );
-    const PhongMaterial red   ( Color::Red(),    ka, kd, ks, kpow );
-    const PhongMaterial green ( Color::Green(),  ka, kd, ks, kpow );
-    const PhongMaterial blue  ( Color::Blue(),   ka, kd, ks, kpow );
-    const PhongMaterial orange( Color::Orange(), ka, kd, ks, kpow );
-    const PhongMaterial purple( Color::Purple(), ka, kd, ks, kpow );
 
-    // add some spheres
-    data->Geometry->Add( new Sphere( purple, vec3(   0.0,   0.0,   0.0 ), 10.0 ) );
-    data->Geometry->Add( new Sphere( green,  vec3(  10.0,  10.0,  10.0 ),  6.0 ) );
-    data->Geometry->Add( new Sphere( white,  vec3( -15.0, -15.0, -15.0 ), 12.0 ) );
+    // add the imported meshes if there are any (meshes with the same color share a material)
+    if ( data->MeshCount > 0 )
+    {
+        for ( uint32 i = 0; i < data->MeshCount; ++i )
+        {
+            const SceneMesh& source = data->Meshes[ i ];
+            Mesh*            mesh   = meshes.Create<Mesh>( REX_NO_MATERIAL );
+            if ( !( source.Shared ? mesh->SetSharedData( source.Data ) : mesh->SetData( source.Data ) ) )
+            {
+                // the mesh never makes it into a list, so it won't be destroyed with the others
+                mesh->~Mesh();
+                continue;
+            }
+
+            // the material is only added once the mesh is known to be used, so failed meshes don't leave any behind
+            mesh->SetMaterial( materials.Add( PhongMaterial( source.Diffuse, ka, kd, ks, kpow ) ) );
+            ++data->MaterialCount;
+
+            // a single copy of each model goes straight into the scene, otherwise each copy is an instance that
+            // shares the mesh (and the hierarchy it builds over its own triangles)
+            if ( data->InstanceCount <= 1 )
+            {
+                mesh->SetPlacement( source.Scale, source.Offset );
+                data->Geometry->Add( mesh );
+                continue;
+            }
+
+            data->InstancedGeometry->Add( mesh );
+            mesh->BuildHierarchy();
+            for ( uint32 j = 0; j < data->InstanceCount; ++j )
+            {
+                const mat4& transform = data->InstanceTransforms[ source.File * data->InstanceCount + j ];
+                data->Geometry->Add( instances.Create<MeshInstance>( mesh, transform ) );
+            }
+        }
+    }
+    else
+    {
+        const uint32 white  = materials.Add( PhongMaterial( Color::White(),  ka, kd, ks, kpow ) );
+        const uint32 green  = materials.Add( PhongMaterial( Color::Green(),  ka, kd, ks, kpow ) );
+        const uint32 blue   = materials.Add( PhongMaterial( Color::Blue(),   ka, kd, ks, kpow ) );
+        const uint32 orange = materials.Add( PhongMaterial( Color::Orange(), ka, kd, ks, kpow ) );
+        const uint32 purple = materials.Add( PhongMaterial( Color::Purple(), ka, kd, ks, kpow ) );
+        data->MaterialCount = materials.GetSize();
+
+        // add some spheres
+        data->Geometry->Add( spheres.Create<Sphere>( purple, vec3(   0.0,   0.0,   0.0 ), 10.0f ) );
+        data->Geometry->Add( spheres.Create<Sphere>( green,  vec3(  10.0,  10.0,  10.0 ),  6.0f ) );
+        data->Geometry->Add( spheres.Create<Sphere>( white,  vec3( -15.0, -15.0, -15.0 ), 12.0f ) );
+
+        // add some triangles
+        data->Geometry->Add( triangles.Create<Triangle>( orange, vec3(), vec3(  20.0, 0.0, 0.0 ), vec3(  20.0,  20.0,  15.0 ) ) );
+        data->Geometry->Add( triangles.Create<Triangle>( blue,   vec3(), vec3( -20.0, 0.0, 0.0 ), vec3( -20.0, -20.0, -15.0 ) ) );
+    }
+
+
+    data->GeometryCount       = data->Geometry->GetSize();
+    data->UniqueMaterialCount = materials.GetSize();
+    data->BytesUsed           = data->SceneArena->GetBytesUsed();
+    data->BytesReserved       = data->SceneArena->GetBytesReserved();
+}
+
+/// <summary>
+/// The scene build kernel.
+/// </summary>
+__global__ void SceneBuildKernel( SceneBuildData* data )
+{
+    clock_t startTime = clock();
+
+    BuildSceneObjects( data );
+
+    clock_t endTime = clock();
+    clock_t elapsed = abs( endTime - startTime );
+    printf( "Elapsed: %f\n", elapsed / 1E-9f );
+}
+
+/// <summary>
+/// The primitive count kernel, which gets the number of primitives in one piece of geometry per thread.
+/// </summary>
+/// <param name="geometry">The geometry.</param>
+/// <param name="counts">The primitive counts to fill in.</param>
+/// <param name="count">The number of pieces of geometry.</param>
+__global__ void PrimitiveCountKernel( const DeviceList<Geometry*>* geometry, uint32* counts, uint32 count )
+{
+    const uint32 index = blockIdx.x * blockDim.x + threadIdx.x;
+    if ( index < count )
+    {
+        counts[ index ] = geometry->Get( index )->GetPrimitiveCount();
+    }
+}
+
+/// <summary>
+/// The geometry bounds kernel, which gets the bounds of every primitive in one piece of geometry per thread.
+/// </summary>
+/// <param name="geometry">The geometry.</param>
+/// <param name="offsets">The index of each piece of geometry's first pair.</param>
+/// <param name="pairs">The bounds and geometry pairs to fill in.</param>
+/// <param name="count">The number of pieces of geometry.</param>
+__global__ void GeometryBoundsKernel( const DeviceList<Geometry*>* geometry, const uint32* offsets, BoundsGeometryPair* pairs, uint32 count )
+{
+    const uint32 index = blockIdx.x * blockDim.x + threadIdx.x;
+    if ( index < count )
+    {
+        const Geometry* geom = geometry->Get( index );
+        const uint32    end  = offsets[ index + 1 ];
+        for ( uint32 i = offsets[ index ]; i < end; ++i )
+        {
+            pairs[ i ].Primitive = i - offsets[ index ];
+            pairs[ i ].Bounds    = geom->GetPrimitiveBounds( pairs[ i ].Primitive );
+            pairs[ i ].Geometry  = geom;
+            pairs[ i ].Index     = i;
+        }
+    }
+}
+
+/// <summary>
+/// Turns per-geometry primitive counts into the index of each piece of geometry's first pair, with the total
+/// number of pairs at the end.
+/// </summary>
+/// <param name="offsets">The primitive counts on input, and the offsets on output. Must have room for one more.</param>
+/// <param name="count">The number of pieces of geometry.</param>
+__host__ static uint32 GetPrimitiveOffsets( std::vector<uint32>& offsets, uint32 count )
+{
+    uint32 total = 0;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const uint32 primitiveCount = offsets[ i ];
+        offsets[ i ] = total;
+        total       += primitiveCount;
+    }
+    offsets[ count ] = total;
+    return total;
+}
+
+/// <summary>
+/// Gets the bounds of every primitive on the host, splitting the geometry evenly between workers.
+/// </summary>
+/// <param name="geometry">The geometry.</param>
+/// <param name="pairs">The bounds and geometry pairs to fill in.</param>
+/// <param name="workerCount">The number of worker threads.</param>
+__host__ static void GetGeometryBounds( const DeviceList<Geometry*>& geometry, std::vector<BoundsGeometryPair>& pairs, uint32 workerCount )
+{
+    // find out where each piece of geometry's primitives go
+    const uint32        count = geometry.GetSize();
+    std::vector<uint32> offsets( count + 1 );
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        offsets[ i ] = geometry[ i ]->GetPrimitiveCount();
+    }
+    pairs.resize( GetPrimitiveOffsets( offsets, count ) );
+
+    auto getBounds = [ &geometry, &offsets, &pairs, count, workerCount ]( uint32 worker )
+    {
+        const uint32 start = static_cast<uint32>( uint64( count ) *   worker       / workerCount );
+        const uint32 end   = static_cast<uint32>( uint64( count ) * ( worker + 1 ) / workerCount );
+        for ( uint32 i = start; i < end; ++i )
+        {
+            const Geometry* geom = geometry[ i ];
+            for ( uint32 j = offsets[ i ]; j < offsets[ i + 1 ]; ++j )
+            {
+                pairs[ j ].Primitive = j - offsets[ i ];
+                pairs[ j ].Bounds    = geom->GetPrimitiveBounds( pairs[ j ].Primitive );
+                pairs[ j ].Geometry  = geom;
+                pairs[ j ].Index     = j;
+            }
+        }
+    };
+
+    // the calling thread takes the first share
+    std::vector<std::thread> workers;
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        workers.emplace_back( getBounds, i );
+    }
+    getBounds( 0 );
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+}
+
+/// <summary>
+/// Gets the bounds of every primitive on the device and copies them back to the host.
+/// </summary>
+/// <param name="sdHost">The host build data.</param>
+/// <param name="pairs">The bounds and geometry pairs to fill in.</param>
+__host__ static bool RunGeometryBoundsKernel( const SceneBuildData& sdHost, std::vector<BoundsGeometryPair>& pairs )
+{
+    const uint32 count = sdHost.GeometryCount;
+    pairs.clear();
+    if ( count == 0 )
+    {
+        return true;
+    }
+
+    uint32* offsetsDevice = nullptr;
+    if ( cudaSuccess != cudaMalloc( (void**)( &offsetsDevice ), sizeof( uint32 ) * ( count + 1 ) ) )
+    {
+        REX_DEBUG_LOG( "Failed to allocate space for primitive counts." );
+        return false;
+    }
+
+    // get each piece of geometry's primitive count so we know where their pairs go
+    const uint32 blockSize = 256;
+    const uint32 gridSize  = ( count + blockSize - 1 ) / blockSize;
+    PrimitiveCountKernel<<<gridSize, blockSize>>>( sdHost.Geometry, offsetsDevice, count );
+
+    std::vector<uint32> offsets( count + 1 );
+    cudaError_t         err = cudaGetLastError();
+    if ( err == cudaSuccess )
+    {
+        err = cudaDeviceSynchronize();
+    }
+    if ( err == cudaSuccess )
+    {
+        err = cudaMemcpy( offsets.data(), offsetsDevice, sizeof( uint32 ) * count, cudaMemcpyDeviceToHost );
+    }
+    if ( err == cudaSuccess )
+    {
+        pairs.resize( GetPrimitiveOffsets( offsets, count ) );
+        err = cudaMemcpy( offsetsDevice, offsets.data(), sizeof( uint32 ) * ( count + 1 ), cudaMemcpyHostToDevice );
+    }
+    if ( err != cudaSuccess )
+    {
+        cudaFree( offsetsDevice );
+        REX_DEBUG_LOG( "Failed to get primitive counts. Reason: ", cudaGetErrorString( err ) );
+        return false;
+    }
+
+    BoundsGeometryPair* pairsDevice = nullptr;
+    if ( cudaSuccess != cudaMalloc( (void**)( &pairsDevice ), sizeof( BoundsGeometryPair ) * pairs.size() ) )
+    {
+        cudaFree( offsetsDevice );
+        REX_DEBUG_LOG( "Failed to allocate space for geometry bounds." );
+        return false;
+    }
+
+    // call the kernel
+    GeometryBoundsKernel<<<gridSize, blockSize>>>( sdHost.Geometry, offsetsDevice, pairsDevice, count );
+
+    // check for errors and wait for the kernel to finish executing
+    err = cudaGetLastError();
+    if ( err == cudaSuccess )
+    {
+        err = cudaDeviceSynchronize();
+    }
+    if ( err == cudaSuccess )
+    {
+        err = cudaMemcpy( pairs.data(), pairsDevice, sizeof( BoundsGeometryPair ) * pairs.size(), cudaMemcpyDeviceToHost );
+    }
+    cudaFree( pairsDevice );
+    cudaFree( offsetsDevice );
+
+    if ( err != cudaSuccess )
+    {
+        REX_DEBUG_LOG( "Failed to get geometry bounds. Reason: ", cudaGetErrorString( err ) );
+        return false;
+    }
+    return true;
+}
+
+/// <summary>
+/// Places each copy of each model file so that they all stand side by side in a grid on the XZ plane, centered on
+/// the origin. With a single copy of each file, the meshes are given a placement so their data is never modified.
+/// Otherwise every copy gets a transform for its instances and the meshes themselves stay where they are.
+/// </summary>
+/// <param name="meshes">The scene meshes.</param>
+/// <param name="bounds">The bounds of each file.</param>
+/// <param name="instanceCount">The number of copies of each file.</param>
+/// <param name="transforms">The transform of each copy of each file, filled in when there's more than one copy.</param>
+__host__ static void ArrangeModels( std::vector<SceneMesh>& meshes, const std::vector<BoundingBox>& bounds, uint32 instanceCount, std::vector<mat4>& transforms )
+{
+    // fit each copy into its own cell, leaving a little room between neighbours
+    const uint32 fileCount = static_cast<uint32>( bounds.size() );
+    const uint32 cellCount = fileCount * instanceCount;
+    const uint32 columns   = static_cast<uint32>( std::ceil( std::sqrt( static_cast<real32>( cellCount ) ) ) );
+    const uint32 rows      = ( cellCount + columns - 1 ) / columns;
+    const real32 cellSize  = MODEL_AREA_SIZE / columns;
+
+    std::vector<real32> scales( fileCount );
+    std::vector<vec3>   bases ( fileCount );
+    for ( uint32 i = 0; i < fileCount; ++i )
+    {
+        const vec3   size   = bounds[ i ].GetSize();
+        const real32 extent = Math::Max( Math::Max( size.x, size.y ), size.z );
+        scales[ i ] = ( extent > 0.0f ) ? ( cellSize * 0.8f / extent ) : 1.0f;
+
+        // stand the file on the XZ plane rather than centering it vertically
+        bases[ i ] = vec3( bounds[ i ].GetCenter().x, bounds[ i ].GetMin().y, bounds[ i ].GetCenter().z );
+    }
+
+    auto getCellCenter = [ columns, rows, cellSize ]( uint32 cell )
+    {
+        const uint32 column = cell % columns;
+        const uint32 row    = cell / columns;
+        return vec3( ( column - ( columns - 1 ) * 0.5f ) * cellSize,
+                     0.0f,
+                     ( row    - ( rows    - 1 ) * 0.5f ) * cellSize );
+    };
+
+    if ( instanceCount <= 1 )
+    {
+        for ( auto& mesh : meshes )
+        {
+            mesh.Scale  = scales[ mesh.File ];
+            mesh.Offset = getCellCenter( mesh.File ) - bases[ mesh.File ] * mesh.Scale;
+        }
+        return;
+    }
+
+    transforms.resize( cellCount );
+    for ( uint32 cell = 0; cell < cellCount; ++cell )
+    {
+        const uint32 file = cell / instanceCount;
+        transforms[ cell ] = glm::translate( getCellCenter( cell ) )
+                           * glm::scale    ( vec3( scales[ file ] ) )
+                           * glm::translate( -bases[ file ] );
+    }
+    for ( auto& mesh : meshes )
+    {
+        mesh.Scale  = 1.0f;
+        mesh.Offset = vec3();
+    }
+}
+
+/// <summary>
+/// Loads the given model files and arranges them for the scene. Files with an up to date mesh cache are mapped
+/// rather than imported, and every other file is imported and then cached for next time.
+/// </summary>
+/// <param name="paths">The paths to the model files.</param>
+/// <param name="workerCount">The number of worker threads to import with.</param>
+/// <param name="caches">The mapped caches, which the scene meshes may refer to.</param>
+/// <param name="importer">The importer to use, which keeps the data of any imported file that couldn't be cached.</param>
+/// <param name="meshes">The scene meshes to fill in.</param>
+/// <param name="instanceCount">The number of copies of each file to place in the scene.</param>
+/// <param name="transforms">The transform of each copy of each file, filled in when there's more than one copy.</param>
+__host__ static void LoadModels( const std::vector<String>& paths, uint32 workerCount, std::vector<MeshCache*>& caches, ModelImporter& importer, std::vector<SceneMesh>& meshes, uint32 instanceCount, std::vector<mat4>& transforms )
+{
+    const uint32            fileCount = static_cast<uint32>( paths.size() );
+    std::vector<MeshCache*> fileCaches( fileCount, nullptr );
+    std::vector<uint32>     importedFiles;
+
+    // map every file that has an up to date cache
+    Timer  cacheTimer;
+    uint32 cachedFileCount     = 0;
+    uint64 cachedTriangleCount = 0;
+    cacheTimer.Start();
+    for ( uint32 i = 0; i < fileCount; ++i )
+    {
+        MeshCache* cache = new MeshCache();
+        if ( cache->Open( paths[ i ] ) )
+        {
+            fileCaches[ i ]      = cache;
+            cachedTriangleCount += cache->GetTriangleCount();
+            ++cachedFileCount;
+        }
+        else
+        {
+            delete cache;
+            importedFiles.push_back( i );
+            importer.AddFile( paths[ i ] );
+        }
+    }
+    cacheTimer.Stop();
+    if ( cachedFileCount > 0 )
+    {
+        REX_DEBUG_LOG( "Mapped ", cachedTriangleCount, " cached triangles from ", cachedFileCount, " files in ", cacheTimer.GetElapsed(), " seconds" );
+    }
+
+
+    // import everything else, caching each file for next time
+    std::vector<std::vector<const ImportedMesh*>> importedMeshes( fileCount );
+    if ( !importedFiles.empty() )
+    {
+        importer.Import( workerCount );
+        for ( const auto& mesh : importer.GetMeshes() )
+        {
+            importedMeshes[ importedFiles[ mesh.File ] ].push_back( &mesh );
+        }
+
+        REX_DEBUG_LOG( "Model import time: ", importer.GetImportTime(), " seconds (convert: ", importer.GetConvertTime(), " seconds)" );
+        REX_DEBUG_LOG( "Imported ", importer.GetMeshes().size(), " meshes with ", importer.GetTriangleCount(), " triangles from ", importer.GetFileCount(), " files" );
 
-    // add some triangles
-    data->Geometry->Add( new Triangle( orange, vec3(), vec3(  20.0, 0.0, 0.0 ), vec3(  20.0,  20.0,  15.0 ) ) );
-    data->Geometry->Add( new Triangle( blue,   vec3(), vec3( -20.0, 0.0, 0.0 ), vec3( -20.0, -20.0, -15.0 ) ) );
+        for ( uint32 file : importedFiles )
+        {
+            if ( importedMeshes[ file ].empty() || !MeshCache::Write( paths[ file ], importedMeshes[ file ] ) )
+            {
+                continue;
+            }
+
+            MeshCache* cache = new MeshCache();
+            if ( cache->Open( paths[ file ] ) )
+            {
+                fileCaches[ file ] = cache;
+            }
+            else
+            {
+                delete cache;
+            }
+        }
+    }
+
+
+    // gather every file's meshes, preferring the mapped data
+    std::vector<BoundingBox> bounds( fileCount, BoundingBox( vec3(), vec3() ) );
+    std::vector<bool>        hasBounds( fileCount, false );
+    auto addMesh = [ & ]( uint32 file, const MeshData& data, const Color& diffuse, const BoundingBox& meshBounds, bool shared )
+    {
+        SceneMesh mesh;
+        mesh.Data    = data;
+        mesh.Diffuse = diffuse;
+        mesh.Scale   = 1.0f;
+        mesh.File    = file;
+        mesh.Shared  = shared;
+        meshes.push_back( mesh );
+
+        if ( hasBounds[ file ] )
+        {
+            bounds[ file ].Merge( meshBounds );
+        }
+        else
+        {
+            bounds   [ file ] = meshBounds;
+            hasBounds[ file ] = true;
+        }
+    };
+    for ( uint32 file = 0; file < fileCount; ++file )
+    {
+        MeshCache* cache = fileCaches[ file ];
+        if ( cache )
+        {
+            for ( uint32 i = 0; i < cache->GetMeshCount(); ++i )
+            {
+                const Color diffuse = cache->GetMaterialColor( cache->GetMeshMaterial( i ) );
+                addMesh( file, cache->GetMeshData( i ), diffuse, cache->GetMeshBounds( i ), true );
+            }
+            caches.push_back( cache );
+        }
+        else
+        {
+            for ( const ImportedMesh* mesh : importedMeshes[ file ] )
+            {
+                addMesh( file, mesh->GetData(), mesh->Diffuse, mesh->GetBounds(), false );
+            }
+        }
+    }
+
+    ArrangeModels( meshes, bounds, instanceCount, transforms );
+}
+
+/// <summary>
+/// Copies the given array to the device, remembering the allocation so it can be freed later.
+/// </summary>
+/// <param name="items">The items to copy.</param>
+/// <param name="count">The number of items.</param>
+/// <param name="allocations">The list of device allocations to add to.</param>
+template<typename T> __host__ static const T* CopyArrayToDevice( const T* items, uint32 count, std::vector<void*>& allocations )
+{
+    if ( !items || count == 0 )
+    {
+        return nullptr;
+    }
+
+    void* itemsDevice = nullptr;
+    if ( cudaSuccess != cudaMalloc( &itemsDevice, sizeof( T ) * count ) )
+    {
+        return nullptr;
+    }
+    allocations.push_back( itemsDevice );
+
+    if ( cudaSuccess != cudaMemcpy( itemsDevice, items, sizeof( T ) * count, cudaMemcpyHostToDevice ) )
+    {
+        return nullptr;
+    }
+    return static_cast<const T*>( itemsDevice );
+}
+
+/// <summary>
+/// Gets the most device heap the acceleration structure's device copy can take. The structure is uploaded after the
+/// build kernel has already used the heap, and the heap can't grow once that's happened, so this has to be worked out
+/// up front from the number of objects the structure will be built over.
+/// </summary>
+/// <param name="objectCount">The number of objects that will be added to the structure.</param>
+__host__ static size_t GetAccelHeapSize( uint64 objectCount )
+{
+    // a binary tree over N objects has fewer than 2N nodes, and the octree's index list holds each object about once
+    return static_cast<size_t>( objectCount * ( sizeof( BoundsGeometryPair ) + sizeof( uint32 ) + sizeof( BVHNode ) * 2 ) );
+}
+
+/// <summary>
+/// Copies the given scene meshes to the device so the build kernel can create meshes from them, and makes sure
+/// the device heap is big enough to hold them and the acceleration structure that will be uploaded over them.
+/// </summary>
+/// <param name="meshes">The scene meshes.</param>
+/// <param name="instanceCount">The number of times each model is instanced.</param>
+/// <param name="allocations">The list of device allocations to add to, which must be freed after the build.</param>
+__host__ static const SceneMesh* UploadMeshes( const std::vector<SceneMesh>& meshes, uint32 instanceCount, std::vector<void*>& allocations )
+{
+    std::vector<SceneMesh> meshesDevice( meshes );
+    size_t                 heapSize    = 0;
+    uint64                 objectCount = 0;
+    for ( size_t i = 0; i < meshes.size(); ++i )
+    {
+        const MeshData& data          = meshes[ i ].Data;
+        MeshData&       copy          = meshesDevice[ i ].Data;
+        const uint32    triangleCount = data.IndexCount / 3;
+        copy.PositionX   = CopyArrayToDevice( data.PositionX, data.VertexCount, allocations );
+        copy.PositionY   = CopyArrayToDevice( data.PositionY, data.VertexCount, allocations );
+        copy.PositionZ   = CopyArrayToDevice( data.PositionZ, data.VertexCount, allocations );
+        copy.NormalX     = CopyArrayToDevice( data.NormalX,   data.VertexCount, allocations );
+        copy.NormalY     = CopyArrayToDevice( data.NormalY,   data.VertexCount, allocations );
+        copy.NormalZ     = CopyArrayToDevice( data.NormalZ,   data.VertexCount, allocations );
+        copy.Indices     = CopyArrayToDevice( data.Indices,   data.IndexCount,  allocations );
+        copy.Triangles   = CopyArrayToDevice( data.Triangles, triangleCount,    allocations );
+
+        // the build kernel always copies the data, since the device copies are freed once it's done
+        meshesDevice[ i ].Shared = false;
+
+        if ( !copy.PositionX || !copy.PositionY || !copy.PositionZ || !copy.Indices ||
+             ( data.NormalX   && ( !copy.NormalX || !copy.NormalY || !copy.NormalZ ) ) ||
+             ( data.Triangles && !copy.Triangles ) )
+        {
+            REX_DEBUG_LOG( "Failed to copy mesh data to the device." );
+            return nullptr;
+        }
+
+        // instanced meshes also build a hierarchy over their triangles
+        heapSize += sizeof( real32 ) * 6 * data.VertexCount + sizeof( uint32 ) * data.IndexCount + sizeof( TriangleData ) * triangleCount;
+        heapSize += ( sizeof( BoundsGeometryPair ) + sizeof( BVHNode ) * 2 ) * triangleCount;
 
+        // the scene's structure gets each of a single model's triangles, or one object per instance
+        objectCount += ( instanceCount <= 1 ) ? triangleCount : instanceCount;
+    }
+    const size_t accelHeapSize = GetAccelHeapSize( objectCount );
 
+    // the build kernel copies every mesh onto the device heap, which is fairly small by default, and the structure's
+    // upload kernel later copies its nodes and objects onto the same heap
+    size_t defaultHeapSize = 0;
+    cudaDeviceGetLimit( &defaultHeapSize, cudaLimitMallocHeapSize );
+    if ( cudaSuccess != cudaDeviceSetLimit( cudaLimitMallocHeapSize, defaultHeapSize + ( heapSize + accelHeapSize ) * 2 ) )
+    {
+        REX_DEBUG_LOG( "Failed to make room on the device heap for ", heapSize, " bytes of mesh data and ", accelHeapSize, " bytes of acceleration structure." );
+        return nullptr;
+    }
 
+    return CopyArrayToDevice( meshesDevice.data(), static_cast<uint32>( meshesDevice.size() ), allocations );
+}
 
+/// <summary>
+/// Creates and builds an acceleration structure on the host over the given objects.
+/// </summary>
+/// <param name="pairs">The bounds and geometry pairs to add.</param>
+/// <param name="workerCount">The number of worker threads to build with.</param>
+/// <param name="linear">True to build a linear hierarchy rather than use the surface area heuristic.</param>
+/// <param name="spatialBudget">The budget for spatial splits, or 0 to not split primitives.</param>
+__host__ static AccelStructure* BuildAccelStructure( const std::vector<BoundsGeometryPair>& pairs, uint32 workerCount, bool linear, real32 spatialBudget )
+{
     // calculate the min and max of the bounds
     vec3 min, max;
-    for ( uint32 i = 0; i < data->Geometry->GetSize(); ++i )
+    for ( const auto& pair : pairs )
     {
-        Geometry* geom = data->Geometry->Get( i );
-        min = glm::min( min, geom->GetBounds().GetMin() );
-        max = glm::max( max, geom->GetBounds().GetMax() );
+        min = glm::min( min, pair.Bounds.GetMin() );
+        max = glm::max( max, pair.Bounds.GetMax() );
     }
 
-    // create the octree
-    data->Octree = new Octree( min, max );
+    // create the acceleration structure, then add the objects to it all at once and build it
+    AccelStructure* accel = new AccelStructure( min, max );
+    accel->AddRange( pairs.data(), static_cast<uint32>( pairs.size() ) );
+    if ( linear )
+    {
+        accel->BuildLinear( workerCount );
+    }
+    else if ( spatialBudget > 0.0f )
+    {
+        accel->BuildSpatial( workerCount, spatialBudget );
+    }
+    else
+    {
+        accel->BuildParallel( workerCount );
+    }
 
-    // add the objects to the octree
-    for ( uint32 i = 0; i < data->Geometry->GetSize(); ++i )
+    return accel;
+}
+
+/// <summary>
+/// Runs the scene build kernel and copies the results back to the host.
+/// </summary>
+/// <param name="sdHost">The host build data to populate.</param>
+__host__ static bool RunSceneBuildKernel( SceneBuildData& sdHost )
+{
+    // prepare for calling the kernel
+    SceneBuildData* sdDevice = nullptr;
+    if ( cudaSuccess != cudaMalloc( (void**)( &sdDevice ), sizeof( SceneBuildData ) ) )
     {
-        Geometry*   geom   = data->Geometry->Get( i );
-        BoundingBox bounds = geom->GetBounds();
-        data->Octree->Add( geom, bounds );
+        REX_DEBUG_LOG( "Failed to allocate space for scene data." );
+        return false;
+    }
+    if ( cudaSuccess != cudaMemcpy( sdDevice, &sdHost, sizeof( SceneBuildData ), cudaMemcpyHostToDevice ) )
+    {
+        REX_DEBUG_LOG( "Failed to initialize device scene data." );
+        return false;
     }
 
+    // call the kernel
+    SceneBuildKernel<<<1, 1 >>>( sdDevice );
 
+    // check for errors
+    cudaError_t err = cudaGetLastError();
+    if ( err != cudaSuccess )
+    {
+        REX_DEBUG_LOG( "Build failed. Reason: ", cudaGetErrorString( err ) );
+        return false;
+    }
 
-    clock_t endTime = clock();
-    clock_t elapsed = abs( endTime - startTime );
-    printf( "Elapsed: %f\n", elapsed / 1E-9f );
+    // wait for the kernel to finish executing
+    err = cudaDeviceSynchronize();
+    if ( err != cudaSuccess )
+    {
+        REX_DEBUG_LOG( "Failed to synchronize device. Reason: ", cudaGetErrorString( err ) );
+        return false;
+    }
+
+    // copy our data back
+    if ( cudaSuccess != cudaMemcpy( &sdHost, sdDevice, sizeof( SceneBuildData ), cudaMemcpyDeviceToHost ) )
+    {
+        REX_DEBUG_LOG( "Failed to copy data from device." );
+        cudaFree( sdDevice );
+        return false;
+    }
+
+    cudaFree( sdDevice );
+    return true;
 }
 
 // build the scene
@@ -110,6 +747,11 @@ bool Scene::Build( uint16 width, uint16 height, int32 samples, bool fullscreen )
     {
         _image = new Image( width, height );
     }
+    // if we're rendering to an image on the host, the image doesn't need any device memory
+    else if ( _renderMode == SceneRenderMode::ToHostImage )
+    {
+        _image = new Image( width, height, false );
+    }
     // if we're rendering to OpenGL...
     else if ( _renderMode == SceneRenderMode::ToOpenGL )
     {
@@ -169,59 +811,116 @@ bool Scene::Build( uint16 width, uint16 height, int32 samples, bool fullscreen )
 
 
     
-    // prepare for calling the kernel
-    SceneBuildData  sdHost   = { nullptr, nullptr, nullptr };
-    SceneBuildData* sdDevice = nullptr;
-    if ( cudaSuccess != cudaMalloc( (void**)( &sdDevice ), sizeof( SceneBuildData ) ) )
+    // start a timer to get the actual build time
+    SceneBuildData sdHost = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0, 0, 0, 0, nullptr, 0, nullptr, 0 };
+    Timer          timer;
+    timer.Start();
+
+    const uint32 workerCount = ( _hostWorkerCount > 0 ) ? _hostWorkerCount
+                                                         : Math::Max( std::thread::hardware_concurrency(), 1U );
+
+    // the objects have to be created wherever they'll be used (their virtual tables differ between the host and the
+    // device), but their bounds are gathered in parallel and the acceleration structure is always built on the host
+    ModelImporter           importer;
+    std::vector<MeshCache*> caches;
+    std::vector<SceneMesh>  meshes;
+    std::vector<mat4>       transforms;
+    if ( !_modelPaths.empty() )
     {
-        REX_DEBUG_LOG( "Failed to allocate space for scene data." );
-        return false;
+        LoadModels( _modelPaths, workerCount, caches, importer, meshes, _modelInstanceCount, transforms );
+        sdHost.MeshCount     = static_cast<uint32>( meshes.size() );
+        sdHost.InstanceCount = _modelInstanceCount;
     }
-    if ( cudaSuccess != cudaMemcpy( sdDevice, &sdHost, sizeof( SceneBuildData ), cudaMemcpyHostToDevice ) )
+
+    std::vector<BoundsGeometryPair> pairs;
+    if ( _renderMode == SceneRenderMode::ToHostImage )
     {
-        REX_DEBUG_LOG( "Failed to initialize device scene data." );
-        return false;
+        // the meshes use the mapped caches in place, so they stay mapped until the scene is disposed
+        _meshCaches.insert( _meshCaches.end(), caches.begin(), caches.end() );
+        sdHost.Meshes             = meshes.data();
+        sdHost.InstanceTransforms = transforms.data();
+        BuildSceneObjects( &sdHost );
+        GetGeometryBounds( *sdHost.Geometry, pairs, workerCount );
     }
+    else
+    {
+        // the build kernel copies the meshes, so their device copies only need to live until it's done
+        std::vector<void*> allocations;
+        sdHost.Meshes             = ( sdHost.MeshCount > 0 ) ? UploadMeshes( meshes, _modelInstanceCount, allocations ) : nullptr;
+        sdHost.InstanceTransforms = CopyArrayToDevice( transforms.data(), static_cast<uint32>( transforms.size() ), allocations );
+
+        const bool uploaded = ( sdHost.Meshes || sdHost.MeshCount == 0 ) && ( sdHost.InstanceTransforms || transforms.empty() );
+        const bool built    = uploaded && RunSceneBuildKernel( sdHost );
+        for ( void* allocation : allocations )
+        {
+            cudaFree( allocation );
+        }
+        for ( MeshCache* cache : caches )
+        {
+            delete cache;
+        }
+        sdHost.Meshes             = nullptr;
+        sdHost.InstanceTransforms = nullptr;
 
-    // start a timer to get the actual build time
-    Timer timer;
-    timer.Start();
-
-    // call the kernel
-    SceneBuildKernel<<<1, 1 >>>( sdDevice );
+        if ( !built || !RunGeometryBoundsKernel( sdHost, pairs ) )
+        {
+            return false;
+        }
+    }
 
-    // check for errors
-    cudaError_t err = cudaGetLastError();
-    if ( err != cudaSuccess )
+    // spatial splits clip primitives through their geometry, which only host-only scenes have on the host
+    real32 spatialBudget = _spatialSplitBudget;
+    if ( spatialBudget > 0.0f && _renderMode != SceneRenderMode::ToHostImage )
     {
-        REX_DEBUG_LOG( "Build failed. Reason: ", cudaGetErrorString( err ) );
-        return false;
+        REX_DEBUG_LOG( "Ignoring spatial split budget. Spatial splits are only supported when rendering to a host image." );
+        spatialBudget = 0.0f;
     }
 
-    // wait for the kernel to finish executing
-    err = cudaDeviceSynchronize();
-    if ( err != cudaSuccess )
+    Timer accelTimer;
+    accelTimer.Start();
+    sdHost.AccelStructure = BuildAccelStructure( pairs, workerCount, _linearAccelBuild, spatialBudget );
+    accelTimer.Stop();
+    _accelBuildTime = accelTimer.GetElapsed();
+
+#if REX_ACCEL_STRUCTURE == REX_ACCEL_BVH
+    // host-only scenes never need the binary nodes that the device walks
+    if ( sdHost.AccelStructure && _renderMode == SceneRenderMode::ToHostImage )
     {
-        REX_DEBUG_LOG( "Failed to synchronize device. Reason: ", cudaGetErrorString( err ) );
-        return false;
+        sdHost.AccelStructure->MakeHostOnly();
     }
+#endif
 
-    timer.Stop();
+    // the memory is measured on the host copy before it's uploaded, and device scenes never collapse that copy, so
+    // it only counts what the device gets, while host-only scenes count just the wide copy they walk
+    const uint64 accelBytes = sdHost.AccelStructure->GetMemoryUsage();
+    _accelBytesPerPrimitive = pairs.empty() ? 0.0 : static_cast<real64>( accelBytes ) / pairs.size();
 
-    // copy our data back
-    if ( cudaSuccess != cudaMemcpy( &sdHost, sdDevice, sizeof( SceneBuildData ), cudaMemcpyDeviceToHost ) )
+    // host-only scenes use the structure in place, everything else gets a copy on the device
+    if ( _renderMode != SceneRenderMode::ToHostImage )
     {
-        REX_DEBUG_LOG( "Failed to copy data from device." );
-        return false;
+        AccelStructure* hostAccel = sdHost.AccelStructure;
+        sdHost.AccelStructure     = hostAccel->UploadToDevice();
+        delete hostAccel;
+
+        if ( !sdHost.AccelStructure )
+        {
+            return false;
+        }
     }
 
+    timer.Stop();
+
 
 
     // set our references
-    _lights       = sdHost.Lights;
-    _ambientLight = sdHost.AmbientLight;
-    _geometry     = sdHost.Geometry;
-    _octree       = sdHost.Octree;
+    _lights            = sdHost.Lights;
+    _ambientLight      = sdHost.AmbientLight;
+    _geometry          = sdHost.Geometry;
+    _instancedGeometry = sdHost.InstancedGeometry;
+    _accelStructure    = sdHost.AccelStructure;
+    _arena             = sdHost.SceneArena;
+    _materials         = sdHost.Materials;
+    _lightTable        = sdHost.LightTable;
 
 
 
@@ -234,7 +933,14 @@ bool Scene::Build( uint16 width, uint16 height, int32 samples, bool fullscreen )
 
 
 
-    REX_DEBUG_LOG( "Build time: ", timer.GetElapsed(), " seconds" );
+    REX_DEBUG_LOG( "Build time: ", timer.GetElapsed(), " seconds (acceleration structure: ", accelTimer.GetElapsed(), " seconds)" );
+    REX_DEBUG_LOG( "Scene object memory: ", sdHost.BytesUsed, " bytes used, ", sdHost.BytesReserved, " bytes reserved" );
+    REX_DEBUG_LOG( "Scene materials: ", sdHost.UniqueMaterialCount, " unique (", sdHost.MaterialCount, " assigned)" );
+    REX_DEBUG_LOG( "Acceleration structure memory: ", accelBytes, " bytes (", _accelBytesPerPrimitive, " bytes per primitive)" );
+    if ( sdHost.InstanceCount > 1 )
+    {
+        REX_DEBUG_LOG( "Instanced ", sdHost.MeshCount, " meshes ", sdHost.InstanceCount, " times each (", sdHost.GeometryCount, " instances)" );
+    }
     return true;
 }
 
@@ -9,51 +9,63 @@ struct SceneDisposeData
 {
     DeviceList<Light*>*    Lights;
     AmbientLight*          AmbientLight;
+    DeviceList<Geometry*>* InstancedGeometry;
     DeviceList<Geometry*>* Geometry;
-    Octree*                Octree;
+    AccelStructure*        AccelStructure;
+    SceneArena*            SceneArena;
 };
 
 /// <summary>
-/// The scene dispose kernel.
+/// Deletes all of the scene objects. Shared by the dispose kernel and host-only scenes.
 /// </summary>
 /// <param name="data">The data to dispose.</param>
-__global__ void SceneDisposeKernel( SceneDisposeData* data )
+__both__ static void DisposeSceneObjects( SceneDisposeData* data )
 {
-    // delete the geometry
+    // delete the lists (the objects in them belong to the arena, but meshes own their vertex data, so the
+    // geometry is destroyed before the arena releases its memory)
     if ( data->Geometry )
     {
         for ( uint32 i = 0; i < data->Geometry->GetSize(); ++i )
         {
-            Geometry* geom = data->Geometry->operator[]( i );
-            delete    geom;
+            data->Geometry->Get( i )->~Geometry();
         }
         delete data->Geometry;
     }
-
-    // delete the lights
-    if ( data->Lights )
+    if ( data->InstancedGeometry )
     {
-        for ( uint32 i = 0; i < data->Lights->GetSize(); ++i )
+        for ( uint32 i = 0; i < data->InstancedGeometry->GetSize(); ++i )
         {
-            Light* light = data->Lights->operator[]( i );
-            delete light;
+            data->InstancedGeometry->Get( i )->~Geometry();
         }
+        delete data->InstancedGeometry;
+    }
+    if ( data->Lights )
+    {
         delete data->Lights;
     }
 
-    // delete the ambient light
-    if ( data->AmbientLight )
+    // release every scene object at once
+    if ( data->SceneArena )
     {
-        delete data->AmbientLight;
+        delete data->SceneArena;
     }
 
-    // delete the octree
-    if ( data->Octree )
+    // delete the acceleration structure
+    if ( data->AccelStructure )
     {
-        delete data->Octree;
+        delete data->AccelStructure;
     }
 }
 
+/// <summary>
+/// The scene dispose kernel.
+/// </summary>
+/// <param name="data">The data to dispose.</param>
+__global__ void SceneDisposeKernel( SceneDisposeData* data )
+{
+    DisposeSceneObjects( data );
+}
+
 // dispose of the scene
 void Scene::Dispose()
 {
@@ -83,8 +95,33 @@ void Scene::Dispose()
 
 
 
+    // host-only scenes own their objects directly, so there's no need for the device
+    SceneDisposeData sdHost = { _lights, _ambientLight, _instancedGeometry, _geometry, _accelStructure, _arena };
+    if ( _renderMode == SceneRenderMode::ToHostImage )
+    {
+        DisposeSceneObjects( &sdHost );
+
+        // the meshes are gone, so the model data they were using can be unmapped
+        for ( MeshCache* cache : _meshCaches )
+        {
+            delete cache;
+        }
+        _meshCaches.clear();
+
+        _lights            = nullptr;
+        _ambientLight      = nullptr;
+        _geometry          = nullptr;
+        _instancedGeometry = nullptr;
+        _accelStructure    = nullptr;
+        _arena             = nullptr;
+        _materials         = nullptr;
+        _lightTable        = nullptr;
+        return;
+    }
+
+
+
     // prepare to call the dispose kernel
-    SceneDisposeData  sdHost = { _lights, _ambientLight, _geometry, _octree };
     SceneDisposeData* sdDevice = nullptr;
 
     // allocate and copy the cleanup information
@@ -117,10 +154,14 @@ void Scene::Dispose()
     }
 
     // now set everything to null :D
-    _lights         = nullptr;
-    _ambientLight   = nullptr;
-    _geometry       = nullptr;
-    _octree         = nullptr;
+    _lights            = nullptr;
+    _ambientLight      = nullptr;
+    _geometry          = nullptr;
+    _instancedGeometry = nullptr;
+    _accelStructure    = nullptr;
+    _arena             = nullptr;
+    _materials         = nullptr;
+    _lightTable        = nullptr;
 
 
     // try to reset the device
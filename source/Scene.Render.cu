@@ -3,6 +3,8 @@
 #include <math.h>
 #include <stdio.h>
 #include "DeviceScene.hxx"
+#include "HostScene.hxx"
+#include "HostWavefront.hxx"
 
 REX_NS_BEGIN
 
@@ -11,16 +13,13 @@ static DeviceSceneData* SceneData = nullptr;
 
 
 /// <summary>
-/// Gets the next power of two that is higher than the given number.
+/// Gets the number of primary rays traced when rendering the given view plane.
 /// </summary>
-/// <param name="number">The number.</param>
-static uint32 GetNextPowerOfTwo( uint32 number )
+/// <param name="vp">The view plane.</param>
+static uint64 GetPrimaryRayCount( const ViewPlane& vp )
 {
-    real64 logBase2 = log( static_cast<real64>( number ) ) / log( 2.0 );
-    uint32 power    = static_cast<uint32>( Math::Ceiling( logBase2 ) );
-    
-    int32 value = 1 << power;
-    return value;
+    uint64 n = static_cast<uint64>( sqrtf( static_cast<real32>( vp.SampleCount ) ) );
+    return static_cast<uint64>( vp.Width ) * vp.Height * n * n;
 }
 
 // handles pre-rendering
@@ -32,9 +31,10 @@ bool Scene::OnPreRender()
         // create the host scene data
         DeviceSceneData hsd =
         {
-            _lights,
+            _lightTable,
             _ambientLight,
-            _octree,
+            _materials,
+            _accelStructure,
             _camera,
             _viewPlane,
             _backgroundColor,
@@ -109,12 +109,10 @@ bool Scene::OnPostRender()
 // renders the scene
 void Scene::Render()
 {
-    // prepare for the kernel
-    uint32 imgWidth  = GetNextPowerOfTwo( _viewPlane.Width  );
-    uint32 imgHeight = GetNextPowerOfTwo( _viewPlane.Height );
-    dim3  blocks     = dim3( 16, 16 );
-    dim3  grid       = dim3( imgWidth  / blocks.y + ( ( imgWidth  % blocks.y ) == 0 ? 0 : 1 ),
-                             imgHeight / blocks.x + ( ( imgHeight % blocks.x ) == 0 ? 0 : 1 ) );
+    // prepare for the kernel, only launching enough blocks to cover the view plane
+    dim3 blocks = dim3( 16, 16 );
+    dim3 grid   = dim3( ( _viewPlane.Width  + blocks.x - 1 ) / blocks.x,
+                        ( _viewPlane.Height + blocks.y - 1 ) / blocks.y );
 
 
     // if we're rendering to the image...
@@ -145,6 +143,53 @@ void Scene::Render()
 
         // log the render time
         REX_DEBUG_LOG( "Rendering took ", timer.GetElapsed(), " seconds (~", 1 / timer.GetElapsed(), " FPS)" );
+        REX_DEBUG_LOG( "  ", GetPrimaryRayCount( _viewPlane ) / timer.GetElapsed(), " primary rays/second" );
+    }
+    // if we're rendering to an image on the host...
+    else if ( _renderMode == SceneRenderMode::ToHostImage )
+    {
+        // make sure the camera is up to date
+        _camera.Update();
+
+        // the host scene data points straight at the scene objects and the image's pixels
+        DeviceSceneData hsd =
+        {
+            _lightTable,
+            _ambientLight,
+            _materials,
+            _accelStructure,
+            _camera,
+            _viewPlane,
+            _backgroundColor,
+            _image->GetHostMemory()
+        };
+
+        // render the scene on the host and time it
+        Timer               timer;
+        WavefrontStageTimes stageTimes;
+        timer.Start();
+        if ( _hostWavefront )
+        {
+            LaunchWavefrontRender( &hsd, _hostWorkerCount, _hostPacketTracing, stageTimes );
+        }
+        else
+        {
+            LaunchHostRender( &hsd, _hostTileSize, _hostWorkerCount, _hostPacketTracing );
+        }
+        timer.Stop();
+
+        // log the render time
+        REX_DEBUG_LOG( "Rendering took ", timer.GetElapsed(), " seconds (~", 1 / timer.GetElapsed(), " FPS)" );
+        REX_DEBUG_LOG( "  ", GetPrimaryRayCount( _viewPlane ) / timer.GetElapsed(), " primary rays/second" );
+        if ( _hostWavefront )
+        {
+            REX_DEBUG_LOG( "  Generate:      ", stageTimes.Generate     * 1000.0, " ms" );
+            REX_DEBUG_LOG( "  Trace:         ", stageTimes.Trace        * 1000.0, " ms" );
+            REX_DEBUG_LOG( "  Sort:          ", stageTimes.Sort         * 1000.0, " ms" );
+            REX_DEBUG_LOG( "  Shade:         ", stageTimes.Shade        * 1000.0, " ms" );
+            REX_DEBUG_LOG( "  Trace shadows: ", stageTimes.TraceShadows * 1000.0, " ms" );
+            REX_DEBUG_LOG( "  Accumulate:    ", stageTimes.Accumulate   * 1000.0, " ms" );
+        }
     }
     // and if we're rendering to OpenGL...
     else if ( _renderMode == SceneRenderMode::ToOpenGL )
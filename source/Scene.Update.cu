@@ -0,0 +1,66 @@
+#include <rex/Rex.hxx>
+#include <thread>
+#include <vector>
+
+REX_NS_BEGIN
+
+// update the scene's geometry between frames
+bool Scene::UpdateGeometry( const std::function<void( Geometry* )>& update )
+{
+    // device scenes keep their objects on the device, where the host can't reach them
+    if ( _renderMode != SceneRenderMode::ToHostImage )
+    {
+        REX_DEBUG_LOG( "Only host scenes can be updated." );
+        return false;
+    }
+    if ( !_geometry || !_accelStructure )
+    {
+        REX_DEBUG_LOG( "The scene must be built before it can be updated." );
+        return false;
+    }
+
+    Timer timer;
+    timer.Start();
+
+    const uint32 workerCount = ( _hostWorkerCount > 0 ) ? _hostWorkerCount
+                                                         : Math::Max( std::thread::hardware_concurrency(), 1U );
+
+    // each worker updates its own range of the geometry
+    const uint32 count       = _geometry->GetSize();
+    auto         updateRange = [ this, &update, count, workerCount ]( uint32 worker )
+    {
+        const uint32 start = static_cast<uint32>( uint64( count ) *   worker       / workerCount );
+        const uint32 end   = static_cast<uint32>( uint64( count ) * ( worker + 1 ) / workerCount );
+        for ( uint32 i = start; i < end; ++i )
+        {
+            update( _geometry->Get( i ) );
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        workers.emplace_back( updateRange, i );
+    }
+    updateRange( 0 );
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+
+    // then bring the acceleration structure up to date with where everything moved
+    bool       rebuilt = false;
+    const bool updated = _accelStructure->Update( workerCount, rebuilt );
+    timer.Stop();
+
+    if ( !updated )
+    {
+        REX_DEBUG_LOG( "Failed to update the acceleration structure." );
+        return false;
+    }
+
+    REX_DEBUG_LOG( "Update time: ", timer.GetElapsed() * 1000.0, " ms (", rebuilt ? "rebuilt" : "refit", ")" );
+    return true;
+}
+
+REX_NS_END
\ No newline at end of file
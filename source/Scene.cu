@@ -7,13 +7,27 @@ REX_NS_BEGIN
 
 // create a new scene
 Scene::Scene( SceneRenderMode renderMode )
-    : _lights    ( nullptr    )
-    , _geometry  ( nullptr    )
-    , _octree    ( nullptr    )
-    , _texture   ( nullptr    )
-    , _image     ( nullptr    )
-    , _window    ( nullptr    )
-    , _renderMode( renderMode )
+    : _lights                ( nullptr    )
+    , _ambientLight          ( nullptr    )
+    , _geometry              ( nullptr    )
+    , _instancedGeometry     ( nullptr    )
+    , _accelStructure        ( nullptr    )
+    , _arena                 ( nullptr    )
+    , _materials             ( nullptr    )
+    , _lightTable            ( nullptr    )
+    , _texture               ( nullptr    )
+    , _image                 ( nullptr    )
+    , _window                ( nullptr    )
+    , _hostTileSize          ( 16         )
+    , _hostWorkerCount       ( 0          )
+    , _hostPacketTracing     ( true       )
+    , _hostWavefront         ( false      )
+    , _linearAccelBuild      ( false      )
+    , _spatialSplitBudget    ( 0.0f       )
+    , _accelBuildTime        ( 0.0        )
+    , _accelBytesPerPrimitive( 0.0        )
+    , _modelInstanceCount    ( 1          )
+    , _renderMode            ( renderMode )
 {
 }
 
@@ -45,12 +59,72 @@ void Scene::SaveImage( const char* fname ) const
     }
 }
 
+// add a model to import
+void Scene::AddModel( const String& path )
+{
+    _modelPaths.push_back( path );
+}
+
+// set the number of copies of each model
+void Scene::SetModelInstanceCount( uint32 count )
+{
+    _modelInstanceCount = Math::Max( count, 1U );
+}
+
 // get scene camera
 Camera& Scene::GetCamera()
 {
     return _camera;
 }
 
+// set the host render tile size
+void Scene::SetHostTileSize( uint32 tileSize )
+{
+    _hostTileSize = tileSize;
+}
+
+// set the host render worker count
+void Scene::SetHostWorkerCount( uint32 workerCount )
+{
+    _hostWorkerCount = workerCount;
+}
+
+// set whether host renders trace ray packets
+void Scene::SetHostPacketTracing( bool enabled )
+{
+    _hostPacketTracing = enabled;
+}
+
+// set whether host renders run as a wavefront
+void Scene::SetHostWavefront( bool enabled )
+{
+    _hostWavefront = enabled;
+}
+
+// set whether to build a linear acceleration structure
+void Scene::SetLinearAccelBuild( bool enabled )
+{
+    _linearAccelBuild = enabled;
+}
+
+// set the spatial split budget
+void Scene::SetSpatialSplitBudget( real32 budget )
+{
+    _spatialSplitBudget = budget;
+}
+
+// get the acceleration structure build time
+real64 Scene::GetAccelBuildTime() const
+{
+    return _accelBuildTime;
+}
+
+// get the acceleration structure memory per primitive
+real64 Scene::GetAccelBytesPerPrimitive() const
+{
+    return _accelBytesPerPrimitive;
+}
+
 // update the scene camera
 void Scene::UpdateCamera( real64 dt )
 {
@@ -0,0 +1,74 @@
+#include <rex/Graphics/SceneArena.hxx>
+
+REX_NS_BEGIN
+
+// create a new scene arena
+__both__ SceneArena::SceneArena()
+{
+}
+
+// destroy this scene arena
+__both__ SceneArena::~SceneArena()
+{
+    Release();
+}
+
+// get the arena for a geometry type
+__both__ Arena& SceneArena::GetGeometryArena( GeometryType type )
+{
+    return _geometry[ static_cast<uint32>( type ) ];
+}
+
+// get the material table
+__both__ MaterialTable& SceneArena::GetMaterialTable()
+{
+    return _materials;
+}
+
+// get the light arena
+__both__ Arena& SceneArena::GetLightArena()
+{
+    return _lights;
+}
+
+// get the light table
+__both__ LightTable& SceneArena::GetLightTable()
+{
+    return _lightTable;
+}
+
+// get the number of bytes used
+__both__ uint64 SceneArena::GetBytesUsed() const
+{
+    uint64 bytes = _materials.GetBytesUsed() + _lights.GetBytesUsed() + _lightTable.GetBytesUsed();
+    for ( uint32 i = 0; i < REX_GEOMETRY_TYPE_COUNT; ++i )
+    {
+        bytes += _geometry[ i ].GetBytesUsed();
+    }
+    return bytes;
+}
+
+// get the number of bytes reserved
+__both__ uint64 SceneArena::GetBytesReserved() const
+{
+    uint64 bytes = _materials.GetBytesReserved() + _lights.GetBytesReserved() + _lightTable.GetBytesReserved();
+    for ( uint32 i = 0; i < REX_GEOMETRY_TYPE_COUNT; ++i )
+    {
+        bytes += _geometry[ i ].GetBytesReserved();
+    }
+    return bytes;
+}
+
+// release all scene objects
+__both__ void SceneArena::Release()
+{
+    for ( uint32 i = 0; i < REX_GEOMETRY_TYPE_COUNT; ++i )
+    {
+        _geometry[ i ].Release();
+    }
+    _materials.Clear();
+    _lights.Release();
+    _lightTable.Clear();
+}
+
+REX_NS_END
\ No newline at end of file
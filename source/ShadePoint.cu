@@ -6,14 +6,14 @@ REX_NS_BEGIN
 ShadePoint::ShadePoint()
 {
     T           = 0.0;
-    Material    = nullptr;
+    Material    = REX_NO_MATERIAL;
 }
 
 // destroy shade point
 ShadePoint::~ShadePoint()
 {
     T           = 0.0;
-    Material    = nullptr;
+    Material    = REX_NO_MATERIAL;
 }
 
 REX_NS_END
\ No newline at end of file
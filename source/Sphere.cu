@@ -5,22 +5,70 @@
 
 REX_NS_BEGIN
 
+// create new sphere
+__both__ Sphere::Sphere( uint32 material )
+    : Geometry( GeometryType::Sphere, material ),
+      _radius ( 0.0 )
+{
+}
+
+// create new sphere
+__both__ Sphere::Sphere( uint32 material, const vec3& center, real32 radius )
+    : Geometry( GeometryType::Sphere, material ),
+      _center ( center ),
+      _radius ( radius )
+{
+}
+
 // destroys this sphere
-__device__ Sphere::~Sphere()
+__both__ Sphere::~Sphere()
 {
     _radius = 0.0;
 }
 
 // get bounds
-__device__ BoundingBox Sphere::GetBounds() const
+__both__ BoundingBox Sphere::GetBounds() const
 {
     vec3     size   = vec3( _radius );
     BoundingBox bounds = BoundingBox( _center - size, _center + size );
     return bounds;
 }
 
-// shade hit this sphere with a ray
-__device__ bool Sphere::Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) const
+// get the center
+__both__ const vec3& Sphere::GetCenter() const
+{
+    return _center;
+}
+
+// get the radius
+__both__ real32 Sphere::GetRadius() const
+{
+    return _radius;
+}
+
+// set the center
+__both__ void Sphere::SetCenter( const vec3& center )
+{
+    _center = center;
+}
+
+// set the radius
+__both__ void Sphere::SetRadius( real32 radius )
+{
+    _radius = radius;
+}
+
+// fill in the shading point for a hit
+__both__ void Sphere::GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const
+{
+    const vec3 temp = ray.Origin - _center;
+    sp.Normal   = ( temp + hit.T * ray.Direction ) / _radius;
+    sp.HitPoint = ray.Origin + hit.T * ray.Direction;
+    sp.Material = _material;
+}
+
+// hit this sphere with a ray
+__both__ bool Sphere::Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const
 {
     // from Suffern, 58
 
@@ -44,10 +92,10 @@ __device__ bool Sphere::Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) cons
     t = ( -b - e ) * denom;
     if ( t > Math::Epsilon() )
     {
-        tmin        = t;
-        sp.Normal   = ( temp + t * ray.Direction ) / _radius;
-        sp.HitPoint = ray.Origin + t * ray.Direction;
-        sp.Material = _material;
+        tmin          = t;
+        hit.Object    = this;
+        hit.Primitive = 0;
+        hit.T         = t;
 
         return true;
     }
@@ -56,10 +104,10 @@ __device__ bool Sphere::Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) cons
     t = ( -b + e ) * denom;
     if ( t > Math::Epsilon() )
     {
-        tmin        = t;
-        sp.Normal   = ( temp + t * ray.Direction ) / _radius;
-        sp.HitPoint = ray.Origin + t * ray.Direction;
-        sp.Material = _material;
+        tmin          = t;
+        hit.Object    = this;
+        hit.Primitive = 0;
+        hit.T         = t;
 
         return true;
     }
@@ -68,7 +116,7 @@ __device__ bool Sphere::Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) cons
 }
 
 // shadow hit this sphere with a ray
-__device__ bool Sphere::ShadowHit( const Ray& ray, real32& tmin ) const
+__both__ bool Sphere::ShadowHit( const Ray& ray, real32& tmin ) const
 {
     // this is basically using the quadratic equation solved for x where x = t
     real32  t    = 0.0;
@@ -0,0 +1,143 @@
+#include <rex/Utility/TileScheduler.hxx>
+#include <rex/Math/Math.hxx>
+#include <algorithm>
+
+REX_NS_BEGIN
+
+// create a new tile scheduler
+TileScheduler::TileScheduler( uint32 width, uint32 height, uint32 tileSize, uint32 workerCount )
+    : _tileSize ( Math::Max( tileSize, 1U ) )
+    , _tileCount( 0 )
+{
+    // get the tile grid, letting the edge tiles hang off of the area instead of padding it
+    const uint32 tilesX = ( width  + _tileSize - 1 ) / _tileSize;
+    const uint32 tilesY = ( height + _tileSize - 1 ) / _tileSize;
+    _tileCount = tilesX * tilesY;
+
+
+    // create all of the tiles along with their Morton codes
+    std::vector<std::pair<uint32, Tile>> tiles;
+    tiles.reserve( _tileCount );
+    for ( uint32 ty = 0; ty < tilesY; ++ty )
+    {
+        for ( uint32 tx = 0; tx < tilesX; ++tx )
+        {
+            Tile tile;
+            tile.StartX = tx * _tileSize;
+            tile.StartY = ty * _tileSize;
+            tile.EndX   = Math::Min( tile.StartX + _tileSize, width  );
+            tile.EndY   = Math::Min( tile.StartY + _tileSize, height );
+
+            tiles.push_back( std::make_pair( Math::Morton2D( tx, ty ), tile ) );
+        }
+    }
+
+    // order the tiles along the Z-order curve
+    std::sort( tiles.begin(), tiles.end(),
+               []( const std::pair<uint32, Tile>& a, const std::pair<uint32, Tile>& b )
+               {
+                   return a.first < b.first;
+               } );
+
+
+    // give each worker a contiguous run of the curve so neighbouring tiles stay on the same worker
+    workerCount = Math::Max( workerCount, 1U );
+    _queues.resize( workerCount );
+    for ( uint32 i = 0; i < workerCount; ++i )
+    {
+        _queues[ i ] = new WorkerQueue();
+
+        const uint32 start = static_cast<uint32>( uint64( _tileCount ) *   i       / workerCount );
+        const uint32 end   = static_cast<uint32>( uint64( _tileCount ) * ( i + 1 ) / workerCount );
+        for ( uint32 t = start; t < end; ++t )
+        {
+            _queues[ i ]->Tiles.push_back( tiles[ t ].second );
+        }
+    }
+}
+
+// destroy this tile scheduler
+TileScheduler::~TileScheduler()
+{
+    for ( auto& queue : _queues )
+    {
+        delete queue;
+        queue = nullptr;
+    }
+    _queues.clear();
+}
+
+// get the tile count
+uint32 TileScheduler::GetTileCount() const
+{
+    return _tileCount;
+}
+
+// get the tile size
+uint32 TileScheduler::GetTileSize() const
+{
+    return _tileSize;
+}
+
+// get the worker count
+uint32 TileScheduler::GetWorkerCount() const
+{
+    return static_cast<uint32>( _queues.size() );
+}
+
+// take a tile from the front of a worker's queue
+bool TileScheduler::PopTile( uint32 worker, Tile& tile )
+{
+    WorkerQueue* queue = _queues[ worker ];
+    std::lock_guard<std::mutex> lock( queue->Mutex );
+
+    if ( queue->Tiles.empty() )
+    {
+        return false;
+    }
+
+    tile = queue->Tiles.front();
+    queue->Tiles.pop_front();
+    return true;
+}
+
+// steal a tile from the back of a worker's queue
+bool TileScheduler::StealTile( uint32 victim, Tile& tile )
+{
+    WorkerQueue* queue = _queues[ victim ];
+    std::lock_guard<std::mutex> lock( queue->Mutex );
+
+    if ( queue->Tiles.empty() )
+    {
+        return false;
+    }
+
+    tile = queue->Tiles.back();
+    queue->Tiles.pop_back();
+    return true;
+}
+
+// get the next tile for a worker
+bool TileScheduler::GetNextTile( uint32 worker, Tile& tile )
+{
+    // check our own queue first
+    if ( PopTile( worker, tile ) )
+    {
+        return true;
+    }
+
+    // now go around everyone else's queues, starting with our neighbour
+    const uint32 workerCount = GetWorkerCount();
+    for ( uint32 i = 1; i < workerCount; ++i )
+    {
+        if ( StealTile( ( worker + i ) % workerCount, tile ) )
+        {
+            return true;
+        }
+    }
+
+    // tiles are never added back, so if everyone is empty then we're done
+    return false;
+}
+
+REX_NS_END
\ No newline at end of file
@@ -1,145 +1,271 @@
 #include <rex/Graphics/Geometry/Triangle.hxx>
 #include <rex/Graphics/ShadePoint.hxx>
 
+
+#define CLIP_MAX_POINTS 9       // each of a box's 6 planes can add at most one point to a triangle
+#define CLIP_SLACK      1.0e-6f // how far clipped bounds are grown, relative to the triangle's size and position, to cover rounding
+
+
 REX_NS_BEGIN
 
-// destroy triangle
-__device__ Triangle::~Triangle()
+// create empty triangle data
+__both__ TriangleData::TriangleData()
 {
 }
 
-// get triangle bounds
-__device__ BoundingBox Triangle::GetBounds() const
+// create triangle data
+__both__ TriangleData::TriangleData( const vec3& p1, const vec3& p2, const vec3& p3 )
+    : Origin( p1 )
+    , Edge1 ( p2 - p1 )
+    , Edge2 ( p3 - p1 )
+    , Normal( glm::normalize( glm::cross( p2 - p1, p3 - p1 ) ) )
 {
-    vec3     min    = glm::min( glm::min( _p1, _p2 ), _p3 );
-    vec3     max    = glm::max( glm::max( _p1, _p2 ), _p3 );
-    BoundingBox bounds = BoundingBox( min, max );
-    return bounds;
 }
 
-// get triangle normal
-__device__ vec3 Triangle::GetNormal() const
+// intersect a ray with the triangle
+__both__ bool TriangleData::Intersect( const Ray& ray, real32& tmin, real32& beta, real32& gamma ) const
 {
-    vec3 normal = glm::cross( _p2 - _p1, _p3 - _p1 );
-    return glm::normalize( normal );
-}
+    // Moller-Trumbore, which only needs the edges and a single division
 
-// shade-hit triangle
-__device__ bool Triangle::Hit( const Ray& ray, real32& tmin, ShadePoint& sp ) const
-{
-    // adapted from Suffern, 479
-
-    real32 a         = _p1.x - _p2.x;
-    real32 b         = _p1.x - _p3.x;
-    real32 c         = ray.Direction.x;
-    real32 d         = _p1.x - ray.Origin.x;
-    real32 e         = _p1.y - _p2.y;
-    real32 f         = _p1.y - _p3.y;
-    real32 g         = ray.Direction.y;
-    real32 h         = _p1.y - ray.Origin.y;
-    real32 i         = _p1.z - _p2.z;
-    real32 j         = _p1.z - _p3.z;
-    real32 k         = ray.Direction.z;
-    real32 l         = _p1.z - ray.Origin.z;
-    real32 m         = f * k - g * j;
-    real32 n         = h * k - g * l;
-    real32 p         = f * l - h * j;
-    real32 q         = g * i - e * k;
-    real32 s         = e * j - f * i;
-    real32 invDenom  = 1.0 / ( a * m + b * q + c * s );
-    real32 e1        = d * m - b * n - c * p;
-    real32 beta      = e1 * invDenom;
-    
-    if ( beta < real32( 0.0 ) )
+    const vec3   pvec = glm::cross( ray.Direction, Edge2 );
+    const real32 det  = glm::dot( Edge1, pvec );
+    if ( det == real32( 0.0 ) )
     {
         return false;
     }
-    
-    real32 r     = e * l - h * i;
-    real32 e2    = a * n + d * q + c * r;
-    real32 gamma = e2 * invDenom;
-    
-    if ( gamma < real32( 0.0 ) )
+
+    const real32 invDet = real32( 1.0 ) / det;
+    const vec3   tvec   = ray.Origin - Origin;
+    beta = glm::dot( tvec, pvec ) * invDet;
+    if ( beta < real32( 0.0 ) )
     {
         return false;
     }
-    
-    if ( beta + gamma > real32( 1.0 ) )
+
+    const vec3 qvec = glm::cross( tvec, Edge1 );
+    gamma = glm::dot( ray.Direction, qvec ) * invDet;
+    if ( ( gamma < real32( 0.0 ) ) || ( beta + gamma > real32( 1.0 ) ) )
     {
         return false;
     }
-    
-    real32 e3 = a * p - b * r + d * s;
-    real32 t  = e3 * invDenom;
-    
+
+    const real32 t = glm::dot( Edge2, qvec ) * invDet;
     if ( t < Math::Epsilon() )
     {
         return false;
     }
 
-    tmin        = t;
-    sp.Normal   = GetNormal();
-    sp.HitPoint = ray.Origin + t * ray.Direction;
-    sp.Material = _material;
-    
+    tmin = t;
     return true;
 }
 
-// shadow-hit triangle
-__device__ bool Triangle::ShadowHit( const Ray& ray, real32& tmin ) const
+// create a new triangle
+__both__ Triangle::Triangle( uint32 material )
+    : Geometry( GeometryType::Triangle, material )
 {
-    // adapted from Suffern, 479
-
-    real32 a         = _p1.x - _p2.x;
-    real32 b         = _p1.x - _p3.x;
-    real32 c         = ray.Direction.x;
-    real32 d         = _p1.x - ray.Origin.x;
-    real32 e         = _p1.y - _p2.y;
-    real32 f         = _p1.y - _p3.y;
-    real32 g         = ray.Direction.y;
-    real32 h         = _p1.y - ray.Origin.y;
-    real32 i         = _p1.z - _p2.z;
-    real32 j         = _p1.z - _p3.z;
-    real32 k         = ray.Direction.z;
-    real32 l         = _p1.z - ray.Origin.z;
-    real32 m         = f * k - g * j;
-    real32 n         = h * k - g * l;
-    real32 p         = f * l - h * j;
-    real32 q         = g * i - e * k;
-    real32 s         = e * j - f * i;
-    real32 invDenom  = 1.0 / ( a * m + b * q + c * s );
-    real32 e1        = d * m - b * n - c * p;
-    real32 beta      = e1 * invDenom;
-    
-    if ( beta < real32( 0.0 ) )
+}
+
+// create a new triangle
+__both__ Triangle::Triangle( uint32 material, const vec3& p1, const vec3& p2, const vec3& p3 )
+    : Geometry( GeometryType::Triangle, material ),
+      _p1( p1 ),
+      _p2( p2 ),
+      _p3( p3 ),
+      _data( p1, p2, p3 )
+{
+}
+
+// destroy triangle
+__both__ Triangle::~Triangle()
+{
+}
+
+// get triangle bounds
+__both__ BoundingBox Triangle::GetBounds() const
+{
+    vec3     min    = glm::min( glm::min( _p1, _p2 ), _p3 );
+    vec3     max    = glm::max( glm::max( _p1, _p2 ), _p3 );
+    BoundingBox bounds = BoundingBox( min, max );
+    return bounds;
+}
+
+// get the bounds of the part of this triangle inside a box
+__both__ BoundingBox Triangle::GetClippedPrimitiveBounds( uint32, const BoundingBox& clip ) const
+{
+    return GetClippedBounds( _p1, _p2, _p3, clip );
+}
+
+// get the bounds of the part of a triangle inside a box
+__both__ BoundingBox Triangle::GetClippedBounds( const vec3& p1, const vec3& p2, const vec3& p3, const BoundingBox& clip )
+{
+    // clip the triangle against one of the box's planes at a time, keeping the points on the inside of each
+    vec3   points[ 2 ][ CLIP_MAX_POINTS ] = { { p1, p2, p3 } };
+    uint32 pointCount = 3;
+    uint32 current    = 0;
+    for ( uint32 plane = 0; plane < 6 && pointCount > 0; ++plane )
     {
-        return false;
+        const uint32 axis     = plane % 3;
+        const real32 side     = ( plane < 3 ) ? 1.0f : -1.0f;
+        const real32 value    = ( plane < 3 ) ? clip.GetMin()[ axis ] : clip.GetMax()[ axis ];
+        const vec3*  in       = points[ current ];
+        vec3*        out      = points[ 1 - current ];
+        uint32       outCount = 0;
+        for ( uint32 i = 0; i < pointCount; ++i )
+        {
+            const vec3&  a  = in[ i ];
+            const vec3&  b  = in[ ( i + 1 ) % pointCount ];
+            const real32 da = ( a[ axis ] - value ) * side;
+            const real32 db = ( b[ axis ] - value ) * side;
+            if ( da >= 0.0f )
+            {
+                out[ outCount++ ] = a;
+            }
+            if ( ( da >= 0.0f ) != ( db >= 0.0f ) )
+            {
+                // the new point lies exactly on the plane, whatever the rounding does to its other coordinates
+                vec3 point    = a + ( b - a ) * ( da / ( da - db ) );
+                point[ axis ] = value;
+                out[ outCount++ ] = point;
+            }
+        }
+        pointCount = outCount;
+        current    = 1 - current;
+    }
+
+    if ( pointCount == 0 )
+    {
+        return BoundingBox( vec3( Math::HugeValue() ), vec3( -Math::HugeValue() ) );
     }
-    
-    real32 r     = e * l - h * i;
-    real32 e2    = a * n + d * q + c * r;
-    real32 gamma = e2 * invDenom;
-    
-    if ( gamma < real32( 0.0 ) )
+
+    vec3 min = points[ current ][ 0 ];
+    vec3 max = points[ current ][ 0 ];
+    for ( uint32 i = 1; i < pointCount; ++i )
+    {
+        min = glm::min( min, points[ current ][ i ] );
+        max = glm::max( max, points[ current ][ i ] );
+    }
+
+    // the crossing points can round inwards, so grow the bounds a little without leaving the box or the triangle
+    const vec3   triMin = glm::min( glm::min( p1, p2 ), p3 );
+    const vec3   triMax = glm::max( glm::max( p1, p2 ), p3 );
+    const vec3   size   = glm::max( glm::abs( triMin ), glm::abs( triMax ) ) + ( triMax - triMin );
+    const real32 slack  = glm::max( glm::max( size.x, size.y ), size.z ) * CLIP_SLACK;
+    min = glm::max( min - vec3( slack ), glm::max( triMin, clip.GetMin() ) );
+    max = glm::min( max + vec3( slack ), glm::min( triMax, clip.GetMax() ) );
+    return BoundingBox( min, max );
+}
+
+// get triangle normal
+__both__ vec3 Triangle::GetNormal() const
+{
+    return _data.Normal;
+}
+
+// intersect a ray with a triangle without any gaps along shared edges
+__both__ bool Triangle::IntersectWatertight( const vec3& p1, const vec3& p2, const vec3& p3, const Ray& ray, real32& tmin, real32& beta, real32& gamma )
+{
+    // from Woop, Benthin, and Wald, "Watertight Ray/Triangle Intersection" (JCGT 2013)
+
+    // make the ray's largest direction component the z axis, swapping x and y to keep the winding the same
+    const vec3 absDir = glm::abs( ray.Direction );
+    int32 kz = ( absDir.x > absDir.y ) ? ( ( absDir.x > absDir.z ) ? 0 : 2 )
+                                       : ( ( absDir.y > absDir.z ) ? 1 : 2 );
+    int32 kx = ( kz + 1 ) % 3;
+    int32 ky = ( kx + 1 ) % 3;
+    if ( ray.Direction[ kz ] < real32( 0.0 ) )
+    {
+        const int32 swap = kx;
+        kx = ky;
+        ky = swap;
+    }
+
+    // shear and scale the points so that the ray points down the z axis from the origin
+    const real32 sx = ray.Direction[ kx ] / ray.Direction[ kz ];
+    const real32 sy = ray.Direction[ ky ] / ray.Direction[ kz ];
+    const real32 sz = real32( 1.0 )       / ray.Direction[ kz ];
+    const vec3   a  = p1 - ray.Origin;
+    const vec3   b  = p2 - ray.Origin;
+    const vec3   c  = p3 - ray.Origin;
+    const real32 ax = a[ kx ] - sx * a[ kz ];
+    const real32 ay = a[ ky ] - sy * a[ kz ];
+    const real32 bx = b[ kx ] - sx * b[ kz ];
+    const real32 by = b[ ky ] - sy * b[ kz ];
+    const real32 cx = c[ kx ] - sx * c[ kz ];
+    const real32 cy = c[ ky ] - sy * c[ kz ];
+
+    // get the scaled barycentric coordinates. these are done in double precision, where the products are exact, so
+    // that a shared edge gives exactly opposite values from each side even if the compiler fuses them into FMAs
+    const real32 u = static_cast<real32>( real64( cx ) * real64( by ) - real64( cy ) * real64( bx ) );
+    const real32 v = static_cast<real32>( real64( ax ) * real64( cy ) - real64( ay ) * real64( cx ) );
+    const real32 w = static_cast<real32>( real64( bx ) * real64( ay ) - real64( by ) * real64( ax ) );
+
+    // the ray misses if the coordinates don't all have the same sign
+    if ( ( ( u < real32( 0.0 ) ) || ( v < real32( 0.0 ) ) || ( w < real32( 0.0 ) ) ) &&
+         ( ( u > real32( 0.0 ) ) || ( v > real32( 0.0 ) ) || ( w > real32( 0.0 ) ) ) )
     {
         return false;
     }
-    
-    if ( beta + gamma > real32( 1.0 ) )
+
+    const real32 det = u + v + w;
+    if ( det == real32( 0.0 ) )
     {
         return false;
     }
-    
-    real32 e3 = a * p - b * r + d * s;
-    real32 t  = e3 * invDenom;
-    
+
+    // get the scaled distance to the hit
+    const real32 invDet = real32( 1.0 ) / det;
+    const real32 t      = ( u * a[ kz ] + v * b[ kz ] + w * c[ kz ] ) * sz * invDet;
     if ( t < Math::Epsilon() )
     {
         return false;
     }
 
-    tmin = t;
+    tmin  = t;
+    beta  = v * invDet;
+    gamma = w * invDet;
+    return true;
+}
+
+// fill in the shading point for a hit
+__both__ void Triangle::GetShadePoint( const Ray& ray, const HitRecord& hit, ShadePoint& sp ) const
+{
+    sp.Normal   = _data.Normal;
+    sp.HitPoint = ray.Origin + hit.T * ray.Direction;
+    sp.Material = _material;
+}
+
+// hit triangle
+__both__ bool Triangle::Hit( const Ray& ray, real32& tmin, HitRecord& hit ) const
+{
+    real32 beta  = 0.0f;
+    real32 gamma = 0.0f;
+#if REX_WATERTIGHT_TRIANGLES
+    if ( !IntersectWatertight( _p1, _p2, _p3, ray, tmin, beta, gamma ) )
+#else
+    if ( !_data.Intersect( ray, tmin, beta, gamma ) )
+#endif
+    {
+        return false;
+    }
+
+    hit.Object    = this;
+    hit.Primitive = 0;
+    hit.T         = tmin;
+    hit.Beta      = beta;
+    hit.Gamma     = gamma;
     return true;
 }
 
+// shadow-hit triangle
+__both__ bool Triangle::ShadowHit( const Ray& ray, real32& tmin ) const
+{
+    real32 beta  = 0.0f;
+    real32 gamma = 0.0f;
+#if REX_WATERTIGHT_TRIANGLES
+    return IntersectWatertight( _p1, _p2, _p3, ray, tmin, beta, gamma );
+#else
+    return _data.Intersect( ray, tmin, beta, gamma );
+#endif
+}
+
 REX_NS_END
\ No newline at end of file
@@ -0,0 +1,1003 @@
+#include <rex/Graphics/Geometry/WideBVH.hxx>
+#include <rex/Graphics/Geometry/Geometry.hxx>
+#include <rex/Graphics/Geometry/Mesh.hxx>
+#include <rex/Graphics/Geometry/Sphere.hxx>
+#include <rex/Graphics/Geometry/Triangle.hxx>
+#include <rex/Graphics/ShadePoint.hxx>
+#include <rex/Math/Math.hxx>
+#include <rex/Utility/Logger.hxx>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string.h>
+#include <math.h>
+
+
+#define TRAVERSAL_STACK_SIZE ( ( REX_SIMD_WIDTH - 1 ) * REX_BVH_MAX_DEPTH + 1 ) // every wide level is at least one binary level deep, and leaves all but one of its children waiting
+#define PARALLEL_REFIT_MIN_NODES 2048 // how many wide nodes are worth refitting across threads
+#define LEAF_COUNT_BITS          10   // how many bits each of a leaf's object counts is packed into
+#define LEAF_COUNT_MASK          ( ( 1U << LEAF_COUNT_BITS ) - 1 )
+#define QUANTIZED_STEPS      ( ( 1U << REX_QUANTIZED_BVH ) - 1 )
+#define QUANTIZED_SLACK      ( 1.0f / ( 1 << 20 ) ) // how far past the real bounds, relative to their size, the stored ones must stay
+
+
+REX_NS_BEGIN
+
+/// <summary>
+/// Defines a child waiting to be visited during traversal.
+/// </summary>
+struct WideBVHStackEntry
+{
+    uint32 Offset;
+    uint32 Count;
+    real32 Distance;
+};
+
+/// <summary>
+/// Defines the hits found by testing a ray against one primitive per SIMD lane.
+/// </summary>
+struct WideBVHLaneHits
+{
+    alignas( REX_SIMD_ALIGNMENT ) real32 T    [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 Beta [ REX_SIMD_WIDTH ];
+    alignas( REX_SIMD_ALIGNMENT ) real32 Gamma[ REX_SIMD_WIDTH ];
+};
+
+#if REX_QUANTIZED_BVH
+// quantize one axis of a node's child bounds
+static void QuantizeAxis( real32 parentMin, real32 parentMax, const real32* mins, const real32* maxs, uint32 count, real32& origin, real32& scale, QuantizedPlane* minPlanes, QuantizedPlane* maxPlanes )
+{
+    // leave some room past the real bounds so that the stored ones still contain them however the planes are decoded
+    const real32 slack = ( fabsf( parentMin ) + fabsf( parentMax ) ) * QUANTIZED_SLACK;
+    const real32 top   = parentMax + slack;
+    origin = parentMin - slack;
+    scale  = ( top - origin ) / QUANTIZED_STEPS;
+    while ( scale > 0.0f && origin + QUANTIZED_STEPS * scale < top )
+    {
+        scale = nextafterf( scale, Math::HugeValue() );
+    }
+
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        // a flat parent can only be stored as the single plane it lies on
+        if ( scale <= 0.0f )
+        {
+            minPlanes[ i ] = 0;
+            maxPlanes[ i ] = QUANTIZED_STEPS;
+            continue;
+        }
+
+        // round the minimum down and the maximum up, and then fix up anything the division got wrong
+        int32 qmin = static_cast<int32>( floorf( ( mins[ i ] - origin ) / scale ) );
+        int32 qmax = static_cast<int32>( ceilf ( ( maxs[ i ] - origin ) / scale ) );
+        qmin = Math::Clamp( qmin, 0, static_cast<int32>( QUANTIZED_STEPS ) );
+        qmax = Math::Clamp( qmax, 0, static_cast<int32>( QUANTIZED_STEPS ) );
+        while ( qmin > 0 && origin + qmin * scale > mins[ i ] - slack )
+        {
+            --qmin;
+        }
+        while ( qmax < static_cast<int32>( QUANTIZED_STEPS ) && origin + qmax * scale < maxs[ i ] + slack )
+        {
+            ++qmax;
+        }
+
+        minPlanes[ i ] = static_cast<QuantizedPlane>( qmin );
+        maxPlanes[ i ] = static_cast<QuantizedPlane>( qmax );
+    }
+}
+
+// load a node's quantized planes
+static SimdReal LoadPlanes( const uint8* planes )
+{
+    return SimdReal::LoadUInt8( planes );
+}
+
+// load a node's quantized planes
+static SimdReal LoadPlanes( const uint16* planes )
+{
+    return SimdReal::LoadUInt16( planes );
+}
+#endif
+
+// store the bounds of a node's children
+static void SetChildBounds( WideBVHNode& node, const vec3* childMins, const vec3* childMaxs, uint32 count )
+{
+#if REX_QUANTIZED_BVH
+    // the planes step across the box around every child
+    BoundingBox parent( childMins[ 0 ], childMaxs[ 0 ] );
+    for ( uint32 i = 1; i < count; ++i )
+    {
+        parent.Merge( BoundingBox( childMins[ i ], childMaxs[ i ] ) );
+    }
+
+    real32 mins[ 3 ][ REX_SIMD_WIDTH ];
+    real32 maxs[ 3 ][ REX_SIMD_WIDTH ];
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        for ( uint32 axis = 0; axis < 3; ++axis )
+        {
+            mins[ axis ][ i ] = childMins[ i ][ axis ];
+            maxs[ axis ][ i ] = childMaxs[ i ][ axis ];
+        }
+    }
+
+    QuantizeAxis( parent.GetMin().x, parent.GetMax().x, mins[ 0 ], maxs[ 0 ], count, node.Origin[ 0 ], node.Scale[ 0 ], node.MinX, node.MaxX );
+    QuantizeAxis( parent.GetMin().y, parent.GetMax().y, mins[ 1 ], maxs[ 1 ], count, node.Origin[ 1 ], node.Scale[ 1 ], node.MinY, node.MaxY );
+    QuantizeAxis( parent.GetMin().z, parent.GetMax().z, mins[ 2 ], maxs[ 2 ], count, node.Origin[ 2 ], node.Scale[ 2 ], node.MinZ, node.MaxZ );
+#else
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        node.MinX[ i ] = childMins[ i ].x;
+        node.MinY[ i ] = childMins[ i ].y;
+        node.MinZ[ i ] = childMins[ i ].z;
+        node.MaxX[ i ] = childMaxs[ i ].x;
+        node.MaxY[ i ] = childMaxs[ i ].y;
+        node.MaxZ[ i ] = childMaxs[ i ].z;
+    }
+#endif
+}
+
+// push the given children so that the nearest is on top
+static void PushChildren( const WideBVHNode& node, uint32 mask, const real32* entries, WideBVHStackEntry* stack, uint32& stackSize )
+{
+    // insertion sort the hit children from farthest to nearest, there are only ever a few of them
+    uint32 lanes[ REX_SIMD_WIDTH ];
+    uint32 laneCount = 0;
+    while ( mask )
+    {
+        uint32 lane = 0;
+        while ( !( mask & ( 1U << lane ) ) )
+        {
+            ++lane;
+        }
+        mask &= mask - 1;
+
+        uint32 i = laneCount++;
+        while ( i > 0 && entries[ lanes[ i - 1 ] ] < entries[ lane ] )
+        {
+            lanes[ i ] = lanes[ i - 1 ];
+            --i;
+        }
+        lanes[ i ] = lane;
+    }
+
+    for ( uint32 i = 0; i < laneCount; ++i )
+    {
+        WideBVHStackEntry& entry = stack[ stackSize++ ];
+        entry.Offset   = node.Offset[ lanes[ i ] ];
+        entry.Count    = node.Count [ lanes[ i ] ];
+        entry.Distance = entries    [ lanes[ i ] ];
+    }
+}
+
+// get the number of triangles in a leaf
+static uint32 GetTriangleCount( uint32 count )
+{
+    return count & LEAF_COUNT_MASK;
+}
+
+// get the number of spheres in a leaf
+static uint32 GetSphereCount( uint32 count )
+{
+    return ( count >> LEAF_COUNT_BITS ) & LEAF_COUNT_MASK;
+}
+
+// get the number of other objects in a leaf
+static uint32 GetOtherCount( uint32 count )
+{
+    return count >> ( LEAF_COUNT_BITS * 2 );
+}
+
+// get the mask of the first few SIMD lanes
+static uint32 GetLaneMask( uint32 count )
+{
+    return ( count >= REX_SIMD_WIDTH ) ? ( ( 1U << REX_SIMD_WIDTH ) - 1 ) : ( ( 1U << count ) - 1 );
+}
+
+// check if a piece of geometry's primitives are triangles that the batched test can hit
+static bool IsBatchedTriangle( const Geometry* geometry )
+{
+    // the watertight test needs double precision to stay watertight, so those triangles are left to their geometry
+    const GeometryType type = geometry->GetType();
+    return !REX_WATERTIGHT_TRIANGLES && ( ( type == GeometryType::Triangle ) || ( type == GeometryType::Mesh ) );
+}
+
+// check if a piece of geometry is a sphere
+static bool IsBatchedSphere( const Geometry* geometry )
+{
+    return geometry->GetType() == GeometryType::Sphere;
+}
+
+// get the lane with the nearest hit
+static uint32 GetNearestLane( uint32 mask, const real32* t )
+{
+    uint32 nearest = REX_SIMD_WIDTH;
+    for ( uint32 lane = 0; lane < REX_SIMD_WIDTH; ++lane )
+    {
+        if ( ( mask & ( 1U << lane ) ) && ( nearest == REX_SIMD_WIDTH || t[ lane ] < t[ nearest ] ) )
+        {
+            nearest = lane;
+        }
+    }
+    return nearest;
+}
+
+// create an empty wide BVH
+WideBVH::WideBVH()
+    : _nodes       ( nullptr )
+    , _nodeCount   ( 0 )
+    , _nodeCapacity( 0 )
+{
+}
+
+// destroy this wide BVH
+WideBVH::~WideBVH()
+{
+    _mm_free( _nodes );
+    _nodes        = nullptr;
+    _nodeCount    = 0;
+    _nodeCapacity = 0;
+}
+
+// add an empty node
+bool WideBVH::AddNode( uint32& index )
+{
+    // the nodes are over-aligned, so they're grown by hand rather than kept in a list
+    if ( _nodeCount == _nodeCapacity )
+    {
+        const uint32 capacity = Math::Max( _nodeCapacity * 2, 16U );
+        WideBVHNode* nodes    = static_cast<WideBVHNode*>( _mm_malloc( capacity * sizeof( WideBVHNode ), REX_SIMD_ALIGNMENT ) );
+        if ( !nodes )
+        {
+            REX_DEBUG_LOG( "Failed to allocate memory for ", capacity, " wide BVH nodes." );
+            return false;
+        }
+        if ( _nodeCount > 0 )
+        {
+            memcpy( nodes, _nodes, _nodeCount * sizeof( WideBVHNode ) );
+        }
+        _mm_free( _nodes );
+        _nodes        = nodes;
+        _nodeCapacity = capacity;
+    }
+
+    memset( &_nodes[ _nodeCount ], 0, sizeof( WideBVHNode ) );
+    index = _nodeCount++;
+    return true;
+}
+
+// collapse a BVH into this one
+bool WideBVH::Build( BVH& bvh )
+{
+    // the old nodes' memory is reused for as long as it lasts
+    _nodeCount = 0;
+    _primitives.clear();
+    _geometry.clear();
+
+    // grouping the leaves reads each object's geometry, which only host-only trees are sure to have on the host
+    if ( !bvh._hostOnly )
+    {
+        REX_DEBUG_LOG( "Failed to collapse BVH. Only host-only BVHs can be collapsed, since the others may refer to device geometry." );
+        return false;
+    }
+    if ( bvh._nodeCount == 0 )
+    {
+        return true;
+    }
+
+    // neighbouring objects nearly always share their geometry, so the table is only searched when it changes
+    const uint32                                objectCount  = bvh._objects.GetSize();
+    std::unordered_map<const Geometry*, uint32> geometryIndices;
+    const Geometry*                             lastGeometry = nullptr;
+    uint32                                      lastIndex    = 0;
+    _primitives.resize( objectCount );
+    for ( uint32 i = 0; i < objectCount; ++i )
+    {
+        const BoundsGeometryPair& object = bvh._objects[ i ];
+        if ( i == 0 || object.Geometry != lastGeometry )
+        {
+            auto search = geometryIndices.find( object.Geometry );
+            if ( search == geometryIndices.end() )
+            {
+                search = geometryIndices.emplace( object.Geometry, static_cast<uint32>( _geometry.size() ) ).first;
+                _geometry.push_back( object.Geometry );
+            }
+            lastGeometry = object.Geometry;
+            lastIndex    = search->second;
+        }
+
+        _primitives[ i ].Geometry  = lastIndex;
+        _primitives[ i ].Primitive = object.Primitive;
+    }
+    _primitives.shrink_to_fit();
+    _geometry  .shrink_to_fit();
+
+    const BVHNode& root      = bvh._nodes[ 0 ];
+    uint32         nodeIndex = 0;
+    if ( root.Count == 0 )
+    {
+        if ( !CollapseNode( bvh, 0, nodeIndex ) )
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // a lone leaf still needs a node above it to be tested from
+        uint32 childOffset = 0;
+        uint32 childCount  = 0;
+        if ( !AddNode( nodeIndex ) || !AddLeaf( bvh, root.Offset, root.Count, childOffset, childCount ) )
+        {
+            return false;
+        }
+
+        WideBVHNode& node = _nodes[ nodeIndex ];
+        SetChildBounds( node, &root.Bounds.GetMin(), &root.Bounds.GetMax(), 1 );
+        node.Offset[ 0 ] = childOffset;
+        node.Count [ 0 ] = childCount;
+        node.ChildCount  = 1;
+    }
+
+    // the nodes grow by doubling, so whatever's left over is given back once they've all been made
+    if ( _nodeCount < _nodeCapacity )
+    {
+        WideBVHNode* nodes = static_cast<WideBVHNode*>( _mm_malloc( _nodeCount * sizeof( WideBVHNode ), REX_SIMD_ALIGNMENT ) );
+        if ( nodes )
+        {
+            memcpy( nodes, _nodes, _nodeCount * sizeof( WideBVHNode ) );
+            _mm_free( _nodes );
+            _nodes        = nodes;
+            _nodeCapacity = _nodeCount;
+        }
+    }
+    return true;
+}
+
+// refit this wide BVH after its primitives have moved
+BoundingBox WideBVH::Refit( uint32 workerCount )
+{
+    if ( _nodeCount == 0 )
+    {
+        return BoundingBox( vec3( 0.0f ), vec3( 0.0f ) );
+    }
+
+    // every node's box goes in here once it's refit, so that its parent can read it back
+    std::vector<BoundingBox> bounds( _nodeCount, BoundingBox( vec3( 0.0f ), vec3( 0.0f ) ) );
+    const WideBVHNode&       root = _nodes[ 0 ];
+    if ( workerCount <= 1 || _nodeCount < PARALLEL_REFIT_MIN_NODES )
+    {
+        RefitNodes( 0, _nodeCount, bounds.data() );
+        return bounds[ 0 ];
+    }
+
+    // each interior child of the root heads a run of nodes that runs up to the next one's, so they can each be refit
+    // on their own thread, and then the root once they're all done
+    std::vector<std::thread> tasks;
+    uint32                   end = _nodeCount;
+    for ( uint32 i = root.ChildCount; i > 0; --i )
+    {
+        if ( root.Count[ i - 1 ] == 0 )
+        {
+            const uint32 start = root.Offset[ i - 1 ];
+            tasks.emplace_back( [ this, start, end, &bounds ]()
+            {
+                RefitNodes( start, end, bounds.data() );
+            } );
+            end = start;
+        }
+    }
+    for ( std::thread& task : tasks )
+    {
+        task.join();
+    }
+    RefitNodes( 0, 1, bounds.data() );
+    return bounds[ 0 ];
+}
+
+// get the source BVH's objects back from the leaves' primitives
+void WideBVH::GetObjects( std::vector<BoundsGeometryPair>& objects, bool unique ) const
+{
+    std::unordered_set<uint64> seen;
+    objects.clear();
+    objects.reserve( _primitives.size() );
+    for ( uint32 i = 0; i < _primitives.size(); ++i )
+    {
+        const WideBVHPrimitive& primitive = _primitives[ i ];
+        if ( unique && !seen.insert( static_cast<uint64>( primitive.Geometry ) << 32 | primitive.Primitive ).second )
+        {
+            continue;
+        }
+
+        BoundsGeometryPair object;
+        object.Geometry  = _geometry[ primitive.Geometry ];
+        object.Bounds    = GetPrimitiveBounds( i );
+        object.Index     = static_cast<uint32>( objects.size() );
+        object.Primitive = primitive.Primitive;
+        objects.push_back( object );
+    }
+}
+
+// group a leaf's objects by type
+bool WideBVH::AddLeaf( BVH& bvh, uint32 offset, uint32 count, uint32& childOffset, uint32& childCount )
+{
+    // the primitives start out in the same order as the source's objects, and are grouped in place
+    if ( count <= LEAF_COUNT_MASK )
+    {
+        WideBVHPrimitive* first   = &_primitives[ offset ];
+        WideBVHPrimitive* last    = first + count;
+        WideBVHPrimitive* spheres = std::partition( first, last, [ this ]( const WideBVHPrimitive& primitive )
+        {
+            return IsBatchedTriangle( _geometry[ primitive.Geometry ] );
+        } );
+        WideBVHPrimitive* others  = std::partition( spheres, last, [ this ]( const WideBVHPrimitive& primitive )
+        {
+            return IsBatchedSphere( _geometry[ primitive.Geometry ] );
+        } );
+
+        childOffset = offset;
+        childCount  = static_cast<uint32>( spheres - first )
+                    | static_cast<uint32>( others  - spheres ) << LEAF_COUNT_BITS
+                    | static_cast<uint32>( last    - others  ) << ( LEAF_COUNT_BITS * 2 );
+        return true;
+    }
+
+    // only degenerate leaves (such as ones forced at the maximum depth) get this big, so they're just split evenly
+    uint32 nodeIndex = 0;
+    if ( !AddNode( nodeIndex ) )
+    {
+        return false;
+    }
+
+    const uint32 chunkSize  = ( count + REX_SIMD_WIDTH - 1 ) / REX_SIMD_WIDTH;
+    uint32       chunkCount = 0;
+    vec3         mins   [ REX_SIMD_WIDTH ];
+    vec3         maxs   [ REX_SIMD_WIDTH ];
+    uint32       offsets[ REX_SIMD_WIDTH ];
+    uint32       counts [ REX_SIMD_WIDTH ];
+    for ( uint32 start = offset; start < offset + count; start += chunkSize )
+    {
+        const uint32 size   = Math::Min( chunkSize, offset + count - start );
+        BoundingBox  bounds = bvh._objects[ start ].Bounds;
+        for ( uint32 i = start + 1; i < start + size; ++i )
+        {
+            bounds.Merge( bvh._objects[ i ].Bounds );
+        }
+
+        mins[ chunkCount ] = bounds.GetMin();
+        maxs[ chunkCount ] = bounds.GetMax();
+        if ( !AddLeaf( bvh, start, size, offsets[ chunkCount ], counts[ chunkCount ] ) )
+        {
+            return false;
+        }
+        ++chunkCount;
+    }
+
+    WideBVHNode& node = _nodes[ nodeIndex ];
+    SetChildBounds( node, mins, maxs, chunkCount );
+    for ( uint32 i = 0; i < chunkCount; ++i )
+    {
+        node.Offset[ i ] = offsets[ i ];
+        node.Count [ i ] = counts [ i ];
+    }
+    node.ChildCount = chunkCount;
+
+    childOffset = nodeIndex;
+    childCount  = 0;
+    return true;
+}
+
+// get the number of objects in a leaf
+uint32 WideBVH::GetLeafSize( uint32 count )
+{
+    return GetTriangleCount( count ) + GetSphereCount( count ) + GetOtherCount( count );
+}
+
+// collapse a binary node and its subtree
+bool WideBVH::CollapseNode( BVH& bvh, uint32 binaryIndex, uint32& nodeIndex )
+{
+    // start with the binary node's children, then keep opening up the largest interior child while there's room
+    uint32 children[ REX_SIMD_WIDTH ];
+    uint32 childCount = 0;
+    children[ childCount++ ] = binaryIndex + 1;
+    children[ childCount++ ] = bvh._nodes[ binaryIndex ].Offset;
+    while ( childCount < REX_SIMD_WIDTH )
+    {
+        int32  largest     = -1;
+        real32 largestArea = -1.0f;
+        for ( uint32 i = 0; i < childCount; ++i )
+        {
+            const BVHNode& child = bvh._nodes[ children[ i ] ];
+            const real32   area  = child.Bounds.GetSurfaceArea();
+            if ( child.Count == 0 && area > largestArea )
+            {
+                largest     = static_cast<int32>( i );
+                largestArea = area;
+            }
+        }
+        if ( largest < 0 )
+        {
+            break;
+        }
+
+        const uint32 opened      = children[ largest ];
+        children[ largest ]      = opened + 1;
+        children[ childCount++ ] = bvh._nodes[ opened ].Offset;
+    }
+
+    // claim this node's index before its children take theirs, so that every subtree follows its root
+    if ( !AddNode( nodeIndex ) )
+    {
+        return false;
+    }
+
+    vec3   mins   [ REX_SIMD_WIDTH ];
+    vec3   maxs   [ REX_SIMD_WIDTH ];
+    uint32 offsets[ REX_SIMD_WIDTH ];
+    uint32 counts [ REX_SIMD_WIDTH ];
+    for ( uint32 i = 0; i < childCount; ++i )
+    {
+        const BVHNode& child = bvh._nodes[ children[ i ] ];
+        mins  [ i ] = child.Bounds.GetMin();
+        maxs  [ i ] = child.Bounds.GetMax();
+        counts[ i ] = 0;
+        const bool added = ( child.Count > 0 ) ? AddLeaf( bvh, child.Offset, child.Count, offsets[ i ], counts[ i ] )
+                                               : CollapseNode( bvh, children[ i ], offsets[ i ] );
+        if ( !added )
+        {
+            return false;
+        }
+    }
+
+    // the nodes may have moved while the children were collapsed, so this one is only filled in now
+    WideBVHNode& node = _nodes[ nodeIndex ];
+    SetChildBounds( node, mins, maxs, childCount );
+    for ( uint32 i = 0; i < childCount; ++i )
+    {
+        node.Offset[ i ] = offsets[ i ];
+        node.Count [ i ] = counts [ i ];
+    }
+    node.ChildCount = childCount;
+
+    return true;
+}
+
+// refit a run of nodes
+void WideBVH::RefitNodes( uint32 start, uint32 end, BoundingBox* nodeBounds )
+{
+    // children always come after their parent, so going backwards refits them first
+    for ( uint32 i = end; i > start; --i )
+    {
+        WideBVHNode& node   = _nodes[ i - 1 ];
+        BoundingBox& bounds = nodeBounds[ i - 1 ];
+        vec3         mins[ REX_SIMD_WIDTH ];
+        vec3         maxs[ REX_SIMD_WIDTH ];
+        for ( uint32 child = 0; child < node.ChildCount; ++child )
+        {
+            if ( node.Count[ child ] > 0 )
+            {
+                // every leaf belongs to exactly one node, so its primitives are only ever read here
+                const uint32 first = node.Offset[ child ];
+                const uint32 end   = first + GetLeafSize( node.Count[ child ] );
+                BoundingBox  box   = GetPrimitiveBounds( first );
+                for ( uint32 j = first + 1; j < end; ++j )
+                {
+                    box.Merge( GetPrimitiveBounds( j ) );
+                }
+                mins[ child ] = box.GetMin();
+                maxs[ child ] = box.GetMax();
+            }
+            else
+            {
+                mins[ child ] = nodeBounds[ node.Offset[ child ] ].GetMin();
+                maxs[ child ] = nodeBounds[ node.Offset[ child ] ].GetMax();
+            }
+        }
+
+        SetChildBounds( node, mins, maxs, node.ChildCount );
+        bounds = BoundingBox( mins[ 0 ], maxs[ 0 ] );
+        for ( uint32 child = 1; child < node.ChildCount; ++child )
+        {
+            bounds.Merge( BoundingBox( mins[ child ], maxs[ child ] ) );
+        }
+    }
+}
+
+// get the current bounds of one of the leaves' primitives
+BoundingBox WideBVH::GetPrimitiveBounds( uint32 index ) const
+{
+    const WideBVHPrimitive& primitive = _primitives[ index ];
+    return _geometry[ primitive.Geometry ]->GetPrimitiveBounds( primitive.Primitive );
+}
+
+// get the number of bytes used by this wide BVH
+uint64 WideBVH::GetMemoryUsage() const
+{
+    return static_cast<uint64>( _nodeCapacity ) * sizeof( WideBVHNode )
+         + static_cast<uint64>( _primitives.capacity() ) * sizeof( WideBVHPrimitive )
+         + static_cast<uint64>( _geometry.capacity() ) * sizeof( const Geometry* );
+}
+
+// get the bounds of one of a node's children
+BoundingBox WideBVH::GetChildBounds( const WideBVHNode& node, uint32 child )
+{
+#if REX_QUANTIZED_BVH
+    // decoded the same way the slab test decodes them
+    const vec3 origin( node.Origin[ 0 ], node.Origin[ 1 ], node.Origin[ 2 ] );
+    const vec3 scale ( node.Scale [ 0 ], node.Scale [ 1 ], node.Scale [ 2 ] );
+    const vec3 min   ( node.MinX[ child ], node.MinY[ child ], node.MinZ[ child ] );
+    const vec3 max   ( node.MaxX[ child ], node.MaxY[ child ], node.MaxZ[ child ] );
+    return BoundingBox( origin + min * scale, origin + max * scale );
+#else
+    return BoundingBox( vec3( node.MinX[ child ], node.MinY[ child ], node.MinZ[ child ] ),
+                        vec3( node.MaxX[ child ], node.MaxY[ child ], node.MaxZ[ child ] ) );
+#endif
+}
+
+// get the SAH cost of this wide BVH
+real32 WideBVH::GetCost( real32 traversalCost ) const
+{
+    if ( _nodeCount == 0 )
+    {
+        return 0.0f;
+    }
+
+    // the root's box is the one around all of its children
+    const WideBVHNode& root       = _nodes[ 0 ];
+    BoundingBox        rootBounds = GetChildBounds( root, 0 );
+    for ( uint32 child = 1; child < root.ChildCount; ++child )
+    {
+        rootBounds.Merge( GetChildBounds( root, child ) );
+    }
+
+    // every ray through the root visits it, and each child costs what it takes to visit weighted by the chance it's hit
+    const real32 rootArea    = rootBounds.GetSurfaceArea();
+    real32       cost        = traversalCost;
+    uint32       objectCount = 0;
+    for ( uint32 i = 0; i < _nodeCount; ++i )
+    {
+        const WideBVHNode& node = _nodes[ i ];
+        for ( uint32 child = 0; child < node.ChildCount; ++child )
+        {
+            const real32 area = GetChildBounds( node, child ).GetSurfaceArea();
+            const uint32 size = GetLeafSize( node.Count[ child ] );
+            cost        += area * ( ( size > 0 ) ? static_cast<real32>( size ) : traversalCost );
+            objectCount += size;
+        }
+    }
+    return ( rootArea > 0.0f ) ? ( cost - traversalCost ) / rootArea + traversalCost : static_cast<real32>( objectCount );
+}
+
+// test a ray against every child of a node
+uint32 WideBVH::IntersectChildren( const WideBVHNode& node, const Ray& ray, const vec3& invDirection, real32 tmax, real32* entries )
+{
+    // this is the same slab test as BoundingBox::Intersects, but for every child at once
+    const SimdReal ox   = SimdReal( ray.Origin.x );
+    const SimdReal oy   = SimdReal( ray.Origin.y );
+    const SimdReal oz   = SimdReal( ray.Origin.z );
+    const SimdReal idx  = SimdReal( invDirection.x );
+    const SimdReal idy  = SimdReal( invDirection.y );
+    const SimdReal idz  = SimdReal( invDirection.z );
+
+#if REX_QUANTIZED_BVH
+    // decode the planes first, so the slab test itself is unchanged
+    const SimdReal sx   = SimdReal( node.Scale [ 0 ] );
+    const SimdReal sy   = SimdReal( node.Scale [ 1 ] );
+    const SimdReal sz   = SimdReal( node.Scale [ 2 ] );
+    const SimdReal bx   = SimdReal( node.Origin[ 0 ] );
+    const SimdReal by   = SimdReal( node.Origin[ 1 ] );
+    const SimdReal bz   = SimdReal( node.Origin[ 2 ] );
+    const SimdReal minX = bx + LoadPlanes( node.MinX ) * sx;
+    const SimdReal maxX = bx + LoadPlanes( node.MaxX ) * sx;
+    const SimdReal minY = by + LoadPlanes( node.MinY ) * sy;
+    const SimdReal maxY = by + LoadPlanes( node.MaxY ) * sy;
+    const SimdReal minZ = bz + LoadPlanes( node.MinZ ) * sz;
+    const SimdReal maxZ = bz + LoadPlanes( node.MaxZ ) * sz;
+#else
+    const SimdReal minX = SimdReal::Load( node.MinX );
+    const SimdReal maxX = SimdReal::Load( node.MaxX );
+    const SimdReal minY = SimdReal::Load( node.MinY );
+    const SimdReal maxY = SimdReal::Load( node.MaxY );
+    const SimdReal minZ = SimdReal::Load( node.MinZ );
+    const SimdReal maxZ = SimdReal::Load( node.MaxZ );
+#endif
+
+    const SimdReal t1   = ( minX - ox ) * idx;
+    const SimdReal t2   = ( maxX - ox ) * idx;
+    const SimdReal t3   = ( minY - oy ) * idy;
+    const SimdReal t4   = ( maxY - oy ) * idy;
+    const SimdReal t5   = ( minZ - oz ) * idz;
+    const SimdReal t6   = ( maxZ - oz ) * idz;
+
+    const SimdReal tmin = SimdReal::Max( SimdReal::Max( SimdReal::Min( t1, t2 ), SimdReal::Min( t3, t4 ) ), SimdReal::Min( t5, t6 ) );
+    const SimdReal tout = SimdReal::Min( SimdReal::Min( SimdReal::Max( t1, t2 ), SimdReal::Max( t3, t4 ) ), SimdReal::Max( t5, t6 ) );
+
+    // children that start past the given distance can be skipped entirely
+    const SimdReal hit  = ( tout >= SimdReal( 0.0f ) ) & ( tmin <= tout ) & ( tmin < SimdReal( tmax ) );
+    tmin.Store( entries );
+    return hit.ToBits() & ( ( 1U << node.ChildCount ) - 1 );
+}
+
+// test a ray against up to one triangle per lane
+uint32 WideBVH::IntersectTriangles( const WideBVHPrimitive* primitives, uint32 count, const Ray& ray, real32 tmax, WideBVHLaneHits& hits ) const
+{
+    // gather each lane's triangle from its geometry, leaving any unused lanes flat so that they can never be hit
+    count = Math::Min( count, static_cast<uint32>( REX_SIMD_WIDTH ) );
+    alignas( REX_SIMD_ALIGNMENT ) real32 lanes[ 9 ][ REX_SIMD_WIDTH ] = {};
+    for ( uint32 lane = 0; lane < count; ++lane )
+    {
+        const Geometry*    geometry = _geometry[ primitives[ lane ].Geometry ];
+        const TriangleData triangle = ( geometry->GetType() == GeometryType::Mesh )
+                                    ? static_cast<const Mesh*>( geometry )->GetTriangleData( primitives[ lane ].Primitive )
+                                    : static_cast<const Triangle*>( geometry )->_data;
+        lanes[ 0 ][ lane ] = triangle.Origin.x;
+        lanes[ 1 ][ lane ] = triangle.Origin.y;
+        lanes[ 2 ][ lane ] = triangle.Origin.z;
+        lanes[ 3 ][ lane ] = triangle.Edge1.x;
+        lanes[ 4 ][ lane ] = triangle.Edge1.y;
+        lanes[ 5 ][ lane ] = triangle.Edge1.z;
+        lanes[ 6 ][ lane ] = triangle.Edge2.x;
+        lanes[ 7 ][ lane ] = triangle.Edge2.y;
+        lanes[ 8 ][ lane ] = triangle.Edge2.z;
+    }
+
+    // Moller-Trumbore (see TriangleData::Intersect), with the triangle terms in SIMD
+
+    const SimdReal e1x    = SimdReal::Load( lanes[ 3 ] );
+    const SimdReal e1y    = SimdReal::Load( lanes[ 4 ] );
+    const SimdReal e1z    = SimdReal::Load( lanes[ 5 ] );
+    const SimdReal e2x    = SimdReal::Load( lanes[ 6 ] );
+    const SimdReal e2y    = SimdReal::Load( lanes[ 7 ] );
+    const SimdReal e2z    = SimdReal::Load( lanes[ 8 ] );
+    const SimdReal dx     = SimdReal( ray.Direction.x );
+    const SimdReal dy     = SimdReal( ray.Direction.y );
+    const SimdReal dz     = SimdReal( ray.Direction.z );
+    const SimdReal tx     = SimdReal( ray.Origin.x ) - SimdReal::Load( lanes[ 0 ] );
+    const SimdReal ty     = SimdReal( ray.Origin.y ) - SimdReal::Load( lanes[ 1 ] );
+    const SimdReal tz     = SimdReal( ray.Origin.z ) - SimdReal::Load( lanes[ 2 ] );
+    const SimdReal px     = dy * e2z - dz * e2y;
+    const SimdReal py     = dz * e2x - dx * e2z;
+    const SimdReal pz     = dx * e2y - dy * e2x;
+    const SimdReal qx     = ty * e1z - tz * e1y;
+    const SimdReal qy     = tz * e1x - tx * e1z;
+    const SimdReal qz     = tx * e1y - ty * e1x;
+
+    // lanes parallel to their triangle end up with infinite or NaN values, which fail every comparison below
+    const SimdReal invDet = SimdReal( 1.0f ) / ( e1x * px + e1y * py + e1z * pz );
+    const SimdReal beta   = ( tx  * px + ty  * py + tz  * pz ) * invDet;
+    const SimdReal gamma  = ( dx  * qx + dy  * qy + dz  * qz ) * invDet;
+    const SimdReal t      = ( e2x * qx + e2y * qy + e2z * qz ) * invDet;
+
+    const SimdReal zero   = SimdReal( 0.0f );
+    const SimdReal hit    = ( beta >= zero )
+                          & ( gamma >= zero )
+                          & ( beta + gamma <= SimdReal( 1.0f ) )
+                          & ( t >= SimdReal( Math::Epsilon() ) )
+                          & ( t < SimdReal( tmax ) );
+
+    t    .Store( hits.T );
+    beta .Store( hits.Beta );
+    gamma.Store( hits.Gamma );
+    return hit.ToBits() & GetLaneMask( count );
+}
+
+// test a ray against up to one sphere per lane
+uint32 WideBVH::IntersectSpheres( const WideBVHPrimitive* primitives, uint32 count, const Ray& ray, real32 tmax, WideBVHLaneHits& hits ) const
+{
+    // gather each lane's sphere from its geometry, leaving any unused lanes empty so that they can never be hit
+    count = Math::Min( count, static_cast<uint32>( REX_SIMD_WIDTH ) );
+    alignas( REX_SIMD_ALIGNMENT ) real32 lanes[ 4 ][ REX_SIMD_WIDTH ] = {};
+    for ( uint32 lane = 0; lane < count; ++lane )
+    {
+        const Sphere* sphere = static_cast<const Sphere*>( _geometry[ primitives[ lane ].Geometry ] );
+        lanes[ 0 ][ lane ] = sphere->_center.x;
+        lanes[ 1 ][ lane ] = sphere->_center.y;
+        lanes[ 2 ][ lane ] = sphere->_center.z;
+        lanes[ 3 ][ lane ] = sphere->_radius;
+    }
+
+    // from Suffern, 58 (see Sphere::Hit), with the sphere terms in SIMD
+
+    const SimdReal dx     = SimdReal( ray.Direction.x );
+    const SimdReal dy     = SimdReal( ray.Direction.y );
+    const SimdReal dz     = SimdReal( ray.Direction.z );
+    const SimdReal tx     = SimdReal( ray.Origin.x ) - SimdReal::Load( lanes[ 0 ] );
+    const SimdReal ty     = SimdReal( ray.Origin.y ) - SimdReal::Load( lanes[ 1 ] );
+    const SimdReal tz     = SimdReal( ray.Origin.z ) - SimdReal::Load( lanes[ 2 ] );
+    const SimdReal radius = SimdReal::Load( lanes[ 3 ] );
+    const SimdReal a      = SimdReal( glm::dot( ray.Direction, ray.Direction ) );
+    const SimdReal b      = ( tx * dx + ty * dy + tz * dz ) * SimdReal( 2.0f );
+    const SimdReal c      = tx * tx + ty * ty + tz * tz - radius * radius;
+    const SimdReal disc   = b * b - SimdReal( 4.0f ) * a * c;
+
+    // lanes that miss end up with a NaN root, but they're masked off by the discriminant anyway
+    const SimdReal e      = SimdReal::Sqrt( disc );
+    const SimdReal denom  = SimdReal( 1.0f ) / ( SimdReal( 2.0f ) * a );
+    const SimdReal eps    = SimdReal( Math::Epsilon() );
+    const SimdReal zero   = SimdReal( 0.0f );
+    const SimdReal tnear  = ( zero - b - e ) * denom;
+    const SimdReal tfar   = ( zero - b + e ) * denom;
+    const SimdReal t      = SimdReal::Select( tnear > eps, tnear, tfar );
+
+    const SimdReal hit    = ( disc >= zero )
+                          & ( t > eps )
+                          & ( t < SimdReal( tmax ) );
+
+    t   .Store( hits.T );
+    zero.Store( hits.Beta );
+    zero.Store( hits.Gamma );
+    return hit.ToBits() & GetLaneMask( count );
+}
+
+// record the nearest of the given lanes' hits
+bool WideBVH::RecordNearestHit( const WideBVHPrimitive* primitives, uint32 mask, const WideBVHLaneHits& hits, real32& dist, HitRecord& hit ) const
+{
+    if ( !mask )
+    {
+        return false;
+    }
+
+    // every lane's hit is already closer than the distance it was tested against
+    const uint32 lane = GetNearestLane( mask, hits.T );
+    dist          = hits.T[ lane ];
+    hit.Object    = _geometry[ primitives[ lane ].Geometry ];
+    hit.Primitive = primitives[ lane ].Primitive;
+    hit.T         = hits.T    [ lane ];
+    hit.Beta      = hits.Beta [ lane ];
+    hit.Gamma     = hits.Gamma[ lane ];
+    return true;
+}
+
+// query the intersections of the given ray
+const Geometry* WideBVH::QueryIntersections( const Ray& ray, real32& dist, HitRecord& hit ) const
+{
+    dist = Math::HugeValue();
+    if ( _nodeCount == 0 )
+    {
+        return nullptr;
+    }
+
+    // the root is treated like an interior child that the ray has already entered
+    return QueryIntersectionsFrom( 0, 0, ray, dist, hit );
+}
+
+// query the intersections of the given ray, starting at a given node or leaf
+const Geometry* WideBVH::QueryIntersectionsFrom( uint32 offset, uint32 count, const Ray& ray, real32& dist, HitRecord& hit ) const
+{
+    const vec3        invDirection = 1.0f / ray.Direction;
+    const Geometry*   closest      = nullptr;
+    WideBVHStackEntry stack[ TRAVERSAL_STACK_SIZE ];
+    uint32            stackSize    = 0;
+    WideBVHLaneHits   hits;
+    real32            tempDist     = 0.0f;
+    HitRecord         tempHit;
+    alignas( REX_SIMD_ALIGNMENT ) real32 entries[ REX_SIMD_WIDTH ];
+
+    stack[ stackSize++ ] = { offset, count, -Math::HugeValue() };
+    while ( stackSize > 0 )
+    {
+        // skip anything that starts past our closest hit, which may have been found since it was pushed
+        const WideBVHStackEntry entry = stack[ --stackSize ];
+        if ( entry.Distance >= dist )
+        {
+            continue;
+        }
+
+        if ( entry.Count > 0 )
+        {
+            // test the leaf's triangles and spheres a register at a time, and anything else through its geometry
+            const uint32            triangleCount = GetTriangleCount( entry.Count );
+            const uint32            sphereCount   = GetSphereCount  ( entry.Count );
+            const uint32            otherCount    = GetOtherCount   ( entry.Count );
+            const WideBVHPrimitive* primitives    = &_primitives[ entry.Offset ];
+            for ( uint32 i = 0; i < triangleCount; i += REX_SIMD_WIDTH )
+            {
+                const uint32 mask = IntersectTriangles( primitives + i, triangleCount - i, ray, dist, hits );
+                if ( RecordNearestHit( primitives + i, mask, hits, dist, hit ) )
+                {
+                    closest = hit.Object;
+                }
+            }
+            primitives += triangleCount;
+
+            for ( uint32 i = 0; i < sphereCount; i += REX_SIMD_WIDTH )
+            {
+                const uint32 mask = IntersectSpheres( primitives + i, sphereCount - i, ray, dist, hits );
+                if ( RecordNearestHit( primitives + i, mask, hits, dist, hit ) )
+                {
+                    // the lanes' roots are a little less precise than the sphere's own test, and shading offsets
+                    // its shadow rays by less than that difference, so the nearest hit is found again exactly
+                    static_cast<const Sphere*>( hit.Object )->Sphere::Hit( ray, dist, hit );
+                    closest = hit.Object;
+                }
+            }
+            primitives += sphereCount;
+
+            for ( uint32 i = 0; i < otherCount; ++i )
+            {
+                const Geometry* geometry = _geometry[ primitives[ i ].Geometry ];
+                if ( geometry->HitPrimitive( primitives[ i ].Primitive, ray, tempDist, tempHit ) && ( tempDist < dist ) )
+                {
+                    closest = geometry;
+                    dist    = tempDist;
+                    hit     = tempHit;
+                }
+            }
+        }
+        else
+        {
+            const WideBVHNode& node = _nodes[ entry.Offset ];
+            const uint32       mask = IntersectChildren( node, ray, invDirection, dist, entries );
+            PushChildren( node, mask, entries, stack, stackSize );
+        }
+    }
+
+    return closest;
+}
+
+// checks to see if anything blocks the given ray
+bool WideBVH::QueryOcclusion( const Ray& ray, real32 tmax ) const
+{
+    if ( _nodeCount == 0 )
+    {
+        return false;
+    }
+
+    const vec3        invDirection = 1.0f / ray.Direction;
+    WideBVHStackEntry stack[ TRAVERSAL_STACK_SIZE ];
+    uint32            stackSize    = 0;
+    WideBVHLaneHits   hits;
+    real32            d            = 0.0f;
+    alignas( REX_SIMD_ALIGNMENT ) real32 entries[ REX_SIMD_WIDTH ];
+
+    stack[ stackSize++ ] = { 0, 0, 0.0f };
+    while ( stackSize > 0 )
+    {
+        const WideBVHStackEntry entry = stack[ --stackSize ];
+        if ( entry.Count > 0 )
+        {
+            // any blocker at all will do, so stop at the first one
+            const uint32            triangleCount = GetTriangleCount( entry.Count );
+            const uint32            sphereCount   = GetSphereCount  ( entry.Count );
+            const uint32            otherCount    = GetOtherCount   ( entry.Count );
+            const WideBVHPrimitive* primitives    = &_primitives[ entry.Offset ];
+            for ( uint32 i = 0; i < triangleCount; i += REX_SIMD_WIDTH )
+            {
+                if ( IntersectTriangles( primitives + i, triangleCount - i, ray, tmax, hits ) )
+                {
+                    return true;
+                }
+            }
+            primitives += triangleCount;
+
+            for ( uint32 i = 0; i < sphereCount; i += REX_SIMD_WIDTH )
+            {
+                if ( IntersectSpheres( primitives + i, sphereCount - i, ray, tmax, hits ) )
+                {
+                    return true;
+                }
+            }
+            primitives += sphereCount;
+
+            for ( uint32 i = 0; i < otherCount; ++i )
+            {
+                if ( _geometry[ primitives[ i ].Geometry ]->ShadowHitPrimitive( primitives[ i ].Primitive, ray, d ) && ( d < tmax ) )
+                {
+                    return true;
+                }
+            }
+        }
+        else
+        {
+            // the nearest children are the likeliest to block the ray, so they're still visited first
+            const WideBVHNode& node = _nodes[ entry.Offset ];
+            const uint32       mask = IntersectChildren( node, ray, invDirection, tmax, entries );
+            PushChildren( node, mask, entries, stack, stackSize );
+        }
+    }
+
+    return false;
+}
+
+REX_NS_END